@@ -131,6 +131,8 @@ void OCPP_initialize(OcppSocket& ocppSocket, float V_eff, ArduinoOcpp::Filesyste
 }
 
 void OCPP_deinitialize() {
+
+    configuration_save(); //write deferred changes
     
     delete ocppEngine;
     ocppEngine = nullptr;
@@ -3,6 +3,9 @@
 // MIT License
 
 #include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/StandardConfiguration.h>
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
+#include <ArduinoOcpp/Platform.h>
 #include <ArduinoOcpp/Debug.h>
 
 #include <string.h>
@@ -53,6 +56,9 @@ std::unique_ptr<ConfigurationContainer> createConfigurationContainer(const char
     if (!filesystem ||
                  !strncmp(filename, CONFIGURATION_VOLATILE, strlen(CONFIGURATION_VOLATILE))) {
         return std::unique_ptr<ConfigurationContainer>(new ConfigurationContainerVolatile(filename));
+    } else if (AO_CONFIGURATION_LOG) {
+        //persistent Configuration store which appends the changes to a log file
+        return std::unique_ptr<ConfigurationContainer>(new ConfigurationContainerLog(filesystem, filename));
     } else {
         //create persistent Configuration store. This is the normal caseS
         return std::unique_ptr<ConfigurationContainer>(new ConfigurationContainerFlash(filesystem, filename));
@@ -60,9 +66,11 @@ std::unique_ptr<ConfigurationContainer> createConfigurationContainer(const char
 }
 
 std::vector<std::shared_ptr<ConfigurationContainer>> configurationContainers;
+ConfigurationIndex configurationIndex; //keys of all registered containers
 
 void addConfigurationContainer(std::shared_ptr<ConfigurationContainer> container) {
     configurationContainers.push_back(container);
+    container->attachIndex(&configurationIndex);
 }
 
 std::vector<std::shared_ptr<ConfigurationContainer>>::iterator getConfigurationContainersBegin() {
@@ -76,7 +84,8 @@ std::vector<std::shared_ptr<ConfigurationContainer>>::iterator getConfigurationC
 std::shared_ptr<ConfigurationContainer> getContainer(const char *filename) {
     std::vector<std::shared_ptr<ConfigurationContainer>>::iterator container = std::find_if(configurationContainers.begin(), configurationContainers.end(),
         [filename](std::shared_ptr<ConfigurationContainer> &elem) {
-            return !strcmp(elem->getFilename(), filename);
+            //the declarations usually pass the same string constant
+            return elem->getFilename() == filename || !strcmp(elem->getFilename(), filename);
         });
 
     if (container != configurationContainers.end()) {
@@ -86,23 +95,29 @@ std::shared_ptr<ConfigurationContainer> getContainer(const char *filename) {
     }
 }
 
-template<class T>
-std::shared_ptr<Configuration<T>> declareConfiguration(const char *key, T defaultValue, const char *filename, bool remotePeerCanWrite, bool remotePeerCanRead, bool localClientCanWrite, bool rebootRequiredWhenChanged) {
-    //already existent? --> stored in last session --> do set default content, but set writepermission flag
-    
+std::shared_ptr<ConfigurationContainer> declareContainer(const char *filename) {
     std::shared_ptr<ConfigurationContainer> container = getContainer(filename);
     
     if (!container) {
         AO_DBG_INFO("init new configurations container: %s", filename);
 
         container = createConfigurationContainer(filename);
-        configurationContainers.push_back(container);
+        addConfigurationContainer(container);
 
         if (!container->load()) {
             AO_DBG_WARN("Cannot load file contents. Path will be overwritten");
         }
     }
 
+    return container;
+}
+
+template<class T>
+std::shared_ptr<Configuration<T>> declareConfiguration(const char *key, T defaultValue, const char *filename, bool remotePeerCanWrite, bool remotePeerCanRead, bool localClientCanWrite, bool rebootRequiredWhenChanged) {
+    //already existent? --> stored in last session --> do set default content, but set writepermission flag
+    
+    std::shared_ptr<ConfigurationContainer> container = declareContainer(filename);
+
     std::shared_ptr<AbstractConfiguration> configuration = container->getConfiguration(key);
 
     if (configuration && strcmp(configuration->getSerializedType(), SerializedType<T>::get())) {
@@ -136,17 +151,49 @@ std::shared_ptr<Configuration<T>> declareConfiguration(const char *key, T defaul
     return configurationConcrete;
 }
 
+void declareStandardConfigurations() {
+    for (auto& entry : Ocpp16::standardConfigurationTable) {
+        std::shared_ptr<ConfigurationContainer> container = declareContainer(entry.filename);
+
+        //static storage: the shared_ptr doesn't own the configuration and doesn't allocate a control block
+        std::shared_ptr<AbstractConfiguration> configuration {std::shared_ptr<AbstractConfiguration>(), entry.configuration};
+
+        std::shared_ptr<AbstractConfiguration> stored = container->getConfiguration(entry.key);
+        if (stored == configuration) {
+            continue; //already registered
+        }
+
+        if (stored && configuration->adoptValue(*stored)) {
+            //take over the value from the previous session. The static object takes the slot of the loaded one, so
+            //the container doesn't need to write anything
+            container->replaceConfiguration(stored, configuration);
+        } else {
+            if (stored) {
+                AO_DBG_ERR("conflicting declared types. Discard old config");
+                container->removeConfiguration(stored);
+            }
+            container->addConfiguration(configuration);
+        }
+
+        if (!entry.remotePeerCanWrite)
+            configuration->revokePermissionRemotePeerCanWrite();
+        if (!entry.remotePeerCanRead)
+            configuration->revokePermissionRemotePeerCanRead();
+        if (!entry.localClientCanWrite)
+            configuration->revokePermissionLocalClientCanWrite();
+        if (entry.rebootRequiredWhenChanged)
+            configuration->requireRebootWhenChanged();
+    }
+}
+
 namespace Ocpp16 {
 
 std::shared_ptr<AbstractConfiguration> getConfiguration(const char *key) {
-    std::shared_ptr<AbstractConfiguration> result = nullptr;
-
-    for (auto container = configurationContainers.begin(); container != configurationContainers.end(); container++) {
-        result = (*container)->getConfiguration(key);
-        if (result)
-            return result;
+    auto entry = configurationIndex.find(key);
+    if (!entry) {
+        return nullptr;
     }
-    return nullptr;
+    return entry->configuration;
 }
 
 std::unique_ptr<std::vector<std::shared_ptr<AbstractConfiguration>>> getAllConfigurations() { //TODO maybe change to iterator?
@@ -177,6 +224,7 @@ bool configuration_init(std::shared_ptr<FilesystemAdapter> _filesystem) {
     filesystem = _filesystem;
 
     if (!filesystem) {
+        declareStandardConfigurations();
         configuration_inited = true;
         return true; //no filesystem, nothing can go wrong
     }
@@ -202,25 +250,102 @@ bool configuration_init(std::shared_ptr<FilesystemAdapter> _filesystem) {
             AO_DBG_ERR("Loading default configurations file failed");
             success = false;
         }
-        configurationContainers.push_back(containerDefault);
+        addConfigurationContainer(containerDefault);
     }
 
+    declareStandardConfigurations();
+
     configuration_inited = success;
     return success;
 }
 
-bool configuration_save() {
+static bool configuration_save_scheduled = false;
+static unsigned long configuration_save_scheduled_at = 0;
+
+//writes the changed containers, but doesn't wait for the writes in the background
+static bool configuration_write() {
     bool success = true;
 
+    //containers without changes skip writing
     for (auto container = configurationContainers.begin(); container != configurationContainers.end(); container++) {
         if (!(*container)->save()) {
             success = false;
         }
     }
 
+    //the changes of failed containers are still pending. Try again after the flush window
+    configuration_save_scheduled = !success;
+    configuration_save_scheduled_at = ao_tick_ms();
+
     return success;
 }
 
+bool configuration_save() {
+    bool success = configuration_write();
+
+    //the result of the writes in the background (see PersistenceExecutor)
+    persistence_flush();
+    for (auto container = configurationContainers.begin(); container != configurationContainers.end(); container++) {
+        if ((*container)->hasWriteFailed()) {
+            success = false;
+        }
+    }
+
+    if (!success && !configuration_save_scheduled) {
+        configuration_save_scheduled = true;
+        configuration_save_scheduled_at = ao_tick_ms();
+    }
+
+    return success;
+}
+
+void configuration_save_deferred() {
+    if (AO_CONFIG_FLUSH_WINDOW <= 0) {
+        configuration_write();
+        return;
+    }
+
+    if (!configuration_save_scheduled) {
+        configuration_save_scheduled = true;
+        configuration_save_scheduled_at = ao_tick_ms();
+    }
+}
+
+void configuration_loop() {
+    if (!configuration_save_scheduled) {
+        //writes which failed in the background are retried like deferred saves
+        for (auto container = configurationContainers.begin(); container != configurationContainers.end(); container++) {
+            if ((*container)->hasWriteFailed()) {
+                AO_DBG_ERR("could not write %s. Retry", (*container)->getFilename());
+                configuration_save_scheduled = true;
+                configuration_save_scheduled_at = ao_tick_ms();
+                break;
+            }
+        }
+    }
+
+    if (configuration_save_scheduled &&
+            ao_tick_ms() - configuration_save_scheduled_at >= (unsigned long) AO_CONFIG_FLUSH_WINDOW) {
+        if (!configuration_write()) {
+            AO_DBG_ERR("could not write changes to flash. Retry");
+            (void)0;
+        }
+    }
+}
+
+unsigned int configuration_write_count() {
+    unsigned int count = 0;
+    for (auto container = configurationContainers.begin(); container != configurationContainers.end(); container++) {
+        count += (*container)->getWriteCount();
+    }
+    return count;
+}
+
+uint32_t configuration_revision() {
+    //both counters only increase, so the sum changes with each of them
+    return AbstractConfiguration::getGlobalRevision() + configurationIndex.getRevision();
+}
+
 template std::shared_ptr<Configuration<int>> createConfiguration(const char *key, int value);
 template std::shared_ptr<Configuration<float>> createConfiguration(const char *key, float value);
 template std::shared_ptr<Configuration<bool>> createConfiguration(const char *key, bool value);
@@ -8,6 +8,7 @@
 #include <ArduinoOcpp/Core/ConfigurationKeyValue.h>
 #include <ArduinoOcpp/Core/ConfigurationOptions.h>
 #include <ArduinoOcpp/Core/ConfigurationContainerFlash.h>
+#include <ArduinoOcpp/Core/ConfigurationContainerLog.h>
 #include <ArduinoOcpp/Core/FilesystemAdapter.h>
 
 #include <memory>
@@ -16,6 +17,14 @@
 #define CONFIGURATION_FN (AO_FILENAME_PREFIX "/arduino-ocpp.cnf")
 #define CONFIGURATION_VOLATILE "/volatile"
 
+#ifndef AO_CONFIG_FLUSH_WINDOW
+#define AO_CONFIG_FLUSH_WINDOW 1000 //in ms. Deferred saves within this time are written together
+#endif
+
+#ifndef AO_CONFIGURATION_LOG
+#define AO_CONFIGURATION_LOG 0 //1: store the persistent containers in append-only logs (see ConfigurationContainerLog)
+#endif
+
 namespace ArduinoOcpp {
 
 template <class T>
@@ -33,7 +42,23 @@ namespace Ocpp16 {
 }
 
 bool configuration_init(std::shared_ptr<FilesystemAdapter> filesytem);
-bool configuration_save();
+bool configuration_save(); //writes all changed containers now and waits until they are on flash. Use on durability-critical paths
+
+/*
+ * Coalesced saving: configuration_save_deferred() only marks the configurations as changed. configuration_loop()
+ * writes the changed containers once AO_CONFIG_FLUSH_WINDOW has passed since the first deferred save. Failed
+ * writes are tried again after the next AO_CONFIG_FLUSH_WINDOW
+ */
+void configuration_save_deferred();
+void configuration_loop();
+
+unsigned int configuration_write_count(); //number of container writes since the start
+
+/*
+ * Changes whenever a configuration is added or removed, or when any value or permission changes. Allows to cache
+ * data derived from the configurations
+ */
+uint32_t configuration_revision();
 
 } //end namespace ArduinoOcpp
 #endif
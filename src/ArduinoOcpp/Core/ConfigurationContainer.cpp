@@ -4,9 +4,22 @@
 
 #include <ArduinoOcpp/Core/ConfigurationContainer.h>
 
+#include <algorithm>
+
 namespace ArduinoOcpp {
 
 std::shared_ptr<AbstractConfiguration> ConfigurationContainer::getConfiguration(const char *key) {
+    if (index) {
+        auto entry = index->find(key);
+        if (!entry) {
+            return nullptr;
+        }
+        if (entry->container == this) {
+            return entry->configuration;
+        }
+        //the key belongs to another container. Search for a duplicate in this one
+    }
+
     for (std::vector<std::shared_ptr<AbstractConfiguration>>::iterator configuration = configurations.begin(); configuration != configurations.end(); configuration++) {
         if ((*configuration)->keyEquals(key)) {
             return *configuration;
@@ -21,6 +34,9 @@ bool ConfigurationContainer::removeConfiguration(std::shared_ptr<AbstractConfigu
     auto config_rev = configurations_revision.begin();
     while (config != configurations.end()) {
         if ((*config) == configuration) {
+            if (index) {
+                index->remove(configuration.get());
+            }
             configurations.erase(config);
             if (config_rev != configurations_revision.end())
                 configurations_revision.erase(config_rev);
@@ -36,6 +52,30 @@ bool ConfigurationContainer::removeConfiguration(std::shared_ptr<AbstractConfigu
 
 void ConfigurationContainer::addConfiguration(std::shared_ptr<AbstractConfiguration> configuration) {
     configurations.push_back(configuration);
+    if (index) {
+        index->add(configuration, this);
+    }
+}
+
+bool ConfigurationContainer::replaceConfiguration(std::shared_ptr<AbstractConfiguration> configuration, std::shared_ptr<AbstractConfiguration> replacement) {
+    auto config = std::find(configurations.begin(), configurations.end(), configuration);
+    if (config == configurations.end()) {
+        return false;
+    }
+
+    if (index && !index->replace(configuration.get(), replacement)) {
+        index->remove(configuration.get());
+        index->add(replacement, this);
+    }
+    *config = replacement;
+    return true;
+}
+
+void ConfigurationContainer::attachIndex(ConfigurationIndex *index) {
+    this->index = index;
+    if (index) {
+        index->addContainer(this);
+    }
 }
 
 bool ConfigurationContainer::configurationsUpdated() {
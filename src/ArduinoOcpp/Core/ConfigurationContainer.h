@@ -9,6 +9,7 @@
 #include <memory>
 
 #include <ArduinoOcpp/Core/ConfigurationKeyValue.h>
+#include <ArduinoOcpp/Core/ConfigurationIndex.h>
 
 namespace ArduinoOcpp {
 
@@ -16,14 +17,18 @@ class ConfigurationContainer {
 private:
     std::vector<uint16_t> configurations_revision;
     const char *filename;
+    ConfigurationIndex *index = nullptr; //set when the container is registered
 
 protected:
     std::vector<std::shared_ptr<AbstractConfiguration>> configurations;
+    unsigned int writeCount = 0;
+    bool writeFailed = false; //a write of the last save() failed. The changes are written again with the next save()
 
     ConfigurationContainer(const char *filename) : filename(filename) { }
 
     //Checks if configurations_revision is equal to (for all) configurations->getValueRevision(). If not, it refreshes the record
     bool configurationsUpdated();
+    void resetRevisions() {configurations_revision.clear();} //the next configurationsUpdated() reports all configurations
 public:
     virtual ~ConfigurationContainer() = default;
 
@@ -32,12 +37,17 @@ public:
     virtual bool save() = 0;
 
     const char *getFilename() {return filename;};
+    unsigned int getWriteCount() {return writeCount;}
+    bool hasWriteFailed() {return writeFailed;} //the background write of the last save() failed
 
     std::shared_ptr<AbstractConfiguration> getConfiguration(const char *key);
     std::vector<std::shared_ptr<AbstractConfiguration>>::iterator configurationsIteratorBegin() {return configurations.begin();}
     std::vector<std::shared_ptr<AbstractConfiguration>>::iterator configurationsIteratorEnd() {return configurations.end();}
-    bool removeConfiguration(std::shared_ptr<AbstractConfiguration> configuration);
+    virtual bool removeConfiguration(std::shared_ptr<AbstractConfiguration> configuration);
     void addConfiguration(std::shared_ptr<AbstractConfiguration> configuration);
+    bool replaceConfiguration(std::shared_ptr<AbstractConfiguration> configuration, std::shared_ptr<AbstractConfiguration> replacement); //keeps the position and the recorded revision
+
+    void attachIndex(ConfigurationIndex *index); //adds the configurations to index and keeps it up to date
 };
 
 class ConfigurationContainerVolatile : public ConfigurationContainer {
@@ -4,6 +4,7 @@
 
 #include <ArduinoOcpp/Core/ConfigurationContainerFlash.h>
 #include <ArduinoOcpp/Core/FilesystemUtils.h>
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
 #include <ArduinoOcpp/Debug.h>
 
 #include <algorithm>
@@ -12,14 +13,24 @@
 #define MAX_CONFIGURATIONS 50
 #define MAX_CONFJSON_CAPACITY 4000
 
+#ifndef AO_CONFIGURATION_FORMAT
+#define AO_CONFIGURATION_FORMAT AO_STORAGE_JSON //keep the configuration files human-readable
+#endif
+
 namespace ArduinoOcpp {
 
+ConfigurationContainerFlash::~ConfigurationContainerFlash() {
+    persistence_flush(); //the completion callback refers to this container
+}
+
 bool ConfigurationContainerFlash::load() {
 
     if (!filesystem) {
         return false;
     }
 
+    persistence_flush(); //the file may have a pending write
+
     if (configurations.size() > 0) {
         AO_DBG_ERR("Error: declared configurations before calling container->load(). " \
                     "All previously declared values won't be written back");
@@ -45,7 +56,15 @@ bool ConfigurationContainerFlash::load() {
         return false;
     }
 
+    //files can be in either format, regardless of AO_CONFIGURATION_FORMAT
+    char first = (char) file->read();
+    auto format = FilesystemUtils::detectFormat(&first, 1);
+    file->seek(0);
+
     auto jsonCapacity = std::max(file_size, (size_t) 256);
+    if (format == StorageFormat::MsgPack) {
+        jsonCapacity *= 2; //MessagePack is more compact than JSON
+    }
     DynamicJsonDocument doc {0};
     DeserializationError err = DeserializationError::NoMemory;
 
@@ -58,8 +77,13 @@ bool ConfigurationContainerFlash::load() {
         AO_DBG_DEBUG("Configs JSON capacity: %zu", jsonCapacity);
 
         doc = DynamicJsonDocument(jsonCapacity);
-        ArduinoJsonFileAdapter file_adapt {file.get()};
-        err = deserializeJson(doc, file_adapt);
+        char buf [AO_FILE_BUFSIZE];
+        ArduinoJsonFileReader file_adapt {file.get(), buf, sizeof(buf)};
+        if (format == StorageFormat::MsgPack) {
+            err = deserializeMsgPack(doc, file_adapt);
+        } else {
+            err = deserializeJson(doc, file_adapt);
+        }
 
         jsonCapacity *= 3;
         jsonCapacity /= 2;
@@ -90,22 +114,10 @@ bool ConfigurationContainerFlash::load() {
     }
 
     for (JsonObject config : configurationsArray) {
-        const char *type = config["type"] | "Undefined";
-
-        std::shared_ptr<AbstractConfiguration> configuration = nullptr;
-
-        if (!strcmp(type, SerializedType<int>::get())){
-            configuration = std::make_shared<Configuration<int>>(config);
-        } else if (!strcmp(type, SerializedType<float>::get())){
-            configuration = std::make_shared<Configuration<float>>(config);
-        } else if (!strcmp(type, SerializedType<bool>::get())){
-            configuration = std::make_shared<Configuration<bool>>(config);
-        } else if (!strcmp(type, SerializedType<const char *>::get())){
-            configuration = std::make_shared<Configuration<const char *>>(config);
-        }
+        std::shared_ptr<AbstractConfiguration> configuration = deserializeConfiguration(config);
 
         if (configuration) {
-            configurations.push_back(configuration);
+            addConfiguration(configuration);
         } else {
             AO_DBG_ERR("Initialization fault: could not read key-value pair %s of type %s", config["key"].as<const char *>(), config["type"].as<const char *>());
         }
@@ -127,17 +139,6 @@ bool ConfigurationContainerFlash::save() {
         return true; //nothing to be done
     }
 
-    size_t file_size = 0;
-    if (filesystem->stat(getFilename(), &file_size) == 0) {
-        filesystem->remove(getFilename());
-    }
-
-    auto file = filesystem->open(getFilename(), "w");
-    if (!file) {
-        AO_DBG_ERR("Unable to save: could not open configuration file %s", getFilename());
-        return false;
-    }
-
     size_t jsonCapacity = 2 * JSON_OBJECT_SIZE(2); //head + configurations + head payload
 
     std::vector<std::shared_ptr<DynamicJsonDocument>> entries;
@@ -159,7 +160,7 @@ bool ConfigurationContainerFlash::save() {
     }
 
     jsonCapacity = std::max(jsonCapacity, (size_t) 256);
-    DynamicJsonDocument doc {0};
+    auto doc = std::make_shared<DynamicJsonDocument>(0); //the write may be deferred (see PersistenceExecutor)
     bool jsonDocOverflow = true;
 
     while (jsonDocOverflow) {
@@ -168,32 +169,63 @@ bool ConfigurationContainerFlash::save() {
             return false;
         }
 
-        file->seek(0);
-
-        doc = DynamicJsonDocument(jsonCapacity);
-        JsonObject head = doc.createNestedObject("head");
+        *doc = DynamicJsonDocument(jsonCapacity);
+        JsonObject head = doc->createNestedObject("head");
         head["content-type"] = "ao_configuration_file";
         head["version"] = "1.1";
 
-        JsonArray configurationsArray = doc.createNestedArray("configurations");
+        JsonArray configurationsArray = doc->createNestedArray("configurations");
         for (auto entry = entries.begin(); entry != entries.end(); entry++) {
             configurationsArray.add((*entry)->as<JsonObject>());
         }
 
-        ArduinoJsonFileAdapter file_adapt {file.get()};
-        size_t written = serializeJson(doc, file_adapt);
-
         jsonCapacity *= 3;
         jsonCapacity /= 2;
-        jsonDocOverflow = doc.overflowed();
-
-        if (!jsonDocOverflow && written < 20) { //plausibility check
-            AO_DBG_ERR("Config serialization: unkown error for file %s", getFilename());
-            return false;
-        }
+        jsonDocOverflow = doc->overflowed();
+    }
+
+    auto filesystem = this->filesystem;
+    std::string fn = getFilename();
+    writeFailed = false;
+    if (!persist([filesystem, fn, doc] () {
+                size_t file_size = 0;
+                if (filesystem->stat(fn.c_str(), &file_size) == 0) {
+                    filesystem->remove(fn.c_str());
+                }
+
+                auto file = filesystem->open(fn.c_str(), "w");
+                if (!file) {
+                    AO_DBG_ERR("Unable to save: could not open configuration file %s", fn.c_str());
+                    return false;
+                }
+
+                //write the complete document once
+                char buf [AO_FILE_BUFSIZE];
+                ArduinoJsonFileWriter file_adapt {file.get(), buf, sizeof(buf)};
+                size_t written = 0;
+                if (AO_CONFIGURATION_FORMAT == AO_STORAGE_MSGPACK) {
+                    written = serializeMsgPack(*doc, file_adapt);
+                } else {
+                    written = serializeJson(*doc, file_adapt);
+                }
+
+                if (!file_adapt.flush() || written < 20) { //plausibility check
+                    AO_DBG_ERR("Config serialization: unkown error for file %s", fn.c_str());
+                    return false;
+                }
+                return true;
+            }, [this] (bool success) {
+                if (!success) {
+                    //the file is outdated, write all configurations again
+                    writeFailed = true;
+                    resetRevisions();
+                }
+            })) {
+        return false;
     }
 
     //success
+    writeCount++;
     AO_DBG_DEBUG("Saving configurations finished");
     return true;
 }
@@ -16,7 +16,7 @@ public:
     ConfigurationContainerFlash(std::shared_ptr<FilesystemAdapter> filesystem, const char *filename) :
             ConfigurationContainer(filename), filesystem(filesystem) { }
 
-    ~ConfigurationContainerFlash() = default;
+    ~ConfigurationContainerFlash();
 
     bool load();
 
@@ -0,0 +1,449 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/ConfigurationContainerLog.h>
+#include <ArduinoOcpp/Core/ConfigurationContainerFlash.h>
+#include <ArduinoOcpp/Core/ConfigurationIndex.h>
+#include <ArduinoOcpp/Core/FilesystemUtils.h>
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
+#include <ArduinoOcpp/Core/MemoryArena.h>
+#include <ArduinoOcpp/Core/RecordCodec.h>
+#include <ArduinoOcpp/Core/LittleEndian.h>
+#include <ArduinoOcpp/Debug.h>
+
+#include <algorithm>
+
+#ifndef AO_CONFIGURATION_FORMAT
+#define AO_CONFIGURATION_FORMAT AO_STORAGE_JSON //keep the configuration files human-readable
+#endif
+
+using namespace ArduinoOcpp;
+
+namespace ArduinoOcpp {
+namespace ConfigurationLogUtils {
+
+constexpr RecordCodec configLogRecords {false};
+
+//appends the 'S' record of configuration to out. Returns false if there is nothing to store
+bool encodeEntry(std::vector<unsigned char>& out, AbstractConfiguration& configuration) {
+    auto entry = configuration.toJsonStorageEntry();
+    if (!entry) {
+        return false; //not initialized yet
+    }
+
+    if (!configLogRecords.appendDocument(out, 'S', *entry, static_cast<StorageFormat>(AO_CONFIGURATION_FORMAT))) {
+        AO_DBG_ERR("cannot serialize %s", configuration.getKey());
+        return false;
+    }
+    return true;
+}
+
+} //end namespace ConfigurationLogUtils
+} //end namespace ArduinoOcpp
+
+using namespace ArduinoOcpp::ConfigurationLogUtils;
+
+ConfigurationContainerLog::~ConfigurationContainerLog() {
+    persistence_flush(); //the completion callbacks refer to this container
+}
+
+bool ConfigurationContainerLog::makeFn(char *fn, unsigned int segment) {
+    auto ret = snprintf(fn, MAX_PATH_SIZE, "%s.%u", getFilename(), segment);
+    if (ret < 0 || ret >= MAX_PATH_SIZE) {
+        AO_DBG_ERR("fn error: %i", ret);
+        return false;
+    }
+    return true;
+}
+
+bool ConfigurationContainerLog::load() {
+
+    if (!filesystem) {
+        return false;
+    }
+
+    persistence_flush(); //the log may have pending records
+
+    if (configurations.size() > 0) {
+        AO_DBG_ERR("Error: declared configurations before calling container->load(). " \
+                    "All previously declared values won't be written back");
+        (void)0;
+    }
+
+    std::vector<std::shared_ptr<AbstractConfiguration>> loaded [2];
+    uint32_t generations [2] = {0, 0};
+    bool corrupted [2] = {false, false};
+    unsigned int recordCounts [2] = {0, 0};
+    bool valid [2] = {false, false};
+
+    for (unsigned int segment = 0; segment < 2; segment++) {
+        valid[segment] = readSegment(segment, &generations[segment], &corrupted[segment], &recordCounts[segment], loaded[segment]);
+    }
+
+    if (!valid[0] && !valid[1]) {
+        //no log yet. The first save writes the current configurations into a new segment
+        compactionRequired = true;
+        return loadLegacy();
+    }
+
+    unsigned int segment = valid[0] ? 0 : 1;
+    if (valid[0] && valid[1]) {
+        //the previous segment wasn't cleared after the compaction. The newer one is complete
+        segment = (int32_t) (generations[1] - generations[0]) > 0 ? 1 : 0;
+    }
+
+    for (auto& configuration : loaded[segment]) {
+        addConfiguration(configuration);
+        loggedRevisions.push_back(configuration->getValueRevision());
+    }
+
+    generation = generations[segment];
+    activeSegment = segment;
+    nRecords = recordCounts[segment];
+    compactionRequired = corrupted[segment];
+
+    AO_DBG_DEBUG("Loaded %zu configurations from %u records", configurations.size(), nRecords);
+    return true;
+}
+
+bool ConfigurationContainerLog::readSegment(unsigned int segment, uint32_t *generationOut, bool *corruptedOut, unsigned int *nRecordsOut,
+            std::vector<std::shared_ptr<AbstractConfiguration>>& out) {
+
+    char fn [MAX_PATH_SIZE] = {'\0'};
+    if (!makeFn(fn, segment)) {
+        return false;
+    }
+
+    size_t fsize = 0;
+    if (filesystem->stat(fn, &fsize) != 0 || fsize == 0) {
+        return false; //missing or empty spare segment
+    }
+
+    auto file = filesystem->open(fn, "r");
+    if (!file) {
+        AO_DBG_ERR("cannot open %s", fn);
+        return false;
+    }
+
+    char buf [AO_FILE_BUFSIZE];
+    ArduinoJsonFileReader reader {file.get(), buf, sizeof(buf)};
+
+    //segment start record
+    const size_t headerSize = configLogRecords.getHeaderSize();
+    unsigned char start [configLogRecords.getRecordSize(4)];
+    if (reader.readBytes((char*) start, sizeof(start)) != sizeof(start) ||
+            configLogRecords.getType(start) != 'G' ||
+            configLogRecords.getLength(start) != 4 ||
+            !configLogRecords.isIntact(start, start + headerSize, 4, start + headerSize + 4)) {
+        AO_DBG_WARN("invalid segment %s", fn);
+        return false;
+    }
+    *generationOut = readUintLE(start + headerSize, 4);
+
+    //the latest record of each key wins. The index only contains the configurations which are still valid
+    ConfigurationIndex latest;
+    std::vector<std::shared_ptr<AbstractConfiguration>> order;
+    bool complete = false;
+
+    ArenaAllocator allocator;
+
+    while (true) {
+        unsigned char header [configLogRecords.getHeaderSize()];
+        size_t nread = reader.readBytes((char*) header, sizeof(header));
+        if (nread == 0) {
+            break; //end of log
+        }
+
+        size_t length = configLogRecords.getLength(header);
+        char type = configLogRecords.getType(header);
+        bool plausible = nread == sizeof(header) &&
+                ((type == 'C' && length == 0) || ((type == 'S' || type == 'D') && length > 0));
+
+        char *data = nullptr;
+        if (plausible && length > 0) {
+            data = static_cast<char*>(allocator.allocate(length + 1));
+            if (!data) {
+                AO_DBG_ERR("OOM");
+                return false;
+            }
+        }
+
+        unsigned char crc [AO_RECORD_CRC_SIZE];
+        if (!plausible ||
+                reader.readBytes(data, length) != length ||
+                reader.readBytes((char*) crc, sizeof(crc)) != sizeof(crc) ||
+                !configLogRecords.isIntact(header, data, length, crc)) {
+            AO_DBG_WARN("configuration log %s has a corrupted tail", fn);
+            allocator.deallocate(data);
+            *corruptedOut = true;
+            break;
+        }
+
+        if (type == 'C') {
+            complete = true;
+            continue;
+        }
+
+        (*nRecordsOut)++;
+
+        if (type == 'D') {
+            data[length] = '\0';
+            auto entry = latest.find(data);
+            if (entry) {
+                latest.remove(entry->configuration.get());
+            }
+            allocator.deallocate(data);
+            continue;
+        }
+
+        auto format = FilesystemUtils::detectFormat(data, length);
+        DynamicJsonDocument doc {std::max(FilesystemUtils::measureCapacity(data, length, format), (size_t) 32)};
+        DeserializationError err = DeserializationError::InvalidInput;
+        if (format == StorageFormat::MsgPack) {
+            err = deserializeMsgPack(doc, (const char*) data, length);
+        } else {
+            err = deserializeJson(doc, (const char*) data, length);
+        }
+        allocator.deallocate(data);
+
+        if (err) {
+            AO_DBG_ERR("Deserialization error: %s", err.c_str());
+            continue;
+        }
+
+        JsonObject stored = doc.as<JsonObject>();
+        auto configuration = deserializeConfiguration(stored);
+        if (!configuration) {
+            AO_DBG_ERR("could not read key-value pair %s of type %s", stored["key"] | "", stored["type"] | "");
+            continue;
+        }
+
+        auto entry = latest.find(configuration->getKey());
+        if (entry) {
+            latest.remove(entry->configuration.get());
+        }
+        latest.add(configuration, this);
+        order.push_back(configuration);
+    }
+
+    if (!complete) {
+        AO_DBG_WARN("incomplete segment %s", fn);
+        return false;
+    }
+
+    //keep the original order of the keys
+    for (auto& configuration : order) {
+        auto entry = latest.find(configuration->getKey());
+        if (entry && entry->configuration == configuration) {
+            out.push_back(configuration);
+        }
+    }
+    return true;
+}
+
+bool ConfigurationContainerLog::loadLegacy() {
+
+    size_t fsize = 0;
+    if (filesystem->stat(getFilename(), &fsize) != 0 || fsize == 0) {
+        AO_DBG_DEBUG("Populate FS: create configuration log");
+        return true;
+    }
+
+    AO_DBG_INFO("migrate configuration file %s", getFilename());
+
+    ConfigurationContainerFlash legacy {filesystem, getFilename()};
+    if (!legacy.load()) {
+        return false;
+    }
+
+    for (auto configuration = legacy.configurationsIteratorBegin(); configuration != legacy.configurationsIteratorEnd(); configuration++) {
+        addConfiguration(*configuration);
+    }
+
+    removeLegacyFile = true; //after the first compaction
+    return true;
+}
+
+bool ConfigurationContainerLog::writeChunk(unsigned int segment, std::shared_ptr<std::vector<unsigned char>> records, bool truncate, std::shared_ptr<bool> failed) {
+    char fn [MAX_PATH_SIZE] = {'\0'};
+    if (!makeFn(fn, segment)) {
+        return false;
+    }
+
+    //the write may be deferred (see PersistenceExecutor), so records is a heap copy
+    auto filesystem = this->filesystem;
+    return persist([filesystem, fn, records, truncate, failed] () {
+                if (*failed) {
+                    return false; //a previous chunk is missing
+                }
+                auto file = filesystem->open(fn, truncate ? "w" : "a");
+                if (!file || file->write((const char*) records->data(), records->size()) != records->size()) {
+                    AO_DBG_ERR("write error %s", fn);
+                    *failed = true;
+                    return false;
+                }
+                return true;
+            }, [this] (bool success) {
+                if (!success) {
+                    //the log may end with a partial record
+                    compactionRequired = true;
+                    writeFailed = true;
+                }
+            });
+}
+
+bool ConfigurationContainerLog::compact() {
+
+    unsigned int oldSegment = activeSegment;
+    unsigned int newSegment = 1 - activeSegment;
+    uint32_t newGeneration = generation + 1;
+
+    AO_DBG_DEBUG("compact configuration log: %zu keys", configurations.size());
+
+    auto failed = std::make_shared<bool>(false);
+    auto chunk = std::make_shared<std::vector<unsigned char>>();
+    bool truncate = true;
+
+    unsigned char generationField [4];
+    writeUintLE(generationField, newGeneration, 4);
+    configLogRecords.append(*chunk, 'G', (const char*) generationField, sizeof(generationField));
+
+    unsigned int newRecords = 0;
+    std::vector<int32_t> newRevisions;
+    newRevisions.reserve(configurations.size());
+
+    for (auto& configuration : configurations) {
+        if (encodeEntry(*chunk, *configuration)) {
+            newRecords++;
+        }
+        newRevisions.push_back(configuration->getValueRevision());
+
+        if (chunk->size() >= AO_CONFIGLOG_CHUNK_SIZE) {
+            if (!writeChunk(newSegment, chunk, truncate, failed)) {
+                return false;
+            }
+            chunk = std::make_shared<std::vector<unsigned char>>();
+            truncate = false;
+        }
+    }
+
+    configLogRecords.append(*chunk, 'C', nullptr, 0);
+    if (!writeChunk(newSegment, chunk, truncate, failed)) {
+        return false;
+    }
+
+    //the new segment is complete. From now on, the old segment and the legacy file aren't needed anymore
+    char oldFn [MAX_PATH_SIZE] = {'\0'};
+    if (!makeFn(oldFn, oldSegment)) {
+        return false;
+    }
+    auto filesystem = this->filesystem;
+    std::string legacyFn = removeLegacyFile ? getFilename() : "";
+    persist([filesystem, oldFn, legacyFn, failed] () {
+                if (*failed) {
+                    return false;
+                }
+                //truncate instead of removing the file, like the operation log does
+                filesystem->open(oldFn, "w");
+                if (!legacyFn.empty()) {
+                    filesystem->remove(legacyFn.c_str());
+                }
+                return true;
+            });
+
+    loggedRevisions = std::move(newRevisions);
+    removedKeys.clear();
+    generation = newGeneration;
+    activeSegment = newSegment;
+    nRecords = newRecords;
+    compactionRequired = false;
+    removeLegacyFile = false;
+    return true;
+}
+
+bool ConfigurationContainerLog::save() {
+
+    if (!filesystem) {
+        return false;
+    }
+
+    size_t nChanges = removedKeys.size();
+    for (size_t i = 0; i < configurations.size(); i++) {
+        if (i >= loggedRevisions.size() || loggedRevisions[i] != configurations[i]->getValueRevision()) {
+            nChanges++;
+        }
+    }
+
+    if (nChanges == 0 && !compactionRequired) {
+        return true; //nothing to be done
+    }
+
+    writeFailed = false;
+
+    if (compactionRequired || nRecords + nChanges > 2 * configurations.size() + AO_CONFIGLOG_COMPACT_SLACK) {
+        if (!compact()) {
+            AO_DBG_ERR("could not compact %s", getFilename());
+            return false;
+        }
+        writeCount++;
+        return true;
+    }
+
+    //append the changes
+    auto failed = std::make_shared<bool>(false);
+    auto chunk = std::make_shared<std::vector<unsigned char>>();
+
+    for (auto& key : removedKeys) {
+        configLogRecords.append(*chunk, 'D', key.c_str(), key.length());
+        nRecords++;
+    }
+
+    loggedRevisions.resize(configurations.size(), -1);
+    for (size_t i = 0; i < configurations.size(); i++) {
+        int32_t revision = configurations[i]->getValueRevision();
+        if (loggedRevisions[i] == revision) {
+            continue;
+        }
+        if (encodeEntry(*chunk, *configurations[i])) {
+            nRecords++;
+        }
+        loggedRevisions[i] = revision;
+
+        if (chunk->size() >= AO_CONFIGLOG_CHUNK_SIZE) {
+            if (!writeChunk(activeSegment, chunk, false, failed)) {
+                compactionRequired = true;
+                return false;
+            }
+            chunk = std::make_shared<std::vector<unsigned char>>();
+        }
+    }
+
+    removedKeys.clear();
+
+    if (!chunk->empty() && !writeChunk(activeSegment, chunk, false, failed)) {
+        compactionRequired = true;
+        return false;
+    }
+
+    writeCount++;
+    AO_DBG_DEBUG("Appended %zu changes to %s", nChanges, getFilename());
+    return true;
+}
+
+bool ConfigurationContainerLog::removeConfiguration(std::shared_ptr<AbstractConfiguration> configuration) {
+    auto found = std::find(configurations.begin(), configurations.end(), configuration);
+    if (found == configurations.end()) {
+        return false;
+    }
+
+    size_t i = found - configurations.begin();
+    if (i < loggedRevisions.size()) {
+        if (loggedRevisions[i] >= 0) {
+            removedKeys.push_back(configuration->getKey());
+        }
+        loggedRevisions.erase(loggedRevisions.begin() + i);
+    }
+
+    return ConfigurationContainer::removeConfiguration(configuration);
+}
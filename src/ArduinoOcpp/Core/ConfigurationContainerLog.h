@@ -0,0 +1,80 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_CONFIGURATIONCONTAINERLOG_H
+#define AO_CONFIGURATIONCONTAINERLOG_H
+
+#include <ArduinoOcpp/Core/ConfigurationContainer.h>
+#include <ArduinoOcpp/Core/FilesystemAdapter.h>
+
+#include <string>
+#include <vector>
+
+#ifndef AO_CONFIGLOG_COMPACT_SLACK
+#define AO_CONFIGLOG_COMPACT_SLACK 32 //compact when the log has this many records more than twice the number of keys
+#endif
+
+#ifndef AO_CONFIGLOG_CHUNK_SIZE
+#define AO_CONFIGLOG_CHUNK_SIZE 512 //large saves are written in chunks of this size to bound the RAM usage
+#endif
+
+namespace ArduinoOcpp {
+
+/*
+ * Configuration container which stores the key-value pairs in an append-only log. Saving only appends the changed
+ * keys, so one changed value costs one small write regardless of the number of keys. Each change is one record (see
+ * RecordCodec):
+ *
+ *     type (1 byte) | length (2 bytes) | data (length bytes) | CRC-32 over all previous fields (4 bytes)
+ *
+ * Record types:
+ *     'G': start of a segment. data is the generation of the segment
+ *     'S': key-value pair. data is the storage entry, i.e. the same object as in the configurations array of the
+ *          JSON configuration file (see ConfigurationContainerFlash)
+ *     'D': removed key. data is the key
+ *     'C': end of the snapshot at the start of the segment. The changes since then follow
+ *
+ * Multi-byte fields are little-endian. Later records of a key replace the earlier ones. There are two segment files,
+ * <filename>.0 and <filename>.1. If the active segment has too many outdated records, the current configurations are
+ * written into the other segment which then becomes the active one. A segment is only valid if it contains the 'C'
+ * record, so an interrupted compaction leaves the previous segment in use. Loading stops at the first corrupted
+ * record, e.g. one which was interrupted by a power loss. Then the log is compacted with the next save.
+ *
+ * If there is no log yet but a configuration file in the format of ConfigurationContainerFlash, load() migrates it.
+ */
+class ConfigurationContainerLog : public ConfigurationContainer {
+private:
+    std::shared_ptr<FilesystemAdapter> filesystem;
+
+    std::vector<int32_t> loggedRevisions; //value revision of the latest record of each configuration; -1 if none
+    std::vector<std::string> removedKeys; //keys with records which have been removed since the last save
+
+    uint32_t generation = 0;
+    unsigned int activeSegment = 0;
+    unsigned int nRecords = 0; //'S' and 'D' records in the active segment
+    bool compactionRequired = true; //no valid segment or the active segment has a corrupted tail
+    bool removeLegacyFile = false;
+
+    bool makeFn(char *fn, unsigned int segment);
+    bool readSegment(unsigned int segment, uint32_t *generationOut, bool *corruptedOut, unsigned int *nRecordsOut,
+            std::vector<std::shared_ptr<AbstractConfiguration>>& out);
+    bool loadLegacy();
+    bool writeChunk(unsigned int segment, std::shared_ptr<std::vector<unsigned char>> records, bool truncate, std::shared_ptr<bool> failed);
+    bool compact();
+public:
+    ConfigurationContainerLog(std::shared_ptr<FilesystemAdapter> filesystem, const char *filename) :
+            ConfigurationContainer(filename), filesystem(filesystem) { }
+
+    ~ConfigurationContainerLog();
+
+    bool load() override;
+
+    bool save() override;
+
+    bool removeConfiguration(std::shared_ptr<AbstractConfiguration> configuration) override;
+};
+
+} //end namespace ArduinoOcpp
+
+#endif
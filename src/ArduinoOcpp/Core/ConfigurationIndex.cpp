@@ -0,0 +1,162 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/ConfigurationIndex.h>
+#include <ArduinoOcpp/Core/ConfigurationContainer.h>
+#include <ArduinoOcpp/Core/ConfigurationKeyValue.h>
+#include <ArduinoOcpp/Debug.h>
+
+#define AO_CONFIGINDEX_INITIAL_CAPACITY 64
+
+using namespace ArduinoOcpp;
+
+uint32_t ConfigurationIndex::hash(const char *key) {
+    uint32_t h = 2166136261UL;
+    for (; *key; key++) {
+        h ^= (unsigned char) *key;
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+size_t ConfigurationIndex::findSlot(const char *key, uint32_t hash) const {
+    size_t mask = table.size() - 1;
+    size_t i = hash & mask;
+    while (table[i].configuration) {
+        if (table[i].hash == hash && table[i].configuration->keyEquals(key)) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+bool ConfigurationIndex::grow() {
+    size_t newCapacity = table.empty() ? AO_CONFIGINDEX_INITIAL_CAPACITY : 2 * table.size();
+
+    std::vector<Entry> newTable (newCapacity);
+
+    size_t mask = newCapacity - 1;
+    for (auto& entry : table) {
+        if (!entry.configuration) {
+            continue;
+        }
+        size_t i = entry.hash & mask;
+        while (newTable[i].configuration) {
+            i = (i + 1) & mask;
+        }
+        newTable[i] = std::move(entry);
+    }
+
+    table = std::move(newTable);
+    return true;
+}
+
+bool ConfigurationIndex::add(std::shared_ptr<AbstractConfiguration> configuration, ConfigurationContainer *container) {
+    if (!configuration || *configuration->getKey() == '\0') {
+        AO_DBG_ERR("invalid argument");
+        return false;
+    }
+
+    if (2 * (count + 1) > table.size() && !grow()) {
+        return false;
+    }
+
+    const char *key = configuration->getKey();
+    auto h = hash(key);
+    auto i = findSlot(key, h);
+
+    if (table[i].configuration) {
+        if (table[i].configuration != configuration) {
+            AO_DBG_WARN("duplicate key %s", key);
+        }
+        return false;
+    }
+
+    table[i].hash = h;
+    table[i].configuration = std::move(configuration);
+    table[i].container = container;
+    count++;
+    revision++;
+    return true;
+}
+
+bool ConfigurationIndex::remove(AbstractConfiguration *configuration) {
+    if (!configuration || table.empty()) {
+        return false;
+    }
+
+    auto i = findSlot(configuration->getKey(), hash(configuration->getKey()));
+    if (table[i].configuration.get() != configuration) {
+        return false; //not indexed, e.g. a duplicate
+    }
+
+    //shift the following entries of the probe sequence back into the gap
+    size_t mask = table.size() - 1;
+    size_t gap = i;
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (!table[j].configuration) {
+            break;
+        }
+        size_t home = table[j].hash & mask;
+        //move entry j if its home slot isn't cyclically in (gap, j]
+        if (((j - home) & mask) >= ((j - gap) & mask)) {
+            table[gap] = std::move(table[j]);
+            gap = j;
+        }
+    }
+
+    table[gap] = Entry();
+    count--;
+    revision++;
+
+    //another container may have declared the same key
+    const char *key = configuration->getKey();
+    for (auto container : containers) {
+        for (auto duplicate = container->configurationsIteratorBegin(); duplicate != container->configurationsIteratorEnd(); duplicate++) {
+            if (duplicate->get() != configuration && (*duplicate)->keyEquals(key)) {
+                add(*duplicate, container);
+                return true;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ConfigurationIndex::replace(AbstractConfiguration *configuration, std::shared_ptr<AbstractConfiguration> replacement) {
+    if (!configuration || !replacement || table.empty() || !replacement->keyEquals(configuration->getKey())) {
+        return false;
+    }
+
+    auto i = findSlot(configuration->getKey(), hash(configuration->getKey()));
+    if (table[i].configuration.get() != configuration) {
+        return false; //not indexed, e.g. a duplicate
+    }
+
+    table[i].configuration = std::move(replacement);
+    revision++;
+    return true;
+}
+
+void ConfigurationIndex::addContainer(ConfigurationContainer *container) {
+    containers.push_back(container);
+    for (auto configuration = container->configurationsIteratorBegin(); configuration != container->configurationsIteratorEnd(); configuration++) {
+        add(*configuration, container);
+    }
+}
+
+const ConfigurationIndex::Entry *ConfigurationIndex::find(const char *key) const {
+    if (table.empty() || !key) {
+        return nullptr;
+    }
+
+    auto i = findSlot(key, hash(key));
+    if (!table[i].configuration) {
+        return nullptr;
+    }
+    return &table[i];
+}
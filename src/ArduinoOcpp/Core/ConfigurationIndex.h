@@ -0,0 +1,59 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_CONFIGURATIONINDEX_H
+#define AO_CONFIGURATIONINDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <vector>
+
+namespace ArduinoOcpp {
+
+class AbstractConfiguration;
+class ConfigurationContainer;
+
+/*
+ * Hash index from key to configuration over all registered containers (see ConfigurationContainer::attachIndex).
+ * Open addressing with linear probing; the table has a power-of-two size and is kept at most half full. Removing
+ * an entry shifts the following entries of its probe sequence back, so there are no tombstones.
+ *
+ * Keys are unique in the index. If two containers declare the same key, the configuration which has been added
+ * first is indexed. When it is removed, the duplicate from the next registered container takes its place.
+ */
+class ConfigurationIndex {
+public:
+    struct Entry {
+        uint32_t hash = 0;
+        std::shared_ptr<AbstractConfiguration> configuration; //nullptr: empty slot
+        ConfigurationContainer *container = nullptr;
+    };
+private:
+    std::vector<Entry> table;
+    std::vector<ConfigurationContainer*> containers; //in the order of registration, to find the duplicates of removed keys
+    size_t count = 0;
+    uint32_t revision = 0; //incremented with every change of the indexed set
+
+    size_t findSlot(const char *key, uint32_t hash) const; //slot of the key or the empty slot where it would be inserted
+    bool grow();
+public:
+    static uint32_t hash(const char *key); //FNV-1a
+
+    bool add(std::shared_ptr<AbstractConfiguration> configuration, ConfigurationContainer *container); //false if the key is indexed already
+    bool remove(AbstractConfiguration *configuration);
+    bool replace(AbstractConfiguration *configuration, std::shared_ptr<AbstractConfiguration> replacement); //replacement with the same key. false if configuration isn't indexed
+
+    void addContainer(ConfigurationContainer *container); //adds the configurations of container
+
+    const Entry *find(const char *key) const; //nullptr if not indexed
+
+    size_t size() const {return count;}
+    size_t capacity() const {return table.size();}
+    uint32_t getRevision() const {return revision;}
+};
+
+}
+
+#endif
@@ -3,6 +3,7 @@
 // MIT License
 
 #include <ArduinoOcpp/Core/ConfigurationKeyValue.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
 #include <ArduinoOcpp/Debug.h>
 
 #include <string.h>
@@ -24,31 +25,35 @@ AbstractConfiguration::AbstractConfiguration(JsonObject &storedKeyValuePair) {
     }
 }
 
+AbstractConfiguration::AbstractConfiguration(const char *staticKey) : key(staticKey) {
+
+}
+
 AbstractConfiguration::~AbstractConfiguration() {
 
 }
 
 void AbstractConfiguration::printKey() {
-    AO_CONSOLE_PRINTF("%s", key.c_str());
+    AO_CONSOLE_PRINTF("%s", key);
     (void)0;
 }
 
 size_t AbstractConfiguration::getStorageHeaderJsonCapacity() {
     return JSON_OBJECT_SIZE(1) //key
-            + key.size() + 1;
+            + strlen(key) + 1;
 }
 
 void AbstractConfiguration::storeStorageHeader(JsonObject &keyValuePair) {
-    keyValuePair["key"] = key;
+    keyValuePair["key"] = (char*) key; //copy, the document may outlive this object
 }
 
 size_t AbstractConfiguration::getOcppMsgHeaderJsonCapacity() {
     return JSON_OBJECT_SIZE(2) //key + readonly field
-            + key.size() + 1;
+            + strlen(key) + 1;
 }
 
 void AbstractConfiguration::storeOcppMsgHeader(JsonObject &keyValuePair) {
-    keyValuePair["key"] = key;
+    keyValuePair["key"] = (char*) key; //copy, the document may outlive this object
     if (remotePeerCanWrite) {
         keyValuePair["readonly"] = false;
     } else {
@@ -56,12 +61,19 @@ void AbstractConfiguration::storeOcppMsgHeader(JsonObject &keyValuePair) {
     }
 }
 
+void AbstractConfiguration::writeOcppMsgHeader(JsonWriter& out) {
+    out.key("key");
+    out.value(key);
+    out.key("readonly");
+    out.value(!remotePeerCanWrite);
+}
+
 bool AbstractConfiguration::isValid() {
-    return initializedValue && !key.empty();
+    return initializedValue && *key;
 }
 
 bool AbstractConfiguration::setKey(const char *newKey) {
-    if (!key.empty()) {
+    if (*key) {
         AO_DBG_ERR("cannot override key");
         return false;
     }
@@ -71,7 +83,10 @@ bool AbstractConfiguration::setKey(const char *newKey) {
         return false;
     }
 
-    key = newKey;
+    size_t size = strlen(newKey) + 1;
+    keyBuf.reset(new char[size]);
+    memcpy(keyBuf.get(), newKey, size);
+    key = keyBuf.get();
     return true;
 }
 
@@ -87,8 +102,58 @@ uint16_t AbstractConfiguration::getValueRevision() {
     return value_revision;
 }
 
+uint32_t AbstractConfiguration::globalRevision = 0;
+unsigned int AbstractConfiguration::observerIdCount = 0;
+
+void AbstractConfiguration::updateValueRevision() {
+    value_revision++;
+    globalRevision++;
+    notifyObservers();
+}
+
+void AbstractConfiguration::adoptValueRevision(AbstractConfiguration& other) {
+    //same revision as other, so the containers don't see a change which would have to be saved
+    value_revision = other.value_revision;
+    globalRevision++;
+    notifyObservers();
+}
+
+void AbstractConfiguration::notifyObservers() {
+    if (observers) {
+        //observers may add or remove observers
+        auto notify = *observers;
+        for (auto& entry : notify) {
+            entry.observer(*this);
+        }
+    }
+}
+
+unsigned int AbstractConfiguration::addObserver(ConfigurationObserver observer) {
+    if (!observers) {
+        observers.reset(new std::vector<Observer>());
+    }
+    unsigned int id = ++observerIdCount;
+    observers->push_back(Observer {id, observer});
+    return id;
+}
+
+void AbstractConfiguration::removeObserver(unsigned int id) {
+    if (!observers) {
+        return;
+    }
+    for (auto entry = observers->begin(); entry != observers->end(); entry++) {
+        if (entry->id == id) {
+            observers->erase(entry);
+            break;
+        }
+    }
+    if (observers->empty()) {
+        observers.reset();
+    }
+}
+
 bool AbstractConfiguration::keyEquals(const char *other) {
-    return !key.compare(other);
+    return !strcmp(key, other);
 }
 
 template <class T>
@@ -123,6 +188,17 @@ void printValue(bool value) {
     AO_CONSOLE_PRINTF("%s", value ? "true" : "false");
 }
 
+template <class T>
+bool Configuration<T>::adoptValue(AbstractConfiguration& other) {
+    if (strcmp(other.getSerializedType(), getSerializedType())) {
+        return false;
+    }
+    value = (T) static_cast<Configuration<T>&>(other);
+    initializedValue = true;
+    adoptValueRevision(other);
+    return true;
+}
+
 template <class T>
 const T &Configuration<T>::operator=(const T & newVal) {
 
@@ -135,11 +211,12 @@ const T &Configuration<T>::operator=(const T & newVal) {
             printValue(newVal);
             AO_CONSOLE_PRINTF("\n");
         }
+        bool changed = !initializedValue || value != newVal;
         initializedValue = true;
-        if (value != newVal) {
-            value_revision++;
-        }
         value = newVal;
+        if (changed) {
+            updateValueRevision();
+        }
     } else {
         AO_DBG_ERR("Tried to override read-only configuration:");
         AO_CONSOLE_PRINTF("[AO]     > Key = ");
@@ -149,11 +226,6 @@ const T &Configuration<T>::operator=(const T & newVal) {
     return newVal;
 }
 
-template <class T>
-Configuration<T>::operator T() {
-    return value;
-}
-
 template<class T>
 bool Configuration<T>::isValid() {
     return AbstractConfiguration::isValid();
@@ -217,6 +289,23 @@ std::shared_ptr<DynamicJsonDocument> Configuration<T>::toJsonOcppMsgEntry() {
     return doc;
 }
 
+template<class T>
+bool Configuration<T>::writeOcppMsgEntry(JsonWriter& out) {
+    if (!isValid()) {
+        return false;
+    }
+    const size_t VALUE_MAXSIZE = 50;
+    char value_str [VALUE_MAXSIZE] = {'\0'};
+    toCStringValue(value_str, VALUE_MAXSIZE, value);
+
+    out.beginObject();
+    writeOcppMsgHeader(out);
+    out.key("value");
+    out.value(value_str);
+    out.endObject();
+    return true;
+}
+
 std::shared_ptr<DynamicJsonDocument> Configuration<const char *>::toJsonStorageEntry() {
     if (!isValid()) {
         return nullptr;
@@ -248,6 +337,19 @@ std::shared_ptr<DynamicJsonDocument> Configuration<const char *>::toJsonOcppMsgE
     return doc;
 }
 
+bool Configuration<const char *>::writeOcppMsgEntry(JsonWriter& out) {
+    if (!isValid()) {
+        return false;
+    }
+
+    out.beginObject();
+    writeOcppMsgHeader(out);
+    out.key("value");
+    out.value(value.c_str());
+    out.endObject();
+    return true;
+}
+
 Configuration<const char *>::Configuration(JsonObject &storedKeyValuePair) : AbstractConfiguration(storedKeyValuePair) {
     if (storedKeyValuePair["value"].as<JsonVariant>().is<const char*>()) {
         const char *storedValue = storedKeyValuePair["value"].as<JsonVariant>().as<const char*>();
@@ -281,7 +383,7 @@ bool Configuration<const char *>::setValue(const char *new_value, size_t buffsiz
 
     if (value.compare(new_value) || !initializedValue) {
         value = new_value;
-        value_revision++;
+        updateValueRevision();
     }
     
     if (AO_DBG_LEVEL >= AO_DL_DEBUG && !initializedValue) {
@@ -294,6 +396,16 @@ bool Configuration<const char *>::setValue(const char *new_value, size_t buffsiz
     return true;
 }
 
+bool Configuration<const char *>::adoptValue(AbstractConfiguration& other) {
+    if (strcmp(other.getSerializedType(), getSerializedType())) {
+        return false;
+    }
+    value = (const char*) static_cast<Configuration<const char*>&>(other);
+    initializedValue = true;
+    adoptValueRevision(other);
+    return true;
+}
+
 const char *Configuration<const char *>::operator=(const char *newVal) {
     if (!setValue(newVal, strlen(newVal) + 1)) {
         AO_DBG_ERR("Setting value in operator= was unsuccessful");
@@ -321,6 +433,21 @@ std::function<bool(const char*)> Configuration<const char *>::getValidator() {
     return this->validator;
 }
 
+std::shared_ptr<AbstractConfiguration> deserializeConfiguration(JsonObject &storedKeyValuePair) {
+    const char *type = storedKeyValuePair["type"] | "Undefined";
+
+    if (!strcmp(type, SerializedType<int>::get())){
+        return std::make_shared<Configuration<int>>(storedKeyValuePair);
+    } else if (!strcmp(type, SerializedType<float>::get())){
+        return std::make_shared<Configuration<float>>(storedKeyValuePair);
+    } else if (!strcmp(type, SerializedType<bool>::get())){
+        return std::make_shared<Configuration<bool>>(storedKeyValuePair);
+    } else if (!strcmp(type, SerializedType<const char *>::get())){
+        return std::make_shared<Configuration<const char *>>(storedKeyValuePair);
+    }
+    return nullptr;
+}
+
 template class Configuration<int>;
 template class Configuration<float>;
 template class Configuration<bool>;
@@ -9,12 +9,29 @@
 #include <memory>
 #include <functional>
 #include <string>
+#include <vector>
 
 namespace ArduinoOcpp {
 
+class JsonWriter;
+class AbstractConfiguration;
+
+using ConfigurationObserver = std::function<void(AbstractConfiguration& configuration)>;
+
 class AbstractConfiguration {
 private:
-    std::string key;
+    const char *key = ""; //points into keyBuf or to a string constant (see the static key constructor)
+    std::unique_ptr<char[]> keyBuf;
+
+    static uint32_t globalRevision;
+
+    struct Observer {
+        unsigned int id;
+        ConfigurationObserver observer;
+    };
+    std::unique_ptr<std::vector<Observer>> observers; //allocated with the first observer. Most keys have none
+    static unsigned int observerIdCount;
+    void notifyObservers();
 
     bool rebootRequiredWhenChanged = false;
 
@@ -27,10 +44,14 @@ protected:
 
     AbstractConfiguration();
     AbstractConfiguration(JsonObject &storedKeyValuePair);
+    AbstractConfiguration(const char *staticKey); //staticKey must outlive this object. It isn't copied
     size_t getStorageHeaderJsonCapacity();
     void storeStorageHeader(JsonObject &keyValuePair);
     size_t getOcppMsgHeaderJsonCapacity();
     void storeOcppMsgHeader(JsonObject &keyValuePair);
+    void writeOcppMsgHeader(JsonWriter& out);
+    void updateValueRevision(); //call after the value has changed. Notifies the observers
+    void adoptValueRevision(AbstractConfiguration& other); //call after taking over the value of other. Notifies the observers
     bool isValid();
 
     bool permissionLocalClientCanWrite() {return localClientCanWrite;}
@@ -44,16 +65,37 @@ public:
 
     uint16_t getValueRevision();
     bool keyEquals(const char *other);
+    const char *getKey() {return key;}
 
     virtual std::shared_ptr<DynamicJsonDocument> toJsonStorageEntry() = 0;
     virtual std::shared_ptr<DynamicJsonDocument> toJsonOcppMsgEntry() = 0;
+    virtual bool writeOcppMsgEntry(JsonWriter& out) = 0; //streaming alternative to toJsonOcppMsgEntry(); false if not valid
+
+    /*
+     * Observers are called after each change of the value, e.g. by ChangeConfiguration or when a module writes it.
+     * Use them to update derived state instead of checking getValueRevision() in the loop. addObserver() returns
+     * the id for removeObserver(). Remove the observer before its captured objects are destroyed
+     */
+    unsigned int addObserver(ConfigurationObserver observer);
+    void removeObserver(unsigned int id);
+
+    /*
+     * Changes whenever the value or the permissions of any configuration change
+     */
+    static uint32_t getGlobalRevision() {return globalRevision;}
 
     virtual const char *getSerializedType() = 0;
 
+    /*
+     * Takes over the value and the value revision of other, e.g. when a static configuration replaces the one loaded
+     * from flash. Ignores the write permissions. Returns false if the types are different
+     */
+    virtual bool adoptValue(AbstractConfiguration& other) = 0;
+
     bool permissionRemotePeerCanWrite() {return remotePeerCanWrite;}
     bool permissionRemotePeerCanRead() {return remotePeerCanRead;}
-    void revokePermissionRemotePeerCanWrite() {remotePeerCanWrite = false;}
-    void revokePermissionRemotePeerCanRead() {remotePeerCanRead = false;}
+    void revokePermissionRemotePeerCanWrite() {remotePeerCanWrite = false; globalRevision++;}
+    void revokePermissionRemotePeerCanRead() {remotePeerCanRead = false; globalRevision++;}
     void revokePermissionLocalClientCanWrite() {localClientCanWrite = false;}
 };
 
@@ -76,14 +118,18 @@ private:
 public:
     Configuration();
     Configuration(JsonObject &storedKeyValuePair);
+    Configuration(const char *staticKey, T value) : AbstractConfiguration(staticKey), value(value) {initializedValue = true;}
     const T &operator=(const T & newVal);
-    operator T();
+    operator T() {return value;}
     bool isValid();
 
     std::shared_ptr<DynamicJsonDocument> toJsonStorageEntry();
     std::shared_ptr<DynamicJsonDocument> toJsonOcppMsgEntry();
+    bool writeOcppMsgEntry(JsonWriter& out);
 
     const char *getSerializedType() {return SerializedType<T>::get();} //returns "int" or "float" as written to the configuration Json file
+
+    bool adoptValue(AbstractConfiguration& other) override;
 };
 
 template <>
@@ -96,6 +142,7 @@ private:
 public:
     Configuration();
     Configuration(JsonObject &storedKeyValuePair);
+    Configuration(const char *staticKey, const char *value) : AbstractConfiguration(staticKey), value(value) {initializedValue = true;}
     ~Configuration();
     bool setValue(const char *newVal, size_t buffsize);
     const char *operator=(const char *newVal);
@@ -105,13 +152,21 @@ public:
 
     std::shared_ptr<DynamicJsonDocument> toJsonStorageEntry();
     std::shared_ptr<DynamicJsonDocument> toJsonOcppMsgEntry();
+    bool writeOcppMsgEntry(JsonWriter& out);
 
     const char *getSerializedType() {return SerializedType<const char *>::get();}
 
+    bool adoptValue(AbstractConfiguration& other) override;
+
     void setValidator(std::function<bool(const char*)> validator);
     std::function<bool(const char*)> getValidator();
 };
 
+/*
+ * Creates the configuration of a stored key-value pair (see toJsonStorageEntry()). nullptr if the type is unknown
+ */
+std::shared_ptr<AbstractConfiguration> deserializeConfiguration(JsonObject &storedKeyValuePair);
+
 } //end namespace ArduinoOcpp
 
 #endif
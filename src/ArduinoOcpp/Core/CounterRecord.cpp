@@ -0,0 +1,154 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/CounterRecord.h>
+#include <ArduinoOcpp/Core/FilesystemAdapter.h>
+#include <ArduinoOcpp/Core/Crc32.h>
+#include <ArduinoOcpp/Core/LittleEndian.h>
+#include <ArduinoOcpp/Debug.h>
+
+#define AO_COUNTERRECORD_SLOT_MAX (4 + 4 * AO_COUNTERRECORD_MAX + 4)
+
+using namespace ArduinoOcpp;
+
+CounterRecord::CounterRecord(std::shared_ptr<FilesystemAdapter> filesystem, const char *fn, size_t nCounters) :
+        filesystem(filesystem), fn(fn), nCounters(nCounters <= AO_COUNTERRECORD_MAX ? nCounters : AO_COUNTERRECORD_MAX) {
+
+    if (nCounters > AO_COUNTERRECORD_MAX) {
+        AO_DBG_ERR("too many counters, increase AO_COUNTERRECORD_MAX");
+        (void)0;
+    }
+}
+
+size_t CounterRecord::getSlotSize() const {
+    return 4 + 4 * nCounters + 4;
+}
+
+void CounterRecord::serializeSlot(unsigned char *out, uint32_t slotSequence) const {
+    writeUintLE(out, slotSequence, 4);
+    for (size_t i = 0; i < nCounters; i++) {
+        writeUintLE(out + 4 + 4 * i, values[i], 4);
+    }
+    writeUintLE(out + 4 + 4 * nCounters, crc32(out, 4 + 4 * nCounters), 4);
+}
+
+bool CounterRecord::load() {
+    if (!filesystem) {
+        return false;
+    }
+
+    size_t fsize = 0;
+    if (filesystem->stat(fn, &fsize) != 0) {
+        AO_DBG_DEBUG("no counter record %s", fn);
+        return false;
+    }
+
+    //the file exists, so the next write can be in place even if both slots are corrupted
+    created = fsize == 2 * getSlotSize();
+
+    auto file = filesystem->open(fn, "r");
+    if (!file) {
+        AO_DBG_ERR("cannot open %s", fn);
+        return false;
+    }
+
+    bool valid = false;
+
+    for (unsigned int slot = 0; slot < 2; slot++) {
+        unsigned char buf [AO_COUNTERRECORD_SLOT_MAX];
+        if (file->read((char*) buf, getSlotSize()) != getSlotSize() ||
+                readUintLE(buf + 4 + 4 * nCounters, 4) != crc32(buf, 4 + 4 * nCounters)) {
+            AO_DBG_WARN("discard corrupted slot %u of %s", slot, fn);
+            continue;
+        }
+
+        uint32_t slotSequence = readUintLE(buf, 4);
+        if (valid && (int32_t) (slotSequence - sequence) <= 0) {
+            continue; //other slot is newer
+        }
+
+        valid = true;
+        sequence = slotSequence;
+        activeSlot = slot;
+        for (size_t i = 0; i < nCounters; i++) {
+            values[i] = readUintLE(buf + 4 + 4 * i, 4);
+        }
+    }
+
+    return valid;
+}
+
+uint32_t CounterRecord::get(size_t index) const {
+    if (index >= nCounters) {
+        AO_DBG_ERR("index out of bounds");
+        return 0;
+    }
+    return values[index];
+}
+
+bool CounterRecord::set(size_t index, uint32_t value) {
+    if (index >= nCounters) {
+        AO_DBG_ERR("index out of bounds");
+        return false;
+    }
+
+    if (values[index] == value && created) {
+        return true; //nothing changed
+    }
+
+    values[index] = value;
+    return write();
+}
+
+bool CounterRecord::setAll(const uint32_t *newValues, size_t nValues) {
+    if (nValues > nCounters) {
+        AO_DBG_ERR("index out of bounds");
+        return false;
+    }
+
+    for (size_t i = 0; i < nValues; i++) {
+        values[i] = newValues[i];
+    }
+    return write();
+}
+
+bool CounterRecord::write() {
+    if (!filesystem) {
+        return true;
+    }
+
+    unsigned int nextSlot = 1 - activeSlot;
+    unsigned char buf [2 * AO_COUNTERRECORD_SLOT_MAX];
+    size_t slotSize = getSlotSize();
+
+    bool success = false;
+
+    if (created) {
+        //overwrite the older slot in place
+        serializeSlot(buf, sequence + 1);
+        auto file = filesystem->open(fn, "r+");
+        if (file) {
+            file->seek(nextSlot * slotSize);
+            success = file->write((const char*) buf, slotSize) == slotSize;
+        }
+    } else {
+        //create the file with both slots
+        serializeSlot(buf + nextSlot * slotSize, sequence + 1);
+        serializeSlot(buf + activeSlot * slotSize, sequence);
+        auto file = filesystem->open(fn, "w");
+        if (file) {
+            success = file->write((const char*) buf, 2 * slotSize) == 2 * slotSize;
+        }
+        created = success;
+    }
+
+    if (!success) {
+        AO_DBG_ERR("cannot write %s", fn);
+        return false;
+    }
+
+    sequence++;
+    activeSlot = nextSlot;
+    return true;
+}
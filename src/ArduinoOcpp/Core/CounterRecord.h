@@ -0,0 +1,58 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_COUNTERRECORD_H
+#define AO_COUNTERRECORD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+
+#ifndef AO_COUNTERRECORD_MAX
+#define AO_COUNTERRECORD_MAX 4 //max. number of counters per record
+#endif
+
+namespace ArduinoOcpp {
+
+class FilesystemAdapter;
+
+/*
+ * Persistent counters which change frequently, like the tx range of a connector. The file has two fixed-size
+ * slots which are overwritten alternately:
+ *
+ *     sequence number (4 bytes) | nCounters * value (4 bytes each) | CRC-32 (4 bytes)
+ *
+ * Multi-byte fields are little-endian. An update is one small in-place write into the older slot. When loading,
+ * the valid slot with the higher sequence number wins, so an interrupted update falls back to the previous values.
+ */
+class CounterRecord {
+private:
+    std::shared_ptr<FilesystemAdapter> filesystem;
+    const char *fn;
+    const size_t nCounters;
+
+    uint32_t values [AO_COUNTERRECORD_MAX] = {0};
+    uint32_t sequence = 0;
+    unsigned int activeSlot = 0;
+    bool created = false; //file with both slots exists
+
+    size_t getSlotSize() const;
+    void serializeSlot(unsigned char *out, uint32_t sequence) const;
+    bool write();
+public:
+    CounterRecord(std::shared_ptr<FilesystemAdapter> filesystem, const char *fn, size_t nCounters); //fn must outlive the record
+
+    /*
+     * Returns false if there is no valid record yet. Then all counters are 0 until the caller initializes them
+     */
+    bool load();
+
+    uint32_t get(size_t index) const;
+    bool set(size_t index, uint32_t value); //writes the record if the value has changed
+    bool setAll(const uint32_t *values, size_t nValues); //updates the first nValues counters with one write
+};
+
+}
+
+#endif
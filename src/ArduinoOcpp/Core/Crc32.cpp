@@ -0,0 +1,21 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/Crc32.h>
+
+//half-byte lookup table: small enough for the flash of the microcontrollers, still 8 times faster than bitwise
+static const uint32_t crc32_nibble [16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t ArduinoOcpp::crc32(const void *data, size_t len, uint32_t crc) {
+    const unsigned char *p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = crc32_nibble[(crc ^ p[i]) & 0x0F] ^ (crc >> 4);
+        crc = crc32_nibble[(crc ^ (p[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
@@ -0,0 +1,20 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_CRC32_H
+#define AO_CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ArduinoOcpp {
+
+/*
+ * CRC-32 (IEEE 802.3, as in zlib). Continue a checksum over several buffers by passing the previous result as crc
+ */
+uint32_t crc32(const void *data, size_t len, uint32_t crc = 0);
+
+}
+
+#endif
@@ -49,7 +49,7 @@ public:
         return file.readBytes(buf, len);
     }
     size_t write(const char *buf, size_t len) override {
-        return file.printf("%.*s", len, buf);
+        return file.write((const uint8_t*) buf, len); //binary safe, e.g. for the operation log
     }
     size_t seek(size_t offset) override {
         return file.seek(offset);
@@ -300,6 +300,16 @@ std::shared_ptr<FilesystemAdapter> makeDefaultFilesystemAdapter(FilesystemOpt co
 #include <cstdio>
 #include <sys/stat.h>
 
+#ifndef AO_USE_MMAP
+#define AO_USE_MMAP 1
+#endif
+
+#if AO_USE_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace ArduinoOcpp {
 
 class PosixFileAdapter : public FileAdapter {
@@ -328,6 +338,27 @@ public:
     }
 };
 
+#if AO_USE_MMAP
+class PosixMappedFile : public MappedFile {
+    void *addr;
+    size_t len;
+public:
+    PosixMappedFile(void *addr, size_t len) : addr(addr), len(len) {}
+
+    ~PosixMappedFile() {
+        munmap(addr, len);
+    }
+
+    char *data() override {
+        return static_cast<char*>(addr);
+    }
+
+    size_t size() override {
+        return len;
+    }
+};
+#endif //AO_USE_MMAP
+
 class PosixFilesystemAdapter : public FilesystemAdapter {
 public:
     FilesystemOpt config;
@@ -358,6 +389,32 @@ public:
     bool remove(const char *fn) override {
         return ::remove(fn) == 0;
     }
+
+#if AO_USE_MMAP
+    std::unique_ptr<MappedFile> map(const char *fn) override {
+        int fd = ::open(fn, O_RDONLY);
+        if (fd < 0) {
+            AO_DBG_DEBUG("Failed to open file path %s", fn);
+            return nullptr;
+        }
+
+        std::unique_ptr<MappedFile> mapping;
+
+        struct ::stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            //private mapping: writes of in-place parsers don't reach the file
+            void *addr = mmap(nullptr, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                mapping.reset(new PosixMappedFile(addr, (size_t) st.st_size));
+            } else {
+                AO_DBG_WARN("Failed to map %s", fn);
+            }
+        }
+
+        close(fd); //the mapping stays valid
+        return mapping;
+    }
+#endif //AO_USE_MMAP
 };
 
 std::weak_ptr<FilesystemAdapter> filesystemCache;
@@ -32,12 +32,26 @@ public:
     virtual int read() = 0;
 };
 
+/*
+ * Whole file contents in memory, e.g. a memory mapping. The data is a private copy: it can be modified by in-place
+ * parsers without changing the file. It is valid as long as the MappedFile exists
+ */
+class MappedFile {
+public:
+    virtual ~MappedFile() = default;
+    virtual char *data() = 0;
+    virtual size_t size() = 0;
+};
+
 class FilesystemAdapter {
 public:
     virtual ~FilesystemAdapter() = default;
     virtual int stat(const char *path, size_t *size) = 0;
     virtual std::unique_ptr<FileAdapter> open(const char *fn, const char *mode) = 0;
     virtual bool remove(const char *fn) = 0;
+
+    //optional. Returns nullptr if the adapter doesn't support mapping files, then the caller uses open(...)
+    virtual std::unique_ptr<MappedFile> map(const char * /*fn*/) {return nullptr;}
 };
 
 } //end namespace ArduinoOcpp
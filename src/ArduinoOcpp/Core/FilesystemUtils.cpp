@@ -5,13 +5,18 @@
 #include <ArduinoOcpp/Core/FilesystemAdapter.h>
 #include <ArduinoOcpp/Core/FilesystemUtils.h>
 #include <ArduinoOcpp/Core/ConfigurationOptions.h> //FilesystemOpt
+#include <ArduinoOcpp/Core/JsonCapacity.h>
+#include <ArduinoOcpp/Core/MemoryArena.h>
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
 #include <ArduinoOcpp/Debug.h>
 
+#include <algorithm>
+
 #define MAX_JSON_CAPACITY 4096
 
 using namespace ArduinoOcpp;
 
-std::unique_ptr<DynamicJsonDocument> FilesystemUtils::loadJson(std::shared_ptr<FilesystemAdapter> filesystem, const char *fn) {
+std::unique_ptr<DynamicJsonDocument> FilesystemUtils::loadJson(std::shared_ptr<FilesystemAdapter> filesystem, const char *fn, std::unique_ptr<MappedFile> *mappingOut) {
     if (!filesystem || !fn || *fn == '\0') {
         AO_DBG_ERR("Format error");
         return nullptr;
@@ -21,6 +26,8 @@ std::unique_ptr<DynamicJsonDocument> FilesystemUtils::loadJson(std::shared_ptr<F
         AO_DBG_ERR("Fn too long: %.*s", MAX_PATH_SIZE, fn);
         return nullptr;
     }
+
+    persistence_flush(); //the file may have a pending write
     
     size_t fsize = 0;
     if (filesystem->stat(fn, &fsize) != 0) {
@@ -28,39 +35,79 @@ std::unique_ptr<DynamicJsonDocument> FilesystemUtils::loadJson(std::shared_ptr<F
         return nullptr;
     }
 
-    if (fsize < 2) {
+    if (fsize < 1) {
         AO_DBG_ERR("File too small for JSON, collect %s", fn);
         filesystem->remove(fn);
         return nullptr;
     }
 
-    auto file = filesystem->open(fn, "r");
-    if (!file) {
-        AO_DBG_ERR("Could not open file %s", fn);
+    if (fsize > MAX_JSON_CAPACITY) {
+        AO_DBG_ERR("File too big: %s", fn);
         return nullptr;
     }
 
-    size_t capacity = (3 * fsize) / 2;
-    if (capacity < 32) {
-        capacity = 32;
-    }
-    if (capacity > MAX_JSON_CAPACITY) {
-        capacity = MAX_JSON_CAPACITY;
+    //map the file if the filesystem supports it. Otherwise read it once into a buffer
+    auto mapping = filesystem->map(fn);
+
+    ArenaAllocator allocator;
+    char *buf = nullptr;
+
+    if (mapping) {
+        buf = mapping->data();
+        fsize = std::min(fsize, mapping->size());
+    } else {
+        auto file = filesystem->open(fn, "r");
+        if (!file) {
+            AO_DBG_ERR("Could not open file %s", fn);
+            return nullptr;
+        }
+
+        buf = static_cast<char*>(allocator.allocate(fsize));
+        if (!buf) {
+            AO_DBG_ERR("OOM");
+            return nullptr;
+        }
+
+        if (file->read(buf, fsize) != fsize) {
+            AO_DBG_ERR("Could not read file %s", fn);
+            allocator.deallocate(buf);
+            return nullptr;
+        }
     }
-    
+
+    //measure the exact capacity before deserializing
     auto doc = std::unique_ptr<DynamicJsonDocument>(nullptr);
-    DeserializationError err = DeserializationError::NoMemory;
-    ArduinoJsonFileAdapter fileReader {file.get()};
+    DeserializationError err = DeserializationError::InvalidInput;
 
-    while (err == DeserializationError::NoMemory && capacity <= MAX_JSON_CAPACITY) {
+    auto format = detectFormat(buf, fsize);
 
-        doc.reset(new DynamicJsonDocument(capacity));
-        err = deserializeJson(*doc, fileReader);
+    size_t capacity = measureCapacity(buf, fsize, format);
+    if (capacity < 32) {
+        capacity = 32;
+    }
 
-        capacity *= 3;
-        capacity /= 2;
+    if (capacity <= MAX_JSON_CAPACITY) {
+        doc.reset(new DynamicJsonDocument(capacity));
+        if (mapping && mappingOut) {
+            //zero-copy: the strings of the document point into the mapping
+            if (format == StorageFormat::MsgPack) {
+                err = deserializeMsgPack(*doc, buf, fsize);
+            } else {
+                err = deserializeJson(*doc, buf, fsize);
+            }
+        } else {
+            if (format == StorageFormat::MsgPack) {
+                err = deserializeMsgPack(*doc, (const char*) buf, fsize);
+            } else {
+                err = deserializeJson(*doc, (const char*) buf, fsize);
+            }
+        }
+    } else {
+        err = DeserializationError::NoMemory;
+    }
 
-        file->seek(0); //rewind file to beginning
+    if (!mapping) {
+        allocator.deallocate(buf);
     }
 
     if (err) {
@@ -69,12 +116,16 @@ std::unique_ptr<DynamicJsonDocument> FilesystemUtils::loadJson(std::shared_ptr<F
         return nullptr;
     }
 
+    if (mapping && mappingOut) {
+        *mappingOut = std::move(mapping);
+    }
+
     AO_DBG_DEBUG("Loaded JSON file: %s", fn);
 
     return doc;
 }
 
-bool FilesystemUtils::storeJson(std::shared_ptr<FilesystemAdapter> filesystem, const char *fn, const DynamicJsonDocument& doc) {
+bool FilesystemUtils::storeJson(std::shared_ptr<FilesystemAdapter> filesystem, const char *fn, const JsonDocument& doc, StorageFormat format) {
     if (!filesystem || !fn || *fn == '\0') {
         AO_DBG_ERR("Format error");
         return false;
@@ -101,11 +152,17 @@ bool FilesystemUtils::storeJson(std::shared_ptr<FilesystemAdapter> filesystem, c
         return false;
     }
 
-    ArduinoJsonFileAdapter fileWriter {file.get()};
+    char buf [AO_FILE_BUFSIZE];
+    ArduinoJsonFileWriter fileWriter {file.get(), buf, sizeof(buf)};
 
-    size_t written = serializeJson(doc, fileWriter);
+    size_t written = 0;
+    if (format == StorageFormat::MsgPack) {
+        written = serializeMsgPack(doc, fileWriter);
+    } else {
+        written = serializeJson(doc, fileWriter);
+    }
 
-    if (written < 2) {
+    if (!fileWriter.flush() || written == 0 || written != measure(doc, format)) {
         AO_DBG_ERR("Error writing file %s", fn);
         if (filesystem->stat(fn, &file_size) == 0) {
             AO_DBG_DEBUG("Collect invalid file %s", fn);
@@ -117,3 +174,31 @@ bool FilesystemUtils::storeJson(std::shared_ptr<FilesystemAdapter> filesystem, c
     AO_DBG_DEBUG("Wrote JSON file: %s", fn);
     return true;
 }
+
+StorageFormat FilesystemUtils::detectFormat(const char *data, size_t length) {
+    if (length == 0) {
+        return StorageFormat::Json;
+    }
+    //MessagePack maps and arrays. JSON documents start with '{', '[' or whitespace
+    unsigned char first = (unsigned char) data[0];
+    if ((first >= 0x80 && first <= 0x9f) || (first >= 0xdc && first <= 0xdf)) {
+        return StorageFormat::MsgPack;
+    }
+    return StorageFormat::Json;
+}
+
+size_t FilesystemUtils::measure(const JsonDocument& doc, StorageFormat format) {
+    if (format == StorageFormat::MsgPack) {
+        return measureMsgPack(doc);
+    } else {
+        return measureJson(doc);
+    }
+}
+
+size_t FilesystemUtils::measureCapacity(const char *data, size_t length, StorageFormat format) {
+    if (format == StorageFormat::MsgPack) {
+        return measureMsgPackCapacity(data, length);
+    } else {
+        return measureJsonCapacity(data, length);
+    }
+}
@@ -8,36 +8,143 @@
 #include <ArduinoOcpp/Core/FilesystemAdapter.h>
 #include <ArduinoJson.h>
 #include <memory>
+#include <algorithm>
+#include <string.h>
+
+#define AO_STORAGE_JSON    1
+#define AO_STORAGE_MSGPACK 2
 
 namespace ArduinoOcpp {
 
-class ArduinoJsonFileAdapter {
+/*
+ * Block-buffered adapters between ArduinoJson's stream (de)serializers and a FileAdapter. ArduinoJson reads and writes
+ * mostly single bytes, which would be one filesystem call each. The caller provides the buffer, e.g.
+ *
+ *     char buf [AO_FILE_BUFSIZE];
+ *     ArduinoJsonFileWriter writer {file.get(), buf, sizeof(buf)};
+ *     serializeJson(doc, writer);
+ *     if (!writer.flush()) { ... }
+ */
+#ifndef AO_FILE_BUFSIZE
+#define AO_FILE_BUFSIZE 256
+#endif
+
+class ArduinoJsonFileReader {
 private:
     FileAdapter *file;
-public:
-    ArduinoJsonFileAdapter(FileAdapter *file) : file(file) { }
+    char *buf;
+    size_t bufsize;
+    size_t pos = 0; //next unread byte in buf
+    size_t len = 0; //number of valid bytes in buf
 
-    size_t readBytes(char *buf, size_t len) {
-        return file->read(buf, len);
+    bool fill() {
+        pos = 0;
+        len = file->read(buf, bufsize);
+        return len > 0;
     }
+public:
+    ArduinoJsonFileReader(FileAdapter *file, char *buf, size_t bufsize) : file(file), buf(buf), bufsize(bufsize) { }
 
     int read() {
-        return file->read();
+        if (pos >= len && !fill()) {
+            return -1;
+        }
+        return (unsigned char) buf[pos++];
     }
 
-    size_t write(const uint8_t *buf, size_t len) {
-        return file->write((const char*) buf, len);
+    size_t readBytes(char *out, size_t n) {
+        size_t copied = 0;
+        while (copied < n) {
+            if (pos >= len) {
+                if (n - copied >= bufsize) {
+                    //large block, bypass the buffer
+                    return copied + file->read(out + copied, n - copied);
+                }
+                if (!fill()) {
+                    break;
+                }
+            }
+            size_t chunk = std::min(n - copied, len - pos);
+            memcpy(out + copied, buf + pos, chunk);
+            pos += chunk;
+            copied += chunk;
+        }
+        return copied;
+    }
+};
+
+class ArduinoJsonFileWriter {
+private:
+    FileAdapter *file;
+    char *buf;
+    size_t bufsize;
+    size_t len = 0; //number of pending bytes in buf
+    bool failure = false;
+public:
+    ArduinoJsonFileWriter(FileAdapter *file, char *buf, size_t bufsize) : file(file), buf(buf), bufsize(bufsize) { }
+
+    ~ArduinoJsonFileWriter() {
+        flush();
     }
 
     size_t write(uint8_t c) {
-        return file->write((const char*) &c, 1);
+        if (len >= bufsize && !flush()) {
+            return 0;
+        }
+        buf[len++] = (char) c;
+        return 1;
     }
+
+    size_t write(const uint8_t *data, size_t n) {
+        if (len + n > bufsize) {
+            if (!flush()) {
+                return 0;
+            }
+            if (n >= bufsize) {
+                //large block, bypass the buffer
+                size_t written = file->write((const char*) data, n);
+                failure |= written != n;
+                return written;
+            }
+        }
+        memcpy(buf + len, data, n);
+        len += n;
+        return n;
+    }
+
+    //writes the pending bytes. Returns false if any write to the file has failed
+    bool flush() {
+        if (len > 0) {
+            failure |= file->write(buf, len) != len;
+            len = 0;
+        }
+        return !failure;
+    }
+};
+
+/*
+ * Encoding of stored documents. MessagePack files are about a third smaller than JSON and parse faster, JSON files
+ * are human-readable. The loaders detect the format by the first byte, so stores can switch the format and still
+ * read the files which they have written before.
+ */
+enum class StorageFormat : uint8_t {
+    Json = AO_STORAGE_JSON,
+    MsgPack = AO_STORAGE_MSGPACK
 };
 
 namespace FilesystemUtils {
 
-std::unique_ptr<DynamicJsonDocument> loadJson(std::shared_ptr<FilesystemAdapter> filesystem, const char *fn);
-bool storeJson(std::shared_ptr<FilesystemAdapter> filesystem, const char *fn, const DynamicJsonDocument& doc);
+/*
+ * Accepts both formats. If mappingOut is given and the filesystem can map files (see FilesystemAdapter::map), the
+ * document is deserialized in zero-copy mode: its strings point into the mapping which is handed over to the caller
+ * and must outlive the document. Without mapping support, *mappingOut stays empty and the document is self-contained
+ */
+std::unique_ptr<DynamicJsonDocument> loadJson(std::shared_ptr<FilesystemAdapter> filesystem, const char *fn, std::unique_ptr<MappedFile> *mappingOut = nullptr);
+bool storeJson(std::shared_ptr<FilesystemAdapter> filesystem, const char *fn, const JsonDocument& doc, StorageFormat format = StorageFormat::Json);
+
+StorageFormat detectFormat(const char *data, size_t length);
+size_t measure(const JsonDocument& doc, StorageFormat format); //size of the serialized document
+size_t measureCapacity(const char *data, size_t length, StorageFormat format); //see JsonCapacity.h
 
 }
 
@@ -0,0 +1,215 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/JsonCapacity.h>
+#include <ArduinoJson.h>
+
+using namespace ArduinoOcpp;
+
+size_t ArduinoOcpp::measureJsonCapacity(const char *json, size_t length) {
+    if (!json) {
+        return 0;
+    }
+
+    size_t capacity = 0;
+
+    //the containers enclosing the current token
+    bool isObject [AO_JSONCAPACITY_MAXDEPTH];
+    size_t nMembers [AO_JSONCAPACITY_MAXDEPTH];
+    int depth = 0;
+
+    //in arrays, every value is an own member; in objects, every key-value pair (counted at the ':')
+    auto addValue = [&isObject, &nMembers, &depth] () {
+        if (depth > 0 && !isObject[depth - 1]) {
+            nMembers[depth - 1]++;
+        }
+    };
+
+    size_t i = 0;
+    while (i < length && json[i] != '\0') {
+        switch (json[i]) {
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+            case ',':
+                i++;
+                break;
+            case ':':
+                if (depth <= 0 || !isObject[depth - 1]) {
+                    return 0;
+                }
+                nMembers[depth - 1]++;
+                i++;
+                break;
+            case '"': {
+                i++;
+                size_t strBegin = i;
+                while (i < length && json[i] != '"') {
+                    if (json[i] == '\0') {
+                        return 0;
+                    }
+                    if (json[i] == '\\') {
+                        i++; //skip escaped character
+                    }
+                    i++;
+                }
+                if (i >= length) {
+                    return 0; //unterminated string
+                }
+                capacity += JSON_STRING_SIZE(i - strBegin);
+                addValue(); //no-op for member keys
+                i++;
+                break;
+            }
+            case '[':
+            case '{':
+                addValue();
+                if (depth >= AO_JSONCAPACITY_MAXDEPTH) {
+                    return 0;
+                }
+                isObject[depth] = json[i] == '{';
+                nMembers[depth] = 0;
+                depth++;
+                i++;
+                break;
+            case ']':
+            case '}':
+                if (depth <= 0 || isObject[depth - 1] != (json[i] == '}')) {
+                    return 0;
+                }
+                depth--;
+                capacity += isObject[depth] ? JSON_OBJECT_SIZE(nMembers[depth]) : JSON_ARRAY_SIZE(nMembers[depth]);
+                i++;
+                break;
+            default:
+                //number or literal (true, false, null). Stored in the slot of its container; no extra space
+                addValue();
+                while (i < length && json[i] != '\0' &&
+                        json[i] != ',' && json[i] != ']' && json[i] != '}' && json[i] != ':' &&
+                        json[i] != ' ' && json[i] != '\t' && json[i] != '\r' && json[i] != '\n') {
+                    i++;
+                }
+                break;
+        }
+    }
+
+    if (depth != 0) {
+        return 0; //unbalanced brackets
+    }
+
+    return capacity;
+}
+
+size_t ArduinoOcpp::measureMsgPackCapacity(const char *data, size_t length) {
+    if (!data) {
+        return 0;
+    }
+
+    const unsigned char *in = reinterpret_cast<const unsigned char*>(data);
+
+    size_t capacity = 0;
+
+    //number of items which are left in the containers enclosing the current item
+    size_t nRemaining [AO_JSONCAPACITY_MAXDEPTH];
+    int depth = 0;
+
+    size_t i = 0;
+
+    //reads a big-endian length field
+    auto readLength = [in, length, &i] (size_t nBytes, size_t& out) -> bool {
+        if (length - i < nBytes) {
+            return false;
+        }
+        out = 0;
+        for (size_t k = 0; k < nBytes; k++) {
+            out = (out << 8) | in[i++];
+        }
+        return true;
+    };
+
+    do {
+        if (i >= length) {
+            return 0; //truncated
+        }
+
+        if (depth > 0) {
+            nRemaining[depth - 1]--;
+        }
+
+        unsigned char type = in[i++];
+
+        size_t skip = 0; //size of the payload
+        size_t nItems = 0; //items of arrays and objects (an object member counts as two items: key and value)
+        bool isContainer = false;
+
+        if (type <= 0x7f || type >= 0xe0 || type == 0xc0 || type == 0xc2 || type == 0xc3) {
+            //fixint, nil, bool. Stored in the slot of its container; no extra space
+        } else if ((type & 0xf0) == 0x80 || (type & 0xf0) == 0x90 || type == 0xdc || type == 0xdd || type == 0xde || type == 0xdf) {
+            isContainer = true;
+            bool isObject = (type & 0xf0) == 0x80 || type == 0xde || type == 0xdf;
+            size_t nMembers = 0;
+            if (type < 0xa0) {
+                nMembers = type & 0x0f;
+            } else if (!readLength(type == 0xdc || type == 0xde ? 2 : 4, nMembers)) {
+                return 0;
+            }
+            if (nMembers > length - i) {
+                return 0; //every item takes at least one byte
+            }
+            nItems = isObject ? 2 * nMembers : nMembers;
+            capacity += isObject ? JSON_OBJECT_SIZE(nMembers) : JSON_ARRAY_SIZE(nMembers);
+        } else if ((type & 0xe0) == 0xa0 || type == 0xd9 || type == 0xda || type == 0xdb ||
+                type == 0xc4 || type == 0xc5 || type == 0xc6) {
+            //str and bin are copied into the document
+            if ((type & 0xe0) == 0xa0) {
+                skip = type & 0x1f;
+            } else if (!readLength(type == 0xd9 || type == 0xc4 ? 1 :
+                                   type == 0xda || type == 0xc5 ? 2 : 4, skip)) {
+                return 0;
+            }
+            capacity += JSON_STRING_SIZE(skip);
+        } else {
+            switch (type) {
+                case 0xcc: case 0xd0: skip = 1; break; //uint8, int8
+                case 0xcd: case 0xd1: skip = 2; break; //uint16, int16
+                case 0xca: case 0xce: case 0xd2: skip = 4; break; //float32, uint32, int32
+                case 0xcb: case 0xcf: case 0xd3: skip = 8; break; //float64, uint64, int64
+                case 0xd4: skip = 2; break; //fixext (type and data)
+                case 0xd5: skip = 3; break;
+                case 0xd6: skip = 5; break;
+                case 0xd7: skip = 9; break;
+                case 0xd8: skip = 17; break;
+                case 0xc7: case 0xc8: case 0xc9: //ext
+                    if (!readLength(type == 0xc7 ? 1 : type == 0xc8 ? 2 : 4, skip)) {
+                        return 0;
+                    }
+                    skip++; //type
+                    break;
+                default:
+                    return 0; //0xc1 is never used
+            }
+        }
+
+        if (skip > length - i) {
+            return 0; //truncated
+        }
+        i += skip;
+
+        if (isContainer && nItems > 0) {
+            if (depth >= AO_JSONCAPACITY_MAXDEPTH) {
+                return 0;
+            }
+            nRemaining[depth] = nItems;
+            depth++;
+        }
+
+        //close all completed containers
+        while (depth > 0 && nRemaining[depth - 1] == 0) {
+            depth--;
+        }
+    } while (depth > 0);
+
+    return capacity;
+}
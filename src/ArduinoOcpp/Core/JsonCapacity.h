@@ -0,0 +1,34 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_JSONCAPACITY_H
+#define AO_JSONCAPACITY_H
+
+#include <stddef.h>
+
+#ifndef AO_JSONCAPACITY_MAXDEPTH
+#define AO_JSONCAPACITY_MAXDEPTH 10 //same as the default nesting limit of ArduinoJson
+#endif
+
+namespace ArduinoOcpp {
+
+/*
+ * Scans the serialized JSON in one pass and returns the capacity which a DynamicJsonDocument needs for
+ * deserializing it with deserializeJson(doc, json, length). The result covers the memory pool slots of all
+ * arrays and objects and copies of all strings (including member keys). It is an upper bound for ArduinoJson,
+ * e.g. escape sequences and duplicate strings need less space than counted here.
+ * 
+ * Returns 0 if json is not well-formed or nested deeper than AO_JSONCAPACITY_MAXDEPTH. Then the capacity is
+ * unknown and the deserializer should determine the error.
+ */
+size_t measureJsonCapacity(const char *json, size_t length);
+
+/*
+ * Same for MessagePack input of deserializeMsgPack(doc, data, length). Only the first value of data is measured
+ */
+size_t measureMsgPackCapacity(const char *data, size_t length);
+
+}
+
+#endif
@@ -0,0 +1,403 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/JsonReader.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define AO_JSONREADER_NUMBER_MAXSIZE 32
+
+using namespace ArduinoOcpp;
+
+JsonReader::JsonReader(const char *json, size_t length) : json(json), length(json ? length : 0) {
+    key[0] = '\0';
+}
+
+void JsonReader::skipWhitespace() {
+    while (pos < length && (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\n' || json[pos] == '\r')) {
+        pos++;
+    }
+}
+
+bool JsonReader::consume(char c) {
+    skipWhitespace();
+    if (!valid || pos >= length || json[pos] != c) {
+        valid = false;
+        return false;
+    }
+    pos++;
+    return true;
+}
+
+bool JsonReader::consumeLiteral(const char *literal) {
+    skipWhitespace();
+    size_t n = strlen(literal);
+    if (!valid || length - pos < n || strncmp(json + pos, literal, n)) {
+        valid = false;
+        return false;
+    }
+    pos += n;
+    return true;
+}
+
+JsonReader::Type JsonReader::peek() {
+    skipWhitespace();
+    if (!valid || pos >= length) {
+        return Type::Invalid;
+    }
+    switch (json[pos]) {
+        case '{':
+            return Type::Object;
+        case '[':
+            return Type::Array;
+        case '"':
+            return Type::String;
+        case 't':
+        case 'f':
+            return Type::Bool;
+        case 'n':
+            return Type::Null;
+        default:
+            if (json[pos] == '-' || (json[pos] >= '0' && json[pos] <= '9')) {
+                return Type::Number;
+            }
+            return Type::Invalid;
+    }
+}
+
+bool JsonReader::beginObject() {
+    if (!consume('{')) {
+        return false;
+    }
+    expectFirst = true;
+    return true;
+}
+
+bool JsonReader::nextMember() {
+    skipWhitespace();
+    if (!valid || pos >= length) {
+        valid = false;
+        return false;
+    }
+    if (json[pos] == '}') {
+        pos++;
+        endValue();
+        return false;
+    }
+    if (!expectFirst && !consume(',')) {
+        return false;
+    }
+    if (!consume('"')) {
+        return false;
+    }
+    if (!readStringContent(key, sizeof(key), nullptr)) {
+        if (!valid) {
+            return false;
+        }
+        key[0] = '\0'; //too long, not one of the expected keys
+    }
+    expectFirst = true; //the value follows without separator
+    return consume(':');
+}
+
+bool JsonReader::beginArray() {
+    if (!consume('[')) {
+        return false;
+    }
+    expectFirst = true;
+    return true;
+}
+
+bool JsonReader::nextElement() {
+    skipWhitespace();
+    if (!valid || pos >= length) {
+        valid = false;
+        return false;
+    }
+    if (json[pos] == ']') {
+        pos++;
+        endValue();
+        return false;
+    }
+    if (!expectFirst) {
+        if (!consume(',')) {
+            return false;
+        }
+        skipWhitespace();
+        if (pos >= length || json[pos] == ']') {
+            valid = false; //trailing comma
+            return false;
+        }
+    }
+    expectFirst = true;
+    return true;
+}
+
+/*
+ * Reads the string after the opening quotation mark and decodes the escape sequences. If out is too small, the
+ * remaining characters are skipped and the function returns false without setting the error state
+ */
+bool JsonReader::readStringContent(char *out, size_t size, std::string *outStr) {
+    size_t outLen = 0;
+    bool fits = true;
+
+    auto put = [&] (char c) {
+        if (outStr) {
+            outStr->push_back(c);
+        } else if (outLen + 1 < size) {
+            out[outLen++] = c;
+        } else {
+            fits = false;
+        }
+    };
+
+    while (pos < length && json[pos] != '"') {
+        char c = json[pos++];
+        if ((unsigned char) c < 0x20) {
+            valid = false;
+            return false;
+        }
+        if (c != '\\') {
+            put(c);
+            continue;
+        }
+        if (pos >= length) {
+            break;
+        }
+        c = json[pos++];
+        switch (c) {
+            case '"':
+            case '\\':
+            case '/':
+                put(c);
+                break;
+            case 'b':
+                put('\b');
+                break;
+            case 'f':
+                put('\f');
+                break;
+            case 'n':
+                put('\n');
+                break;
+            case 'r':
+                put('\r');
+                break;
+            case 't':
+                put('\t');
+                break;
+            case 'u': {
+                unsigned long codepoint = 0;
+                for (int i = 0; i < 2; i++) {
+                    if (length - pos < 4) {
+                        valid = false;
+                        return false;
+                    }
+                    char hex [5];
+                    memcpy(hex, json + pos, 4);
+                    hex[4] = '\0';
+                    char *end = nullptr;
+                    unsigned long unit = strtoul(hex, &end, 16);
+                    if (end != hex + 4) {
+                        valid = false;
+                        return false;
+                    }
+                    pos += 4;
+                    if (i == 0) {
+                        codepoint = unit;
+                        //high surrogate: combine with the following low surrogate
+                        if (codepoint < 0xD800 || codepoint > 0xDBFF ||
+                                length - pos < 6 || json[pos] != '\\' || json[pos + 1] != 'u') {
+                            break;
+                        }
+                        pos += 2;
+                    } else {
+                        if (unit < 0xDC00 || unit > 0xDFFF) {
+                            valid = false;
+                            return false;
+                        }
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (unit - 0xDC00);
+                    }
+                }
+                //encode as UTF-8
+                if (codepoint < 0x80) {
+                    put((char) codepoint);
+                } else if (codepoint < 0x800) {
+                    put((char) (0xC0 | (codepoint >> 6)));
+                    put((char) (0x80 | (codepoint & 0x3F)));
+                } else if (codepoint < 0x10000) {
+                    put((char) (0xE0 | (codepoint >> 12)));
+                    put((char) (0x80 | ((codepoint >> 6) & 0x3F)));
+                    put((char) (0x80 | (codepoint & 0x3F)));
+                } else {
+                    put((char) (0xF0 | (codepoint >> 18)));
+                    put((char) (0x80 | ((codepoint >> 12) & 0x3F)));
+                    put((char) (0x80 | ((codepoint >> 6) & 0x3F)));
+                    put((char) (0x80 | (codepoint & 0x3F)));
+                }
+                break;
+            }
+            default:
+                valid = false;
+                return false;
+        }
+    }
+
+    if (pos >= length) {
+        valid = false;
+        return false;
+    }
+    pos++; //closing quotation mark
+
+    if (out && size > 0) {
+        out[outLen] = '\0';
+    }
+    return fits;
+}
+
+bool JsonReader::readNumberToken(char *out, size_t size) {
+    if (peek() != Type::Number) {
+        valid = false;
+        return false;
+    }
+    size_t n = 0;
+    while (pos < length && n + 1 < size &&
+            ((json[pos] >= '0' && json[pos] <= '9') ||
+                json[pos] == '-' || json[pos] == '+' || json[pos] == '.' || json[pos] == 'e' || json[pos] == 'E')) {
+        out[n++] = json[pos++];
+    }
+    out[n] = '\0';
+    if (n + 1 >= size) {
+        valid = false; //too many digits
+        return false;
+    }
+    return true;
+}
+
+bool JsonReader::readString(char *out, size_t size) {
+    if (!consume('"')) {
+        return false;
+    }
+    if (!readStringContent(out, size, nullptr)) {
+        valid = false;
+        return false;
+    }
+    return endValue();
+}
+
+bool JsonReader::readTruncatedString(char *out, size_t size) {
+    if (!consume('"')) {
+        return false;
+    }
+    if (!readStringContent(out, size, nullptr) && !valid) {
+        return false;
+    }
+    return endValue();
+}
+
+bool JsonReader::readString(std::string& out) {
+    if (!consume('"')) {
+        return false;
+    }
+    out.clear();
+    if (!readStringContent(nullptr, 0, &out)) {
+        return false;
+    }
+    return endValue();
+}
+
+bool JsonReader::readInt(int& out) {
+    char number [AO_JSONREADER_NUMBER_MAXSIZE];
+    if (!readNumberToken(number, sizeof(number))) {
+        return false;
+    }
+    char *end = nullptr;
+    if (strpbrk(number, ".eE")) {
+        out = (int) strtod(number, &end);
+    } else {
+        out = (int) strtol(number, &end, 10);
+    }
+    if (!end || *end != '\0') {
+        valid = false;
+        return false;
+    }
+    return endValue();
+}
+
+bool JsonReader::readFloat(float& out) {
+    char number [AO_JSONREADER_NUMBER_MAXSIZE];
+    if (!readNumberToken(number, sizeof(number))) {
+        return false;
+    }
+    char *end = nullptr;
+    out = (float) strtod(number, &end);
+    if (!end || *end != '\0') {
+        valid = false;
+        return false;
+    }
+    return endValue();
+}
+
+bool JsonReader::readBool(bool& out) {
+    if (peek() != Type::Bool) {
+        valid = false;
+        return false;
+    }
+    out = json[pos] == 't';
+    if (!consumeLiteral(out ? "true" : "false")) {
+        return false;
+    }
+    return endValue();
+}
+
+bool JsonReader::readNull() {
+    if (!consumeLiteral("null")) {
+        return false;
+    }
+    return endValue();
+}
+
+bool JsonReader::skipValue() {
+    switch (peek()) {
+        case Type::Object:
+        case Type::Array:
+            if (depth >= AO_JSONREADER_MAXDEPTH) {
+                valid = false;
+                return false;
+            }
+            depth++;
+            if (peek() == Type::Object) {
+                beginObject();
+                while (nextMember()) {
+                    skipValue();
+                }
+            } else {
+                beginArray();
+                while (nextElement()) {
+                    skipValue();
+                }
+            }
+            depth--;
+            return valid;
+        case Type::String:
+            pos++;
+            readStringContent(nullptr, 0, nullptr);
+            return endValue();
+        case Type::Number: {
+            char number [AO_JSONREADER_NUMBER_MAXSIZE];
+            readNumberToken(number, sizeof(number));
+            return endValue();
+        }
+        case Type::Bool: {
+            bool dummy;
+            return readBool(dummy);
+        }
+        case Type::Null:
+            return readNull();
+        default:
+            valid = false;
+            return false;
+    }
+}
@@ -0,0 +1,122 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_JSONREADER_H
+#define AO_JSONREADER_H
+
+#include <stddef.h>
+#include <string>
+
+#ifndef AO_JSONREADER_KEY_MAXLEN
+#define AO_JSONREADER_KEY_MAXLEN 31 //longer member keys are skipped as unknown keys
+#endif
+
+#ifndef AO_JSONREADER_MAXDEPTH
+#define AO_JSONREADER_MAXDEPTH 10 //nesting limit for skipping unknown values
+#endif
+
+namespace ArduinoOcpp {
+
+/*
+ * Pull-based JSON tokenizer which reads the serialized input directly, without building a JsonDocument. The caller
+ * walks through the input by requesting the type it expects at the current position. If the input has a different
+ * type or is malformed, the reader goes into the error state and all further reads fail.
+ *
+ * Objects are read with readObject() which passes each member key to a field handler. The handler reads the value
+ * and returns true, or returns false to skip the value. Arrays are read with readArray() which calls the element
+ * handler for each element. This allows the OCPP messages to fill their model objects directly from the input.
+ */
+class JsonReader {
+public:
+    enum class Type {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object,
+        Invalid
+    };
+private:
+    const char *json;
+    size_t length;
+    size_t pos = 0;
+    bool expectFirst = true; //at the first element of an array or object, i.e. no comma expected
+    bool valid = true;
+    unsigned int depth = 0; //nesting of skipValue()
+
+    char key [AO_JSONREADER_KEY_MAXLEN + 1];
+
+    void skipWhitespace();
+    bool consume(char c);
+    bool consumeLiteral(const char *literal);
+    bool readStringContent(char *out, size_t size, std::string *outStr); //writes into out or appends to outStr
+    bool readNumberToken(char *out, size_t size);
+    bool endValue() {expectFirst = false; return valid;}
+public:
+    JsonReader(const char *json, size_t length);
+
+    Type peek(); //type of the next value, without consuming it
+
+    bool beginObject();
+    bool nextMember(); //returns false at the end of the object, otherwise reads the next key (see getKey())
+    const char *getKey() const {return key;}
+
+    bool beginArray();
+    bool nextElement(); //returns false at the end of the array
+
+    bool readString(char *out, size_t size); //fails if the string doesn't fit including the terminating zero
+    bool readTruncatedString(char *out, size_t size); //like readString, but truncates a string which doesn't fit
+    bool readString(std::string& out);
+    bool readInt(int& out);
+    bool readFloat(float& out);
+    bool readBool(bool& out);
+    bool readNull();
+    bool skipValue();
+
+    size_t getPosition() const {return pos;} //offset in the input, e.g. to keep the raw input of a value. After peek(), the offset of the next value
+    const char *getInput() const {return json;}
+
+    /*
+     * onMember(const char *key) reads the value of the member and returns true, or returns false if
+     * the reader should skip the value. The key is only valid until the handler reads the value
+     */
+    template<class F>
+    bool readObject(F onMember) {
+        if (!beginObject()) {
+            return false;
+        }
+        while (nextMember()) {
+            if (!onMember((const char*) key)) {
+                skipValue();
+            }
+        }
+        return valid;
+    }
+
+    /*
+     * onElement() reads one element of the array. If it doesn't read the element, the reader skips it
+     */
+    template<class F>
+    bool readArray(F onElement) {
+        if (!beginArray()) {
+            return false;
+        }
+        while (nextElement()) {
+            size_t elementPos = pos;
+            onElement();
+            if (pos == elementPos) {
+                skipValue();
+            }
+        }
+        return valid;
+    }
+
+    void setError() {valid = false;} //the input violates the expected format
+    bool isValid() const {return valid;}
+};
+
+}
+
+#endif
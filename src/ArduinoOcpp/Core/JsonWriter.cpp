@@ -0,0 +1,201 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/JsonWriter.h>
+
+#include <ArduinoJson.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <cmath>
+
+#define AO_JSONWRITER_NUMBER_MAXSIZE 24
+
+using namespace ArduinoOcpp;
+
+JsonWriter::JsonWriter(char *buf, size_t size) : buf(buf), size(buf ? size : 0) {
+
+}
+
+void JsonWriter::write(char c) {
+    if (buf) {
+        if (len < size) {
+            buf[len] = c;
+        } else {
+            valid = false;
+        }
+    }
+    len++;
+}
+
+void JsonWriter::write(const char *str, size_t n) {
+    if (buf) {
+        if (len + n <= size) {
+            memcpy(buf + len, str, n);
+        } else {
+            valid = false;
+        }
+    }
+    len += n;
+}
+
+void JsonWriter::writeEscaped(const char *str) {
+    write('"');
+    for (const char *c = str; *c; c++) {
+        switch (*c) {
+            case '"':
+                write("\\\"", 2);
+                break;
+            case '\\':
+                write("\\\\", 2);
+                break;
+            case '\b':
+                write("\\b", 2);
+                break;
+            case '\f':
+                write("\\f", 2);
+                break;
+            case '\n':
+                write("\\n", 2);
+                break;
+            case '\r':
+                write("\\r", 2);
+                break;
+            case '\t':
+                write("\\t", 2);
+                break;
+            default:
+                if ((unsigned char) *c < 0x20) {
+                    char escaped [7];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int) (unsigned char) *c);
+                    write(escaped, 6);
+                } else {
+                    write(*c);
+                }
+                break;
+        }
+    }
+    write('"');
+}
+
+void JsonWriter::writeNumber(const char *format, ...) {
+    char number [AO_JSONWRITER_NUMBER_MAXSIZE];
+    va_list args;
+    va_start(args, format);
+    int ret = vsnprintf(number, sizeof(number), format, args);
+    va_end(args);
+    if (ret < 0 || (size_t) ret >= sizeof(number)) {
+        valid = false;
+        return;
+    }
+    write(number, (size_t) ret);
+}
+
+void JsonWriter::beginElement() {
+    if (needsComma) {
+        write(',');
+    }
+    needsComma = true;
+}
+
+void JsonWriter::beginObject() {
+    beginElement();
+    write('{');
+    needsComma = false;
+}
+
+void JsonWriter::endObject() {
+    write('}');
+    needsComma = true;
+}
+
+void JsonWriter::beginArray() {
+    beginElement();
+    write('[');
+    needsComma = false;
+}
+
+void JsonWriter::endArray() {
+    write(']');
+    needsComma = true;
+}
+
+void JsonWriter::key(const char *key) {
+    beginElement();
+    writeEscaped(key ? key : "");
+    write(':');
+    needsComma = false;
+}
+
+void JsonWriter::value(const char *str) {
+    beginElement();
+    if (str) {
+        writeEscaped(str);
+    } else {
+        write("null", 4);
+    }
+}
+
+void JsonWriter::value(bool val) {
+    beginElement();
+    if (val) {
+        write("true", 4);
+    } else {
+        write("false", 5);
+    }
+}
+
+void JsonWriter::value(int val) {
+    beginElement();
+    writeNumber("%d", val);
+}
+
+void JsonWriter::value(unsigned int val) {
+    beginElement();
+    writeNumber("%u", val);
+}
+
+void JsonWriter::value(long val) {
+    beginElement();
+    writeNumber("%ld", val);
+}
+
+void JsonWriter::value(unsigned long val) {
+    beginElement();
+    writeNumber("%lu", val);
+}
+
+void JsonWriter::value(float val) {
+    beginElement();
+    if (!std::isfinite(val)) {
+        write("null", 4);
+        return;
+    }
+    //let ArduinoJson format the number, so that the output is the same as of a serialized JsonDocument
+    StaticJsonDocument<8> number;
+    number.set(val);
+    char numberStr [AO_JSONWRITER_NUMBER_MAXSIZE];
+    size_t n = serializeJson(number, numberStr, sizeof(numberStr));
+    if (n == 0 || n + 1 >= sizeof(numberStr)) {
+        valid = false;
+        return;
+    }
+    write(numberStr, n);
+}
+
+void JsonWriter::rawValue(const char *json, size_t n) {
+    beginElement();
+    write(json, n);
+}
+
+void JsonWriter::rollback(const Checkpoint& checkpoint) {
+    if (checkpoint.len <= len) {
+        if (len > maxLen) {
+            maxLen = len;
+        }
+        len = checkpoint.len;
+        needsComma = checkpoint.needsComma;
+    }
+}
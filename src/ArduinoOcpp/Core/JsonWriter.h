@@ -0,0 +1,70 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_JSONWRITER_H
+#define AO_JSONWRITER_H
+
+#include <stddef.h>
+
+namespace ArduinoOcpp {
+
+/*
+ * Streaming JSON serializer which writes directly into a caller-provided buffer, without building a JsonDocument first.
+ * The caller is responsible for the correct nesting of begin / end calls and for writing a key before each value in
+ * objects. The writer takes care of the separators and of escaping strings.
+ * 
+ * If the buffer is nullptr, the writer only counts the output length. This allows to determine the exact buffer size
+ * in a first pass and to serialize in a second pass.
+ */
+class JsonWriter {
+private:
+    char *buf;
+    size_t size;
+    size_t len = 0;
+    size_t maxLen = 0; //len can decrease after rollbacks
+    bool needsComma = false; //next element follows a sibling element
+    bool valid = true;
+
+    void write(char c);
+    void write(const char *str, size_t n);
+    void writeEscaped(const char *str);
+    void writeNumber(const char *format, ...);
+    void beginElement();
+public:
+    JsonWriter(char *buf, size_t size);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void key(const char *key);
+
+    void value(const char *str); //nullptr results in null
+    void value(bool val);
+    void value(int val);
+    void value(unsigned int val);
+    void value(long val);
+    void value(unsigned long val);
+    void value(float val); //same format as ArduinoJson. Non-finite numbers result in null
+    void rawValue(const char *json, size_t n); //copies an element which has been serialized before, e.g. a cached one
+
+    struct Checkpoint {
+        size_t len;
+        bool needsComma;
+    };
+
+    Checkpoint getCheckpoint() const {return {len, needsComma};}
+    void rollback(const Checkpoint& checkpoint); //discards everything written after checkpoint
+
+    void setError() {valid = false;} //the serialization cannot be completed, e.g. because data is missing
+    bool isValid() const {return valid;} //false if the output exceeds the buffer or after setError()
+
+    size_t getLength() const {return len;} //length of the output (without terminating zero)
+    size_t getRequiredSize() const {return maxLen > len ? maxLen : len;} //buffer size needed for writing this output, including discarded parts
+};
+
+}
+
+#endif
@@ -0,0 +1,32 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_LITTLEENDIAN_H
+#define AO_LITTLEENDIAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ArduinoOcpp {
+
+/*
+ * Fixed-width integer fields of the binary storage formats (see OperationLog, StoreManifest, CounterRecord)
+ */
+inline void writeUintLE(unsigned char *out, uint32_t val, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (unsigned char) (val >> (8 * i));
+    }
+}
+
+inline uint32_t readUintLE(const unsigned char *in, size_t n) {
+    uint32_t val = 0;
+    for (size_t i = 0; i < n; i++) {
+        val |= ((uint32_t) in[i]) << (8 * i);
+    }
+    return val;
+}
+
+}
+
+#endif
@@ -0,0 +1,165 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/MemoryArena.h>
+#include <ArduinoOcpp/Debug.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define AO_ARENA_ALIGN(X) (((X) + (AO_ARENA_ALIGNMENT - 1)) & ~((size_t) AO_ARENA_ALIGNMENT - 1))
+#define AO_ARENA_HEADER AO_ARENA_ALIGN(sizeof(size_t)) //each block starts with its size
+#define AO_ARENA_NO_BLOCK ((size_t) -1)
+
+using namespace ArduinoOcpp;
+
+static MemoryArena *activeArena = nullptr;
+
+MemoryArena *ArduinoOcpp::getActiveArena() {
+    return activeArena;
+}
+
+void ArduinoOcpp::setActiveArena(MemoryArena *arena) {
+    activeArena = arena;
+}
+
+MemoryArena::MemoryArena(size_t capacity) : lastBlock(AO_ARENA_NO_BLOCK) {
+    if (capacity > 0) {
+        buf = static_cast<unsigned char*>(malloc(capacity));
+        if (!buf) {
+            AO_DBG_ERR("OOM");
+            capacity = 0;
+        }
+    }
+    this->capacity = capacity;
+}
+
+MemoryArena::~MemoryArena() {
+    if (live > 0) {
+        AO_DBG_ERR("%zu blocks still in use", live);
+    }
+    free(buf);
+}
+
+void *MemoryArena::allocate(size_t size) {
+    size_t blockSize = AO_ARENA_HEADER + AO_ARENA_ALIGN(size);
+    if (blockSize < size || blockSize > capacity - used) {
+        return nullptr;
+    }
+
+    *reinterpret_cast<size_t*>(buf + used) = size;
+    lastBlock = used;
+    used += blockSize;
+    live++;
+
+    if (used > highWater) {
+        highWater = used;
+    }
+
+    return buf + lastBlock + AO_ARENA_HEADER;
+}
+
+void MemoryArena::deallocate(void *ptr) {
+    if (!owns(ptr) || live == 0) {
+        AO_DBG_ERR("invalid argument");
+        return;
+    }
+
+    live--;
+
+    if (live == 0) {
+        //nothing in use anymore, start over
+        used = 0;
+        lastBlock = AO_ARENA_NO_BLOCK;
+    } else if (static_cast<unsigned char*>(ptr) == buf + lastBlock + AO_ARENA_HEADER) {
+        //the most recent block can be given back right away
+        used = lastBlock;
+        lastBlock = AO_ARENA_NO_BLOCK;
+    }
+}
+
+void *MemoryArena::reallocate(void *ptr, size_t size) {
+    if (!owns(ptr) || lastBlock == AO_ARENA_NO_BLOCK ||
+            static_cast<unsigned char*>(ptr) != buf + lastBlock + AO_ARENA_HEADER) {
+        return nullptr;
+    }
+
+    size_t blockSize = AO_ARENA_HEADER + AO_ARENA_ALIGN(size);
+    if (blockSize < size || blockSize > capacity - lastBlock) {
+        return nullptr;
+    }
+
+    *reinterpret_cast<size_t*>(buf + lastBlock) = size;
+    used = lastBlock + blockSize;
+
+    if (used > highWater) {
+        highWater = used;
+    }
+
+    return ptr;
+}
+
+size_t MemoryArena::getBlockSize(const void *ptr) const {
+    if (!owns(ptr)) {
+        return 0;
+    }
+    return *reinterpret_cast<const size_t*>(static_cast<const unsigned char*>(ptr) - AO_ARENA_HEADER);
+}
+
+size_t MemoryArena::getAvailable() const {
+    if (capacity - used <= AO_ARENA_HEADER) {
+        return 0;
+    }
+    return capacity - used - AO_ARENA_HEADER;
+}
+
+void MemoryArena::reset() {
+    if (live > 0) {
+        AO_DBG_DEBUG("cannot reset arena, %zu blocks still in use", live);
+        return;
+    }
+    used = 0;
+    lastBlock = AO_ARENA_NO_BLOCK;
+}
+
+void *ArenaAllocator::allocate(size_t size) {
+    if (arena) {
+        if (void *ptr = arena->allocate(size)) {
+            return ptr;
+        }
+    }
+    return malloc(size);
+}
+
+void ArenaAllocator::deallocate(void *ptr) {
+    if (arena && arena->owns(ptr)) {
+        arena->deallocate(ptr);
+    } else {
+        free(ptr);
+    }
+}
+
+void *ArenaAllocator::reallocate(void *ptr, size_t size) {
+    if (!ptr) {
+        return allocate(size);
+    }
+
+    if (!arena || !arena->owns(ptr)) {
+        return realloc(ptr, size);
+    }
+
+    if (void *resized = arena->reallocate(ptr, size)) {
+        return resized;
+    }
+
+    //not the most recent block, move it
+    size_t oldSize = arena->getBlockSize(ptr);
+    void *moved = allocate(size);
+    if (!moved) {
+        return nullptr;
+    }
+    memcpy(moved, ptr, oldSize < size ? oldSize : size);
+    arena->deallocate(ptr);
+    return moved;
+}
@@ -0,0 +1,91 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_MEMORYARENA_H
+#define AO_MEMORYARENA_H
+
+#include <ArduinoJson.h>
+#include <stddef.h>
+
+#ifndef AO_ENGINE_ARENA_SIZE
+#define AO_ENGINE_ARENA_SIZE 4096 //0 disables the arena: all documents are allocated on the heap
+#endif
+
+#ifndef AO_ARENA_ALIGNMENT
+#define AO_ARENA_ALIGNMENT 8
+#endif
+
+namespace ArduinoOcpp {
+
+/*
+ * Monotonic allocator over one buffer which is allocated once and lives as long as the OcppEngine. Allocations
+ * only bump the fill level. Freeing memory is deferred until reset() which the engine calls at the end of each
+ * loop() iteration. This way, the JSON documents which are created and destroyed within one loop iteration
+ * don't fragment the heap.
+ *
+ * reset() is refused while allocations are still alive, so a document which outlives the iteration by mistake
+ * only blocks the arena but doesn't get overwritten.
+ */
+class MemoryArena {
+private:
+    unsigned char *buf = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+    size_t lastBlock = 0; //offset of the most recent allocation which can be resized in place
+    size_t live = 0; //number of allocations which haven't been deallocated yet
+    size_t highWater = 0;
+public:
+    MemoryArena(size_t capacity);
+    ~MemoryArena();
+
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator=(const MemoryArena&) = delete;
+
+    void *allocate(size_t size); //returns nullptr if the arena is exhausted
+    void deallocate(void *ptr);
+    void *reallocate(void *ptr, size_t size); //in place only, returns nullptr if ptr isn't the last block or doesn't fit
+
+    bool owns(const void *ptr) const {return buf && ptr >= buf && ptr < buf + capacity;}
+    size_t getBlockSize(const void *ptr) const;
+
+    void reset();
+
+    size_t getCapacity() const {return capacity;}
+    size_t getUsed() const {return used;}
+    size_t getAvailable() const;
+    size_t getHighWater() const {return highWater;}
+};
+
+/*
+ * The arena of the OcppEngine. nullptr if there is no engine or the arena is disabled
+ */
+MemoryArena *getActiveArena();
+void setActiveArena(MemoryArena *arena);
+
+/*
+ * ArduinoJson allocator which takes memory from the active arena and falls back to the heap when the arena is
+ * exhausted. Documents bind to the arena which was active when they were constructed.
+ */
+class ArenaAllocator {
+private:
+    MemoryArena *arena;
+public:
+    ArenaAllocator() : arena(getActiveArena()) { }
+    ArenaAllocator(MemoryArena *arena) : arena(arena) { }
+
+    void *allocate(size_t size);
+    void deallocate(void *ptr);
+    void *reallocate(void *ptr, size_t size);
+};
+
+/*
+ * Document type for the JSON documents which only live within one loop iteration, i.e. the RPC frames and
+ * the intermediate payloads which get serialized right away. Documents which are kept across loop iterations
+ * must remain DynamicJsonDocuments
+ */
+using ArenaJsonDocument = BasicJsonDocument<ArenaAllocator>;
+
+}
+
+#endif
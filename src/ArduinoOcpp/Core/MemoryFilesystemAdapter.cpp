@@ -0,0 +1,278 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/MemoryFilesystemAdapter.h>
+#include <ArduinoOcpp/Debug.h>
+
+#include <string.h>
+#include <algorithm>
+
+#if AO_PERSISTENCE_THREADS
+#define AO_MEMFS_LOCK std::lock_guard<std::mutex> lock {mutex}
+#else
+#define AO_MEMFS_LOCK (void)0
+#endif
+
+namespace ArduinoOcpp {
+
+class MemoryFilesystemAdapter::MemoryFileAdapter : public FileAdapter {
+    MemoryFilesystemAdapter *filesystem;
+    std::shared_ptr<std::vector<char>> data;
+    size_t pos = 0;
+    bool readable = false;
+    bool writable = false;
+    bool append = false;
+public:
+    MemoryFileAdapter(MemoryFilesystemAdapter *filesystem, std::shared_ptr<std::vector<char>> data, bool readable, bool writable, bool append)
+            : filesystem(filesystem), data(data), readable(readable), writable(writable), append(append) { }
+
+    size_t read(char *buf, size_t len) override {
+        if (!readable) {
+            return 0;
+        }
+        auto nread = filesystem->read(*data, pos, buf, len);
+        pos += nread;
+        return nread;
+    }
+
+    size_t write(const char *buf, size_t len) override {
+        if (!writable) {
+            return 0;
+        }
+        if (append) {
+            pos = data->size();
+        }
+        auto written = filesystem->write(*data, pos, buf, len);
+        pos += written;
+        return written;
+    }
+
+    size_t seek(size_t offset) override {
+        if (offset > data->size()) {
+            return 1;
+        }
+        pos = offset;
+        return 0;
+    }
+
+    int read() override {
+        char c;
+        if (read(&c, 1) != 1) {
+            return -1;
+        }
+        return (unsigned char) c;
+    }
+};
+
+class MemoryMappedFile : public MappedFile {
+    std::vector<char> copy;
+public:
+    MemoryMappedFile(const std::vector<char>& data) : copy(data) { }
+
+    char *data() override {return copy.data();}
+    size_t size() override {return copy.size();}
+};
+
+} //end namespace ArduinoOcpp
+
+using namespace ArduinoOcpp;
+
+MemoryFilesystemAdapter::MemoryFilesystemAdapter(MemoryFilesystemProfile profile) : profile(profile) {
+    if (this->profile.blockSize == 0) {
+        this->profile.blockSize = 1;
+    }
+}
+
+std::vector<MemoryFilesystemAdapter::File>::iterator MemoryFilesystemAdapter::find(const char *fn) {
+    return std::find_if(files.begin(), files.end(),
+            [fn] (const File& file) {
+                return !file.fn.compare(fn);
+            });
+}
+
+void MemoryFilesystemAdapter::addLatency(unsigned long us) {
+    if (us == 0) {
+        return;
+    }
+    stats.elapsedUs += us;
+    if (profile.delayUs) {
+        profile.delayUs(us);
+    }
+}
+
+int MemoryFilesystemAdapter::stat(const char *path, size_t *size) {
+    AO_MEMFS_LOCK;
+    auto file = find(path);
+    if (file == files.end()) {
+        return -1;
+    }
+    *size = file->data->size();
+    return 0;
+}
+
+std::unique_ptr<FileAdapter> MemoryFilesystemAdapter::open(const char *fn, const char *mode) {
+    AO_MEMFS_LOCK;
+
+    bool plus = strchr(mode, '+') != nullptr;
+    bool readable = mode[0] == 'r' || plus;
+    bool writable = mode[0] == 'w' || mode[0] == 'a' || plus;
+    bool append = mode[0] == 'a';
+
+    if (writable && poweredOff) {
+        AO_DBG_DEBUG("powered off");
+        return nullptr;
+    }
+
+    stats.nOpens++;
+    addLatency(profile.openUs);
+
+    auto file = find(fn);
+    if (file == files.end()) {
+        if (mode[0] == 'r') {
+            AO_DBG_DEBUG("Failed to open file path %s", fn);
+            return nullptr;
+        }
+        files.push_back(File {fn, std::make_shared<std::vector<char>>()});
+        file = files.end() - 1;
+    } else if (mode[0] == 'w') {
+        //truncating frees the blocks. They are erased when they are written again
+        file->data = std::make_shared<std::vector<char>>();
+    }
+
+    return std::unique_ptr<FileAdapter>(new MemoryFileAdapter(this, file->data, readable, writable, append));
+}
+
+bool MemoryFilesystemAdapter::remove(const char *fn) {
+    AO_MEMFS_LOCK;
+    if (poweredOff) {
+        return false;
+    }
+    auto file = find(fn);
+    if (file == files.end()) {
+        return false;
+    }
+    files.erase(file);
+    return true;
+}
+
+std::unique_ptr<MappedFile> MemoryFilesystemAdapter::map(const char *fn) {
+    AO_MEMFS_LOCK;
+    auto file = find(fn);
+    if (file == files.end() || file->data->empty()) {
+        return nullptr;
+    }
+
+    stats.nReads++;
+    stats.bytesRead += file->data->size();
+    addLatency(profile.openUs + profile.readUs);
+
+    return std::unique_ptr<MappedFile>(new MemoryMappedFile(*file->data));
+}
+
+size_t MemoryFilesystemAdapter::read(std::vector<char>& data, size_t pos, char *buf, size_t len) {
+    AO_MEMFS_LOCK;
+
+    stats.nReads++;
+    addLatency(profile.readUs);
+
+    if (pos >= data.size()) {
+        return 0;
+    }
+
+    size_t nread = std::min(len, data.size() - pos);
+    memcpy(buf, data.data() + pos, nread);
+    stats.bytesRead += nread;
+    return nread;
+}
+
+size_t MemoryFilesystemAdapter::write(std::vector<char>& data, size_t pos, const char *buf, size_t len) {
+    AO_MEMFS_LOCK;
+
+    if (poweredOff) {
+        return 0;
+    }
+
+    if (failWriteCountdown > 0) {
+        failWriteCountdown--;
+        if (failWriteCountdown == 0) {
+            AO_DBG_DEBUG("inject write failure");
+            return 0;
+        }
+    }
+
+    if (powerLossCountdown > 0) {
+        powerLossCountdown--;
+        if (powerLossCountdown == 0) {
+            AO_DBG_DEBUG("inject power loss");
+            len = std::min(len, powerLossWritten);
+            poweredOff = true;
+        }
+    }
+
+    if (pos > data.size()) {
+        return 0;
+    }
+
+    stats.nWrites++;
+    stats.bytesWritten += len;
+    addLatency(profile.writeUs + len * profile.writeByteUs);
+
+    if (len == 0) {
+        return 0;
+    }
+
+    //erase the overwritten blocks and the new blocks at the end
+    auto bs = profile.blockSize;
+    unsigned long nErases = 0;
+    size_t overwriteEnd = std::min(pos + len, data.size());
+    if (pos < overwriteEnd) {
+        nErases += (overwriteEnd - 1) / bs - pos / bs + 1;
+    }
+    if (pos + len > data.size()) {
+        nErases += (pos + len + bs - 1) / bs - (data.size() + bs - 1) / bs;
+        data.resize(pos + len);
+    }
+    stats.nErases += nErases;
+    addLatency(nErases * profile.eraseUs);
+
+    memcpy(data.data() + pos, buf, len);
+    return len;
+}
+
+void MemoryFilesystemAdapter::failWrite(unsigned long n) {
+    AO_MEMFS_LOCK;
+    failWriteCountdown = n;
+}
+
+void MemoryFilesystemAdapter::powerLossAtWrite(unsigned long n, size_t written) {
+    AO_MEMFS_LOCK;
+    powerLossCountdown = n;
+    powerLossWritten = written;
+}
+
+void MemoryFilesystemAdapter::powerOn() {
+    AO_MEMFS_LOCK;
+    poweredOff = false;
+    powerLossCountdown = 0;
+}
+
+bool MemoryFilesystemAdapter::isPoweredOff() {
+    AO_MEMFS_LOCK;
+    return poweredOff;
+}
+
+MemoryFilesystemStats MemoryFilesystemAdapter::getStats() {
+    AO_MEMFS_LOCK;
+    return stats;
+}
+
+void MemoryFilesystemAdapter::resetStats() {
+    AO_MEMFS_LOCK;
+    stats = MemoryFilesystemStats();
+}
+
+size_t MemoryFilesystemAdapter::getFilesCount() {
+    AO_MEMFS_LOCK;
+    return files.size();
+}
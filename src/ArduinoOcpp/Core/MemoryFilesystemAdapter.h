@@ -0,0 +1,101 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_MEMORYFILESYSTEMADAPTER_H
+#define AO_MEMORYFILESYSTEMADAPTER_H
+
+#include <ArduinoOcpp/Core/FilesystemAdapter.h>
+#include <ArduinoOcpp/Core/PersistenceExecutor.h> //AO_PERSISTENCE_THREADS
+
+#include <stddef.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ArduinoOcpp {
+
+/*
+ * Cost model of the simulated flash. Every operation adds its latency to the simulated time. Flash is organized in
+ * erase blocks: a write which extends a file into a new block or which overwrites existing data erases the affected
+ * blocks first. If delayUs is set, it is called with each latency, e.g. to actually block the calling thread
+ */
+struct MemoryFilesystemProfile {
+    unsigned long openUs = 0;
+    unsigned long readUs = 0; //per read call
+    unsigned long writeUs = 0; //per write call
+    unsigned long writeByteUs = 0; //per written byte
+    unsigned long eraseUs = 0; //per erased block
+    size_t blockSize = 4096;
+    std::function<void(unsigned long us)> delayUs;
+};
+
+struct MemoryFilesystemStats {
+    unsigned long nOpens = 0;
+    unsigned long nReads = 0;
+    unsigned long nWrites = 0;
+    unsigned long nErases = 0;
+    size_t bytesRead = 0;
+    size_t bytesWritten = 0;
+    unsigned long elapsedUs = 0; //simulated time
+};
+
+/*
+ * RAM-backed filesystem for tests and benchmarks. Besides the cost model, it can inject faults:
+ *
+ *     failWrite(n): the n-th write from now fails without changing the file
+ *     powerLossAtWrite(n, written): the n-th write from now only stores the first written bytes. Then the power is
+ *         lost: all further writes fail until powerOn() is called. Reads still work, so that the state of the files
+ *         can be checked
+ *
+ * Files which are open when the adapter is destroyed become invalid.
+ */
+class MemoryFilesystemAdapter : public FilesystemAdapter {
+private:
+    struct File {
+        std::string fn;
+        std::shared_ptr<std::vector<char>> data;
+    };
+    std::vector<File> files;
+
+    MemoryFilesystemProfile profile;
+    MemoryFilesystemStats stats;
+
+    unsigned long failWriteCountdown = 0; //0: off
+    unsigned long powerLossCountdown = 0; //0: off
+    size_t powerLossWritten = 0;
+    bool poweredOff = false;
+
+#if AO_PERSISTENCE_THREADS
+    std::mutex mutex; //the persistence worker accesses the files concurrently
+#endif
+
+    std::vector<File>::iterator find(const char *fn);
+    void addLatency(unsigned long us);
+
+    class MemoryFileAdapter;
+    friend class MemoryFileAdapter;
+
+    size_t read(std::vector<char>& data, size_t pos, char *buf, size_t len);
+    size_t write(std::vector<char>& data, size_t pos, const char *buf, size_t len);
+public:
+    MemoryFilesystemAdapter(MemoryFilesystemProfile profile = MemoryFilesystemProfile());
+
+    int stat(const char *path, size_t *size) override;
+    std::unique_ptr<FileAdapter> open(const char *fn, const char *mode) override;
+    bool remove(const char *fn) override;
+    std::unique_ptr<MappedFile> map(const char *fn) override;
+
+    void failWrite(unsigned long n);
+    void powerLossAtWrite(unsigned long n, size_t written = 0);
+    void powerOn();
+    bool isPoweredOff();
+
+    MemoryFilesystemStats getStats();
+    void resetStats();
+    size_t getFilesCount();
+};
+
+}
+
+#endif
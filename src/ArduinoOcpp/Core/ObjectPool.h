@@ -0,0 +1,94 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_OBJECTPOOL_H
+#define AO_OBJECTPOOL_H
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+
+#ifndef AO_OPERATION_POOL_SIZE
+#define AO_OPERATION_POOL_SIZE 12 //operation cache (see OperationsQueue) plus the operations in progress
+#endif
+
+#ifndef AO_MESSAGE_POOL_SIZE
+#define AO_MESSAGE_POOL_SIZE 4 //per pooled OcppMessage subclass
+#endif
+
+namespace ArduinoOcpp {
+
+/*
+ * Fixed-capacity pool for objects which are created and destroyed over and over again, like the OcppOperations of
+ * the periodic messages. The slots are part of the static memory, so they don't fragment the heap. When all slots
+ * are taken or the object is larger than SlotSize, the pool falls back to the heap.
+ *
+ * The pool must have static storage duration: it relies on the zero-initialization of static objects, so it
+ * can be used before the dynamic initialization runs. Classes use it in their operator new / operator delete.
+ */
+template<size_t SlotSize, size_t Capacity>
+class ObjectPool {
+private:
+    union Slot {
+        Slot *next;
+        typename std::aligned_storage<SlotSize>::type storage;
+    };
+
+    Slot slots [Capacity > 0 ? Capacity : 1];
+    Slot *freeList;
+    size_t initialized; //slots [0, initialized) have been handed out at least once
+    size_t inUse;
+    size_t highWater;
+    size_t heapFallbacks;
+
+    bool owns(void *ptr) const {
+        return ptr >= (const void*) slots && ptr < (const void*) (slots + Capacity);
+    }
+public:
+    void *allocate(size_t size) {
+        Slot *slot = nullptr;
+        if (size <= sizeof(Slot)) {
+            if (freeList) {
+                slot = freeList;
+                freeList = freeList->next;
+            } else if (initialized < Capacity) {
+                slot = &slots[initialized++];
+            }
+        }
+
+        if (!slot) {
+            heapFallbacks++;
+            return ::operator new(size);
+        }
+
+        inUse++;
+        if (inUse > highWater) {
+            highWater = inUse;
+        }
+        return slot;
+    }
+
+    void deallocate(void *ptr) {
+        if (!ptr) {
+            return;
+        }
+        if (!owns(ptr)) {
+            ::operator delete(ptr);
+            return;
+        }
+        Slot *slot = static_cast<Slot*>(ptr);
+        slot->next = freeList;
+        freeList = slot;
+        inUse--;
+    }
+
+    size_t getCapacity() const {return Capacity;}
+    size_t getInUse() const {return inUse;}
+    size_t getHighWater() const {return highWater;}
+    size_t getHeapFallbacks() const {return heapFallbacks;}
+};
+
+}
+
+#endif
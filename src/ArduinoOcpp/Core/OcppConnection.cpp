@@ -8,11 +8,16 @@
 #include <ArduinoOcpp/SimpleOcppOperationFactory.h>
 #include <ArduinoOcpp/Core/OcppError.h>
 #include <ArduinoOcpp/Core/OperationStore.h>
+#include <ArduinoOcpp/Core/JsonCapacity.h>
+#include <ArduinoOcpp/Core/JsonReader.h>
+#include <ArduinoOcpp/Core/MemoryArena.h>
 
 #include <ArduinoOcpp/Debug.h>
 
 #define HEAP_GUARD 2000UL //will not accept JSON messages if it will result in less than HEAP_GUARD free bytes in heap
 
+#define ACTION_MAXSIZE 40 //actions with longer names are always deserialized into a JsonDocument
+
 size_t removePayload(const char *src, size_t src_size, char *dst, size_t dst_size);
 
 using namespace ArduinoOcpp;
@@ -103,12 +108,28 @@ bool OcppConnection::processOcppSocketInputTXT(const char* payload, size_t lengt
     
     bool deserializationSuccess = false;
 
-    auto doc = std::unique_ptr<DynamicJsonDocument>{nullptr};
-    size_t capacity = length + 100;
+    auto doc = std::unique_ptr<ArenaJsonDocument>{nullptr};
+
+    /*
+     * Pre-scan the input to allocate the document with the right size at once. Then the payload is only
+     * parsed one time. If the pre-scan fails, the input is malformed and the deserializer will report the error
+     */
+    size_t capacity = measureJsonCapacity(payload, length);
+    if (capacity == 0) {
+        capacity = length + 100;
+    } else if (handleReqMessageStreamed(payload, length)) {
+        //well-formed request which the message decoded directly from the input
+        return true;
+    }
+
+    //documents which fit into the arena don't take heap memory
+    MemoryArena *arena = getActiveArena();
 
     DeserializationError err = DeserializationError::NoMemory;
-    while (capacity + HEAP_GUARD < ao_avail_heap() && err == DeserializationError::NoMemory) {
-        doc = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(capacity));
+    while (((arena && capacity <= arena->getAvailable()) || capacity + HEAP_GUARD < ao_avail_heap())
+                && err == DeserializationError::NoMemory) {
+        doc.reset(); //give back the memory of the previous attempt first
+        doc = std::unique_ptr<ArenaJsonDocument>(new ArenaJsonDocument(capacity));
         err = deserializeJson(*doc, payload, length);
 
         capacity *= 3;
@@ -155,7 +176,8 @@ bool OcppConnection::processOcppSocketInputTXT(const char* payload, size_t lengt
                  * If the input type is MESSAGE_TYPE_CALLRESULT, it can be ignored. This controller will automatically resend the corresponding request message.
                  */
 
-                doc = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(200));
+                doc.reset();
+                doc = std::unique_ptr<ArenaJsonDocument>(new ArenaJsonDocument(200));
                 char onlyRpcHeader[200];
                 size_t onlyRpcHeader_len = removePayload(payload, length, onlyRpcHeader, sizeof(onlyRpcHeader));
                 DeserializationError err2 = deserializeJson(*doc, onlyRpcHeader, onlyRpcHeader_len);
@@ -178,27 +200,20 @@ bool OcppConnection::processOcppSocketInputTXT(const char* payload, size_t lengt
 }
 
 /**
- * call conf() on each element of the queue. Start with first element. On successful message delivery,
- * delete the element from the list. Try all the pending OCPP Operations until the right one is found.
+ * Look up the pending OCPP Operation with the messageID of the CALLRESULT and hand the message over to it. On
+ * successful processing, delete the operation from the queue.
  * 
  * This function could result in improper behavior in Charging Stations, because messages are not
  * guaranteed to be received and therefore processed in the right order.
  */
 void OcppConnection::handleConfMessage(JsonDocument& json) {
 
-    bool success = false;
-
-    initiatedOcppOperations.drop_if(
-        [&json, &success] (std::unique_ptr<OcppOperation>& operation) {
-            bool match = operation->receiveConf(json);
-            if (match) {
-                success = true;
-                //operation will be deleted by the surrounding drop_if
-            }
-            return match;
-        }); //executes in order and drops every operation where predicate(op) == true
+    const char *messageID = json[1] | "";
 
-    if (!success) {
+    auto operation = initiatedOcppOperations.find(messageID);
+    if (operation && operation->receiveConf(json)) {
+        initiatedOcppOperations.drop(operation);
+    } else {
         //didn't find matching OcppOperation
         AO_DBG_WARN("Received CALLRESULT doesn't match any pending operation");
         (void)0;
@@ -224,21 +239,54 @@ void OcppConnection::handleReqMessage(JsonDocument& json, std::unique_ptr<OcppOp
     receivedOcppOperations.push_back(std::move(op)); //enqueue so loop() plans conf sending
 }
 
-void OcppConnection::handleErrMessage(JsonDocument& json) {
+/*
+ * Requests are decoded without JsonDocument if the OcppMessage supports it (see OcppMessage::readReq). The payload
+ * then goes directly into the model objects of the message which saves the memory of the DOM. Returns false if
+ * the frame isn't a request or if the operation needs the JsonDocument. Then nothing has been executed yet.
+ */
+bool OcppConnection::handleReqMessageStreamed(const char *payload, size_t length) {
+    JsonReader reader {payload, length};
 
-    bool success = false;
+    int messageTypeId = -1;
+    if (!reader.beginArray() || !reader.nextElement() || !reader.readInt(messageTypeId) ||
+            messageTypeId != MESSAGE_TYPE_CALL) {
+        return false;
+    }
 
-    initiatedOcppOperations.drop_if(
-        [&json, &success] (std::unique_ptr<OcppOperation>& operation) {
-            bool match = operation->receiveError(json);
-            if (match) {
-                success = true;
-                //operation will be deleted by the surrounding drop_if
-            }
-            return match;
-        }); //executes in order and drops every operation where predicate(op) == true
+    std::string messageID;
+    char action [ACTION_MAXSIZE];
+    if (!reader.nextElement() || !reader.readString(messageID) ||
+            !reader.nextElement() || !reader.readString(action, sizeof(action)) ||
+            !reader.nextElement()) {
+        return false;
+    }
+
+    if (!isStreamableOperation(action)) {
+        return false;
+    }
+
+    auto op = makeOcppOperation(action);
+    if (!op) {
+        return false;
+    }
+
+    op->setOcppModel(baseModel);
+    if (!op->receiveReq(messageID.c_str(), reader)) {
+        return false;
+    }
+
+    receivedOcppOperations.push_back(std::move(op)); //enqueue so loop() plans conf sending
+    return true;
+}
+
+void OcppConnection::handleErrMessage(JsonDocument& json) {
+
+    const char *messageID = json[1] | "";
 
-    if (!success) {
+    auto operation = initiatedOcppOperations.find(messageID);
+    if (operation && operation->receiveError(json)) {
+        initiatedOcppOperations.drop(operation);
+    } else {
         //No OcppOperation was aborted because of the error message
         AO_DBG_WARN("Received CALLERROR did not abort a pending operation");
         (void)0;
@@ -29,6 +29,7 @@ private:
     void handleConfMessage(JsonDocument& json);
     void handleReqMessage(JsonDocument& json);
     void handleReqMessage(JsonDocument& json, std::unique_ptr<OcppOperation> op);
+    bool handleReqMessageStreamed(const char *payload, size_t length);
     void handleErrMessage(JsonDocument& json);
 public:
     OcppConnection(OcppSocket& oSock, std::shared_ptr<OcppModel> baseModel, std::shared_ptr<FilesystemAdapter> filesystem);
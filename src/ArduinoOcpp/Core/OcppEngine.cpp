@@ -6,18 +6,33 @@
 #include <ArduinoOcpp/Core/OcppOperation.h>
 #include <ArduinoOcpp/Core/OcppSocket.h>
 #include <ArduinoOcpp/Core/OcppModel.h>
+#include <ArduinoOcpp/Core/Configuration.h>
 
 using namespace ArduinoOcpp;
 
 OcppEngine *ArduinoOcpp::defaultOcppEngine = nullptr;
 
 OcppEngine::OcppEngine(OcppSocket& ocppSocket, const OcppClock& system_clock, std::shared_ptr<FilesystemAdapter> filesystem)
-        : oSock(ocppSocket), oModel{std::make_shared<OcppModel>(system_clock)}, oConn{oSock, oModel, filesystem} {
+        : arena(AO_ENGINE_ARENA_SIZE), persistence(AO_PERSISTENCE_ASYNC), oSock(ocppSocket), oModel{std::make_shared<OcppModel>(system_clock)}, oConn{oSock, oModel, filesystem} {
     defaultOcppEngine = this;
+    if (arena.getCapacity() > 0) {
+        setActiveArena(&arena);
+    }
+    setActivePersistenceExecutor(&persistence);
 }
 
 OcppEngine::~OcppEngine() {
     defaultOcppEngine = nullptr;
+
+    //pending completion callbacks may still refer to the stores
+    persistence.flush();
+    if (getActivePersistenceExecutor() == &persistence) {
+        setActivePersistenceExecutor(nullptr);
+    }
+
+    if (getActiveArena() == &arena) {
+        setActiveArena(nullptr);
+    }
 }
 
 void OcppEngine::loop() {
@@ -26,6 +41,13 @@ void OcppEngine::loop() {
 
     if (runOcppTasks)
         oModel->loop();
+
+    configuration_loop();
+
+    persistence.loop();
+
+    //all documents of this iteration are destroyed now
+    arena.reset();
 }
 
 void OcppEngine::initiateOperation(std::unique_ptr<OcppOperation> op) {
@@ -7,6 +7,8 @@
 
 #include <ArduinoOcpp/Core/OcppConnection.h>
 #include <ArduinoOcpp/Core/OcppTime.h>
+#include <ArduinoOcpp/Core/MemoryArena.h>
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
 #include <memory>
 
 namespace ArduinoOcpp {
@@ -17,6 +19,8 @@ class FilesystemAdapter;
 
 class OcppEngine {
 private:
+    MemoryArena arena; //per-iteration memory, see ArenaJsonDocument. Declared first to outlive the other members
+    PersistenceExecutor persistence; //filesystem writes of the stores
     OcppSocket& oSock;
     std::shared_ptr<OcppModel> oModel;
     OcppConnection oConn;
@@ -33,6 +37,9 @@ public:
     void initiateOperation(std::unique_ptr<OcppOperation> op);
 
     OcppModel& getOcppModel();
+
+    MemoryArena& getArena() {return arena;}
+    PersistenceExecutor& getPersistenceExecutor() {return persistence;}
 };
 
 extern OcppEngine *defaultOcppEngine;
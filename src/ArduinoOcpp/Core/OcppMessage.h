@@ -28,10 +28,13 @@ std::unique_ptr<DynamicJsonDocument> createEmptyDocument();
 class OcppModel;
 class TransactionRPC;
 class StoredOperationHandler;
+class JsonWriter;
+class JsonReader;
 
 class OcppMessage {
 private:
     bool ocppModelInitialized = false;
+    uint16_t reqRevision = 0;
 protected:
     std::shared_ptr<OcppModel> ocppModel;
 public:
@@ -58,6 +61,35 @@ public:
      */
     virtual std::unique_ptr<DynamicJsonDocument> createReq();
 
+    /**
+     * Streaming alternative to createReq(): writes the payload object of the request directly into the output of the writer,
+     * without building a JsonDocument. It is called twice per request, first for measuring the output and then for writing it, so
+     * both calls must produce the same output. If the payload cannot be created at the moment, call payload.setError().
+     * 
+     * Returns false if the message doesn't implement it. Then the engine falls back to createReq()
+     */
+    virtual bool writeReq(JsonWriter& payload) {return false;}
+
+    /**
+     * The request is created and serialized only once; retries resend the same frame. This requires the request payload to be
+     * immutable after initiate(). If the payload of a message changes nevertheless, it must call invalidateReq() so that the next
+     * attempt creates the request again (see AO_DEACTIVATE_REQ_CACHE)
+     */
+    void invalidateReq() {reqRevision++;}
+    uint16_t getReqRevision() {return reqRevision;}
+
+    /**
+     * Appends the payload of a later, not yet sent request of the same type to this request, so that both are sent in one
+     * frame. The request payload must not exceed maxSize bytes after merging. Returns false if the messages can't be merged;
+     * then both messages remain unchanged. On success, other can be discarded
+     */
+    virtual bool merge(OcppMessage& other, size_t maxSize) {return false;}
+
+    /**
+     * Returns true if the request belongs to a transaction with transactionId, like MeterValues during a transaction.
+     * These requests must reach the server in chronological order with StartTransaction and StopTransaction
+     */
+    virtual bool isTransactionRelated() {return false;}
 
     virtual void processConf(JsonObject payload);
     
@@ -71,12 +103,30 @@ public:
      */
     virtual void processReq(JsonObject payload);
 
+    /**
+     * Streaming alternative to processReq(): reads the request payload directly from the input, without building a
+     * JsonDocument first. The message declares field handlers for the payload object (see JsonReader::readObject) and
+     * fills its model objects directly. Format violations should be reported via getErrorCode().
+     * 
+     * Returns false if the message doesn't implement it. Then the reader must remain untouched and the engine falls back
+     * to processReq()
+     */
+    virtual bool readReq(JsonReader& payload) {return false;}
+
     /**
      * After successfully processing a request sent by the communication counterpart, this function creates the payload for a confirmation
      * message.
      */
     virtual std::unique_ptr<DynamicJsonDocument> createConf();
 
+    /**
+     * Streaming alternative to createConf(), see writeReq(). It is called twice, for measuring and for writing the output.
+     * It's only used if getErrorCode() returns nullptr and no OnSendConf listener needs the payload as JsonObject.
+     * 
+     * Returns false if the message doesn't implement it. Then the engine falls back to createConf()
+     */
+    virtual bool writeConf(JsonWriter& payload) {return false;}
+
     virtual const char *getErrorCode() {return nullptr;} //nullptr means no error
     virtual const char *getErrorDescription() {return "";}
     virtual std::unique_ptr<DynamicJsonDocument> getErrorDetails() {return createEmptyDocument();}
@@ -8,6 +8,10 @@
 #include <ArduinoOcpp/Core/OcppSocket.h>
 #include <ArduinoOcpp/Tasks/Transactions/Transaction.h>
 #include <ArduinoOcpp/Core/OperationStore.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
+#include <ArduinoOcpp/Core/MemoryArena.h>
+#include <ArduinoOcpp/Core/ObjectPool.h>
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
 
 #include <ArduinoOcpp/MessagesV16/StartTransaction.h>
 #include <ArduinoOcpp/MessagesV16/StopTransaction.h>
@@ -19,6 +23,49 @@ int unique_id_counter = 1000000;
 
 using namespace ArduinoOcpp;
 
+static ObjectPool<sizeof(OcppOperation), AO_OPERATION_POOL_SIZE> operationPool;
+
+namespace ArduinoOcpp {
+namespace OcppOperationUtils {
+
+//calls both listeners in order. A functor instead of a generic lambda, so that it compiles as C++11
+template <class Listener>
+struct ChainedListeners {
+    Listener first;
+    Listener second;
+
+    template <class... Args>
+    void operator()(Args... args) const {
+        first(args...);
+        second(args...);
+    }
+};
+
+//empty listeners are skipped
+template <class Listener>
+Listener chainListeners(Listener first, Listener second) {
+    if (!first) {
+        return second;
+    }
+    if (!second) {
+        return first;
+    }
+    return ChainedListeners<Listener> {first, second};
+}
+
+} //end namespace OcppOperationUtils
+} //end namespace ArduinoOcpp
+
+using namespace ArduinoOcpp::OcppOperationUtils;
+
+void *OcppOperation::operator new(size_t size) {
+    return operationPool.allocate(size);
+}
+
+void OcppOperation::operator delete(void *ptr) {
+    operationPool.deallocate(ptr);
+}
+
 OcppOperation::OcppOperation(std::unique_ptr<OcppMessage> msg) : ocppMessage(std::move(msg)) {
 
 }
@@ -53,11 +100,16 @@ void OcppOperation::setTimeout(std::unique_ptr<Timeout> to){
         return;
     }
     timeout = std::move(to);
-    timeout->setOnTimeoutListener(onTimeoutListener);
-    timeout->setOnAbortListener(onAbortListener);
+    if (listeners) {
+        timeout->setOnTimeoutListener(listeners->onTimeout);
+        timeout->setOnAbortListener(listeners->onAbort);
+    }
 }
 
 Timeout *OcppOperation::getTimeout() {
+    if (!timeout) {
+        timeout = std::unique_ptr<Timeout>(new OfflineSensitiveTimeout(40000));
+    }
     return timeout.get();
 }
 
@@ -68,14 +120,18 @@ void OcppOperation::setMessageID(const std::string &id){
     messageID = id;
 }
 
-const std::string *OcppOperation::getMessageID() {
+const char *OcppOperation::getMessageID() {
     if (messageID.empty()) {
         char id_str [16] = {'\0'};
         sprintf(id_str, "%d", unique_id_counter++);
         messageID = std::string {id_str};
         //messageID = std::to_string(unique_id_counter++);
     }
-    return &messageID;
+    return messageID.c_str();
+}
+
+const char *OcppOperation::getOcppOperationType() {
+    return ocppMessage ? ocppMessage->getOcppOperationType() : "";
 }
 
 bool OcppOperation::sendReq(OcppSocket& ocppSocket){
@@ -85,12 +141,34 @@ bool OcppOperation::sendReq(OcppSocket& ocppSocket){
      * 
      * if timeout, print out error message and treat this operation as completed (-> return true)
      */
-    if (timeout->isExceeded()) {
+    if (getTimeout()->isExceeded()) {
         //cancel this operation
         AO_DBG_INFO("%s has timed out! Discard operation", ocppMessage->getOcppOperationType());
         return true;
     }
 
+    if (!persistence_isDurable(persistTicket)) {
+        //the counterpart must not see this message before it is stored on flash
+        return false;
+    }
+
+    if (opStore && opStore->isWriteFailed()) {
+        if (persistRetries < AO_OPERATION_PERSIST_RETRIES) {
+            //hold the message back and write it again
+            persistRetries++;
+            opStore->recommit();
+            persistTicket = persistence_ticket();
+            return false;
+        } else if (persistRetries == AO_OPERATION_PERSIST_RETRIES) {
+            persistRetries++;
+            AO_DBG_ERR("could not store %s. Send it anyway", ocppMessage->getOcppOperationType());
+        }
+    }
+
+    if (opStore) {
+        opStore->releaseRecord(); //the stored request won't be written again
+    }
+
     /*
      * retry behaviour
      * 
@@ -105,46 +183,33 @@ bool OcppOperation::sendReq(OcppSocket& ocppSocket){
         retry_interval_mult *= 2;
 
     /*
-     * Create the OCPP message
+     * Create the OCPP message, or reuse the frame of the previous attempt if the request is still valid
      */
-    auto requestPayload = ocppMessage->createReq();
-    if (!requestPayload) {
-        return false;
+    if (reqFrame.empty() || reqFrameRevision != ocppMessage->getReqRevision()) {
+        if (!createReqFrame()) {
+            return false;
+        }
     }
 
     /*
-     * Create OCPP-J Remote Procedure Call header
-     */
-    size_t json_buffsize = JSON_ARRAY_SIZE(4) + (getMessageID()->length() + 1) + requestPayload->capacity();
-    DynamicJsonDocument requestJson(json_buffsize);
-
-    requestJson.add(MESSAGE_TYPE_CALL);                    //MessageType
-    requestJson.add(*getMessageID());                      //Unique message ID
-    requestJson.add(ocppMessage->getOcppOperationType());  //Action
-    requestJson.add(*requestPayload);                      //Payload
-
-    /*
-     * Serialize and send. Destroy serialization and JSON object. 
+     * Send the frame
      * 
      * If sending was successful, start timer
      * 
      * Return that this function must be called again (-> false)
      */
-    std::string out {};
-    serializeJson(requestJson, out);
-
     if (printReqCounter > 5000) {
         printReqCounter = 0;
-        AO_DBG_DEBUG("Try to send request: %s", out.c_str());
+        AO_DBG_DEBUG("Try to send request: %s", reqFrame.c_str());
     }
     printReqCounter++;
     
-    bool success = ocppSocket.sendTXT(out);
+    bool success = ocppSocket.sendTXT(reqFrame.c_str(), reqFrame.length());
 
-    timeout->tick(success);
+    getTimeout()->tick(success);
 
     if (success) {
-        AO_DBG_TRAFFIC_OUT(out.c_str());
+        AO_DBG_TRAFFIC_OUT(reqFrame.c_str());
         retry_start = ao_tick_ms();
     } else {
         //ocppSocket is not able to put any data on TCP stack. Maybe because we're offline
@@ -152,14 +217,97 @@ bool OcppOperation::sendReq(OcppSocket& ocppSocket){
         retry_interval_mult = 1;
     }
 
+#ifdef AO_DEACTIVATE_REQ_CACHE
+    std::string().swap(reqFrame); //create the request again on the next attempt and release memory in the meantime
+#endif
+
     return false;
 }
 
+bool OcppOperation::createReqFrame() {
+
+    /*
+     * Try to stream the frame into the buffer directly. Measure the output first, then write it into the buffer
+     */
+    JsonWriter measure {nullptr, 0};
+    if (writeReqFrame(measure)) {
+        if (!measure.isValid()) {
+            return false; //payload not ready yet
+        }
+
+        reqFrame.resize(measure.getRequiredSize());
+        JsonWriter writer {&reqFrame[0], reqFrame.length()};
+        writeReqFrame(writer);
+
+        if (!writer.isValid() || writer.getLength() != measure.getLength()) {
+            AO_DBG_ERR("%s: payload changed during serialization", ocppMessage->getOcppOperationType());
+            reqFrame.clear();
+            return false;
+        }
+
+        reqFrame.resize(writer.getLength());
+        reqFrameRevision = ocppMessage->getReqRevision();
+        return !reqFrame.empty();
+    }
+
+    /*
+     * Message doesn't support streaming. Create the payload as JsonDocument
+     */
+    auto requestPayload = ocppMessage->createReq();
+    if (!requestPayload) {
+        return false;
+    }
+
+    /*
+     * Create OCPP-J Remote Procedure Call header
+     */
+    size_t json_buffsize = JSON_ARRAY_SIZE(4) + (strlen(getMessageID()) + 1) + requestPayload->capacity();
+    ArenaJsonDocument requestJson(json_buffsize);
+
+    requestJson.add(MESSAGE_TYPE_CALL);                    //MessageType
+    requestJson.add(messageID);                            //Unique message ID
+    requestJson.add(ocppMessage->getOcppOperationType());  //Action
+    requestJson.add(*requestPayload);                      //Payload
+
+    /*
+     * Serialize. Destroy JSON objects. Keep serialization for retries
+     */
+    reqFrame.clear();
+    serializeJson(requestJson, reqFrame);
+
+    reqFrameRevision = ocppMessage->getReqRevision();
+    return !reqFrame.empty();
+}
+
+bool OcppOperation::writeConfFrame(JsonWriter& out) {
+    out.beginArray();
+    out.value(MESSAGE_TYPE_CALLRESULT);              //MessageType
+    out.value(messageID.c_str());                    //Unique message ID
+    if (!ocppMessage->writeConf(out)) {              //Payload
+        return false;
+    }
+    out.endArray();
+    return true;
+}
+
+bool OcppOperation::writeReqFrame(JsonWriter& out) {
+    out.beginArray();
+    out.value(MESSAGE_TYPE_CALL);                    //MessageType
+    out.value(getMessageID());                       //Unique message ID
+    out.value(ocppMessage->getOcppOperationType());  //Action
+    if (!ocppMessage->writeReq(out)) {               //Payload
+        return false;
+    }
+    out.endArray();
+    return true;
+}
+
 bool OcppOperation::receiveConf(JsonDocument& confJson){
     /*
      * check if messageIDs match. If yes, continue with this function. If not, return false for message not consumed
      */
-    if (*getMessageID() != confJson[1].as<std::string>()){
+    const char *confMessageID = confJson[1] | "";
+    if (strcmp(getMessageID(), confMessageID)) {
         return false;
     }
 
@@ -172,7 +320,9 @@ bool OcppOperation::receiveConf(JsonDocument& confJson){
     /*
      * Hand the payload over to the onReceiveConf Callback
      */
-    onReceiveConfListener(payload);
+    if (listeners && listeners->onReceiveConf) {
+        listeners->onReceiveConf(payload);
+    }
 
     /*
      * return true as this message has been consumed
@@ -184,7 +334,8 @@ bool OcppOperation::receiveError(JsonDocument& confJson){
     /*
      * check if messageIDs match. If yes, continue with this function. If not, return false for message not consumed
      */
-    if (*getMessageID() != confJson[1].as<std::string>()){
+    const char *confMessageID = confJson[1] | "";
+    if (strcmp(getMessageID(), confMessageID)) {
         return false;
     }
 
@@ -197,11 +348,15 @@ bool OcppOperation::receiveError(JsonDocument& confJson){
     bool abortOperation = ocppMessage->processErr(errorCode, errorDescription, errorDetails);
 
     if (abortOperation) {
-        onReceiveErrorListener(errorCode, errorDescription, errorDetails);
-        onAbortListener();
+        if (listeners && listeners->onReceiveError) {
+            listeners->onReceiveError(errorCode, errorDescription, errorDetails);
+        }
+        if (listeners && listeners->onAbort) {
+            listeners->onAbort();
+        }
     } else {
         //restart operation
-        timeout->restart();
+        getTimeout()->restart();
         retry_start = 0;
         retry_interval_mult = 1;
     }
@@ -226,13 +381,34 @@ bool OcppOperation::receiveReq(JsonDocument& reqJson){
     /*
      * Hand the payload over to the first Callback. It is a callback that notifies the client that request has been processed in the OCPP-library
      */
-    onReceiveReqListener(payload);
+    if (listeners && listeners->onReceiveReq) {
+        listeners->onReceiveReq(payload);
+    }
 
     reqExecuted = true; //ensure that the conf is only sent after the req has been executed
 
     return true; //true because everything was successful. If there will be an error check in future, this value becomes more reasonable
 }
 
+bool OcppOperation::receiveReq(const char *messageID, JsonReader& payload) {
+
+    if (listeners && listeners->onReceiveReq) {
+        //listener needs the payload as JsonObject
+        return false;
+    }
+
+    if (!ocppMessage->readReq(payload)) {
+        //message doesn't implement streamed input
+        return false;
+    }
+
+    setMessageID(messageID);
+
+    reqExecuted = true; //ensure that the conf is only sent after the req has been executed
+
+    return true;
+}
+
 bool OcppOperation::sendConf(OcppSocket& ocppSocket){
 
     if (!reqExecuted) {
@@ -240,10 +416,47 @@ bool OcppOperation::sendConf(OcppSocket& ocppSocket){
         return false;
     }
 
+    /*
+     * Try to stream the confirmation into the output buffer directly. Measure the output first, then write it
+     */
+    if (!ocppMessage->getErrorCode() && !(listeners && listeners->onSendConf)) {
+        JsonWriter measure {nullptr, 0};
+        if (writeConfFrame(measure)) {
+            if (!measure.isValid()) {
+                return false; //confirmation message still pending
+            }
+
+            ArenaAllocator allocator;
+            size_t len = measure.getRequiredSize();
+            char *out = static_cast<char*>(allocator.allocate(len + 1));
+            if (!out) {
+                AO_DBG_ERR("OOM");
+                return false;
+            }
+
+            JsonWriter writer {out, len};
+            writeConfFrame(writer);
+
+            bool wsSuccess = false;
+            if (writer.isValid() && writer.getLength() == measure.getLength()) {
+                out[writer.getLength()] = '\0';
+                wsSuccess = ocppSocket.sendTXT(out, writer.getLength());
+                if (wsSuccess) {
+                    AO_DBG_TRAFFIC_OUT(out);
+                }
+            } else {
+                AO_DBG_ERR("%s: payload changed during serialization", ocppMessage->getOcppOperationType());
+            }
+
+            allocator.deallocate(out);
+            return wsSuccess;
+        }
+    }
+
     /*
      * Create the OCPP message
      */
-    std::unique_ptr<DynamicJsonDocument> confJson = nullptr;
+    std::unique_ptr<ArenaJsonDocument> confJson = nullptr;
     std::unique_ptr<DynamicJsonDocument> confPayload = ocppMessage->createConf();
     std::unique_ptr<DynamicJsonDocument> errorDetails = nullptr;
     
@@ -258,11 +471,11 @@ bool OcppOperation::sendConf(OcppSocket& ocppSocket){
         /*
          * Create OCPP-J Remote Procedure Call header
          */
-        size_t json_buffsize = JSON_ARRAY_SIZE(3) + (getMessageID()->length() + 1) + confPayload->capacity();
-        confJson = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(json_buffsize));
+        size_t json_buffsize = JSON_ARRAY_SIZE(3) + (strlen(getMessageID()) + 1) + confPayload->capacity();
+        confJson = std::unique_ptr<ArenaJsonDocument>(new ArenaJsonDocument(json_buffsize));
 
         confJson->add(MESSAGE_TYPE_CALLRESULT);   //MessageType
-        confJson->add(*getMessageID());            //Unique message ID
+        confJson->add(messageID);                  //Unique message ID
         confJson->add(*confPayload);              //Payload
     } else {
         //operation failure. Send error message instead
@@ -280,36 +493,47 @@ bool OcppOperation::sendConf(OcppSocket& ocppSocket){
          * Create OCPP-J Remote Procedure Call header
          */
         size_t json_buffsize = JSON_ARRAY_SIZE(5)
-                    + (getMessageID()->length() + 1)
+                    + (strlen(getMessageID()) + 1)
                     + strlen(errorCode) + 1
                     + strlen(errorDescription) + 1
                     + errorDetails->capacity();
-        confJson = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(json_buffsize));
+        confJson = std::unique_ptr<ArenaJsonDocument>(new ArenaJsonDocument(json_buffsize));
 
         confJson->add(MESSAGE_TYPE_CALLERROR);   //MessageType
-        confJson->add(*getMessageID());            //Unique message ID
+        confJson->add(messageID);                  //Unique message ID
         confJson->add(errorCode);
         confJson->add(errorDescription);
         confJson->add(*errorDetails);              //Error description
     }
 
     /*
-     * Serialize and send. Destroy serialization and JSON object. 
+     * Serialize into the arena and send. Destroy serialization and JSON object. 
      */
-    std::string out {};
-    serializeJson(*confJson, out);
-    bool wsSuccess = ocppSocket.sendTXT(out);
+    ArenaAllocator allocator;
+    size_t len = measureJson(*confJson);
+    char *out = static_cast<char*>(allocator.allocate(len + 1));
+    if (!out) {
+        AO_DBG_ERR("OOM");
+        return false;
+    }
+    serializeJson(*confJson, out, len + 1);
+    bool wsSuccess = ocppSocket.sendTXT(out, len);
 
     if (wsSuccess) {
         if (!operationFailure) {
-            AO_DBG_TRAFFIC_OUT(out.c_str());
-            onSendConfListener(confPayload->as<JsonObject>());
+            AO_DBG_TRAFFIC_OUT(out);
+            if (listeners && listeners->onSendConf) {
+                listeners->onSendConf(confPayload->as<JsonObject>());
+            }
         } else {
-            AO_DBG_WARN("Operation failed. JSON CallError message: %s", out.c_str());
-            onAbortListener();
+            AO_DBG_WARN("Operation failed. JSON CallError message: %s", out);
+            if (listeners && listeners->onAbort) {
+                listeners->onAbort();
+            }
         }
     }
 
+    allocator.deallocate(out);
     return wsSuccess;
 }
 
@@ -321,11 +545,11 @@ void OcppOperation::initiate(std::unique_ptr<StoredOperationHandler> opStorage)
          */
         if (opStorage) {
             opStore = std::move(opStorage);
-            size_t json_buffsize = JSON_ARRAY_SIZE(3) + (getMessageID()->length() + 1);
+            size_t json_buffsize = JSON_ARRAY_SIZE(3) + (strlen(getMessageID()) + 1);
             auto rpcData = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(json_buffsize));
 
             rpcData->add(MESSAGE_TYPE_CALL);                    //MessageType
-            rpcData->add(*getMessageID());                      //Unique message ID
+            rpcData->add(messageID);                            //Unique message ID
             rpcData->add(ocppMessage->getOcppOperationType());  //Action
 
             opStore->setRpc(std::move(rpcData));
@@ -340,6 +564,8 @@ void OcppOperation::initiate(std::unique_ptr<StoredOperationHandler> opStorage)
         if (!inited) { //legacy support
             ocppMessage->initiate();
         }
+
+        persistTicket = persistence_ticket();
     } else {
         AO_DBG_ERR("Missing ocppMessage instance");
     }
@@ -406,9 +632,66 @@ bool OcppOperation::restore(std::unique_ptr<StoredOperationHandler> opStorage, s
     return success;
 }
 
+bool OcppOperation::merge(OcppOperation& other, size_t maxSize) {
+    if (!ocppMessage || !other.ocppMessage ||
+            !reqFrame.empty() || !other.reqFrame.empty()) { //already sent
+        return false;
+    }
+
+    if ((opStore && opStore->getOpNr() >= 0) || (other.opStore && other.opStore->getOpNr() >= 0)) {
+        //stored operations must be sent as they are
+        return false;
+    }
+
+    if (strcmp(ocppMessage->getOcppOperationType(), other.ocppMessage->getOcppOperationType())) {
+        return false;
+    }
+
+    if (!ocppMessage->merge(*other.ocppMessage, maxSize)) {
+        return false;
+    }
+
+    //the confirmation of this operation now also answers other, so its listeners are called as well
+    if (other.listeners && other.listeners != listeners) {
+        if (!listeners) {
+            listeners = other.listeners;
+        } else {
+            auto first = listeners;
+            auto& merged = editListeners();
+            merged.onReceiveConf = chainListeners(first->onReceiveConf, other.listeners->onReceiveConf);
+            merged.onReceiveReq = chainListeners(first->onReceiveReq, other.listeners->onReceiveReq);
+            merged.onSendConf = chainListeners(first->onSendConf, other.listeners->onSendConf);
+            merged.onTimeout = chainListeners(first->onTimeout, other.listeners->onTimeout);
+            merged.onReceiveError = chainListeners(first->onReceiveError, other.listeners->onReceiveError);
+            merged.onAbort = chainListeners(first->onAbort, other.listeners->onAbort);
+        }
+
+        if (timeout) {
+            timeout->setOnTimeoutListener(listeners->onTimeout);
+            timeout->setOnAbortListener(listeners->onAbort);
+        }
+    }
+
+    return true;
+}
+
+bool OcppOperation::isTransactionRelated() {
+    return ocppMessage && ocppMessage->isTransactionRelated();
+}
+
+OcppOperationListeners& OcppOperation::editListeners() {
+    if (!listeners) {
+        listeners = std::make_shared<OcppOperationListeners>();
+    } else if (listeners.use_count() > 1) {
+        //shared with other operations. Don't change their listeners
+        listeners = std::make_shared<OcppOperationListeners>(*listeners);
+    }
+    return *listeners;
+}
+
 void OcppOperation::setOnReceiveConfListener(OnReceiveConfListener onReceiveConf){
     if (onReceiveConf)
-        onReceiveConfListener = onReceiveConf;
+        editListeners().onReceiveConf = onReceiveConf;
 }
 
 /**
@@ -416,27 +699,31 @@ void OcppOperation::setOnReceiveConfListener(OnReceiveConfListener onReceiveConf
  */
 void OcppOperation::setOnReceiveReqListener(OnReceiveReqListener onReceiveReq){
     if (onReceiveReq)
-        onReceiveReqListener = onReceiveReq;
+        editListeners().onReceiveReq = onReceiveReq;
 }
 
 void OcppOperation::setOnSendConfListener(OnSendConfListener onSendConf){
     if (onSendConf)
-        onSendConfListener = onSendConf;
+        editListeners().onSendConf = onSendConf;
 }
 
 void OcppOperation::setOnTimeoutListener(OnTimeoutListener onTimeout) {
     if (onTimeout)
-        onTimeoutListener = onTimeout;
+        editListeners().onTimeout = onTimeout;
 }
 
 void OcppOperation::setOnReceiveErrorListener(OnReceiveErrorListener onReceiveError) {
     if (onReceiveError)
-        onReceiveErrorListener = onReceiveError;
+        editListeners().onReceiveError = onReceiveError;
 }
 
 void OcppOperation::setOnAbortListener(OnAbortListener onAbort) {
     if (onAbort)
-        onAbortListener = onAbort;
+        editListeners().onAbort = onAbort;
+}
+
+void OcppOperation::setListeners(std::shared_ptr<OcppOperationListeners> listeners) {
+    this->listeners = listeners;
 }
 
 bool OcppOperation::isFullyConfigured(){
@@ -9,7 +9,13 @@
 #define MESSAGE_TYPE_CALLRESULT 3
 #define MESSAGE_TYPE_CALLERROR 4
 
+#ifndef AO_OPERATION_PERSIST_RETRIES
+#define AO_OPERATION_PERSIST_RETRIES 2 //a stored request whose write failed is written again this often. Then it is sent anyway
+#endif
+
 #include <memory>
+#include <string>
+#include <stdint.h>
 
 #include <ArduinoOcpp/Core/OcppOperationCallbacks.h>
 
@@ -19,31 +25,37 @@ class OcppMessage;
 class OcppModel;
 class OcppSocket;
 class StoredOperationHandler;
+class JsonWriter;
+class JsonReader;
 
 class OcppOperation {
 private:
     std::string messageID {};
     std::unique_ptr<OcppMessage> ocppMessage;
-    const std::string *getMessageID();
     void setMessageID(const std::string &id);
-    OnReceiveConfListener onReceiveConfListener = [] (JsonObject payload) {};
-    OnReceiveReqListener onReceiveReqListener = [] (JsonObject payload) {};
-    OnSendConfListener onSendConfListener = [] (JsonObject payload) {};
-    OnTimeoutListener onTimeoutListener = [] () {};
-    OnReceiveErrorListener onReceiveErrorListener = [] (const char *code, const char *description, JsonObject details) {};
-    OnAbortListener onAbortListener = [] () {};
-    bool reqExecuted = false;
+    std::shared_ptr<OcppOperationListeners> listeners; //nullptr if no listener is set
+    OcppOperationListeners& editListeners(); //creates the bundle or detaches it from other operations
 
-    std::unique_ptr<Timeout> timeout{new OfflineSensitiveTimeout(40000)};
+    std::unique_ptr<Timeout> timeout; //created on first use if not set before (OfflineSensitiveTimeout with 40s)
 
-    const unsigned long RETRY_INTERVAL = 3000; //in ms; first retry after ... ms; second retry after 2 * ... ms; third after 4 ...
-    const unsigned long RETRY_INTERVAL_MAX = 20000; //in ms; 
+    static const unsigned long RETRY_INTERVAL = 3000; //in ms; first retry after ... ms; second retry after 2 * ... ms; third after 4 ...
+    static const unsigned long RETRY_INTERVAL_MAX = 20000; //in ms; 
     unsigned long retry_start = 0;
-    unsigned long retry_interval_mult = 1; // RETRY_INTERVAL * retry_interval_mult gives longer periods with each iteration
+    uint16_t retry_interval_mult = 1; // RETRY_INTERVAL * retry_interval_mult gives longer periods with each iteration
 
     uint16_t printReqCounter = 0;
 
+    uint16_t reqFrameRevision = 0;
+    bool reqExecuted = false;
+
+    std::string reqFrame; //serialized request which is resent on retries. Empty if not created yet
+    bool createReqFrame();
+    bool writeReqFrame(JsonWriter& out);
+    bool writeConfFrame(JsonWriter& out);
+
     std::unique_ptr<StoredOperationHandler> opStore;
+    uint32_t persistTicket = 0; //the request isn't sent before the records written during initiate() are durable
+    unsigned int persistRetries = 0; //failed writes of the stored request which have been repeated
 public:
 
     OcppOperation(std::unique_ptr<OcppMessage> msg);
@@ -52,13 +64,23 @@ public:
 
     ~OcppOperation();
 
+    /*
+     * Operations are allocated from a fixed-capacity pool (see AO_OPERATION_POOL_SIZE)
+     */
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr);
+
     void setOcppMessage(std::unique_ptr<OcppMessage> msg);
 
     void setOcppModel(std::shared_ptr<OcppModel> oModel);
 
     void setTimeout(std::unique_ptr<Timeout> timeout);
 
-    Timeout *getTimeout();
+    Timeout *getTimeout(); //creates the default timeout if not set
+
+    const char *getMessageID(); //assigns a new unique messageID if this operation doesn't have one yet
+
+    const char *getOcppOperationType(); //action of the OcppMessage or empty string if not set
 
     /**
      * Sends the message(s) that belong to the OCPP Operation. This function puts a JSON message on the lower protocol layer.
@@ -94,6 +116,15 @@ public:
      */
     bool receiveReq(JsonDocument& json);
 
+    /**
+     * Processes the request payload directly from the input stream, without deserializing it into a JsonDocument.
+     * 
+     * Returns false if this operation cannot process streamed input, i.e. the OcppMessage doesn't implement readReq()
+     * or a ReceiveReq listener expects the payload as JsonObject. Then the reader is untouched and the caller needs to
+     * fall back to receiveReq(JsonDocument&)
+     */
+    bool receiveReq(const char *messageID, JsonReader& payload);
+
     /**
      * After processing a request sent by the communication counterpart, this function sends a confirmation
      * message. Returns true on success, false otherwise. Returns also true if a CallError has successfully
@@ -105,6 +136,15 @@ public:
 
     bool restore(std::unique_ptr<StoredOperationHandler> opStorage, std::shared_ptr<OcppModel> oModel);
 
+    /**
+     * Merges the request of other into the request of this operation (see OcppMessage::merge). Only possible if neither
+     * operation has been sent or stored on flash yet. Returns true on success; then other can be discarded. The
+     * listeners of other are called together with the listeners of this operation
+     */
+    bool merge(OcppOperation& other, size_t maxSize);
+
+    bool isTransactionRelated(); //see OcppMessage::isTransactionRelated()
+
     StoredOperationHandler *getStorageHandler() {return opStore.get();}
 
     void setOnReceiveConfListener(OnReceiveConfListener onReceiveConf);
@@ -133,6 +173,12 @@ public:
      */
     void setOnAbortListener(OnAbortListener onAbort);
 
+    /**
+     * Replaces all listeners by the bundle. Operations with the same callbacks can share one bundle. Setting
+     * single listeners afterwards only affects this operation
+     */
+    void setListeners(std::shared_ptr<OcppOperationListeners> listeners);
+
     bool isFullyConfigured();
 
     void rebaseMsgId(int msgIdCounter); //workaround; remove when random UUID msg IDs are introduced
@@ -19,6 +19,18 @@ using OnSendConfListener = std::function<void(JsonObject payload)>;
 using OnReceiveErrorListener = std::function<void(const char *code, const char *description, JsonObject details)>; //will be called if OCPP communication partner returns error code
 //using OnAbortListener = std::function<void()>; //will be called whenever the engine will stop trying to execute the operation normallythere is a timeout or error (onAbort = onTimeout || onReceiveError)
 
+/*
+ * Listeners of an OcppOperation. Most operations don't have any listener, so they are bundled and only allocated
+ * when the first one is set. Operations with the same callbacks can share one bundle. Unset listeners are empty
+ */
+struct OcppOperationListeners {
+    OnReceiveConfListener onReceiveConf;
+    OnReceiveReqListener onReceiveReq;
+    OnSendConfListener onSendConf;
+    OnTimeoutListener onTimeout;
+    OnReceiveErrorListener onReceiveError;
+    OnAbortListener onAbort;
+};
 
 } //end namespace ArduinoOcpp
 #endif
@@ -24,6 +24,10 @@ bool OcppClientSocket::sendTXT(std::string &out) {
     return wsock->sendTXT(out.c_str(), out.length());
 }
 
+bool OcppClientSocket::sendTXT(const char *out, size_t length) {
+    return wsock->sendTXT(out, length);
+}
+
 void OcppClientSocket::setReceiveTXTcallback(ReceiveTXTcallback &callback) {
     wsock->onEvent([callback](WStype_t type, uint8_t * payload, size_t length) {
         switch (type) {
@@ -22,6 +22,15 @@ public:
 
     virtual bool sendTXT(std::string &out) = 0;
 
+    /*
+     * Sends the text frame in the buffer out with the given length. The default implementation copies the buffer into a
+     * std::string. Sockets which can send from a buffer directly should override this
+     */
+    virtual bool sendTXT(const char *out, size_t length) {
+        std::string outStr {out, length};
+        return sendTXT(outStr);
+    }
+
     virtual void setReceiveTXTcallback(ReceiveTXTcallback &receiveTXT) = 0; //ReceiveTXTcallback is defined in OcppServer.h
 };
 
@@ -33,11 +42,14 @@ private:
 public:
     void loop() override { }
     bool sendTXT(std::string &out) override {
+        return sendTXT(out.c_str(), out.length());
+    }
+    bool sendTXT(const char *out, size_t length) override {
         if (!connected) {
             return true;
         }
         if (receiveTXT) {
-            return receiveTXT(out.c_str(), out.length());
+            return receiveTXT(out, length);
         } else {
             return false;
         }
@@ -69,6 +81,7 @@ public:
     void loop();
 
     bool sendTXT(std::string &out);
+    bool sendTXT(const char *out, size_t length) override;
 
     void setReceiveTXTcallback(ReceiveTXTcallback &receiveTXT);
 };
@@ -0,0 +1,555 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/OperationLog.h>
+#include <ArduinoOcpp/Core/OperationStore.h>
+#include <ArduinoOcpp/Core/FilesystemAdapter.h>
+#include <ArduinoOcpp/Core/MemoryArena.h>
+#include <ArduinoOcpp/Core/RecordCodec.h>
+#include <ArduinoOcpp/Core/Crc32.h>
+#include <ArduinoOcpp/Core/LittleEndian.h>
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
+#include <ArduinoOcpp/Debug.h>
+
+#include <string.h>
+#include <algorithm>
+
+#ifndef AO_OPSTORE_DIR
+#define AO_OPSTORE_DIR AO_FILENAME_PREFIX "/"
+#endif
+
+#define AO_OPLOG_FN_FORMAT AO_OPSTORE_DIR "oplog-%u.wal"
+
+#define AO_OPLOG_CHUNK_SIZE 64 //read buffer for checking the CRC
+
+using namespace ArduinoOcpp;
+
+namespace ArduinoOcpp {
+namespace OperationLogUtils {
+
+constexpr RecordCodec opLogRecords {true};
+
+bool makeFn(char *fn, unsigned int segment) {
+    auto ret = snprintf(fn, MAX_PATH_SIZE, AO_OPLOG_FN_FORMAT, segment);
+    if (ret < 0 || ret >= MAX_PATH_SIZE) {
+        AO_DBG_ERR("fn error: %i", ret);
+        return false;
+    }
+    return true;
+}
+
+bool readFully(FileAdapter& file, char *buf, size_t len) {
+    return file.read(buf, len) == len;
+}
+
+} //end namespace OperationLogUtils
+} //end namespace ArduinoOcpp
+
+using namespace ArduinoOcpp::OperationLogUtils;
+
+OperationLog::OperationLog(std::shared_ptr<FilesystemAdapter> filesystem) : filesystem(filesystem) {
+
+}
+
+OperationLog::~OperationLog() {
+    persistence_flush(); //the completion callbacks refer to this log
+}
+
+bool OperationLog::load(unsigned int initialHead) {
+    head = initialHead;
+
+    uint32_t generations [2] = {0, 0};
+    bool exists [2] = {false, false};
+
+    for (unsigned int segment = 0; segment < 2; segment++) {
+        char fn [MAX_PATH_SIZE];
+        if (!makeFn(fn, segment)) {
+            return false;
+        }
+        size_t msize;
+        if (filesystem->stat(fn, &msize) != 0 || msize == 0) {
+            //missing or empty spare segment
+            continue;
+        }
+
+        //only read the segment start record
+        auto file = filesystem->open(fn, "r");
+        const size_t headerSize = opLogRecords.getHeaderSize();
+        unsigned char record [opLogRecords.getRecordSize(4)];
+        if (file && readFully(*file, (char*) record, sizeof(record)) &&
+                opLogRecords.getType(record) == 'S' &&
+                opLogRecords.getLength(record) == 4 &&
+                opLogRecords.isIntact(record, record + headerSize, 4, record + headerSize + 4)) {
+            exists[segment] = true;
+            generations[segment] = readUintLE(record + headerSize, 4);
+        } else {
+            AO_DBG_WARN("discard corrupted segment %s", fn);
+            file.reset();
+            clearSegment(segment);
+        }
+    }
+
+    if (!exists[0] && !exists[1]) {
+        //start new log
+        AO_DBG_DEBUG("create operation log");
+        pending.clear();
+        generation = 0;
+        createSegment(0);
+        clearSegment(1);
+        return false;
+    }
+
+    if (exists[0] && exists[1]) {
+        /*
+         * Either the compaction was interrupted, then the newer segment only contains copies of the older segment
+         * which is still complete. Or the older segment couldn't be cleared after the compaction, then the newer
+         * segment is complete and may have further records
+         */
+        unsigned int newer = (int32_t) (generations[1] - generations[0]) > 0 ? 1 : 0;
+        unsigned int discarded = newer;
+        uint32_t unused;
+        bool compacted = false;
+        if (scanSegment(newer, &unused, &compacted) && compacted) {
+            discarded = 1 - newer;
+        }
+        AO_DBG_WARN("discard segment %u", discarded);
+        clearSegment(discarded);
+        exists[discarded] = false;
+        compactionRequired = false;
+    }
+
+    activeSegment = exists[0] ? 0 : 1;
+
+    if (!scanSegment(activeSegment, &generation)) {
+        AO_DBG_ERR("cannot read operation log");
+        return true;
+    }
+
+    if (compactionRequired) {
+        compact();
+    }
+
+    AO_DBG_DEBUG("loaded operation log: head = %u, pending = %zu", head, pending.size());
+    return true;
+}
+
+bool OperationLog::scanSegment(unsigned int segment, uint32_t *generationOut, bool *compactedOut) {
+    char fn [MAX_PATH_SIZE];
+    if (!makeFn(fn, segment)) {
+        return false;
+    }
+
+    auto file = filesystem->open(fn, "r");
+    if (!file) {
+        return false;
+    }
+
+    pending.clear();
+
+    size_t offset = 0;
+    bool first = true;
+
+    while (true) {
+        unsigned char header [opLogRecords.getHeaderSize()];
+        size_t n = file->read((char*) header, sizeof(header));
+        if (n == 0) {
+            break; //end of file
+        }
+        if (n != sizeof(header)) {
+            compactionRequired = true;
+            break;
+        }
+
+        char type = opLogRecords.getType(header);
+        unsigned int opNr = opLogRecords.getOpNr(header);
+        size_t length = opLogRecords.getLength(header);
+
+        //check CRC and keep the first bytes of the data (the generation of 'S' records)
+        uint32_t crc = opLogRecords.crcOf(header);
+        unsigned char data [4] = {0, 0, 0, 0};
+        size_t remaining = length;
+        bool complete = true;
+        while (remaining > 0) {
+            char chunk [AO_OPLOG_CHUNK_SIZE];
+            size_t chunkSize = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+            if (!readFully(*file, chunk, chunkSize)) {
+                complete = false;
+                break;
+            }
+            if (remaining == length) {
+                memcpy(data, chunk, chunkSize < sizeof(data) ? chunkSize : sizeof(data));
+            }
+            crc = crc32(chunk, chunkSize, crc);
+            remaining -= chunkSize;
+        }
+
+        unsigned char crcField [AO_RECORD_CRC_SIZE];
+        if (!complete || !readFully(*file, (char*) crcField, sizeof(crcField)) || opLogRecords.getCrc(crcField) != crc) {
+            AO_DBG_WARN("corrupted record in %s at %zu", fn, offset);
+            compactionRequired = true;
+            break;
+        }
+
+        if (first) {
+            if (type != 'S') {
+                AO_DBG_ERR("invalid segment start");
+                return false;
+            }
+            *generationOut = readUintLE(data, 4);
+            head = opNr;
+            first = false;
+        } else if (type == 'O') {
+            //a record which was written again replaces the previous attempt
+            pending.erase(std::remove_if(pending.begin(), pending.end(), [opNr] (const Entry& entry) {
+                        return entry.opNr == (uint16_t) opNr;
+                    }), pending.end());
+
+            Entry entry;
+            entry.opNr = (uint16_t) opNr;
+            entry.length = (uint16_t) length;
+            entry.offset = (uint32_t) (offset + opLogRecords.getHeaderSize());
+            entry.segment = (uint8_t) segment;
+            pending.push_back(entry);
+        } else if (type == 'H') {
+            dropUntil(opNr);
+        } else if (type == 'C') {
+            if (compactedOut) {
+                *compactedOut = true;
+            }
+        } else {
+            AO_DBG_WARN("skip unknown record type");
+            (void)0;
+        }
+
+        offset += opLogRecords.getRecordSize(length);
+    }
+
+    segmentSize = offset;
+    return !first;
+}
+
+bool OperationLog::writeRecord(FileAdapter& file, char type, unsigned int opNr, const char *data, size_t length) {
+    if (length > AO_RECORD_LENGTH_MAX) {
+        AO_DBG_ERR("record too long");
+        return false;
+    }
+
+    //write the record in one call
+    size_t recordSize = opLogRecords.getRecordSize(length);
+    ArenaAllocator allocator;
+    unsigned char *record = static_cast<unsigned char*>(allocator.allocate(recordSize));
+    if (!record) {
+        AO_DBG_ERR("OOM");
+        return false;
+    }
+
+    opLogRecords.encode(record, type, data, length, opNr);
+
+    bool success = file.write((const char*) record, recordSize) == recordSize;
+
+    allocator.deallocate(record);
+    return success;
+}
+
+bool OperationLog::appendRecord(char type, unsigned int opNr, const char *data, size_t length, std::function<void(bool)> onComplete) {
+    if (compactionRequired && !compact()) {
+        //don't append behind a corrupted record, it would be unreachable
+        return false;
+    }
+
+    if (segmentSize == 0 && !createSegment(activeSegment)) {
+        //segment start record is missing
+        return false;
+    }
+
+    if (length > AO_RECORD_LENGTH_MAX) {
+        AO_DBG_ERR("record too long");
+        return false;
+    }
+
+    char fn [MAX_PATH_SIZE];
+    if (!makeFn(fn, activeSegment)) {
+        return false;
+    }
+
+    //the write may be deferred (see PersistenceExecutor), so the record is a heap copy
+    auto record = std::make_shared<std::vector<unsigned char>>();
+    opLogRecords.append(*record, type, data, length, opNr);
+
+    auto filesystem = this->filesystem;
+    if (!persist([filesystem, fn, record] () {
+                auto file = filesystem->open(fn, "a");
+                if (!file) {
+                    AO_DBG_ERR("cannot open %s", fn);
+                    return false;
+                }
+                return file->write((const char*) record->data(), record->size()) == record->size();
+            }, [this, fn, onComplete] (bool success) {
+                if (!success) {
+                    AO_DBG_ERR("write error %s", fn);
+                    compactionRequired = true; //the record may be written partially
+                }
+                if (onComplete) {
+                    onComplete(success);
+                }
+            })) {
+        return false;
+    }
+
+    segmentSize += record->size();
+    return true;
+}
+
+bool OperationLog::createSegment(unsigned int segment) {
+    persistence_flush(); //pending appends go to the previous segment
+
+    char fn [MAX_PATH_SIZE];
+    if (!makeFn(fn, segment)) {
+        return false;
+    }
+
+    auto file = filesystem->open(fn, "w");
+    if (!file) {
+        AO_DBG_ERR("cannot create %s", fn);
+        return false;
+    }
+
+    unsigned char generationField [4];
+    writeUintLE(generationField, generation, 4);
+    if (!writeRecord(*file, 'S', head, (const char*) generationField, sizeof(generationField))) {
+        return false;
+    }
+
+    activeSegment = segment;
+    segmentSize = opLogRecords.getRecordSize(sizeof(generationField));
+    compactionRequired = false;
+    return true;
+}
+
+bool OperationLog::clearSegment(unsigned int segment) {
+    persistence_flush();
+
+    char fn [MAX_PATH_SIZE];
+    if (!makeFn(fn, segment)) {
+        return false;
+    }
+
+    //truncate instead of removing the file. Then both segments always exist and loading never looks for a missing file
+    auto file = filesystem->open(fn, "w");
+    if (!file) {
+        AO_DBG_ERR("cannot clear %s", fn);
+        return false;
+    }
+    return true;
+}
+
+bool OperationLog::isCompactionDue() const {
+    if (segmentSize <= AO_OPLOG_SEGMENT_SIZE) {
+        return false;
+    }
+
+    //only compact if it frees at least half of the segment. Otherwise many pending operations would be copied over and over
+    size_t liveSize = opLogRecords.getRecordSize(4);
+    for (auto entry = pending.begin(); entry != pending.end(); entry++) {
+        liveSize += opLogRecords.getRecordSize(entry->length);
+    }
+    return 2 * liveSize <= segmentSize;
+}
+
+bool OperationLog::compact() {
+    persistence_flush(); //the old segment must be complete before copying it
+
+    unsigned int oldSegment = activeSegment;
+    unsigned int newSegment = 1 - activeSegment;
+
+    char oldFn [MAX_PATH_SIZE];
+    char newFn [MAX_PATH_SIZE];
+    if (!makeFn(oldFn, oldSegment) || !makeFn(newFn, newSegment)) {
+        return false;
+    }
+
+    AO_DBG_DEBUG("compact operation log: %zu pending operations", pending.size());
+
+    auto oldFile = filesystem->open(oldFn, "r");
+    auto newFile = filesystem->open(newFn, "w");
+    if (!oldFile || !newFile) {
+        AO_DBG_ERR("cannot open segments");
+        return false;
+    }
+
+    uint32_t newGeneration = generation + 1;
+
+    unsigned char generationField [4];
+    writeUintLE(generationField, newGeneration, 4);
+    bool success = writeRecord(*newFile, 'S', head, (const char*) generationField, sizeof(generationField));
+    size_t newSize = opLogRecords.getRecordSize(sizeof(generationField));
+
+    std::vector<Entry> copied;
+    copied.reserve(pending.size());
+
+    ArenaAllocator allocator;
+    for (auto entry = pending.begin(); success && entry != pending.end(); entry++) {
+        char *data = static_cast<char*>(allocator.allocate(entry->length));
+        if (!data) {
+            AO_DBG_ERR("OOM");
+            success = false;
+            break;
+        }
+
+        /*
+         * The record may never have reached the segment, e.g. if a deferred write failed. Check it against the CRC
+         * and drop the operation if it can't be read. The remaining operations can still be copied
+         */
+        unsigned char header [opLogRecords.getHeaderSize()];
+        opLogRecords.encodeHeader(header, 'O', entry->length, entry->opNr);
+        unsigned char crcField [AO_RECORD_CRC_SIZE];
+        oldFile->seek(entry->offset);
+        if (!readFully(*oldFile, data, entry->length) ||
+                !readFully(*oldFile, (char*) crcField, sizeof(crcField)) ||
+                !opLogRecords.isIntact(header, data, entry->length, crcField)) {
+            AO_DBG_WARN("drop unreadable opNr %u", entry->opNr);
+            allocator.deallocate(data);
+            continue;
+        }
+
+        success = writeRecord(*newFile, 'O', entry->opNr, data, entry->length);
+        allocator.deallocate(data);
+
+        Entry moved = *entry;
+        moved.offset = (uint32_t) (newSize + opLogRecords.getHeaderSize());
+        moved.segment = (uint8_t) newSegment;
+        copied.push_back(moved);
+        newSize += opLogRecords.getRecordSize(entry->length);
+    }
+
+    if (success) {
+        //all operations are copied. With this record, the new segment replaces the old one
+        success = writeRecord(*newFile, 'C', head, nullptr, 0);
+        newSize += opLogRecords.getRecordSize(0);
+    }
+
+    oldFile.reset();
+    newFile.reset();
+
+    if (!success) {
+        AO_DBG_ERR("compaction failed");
+        clearSegment(newSegment);
+        return false;
+    }
+
+    //the new segment is complete. From now on, the old segment isn't needed anymore
+    if (!clearSegment(oldSegment)) {
+        //the next load discards the old segment, because the new one has the completion record
+        AO_DBG_WARN("old segment remains");
+        (void)0;
+    }
+
+    pending = std::move(copied);
+    generation = newGeneration;
+    activeSegment = newSegment;
+    segmentSize = newSize;
+    compactionRequired = false;
+    return true;
+}
+
+void OperationLog::dropUntil(unsigned int newHead) {
+    unsigned int rangeSize = (newHead + AO_MAX_OPNR - head) % AO_MAX_OPNR;
+
+    for (auto entry = pending.begin(); entry != pending.end();) {
+        if ((entry->opNr + AO_MAX_OPNR - head) % AO_MAX_OPNR < rangeSize) {
+            entry = pending.erase(entry);
+        } else {
+            entry++;
+        }
+    }
+
+    head = newHead;
+}
+
+const OperationLog::Entry *OperationLog::findEntry(unsigned int opNr) const {
+    //the most recent record of opNr is valid
+    for (auto entry = pending.rbegin(); entry != pending.rend(); entry++) {
+        if (entry->opNr == opNr) {
+            return &*entry;
+        }
+    }
+    return nullptr;
+}
+
+bool OperationLog::append(unsigned int opNr, const char *data, size_t length, std::function<void(bool)> onComplete) {
+    if (!appendRecord('O', opNr, data, length, onComplete)) {
+        return false;
+    }
+
+    //a record which is written again replaces the previous attempt
+    pending.erase(std::remove_if(pending.begin(), pending.end(), [opNr] (const Entry& entry) {
+                return entry.opNr == (uint16_t) opNr;
+            }), pending.end());
+
+    Entry entry;
+    entry.opNr = (uint16_t) opNr;
+    entry.length = (uint16_t) length;
+    entry.offset = (uint32_t) (segmentSize - length - AO_RECORD_CRC_SIZE);
+    entry.segment = (uint8_t) activeSegment;
+    pending.push_back(entry);
+
+    if (isCompactionDue()) {
+        compact();
+    }
+    return true;
+}
+
+bool OperationLog::setHead(unsigned int newHead) {
+    if (!appendRecord('H', newHead, nullptr, 0)) {
+        return false;
+    }
+
+    dropUntil(newHead);
+
+    if (isCompactionDue()) {
+        compact();
+    }
+    return true;
+}
+
+size_t OperationLog::getLength(unsigned int opNr) const {
+    auto entry = findEntry(opNr);
+    return entry ? entry->length : 0;
+}
+
+bool OperationLog::read(unsigned int opNr, char *buf, size_t size) {
+    auto entry = findEntry(opNr);
+    if (!entry || size < entry->length) {
+        return false;
+    }
+
+    char fn [MAX_PATH_SIZE];
+    if (!makeFn(fn, entry->segment)) {
+        return false;
+    }
+
+    persistence_flush(); //the record may still be pending
+
+    auto file = filesystem->open(fn, "r");
+    if (!file) {
+        AO_DBG_ERR("cannot open %s", fn);
+        return false;
+    }
+
+    file->seek(entry->offset);
+    return readFully(*file, buf, entry->length);
+}
+
+unsigned int OperationLog::getEnd() const {
+    unsigned int end = head;
+    unsigned int maxDistance = 0;
+    for (auto entry = pending.begin(); entry != pending.end(); entry++) {
+        unsigned int distance = (entry->opNr + 1 + AO_MAX_OPNR - head) % AO_MAX_OPNR;
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            end = (entry->opNr + 1) % AO_MAX_OPNR;
+        }
+    }
+    return end;
+}
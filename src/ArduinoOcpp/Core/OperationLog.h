@@ -0,0 +1,90 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_OPERATIONLOG_H
+#define AO_OPERATIONLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+#include <functional>
+
+#ifndef AO_OPLOG_SEGMENT_SIZE
+#define AO_OPLOG_SEGMENT_SIZE 4096 //when the active segment exceeds this size, the pending operations are compacted into the other segment
+#endif
+
+namespace ArduinoOcpp {
+
+class FilesystemAdapter;
+class FileAdapter;
+
+/*
+ * Append-only log of the stored operations (see OperationStore). Each change is one record which is appended to the
+ * active segment file (see RecordCodec):
+ *
+ *     type (1 byte) | opNr (2 bytes) | length (2 bytes) | data (length bytes) | CRC-32 over all previous fields (4 bytes)
+ *
+ * Record types:
+ *     'S': start of a segment. data is the generation of the segment, opNr the head at the time of creation
+ *     'O': stored operation opNr, data is the serialized operation
+ *     'H': head pointer. All operations before opNr are completed
+ *     'C': end of the operations which a compaction copied into the segment. Then the other segment is obsolete
+ *
+ * Multi-byte fields are little-endian. There are two segment files. If the active segment grows beyond
+ * AO_OPLOG_SEGMENT_SIZE and at least half of it is outdated, the pending operations are copied into the other
+ * segment which then becomes the active one. The inactive segment is kept as an empty file. If both segments have
+ * content, the newer one is used if it has the 'C' record. Loading stops at the first corrupted record, e.g. one
+ * which was interrupted by a power loss.
+ */
+class OperationLog {
+private:
+    struct Entry {
+        uint16_t opNr;
+        uint16_t length;
+        uint32_t offset; //position of the data in the segment file
+        uint8_t segment;
+    };
+
+    std::shared_ptr<FilesystemAdapter> filesystem;
+    std::vector<Entry> pending; //operations from head on, in log order
+
+    unsigned int head = 0;
+    uint32_t generation = 0;
+    unsigned int activeSegment = 0;
+    size_t segmentSize = 0;
+    bool compactionRequired = false; //active segment has a corrupted tail
+
+    bool scanSegment(unsigned int segment, uint32_t *generationOut, bool *compactedOut = nullptr);
+    bool writeRecord(FileAdapter& file, char type, unsigned int opNr, const char *data, size_t length);
+    bool appendRecord(char type, unsigned int opNr, const char *data, size_t length, std::function<void(bool)> onComplete = nullptr);
+    bool createSegment(unsigned int segment);
+    bool clearSegment(unsigned int segment);
+    bool isCompactionDue() const;
+    bool compact();
+    void dropUntil(unsigned int newHead);
+    const Entry *findEntry(unsigned int opNr) const;
+public:
+    OperationLog(std::shared_ptr<FilesystemAdapter> filesystem);
+    ~OperationLog();
+
+    /*
+     * Loads the index of the pending operations. Returns false if there is no log yet. Then it starts a new log at
+     * initialHead
+     */
+    bool load(unsigned int initialHead);
+
+    bool append(unsigned int opNr, const char *data, size_t length, std::function<void(bool)> onComplete = nullptr); //onComplete reports if the record reached flash. Appending opNr again replaces the previous record
+    bool setHead(unsigned int head);
+
+    size_t getLength(unsigned int opNr) const; //length of the stored operation or 0 if it doesn't exist
+    bool read(unsigned int opNr, char *buf, size_t size);
+
+    unsigned int getHead() const {return head;}
+    unsigned int getEnd() const; //one place after the last stored operation, or the head if there are none
+};
+
+}
+
+#endif
@@ -3,6 +3,8 @@
 // MIT License
 
 #include <ArduinoOcpp/Core/OperationStore.h>
+#include <ArduinoOcpp/Core/OperationLog.h>
+#include <ArduinoOcpp/Core/JsonCapacity.h>
 #include <ArduinoOcpp/Core/FilesystemAdapter.h>
 #include <ArduinoOcpp/Core/FilesystemUtils.h>
 #include <ArduinoOcpp/Core/Configuration.h>
@@ -14,7 +16,9 @@
 
 #define AO_OPSTORE_FN AO_FILENAME_PREFIX "/opstore.cnf"
 
-#define AO_OPHISTORY_SIZE 3
+#ifndef AO_OPSTORE_FORMAT
+#define AO_OPSTORE_FORMAT AO_STORAGE_MSGPACK
+#endif
 
 using namespace ArduinoOcpp;
 
@@ -23,31 +27,59 @@ bool StoredOperationHandler::commit() {
         AO_DBG_ERR("cannot call two times");
         return false;
     }
-    if (!filesystem) {
-        AO_DBG_DEBUG("filesystem");
-        return false;
-    }
 
     if (!rpc || !payload) {
         AO_DBG_ERR("unitialized");
         return false;
     }
 
+    ArenaJsonDocument doc {JSON_OBJECT_SIZE(2) + rpc->capacity() + payload->capacity()};
+    doc["rpc"] = *rpc;
+    doc["payload"] = *payload;
+
+    auto format = static_cast<StorageFormat>(AO_OPSTORE_FORMAT);
+    size_t length = FilesystemUtils::measure(doc, format);
+    record.resize(length + 1);
+    if (format == StorageFormat::MsgPack) {
+        serializeMsgPack(doc, &record[0], length + 1);
+    } else {
+        serializeJson(doc, &record[0], length + 1);
+    }
+    record.resize(length);
+
     opNr = context.reserveOpNr();
 
-    char fn [MAX_PATH_SIZE] = {'\0'};
-    auto ret = snprintf(fn, MAX_PATH_SIZE, AO_OPSTORE_DIR "op" "-%u.jsn", opNr);
-    if (ret < 0 || ret >= MAX_PATH_SIZE) {
-        AO_DBG_ERR("fn error: %i", ret);
+    return write();
+}
+
+bool StoredOperationHandler::recommit() {
+    if (record.empty() || opNr < 0) {
+        AO_DBG_ERR("nothing to write");
         return false;
     }
 
-    DynamicJsonDocument doc {JSON_OBJECT_SIZE(2) + rpc->capacity() + payload->capacity()};
-    doc["rpc"] = *rpc;
-    doc["payload"] = *payload;
+    AO_DBG_DEBUG("write operation %i again", opNr);
+    return write();
+}
 
-    if (!FilesystemUtils::storeJson(filesystem, fn, doc)) {
-        AO_DBG_ERR("FS error");
+bool StoredOperationHandler::write() {
+    if (!context.hasStorage()) {
+        return false; //nothing to retry
+    }
+
+    //the completion may come after this handler is gone, so the result goes to a shared flag
+    auto failed = std::make_shared<bool>(false);
+    writeFailed = failed;
+
+    bool success = context.storeOp((unsigned int) opNr, record.c_str(), record.length(), [failed] (bool success) {
+        if (!success) {
+            *failed = true;
+        }
+    });
+
+    if (!success) {
+        AO_DBG_DEBUG("operation %i not stored", opNr);
+        *failed = true;
         return false;
     }
 
@@ -60,29 +92,12 @@ bool StoredOperationHandler::restore(unsigned int opNrToLoad) {
         AO_DBG_ERR("cannot restore after commit");
         return false;
     }
-    if (!filesystem) {
-        AO_DBG_DEBUG("filesystem");
-        return false;
-    }
 
     opNr = opNrToLoad;
 
-    char fn [MAX_PATH_SIZE] = {'\0'};
-    auto ret = snprintf(fn, MAX_PATH_SIZE, AO_OPSTORE_DIR "op" "-%u.jsn", opNr);
-    if (ret < 0 || ret >= MAX_PATH_SIZE) {
-        AO_DBG_ERR("fn error: %i", ret);
-        return false;
-    }
-
-    size_t msize;
-    if (filesystem->stat(fn, &msize) != 0) {
-        AO_DBG_VERBOSE("operation %u does not exist", opNr);
-        return false;
-    }
-
-    auto doc = FilesystemUtils::loadJson(filesystem, fn);
+    auto doc = context.loadOp(opNr);
     if (!doc) {
-        AO_DBG_ERR("FS error");
+        AO_DBG_VERBOSE("operation %u does not exist", opNr);
         return false;
     }
     
@@ -104,39 +119,117 @@ OperationStore::OperationStore(std::shared_ptr<FilesystemAdapter> filesystem) :
 
     if (!opBegin || *opBegin < 0) {
         AO_DBG_ERR("init failure");
-    } else if (filesystem) {
-        opEnd = *opBegin;
-
-        unsigned int misses = 0;
-        unsigned int i = opEnd;
-        while (misses < 3) {
-            char fn [MAX_PATH_SIZE] = {'\0'};
-            auto ret = snprintf(fn, MAX_PATH_SIZE, AO_OPSTORE_DIR "op" "-%u.jsn", i);
-            if (ret < 0 || ret >= MAX_PATH_SIZE) {
-                AO_DBG_ERR("fn error: %i", ret);
-                misses++;
-                i = (i + 1) % AO_MAX_OPNR;
-                continue;
-            }
+    } else if (!filesystem) {
+        opEnd = *opBegin; //no stored operations
+    } else {
+        log = std::unique_ptr<OperationLog>(new OperationLog(filesystem));
+        if (!log->load((unsigned int) *opBegin)) {
+            //new log. Take over the operations of the former storage
+            migrateOpFiles();
+        }
 
-            size_t msize;
-            if (filesystem->stat(fn, &msize) != 0) {
-                AO_DBG_DEBUG("operation %u does not exist", i);
-                misses++;
-                i = (i + 1) % AO_MAX_OPNR;
-                continue;
-            }
+        //the head pointer in the log replaces AO_opBegin; the config only mirrors it
+        *opBegin = (int) log->getHead();
+        opEnd = log->getEnd();
+    }
+}
+
+OperationStore::~OperationStore() = default;
 
-            //file exists
-            misses = 0;
+void OperationStore::migrateOpFiles() {
+    unsigned int misses = 0;
+    unsigned int i = log->getHead();
+    while (misses < 3) {
+        char fn [MAX_PATH_SIZE] = {'\0'};
+        auto ret = snprintf(fn, MAX_PATH_SIZE, AO_OPSTORE_DIR "op" "-%u.jsn", i);
+        if (ret < 0 || ret >= MAX_PATH_SIZE) {
+            AO_DBG_ERR("fn error: %i", ret);
+            break;
+        }
+
+        size_t msize;
+        if (filesystem->stat(fn, &msize) != 0) {
+            misses++;
             i = (i + 1) % AO_MAX_OPNR;
-            opEnd = i;
+            continue;
+        }
+        misses = 0;
+
+        auto file = filesystem->open(fn, "r");
+        ArenaAllocator allocator;
+        char *data = static_cast<char*>(allocator.allocate(msize));
+        if (file && data && file->read(data, msize) == msize) {
+            AO_DBG_DEBUG("migrate operation %u", i);
+            log->append(i, data, msize);
+        } else {
+            AO_DBG_ERR("cannot migrate %s", fn);
+            (void)0;
+        }
+        allocator.deallocate(data);
+        file.reset();
+
+        filesystem->remove(fn);
+        i = (i + 1) % AO_MAX_OPNR;
+    }
+}
+
+bool OperationStore::storeOp(unsigned int opNr, const char *data, size_t length, std::function<void(bool)> onComplete) {
+    if (!log) {
+        return false;
+    }
+    return log->append(opNr, data, length, onComplete);
+}
+
+std::unique_ptr<ArenaJsonDocument> OperationStore::loadOp(unsigned int opNr) {
+    if (!log) {
+        return nullptr;
+    }
+
+    size_t length = log->getLength(opNr);
+    if (length == 0) {
+        return nullptr;
+    }
+
+    ArenaAllocator allocator;
+    char *data = static_cast<char*>(allocator.allocate(length));
+    if (!data) {
+        AO_DBG_ERR("OOM");
+        return nullptr;
+    }
+
+    std::unique_ptr<ArenaJsonDocument> doc;
+
+    if (log->read(opNr, data, length)) {
+        //operations of previous firmware versions are stored as JSON
+        auto format = FilesystemUtils::detectFormat(data, length);
+        size_t capacity = FilesystemUtils::measureCapacity(data, length, format);
+        if (capacity > 0) {
+            doc = std::unique_ptr<ArenaJsonDocument>(new ArenaJsonDocument(capacity));
+            DeserializationError err;
+            if (format == StorageFormat::MsgPack) {
+                err = deserializeMsgPack(*doc, (const char*) data, length);
+            } else {
+                err = deserializeJson(*doc, (const char*) data, length);
+            }
+            if (err) {
+                AO_DBG_ERR("operation %u: %s", opNr, err.c_str());
+                doc.reset();
+            }
+        } else {
+            AO_DBG_ERR("operation %u: invalid format", opNr);
+            (void)0;
         }
+    } else {
+        AO_DBG_ERR("FS error");
+        (void)0;
     }
+
+    allocator.deallocate(data);
+    return doc;
 }
 
 std::unique_ptr<StoredOperationHandler> OperationStore::makeOpHandler() {
-    return std::unique_ptr<StoredOperationHandler>(new StoredOperationHandler(*this, filesystem));
+    return std::unique_ptr<StoredOperationHandler>(new StoredOperationHandler(*this));
 }
 
 unsigned int OperationStore::reserveOpNr() {
@@ -165,38 +258,14 @@ void OperationStore::advanceOpNr(unsigned int oldOpNr) {
 
     unsigned int opNr = (oldOpNr + 1) % AO_MAX_OPNR;
 
-    //delete range [*opBegin ... opNr)
-
-    unsigned int rangeSize = (opNr + AO_MAX_OPNR - (unsigned int) *opBegin) % AO_MAX_OPNR;
-
-    AO_DBG_DEBUG("delete %u operations", rangeSize);
-
-    for (unsigned int i = 0; i < rangeSize; i++) {
-        unsigned int op = ((unsigned int) *opBegin + i + AO_MAX_OPNR - AO_OPHISTORY_SIZE) % AO_MAX_OPNR;
-
-        char fn [MAX_PATH_SIZE] = {'\0'};
-        auto ret = snprintf(fn, MAX_PATH_SIZE, AO_OPSTORE_DIR "op" "-%u.jsn", op);
-        if (ret < 0 || ret >= MAX_PATH_SIZE) {
-            AO_DBG_ERR("fn error: %i", ret);
-            break;
-        }
-
-        size_t msize;
-        if (filesystem->stat(fn, &msize) != 0) {
-            AO_DBG_DEBUG("operation %u does not exist", i);
-            continue;
-        }
+    AO_DBG_DEBUG("advance opBegin: %u", opNr);
 
-        bool success = filesystem->remove(fn);
-        if (!success) {
-            AO_DBG_ERR("error deleting %s", fn);
-            (void)0;
-        }
+    if (log && !log->setHead(opNr)) {
+        AO_DBG_ERR("cannot persist opBegin");
+        (void)0;
     }
 
-    AO_DBG_DEBUG("advance opBegin: %u", opNr);
     *opBegin = opNr;
-    configuration_save();
 }
 
 unsigned int OperationStore::getOpBegin() {
@@ -7,13 +7,17 @@
 
 #include <memory>
 #include <deque>
+#include <string>
+#include <functional>
 #include <ArduinoJson.h>
+#include <ArduinoOcpp/Core/MemoryArena.h>
 
 #define AO_MAX_OPNR 10000
 
 namespace ArduinoOcpp {
 
 class OperationStore;
+class OperationLog;
 class FilesystemAdapter;
 template<class T> class Configuration;
 
@@ -21,15 +25,19 @@ class StoredOperationHandler {
 private:
     OperationStore& context;
     int opNr = -1;
-    std::shared_ptr<FilesystemAdapter> filesystem;
 
     std::unique_ptr<DynamicJsonDocument> rpc;
     std::unique_ptr<DynamicJsonDocument> payload;
 
     bool isPersistent = false;
 
+    std::string record; //serialized operation. Kept until the write is confirmed, so that it can be written again
+    std::shared_ptr<bool> writeFailed; //set by the completion of the latest write
+
+    bool write();
+
 public:
-    StoredOperationHandler(OperationStore& context, std::shared_ptr<FilesystemAdapter> filesystem) : context(context), filesystem(filesystem) {}
+    StoredOperationHandler(OperationStore& context) : context(context) {}
 
     void setRpc(std::unique_ptr<DynamicJsonDocument> rpc) {this->rpc = std::move(rpc);}
     void setPayload(std::unique_ptr<DynamicJsonDocument> payload) {this->payload = std::move(payload);}
@@ -40,6 +48,10 @@ public:
     bool commit();
     void clearBuffer() {rpc.reset(); payload.reset();}
 
+    bool isWriteFailed() {return writeFailed && *writeFailed;} //the last write of commit() or recommit() failed
+    bool recommit(); //writes the record of commit() again after a failed write
+    void releaseRecord() {std::string().swap(record);} //the write is confirmed; no further attempts
+
     bool restore(unsigned int opNr);
 
     int getOpNr() {return isPersistent ? opNr : -1;}
@@ -48,12 +60,19 @@ public:
 class OperationStore {
 private:
     std::shared_ptr<FilesystemAdapter> filesystem;
+    std::unique_ptr<OperationLog> log; //nullptr if there is no filesystem
     std::shared_ptr<Configuration<int>> opBegin; //Tx-related operations are stored; index of the first pending operation
     unsigned int opEnd = 0; //one place after last number
 
+    void migrateOpFiles(); //moves the operations of the former one-file-per-operation storage into the log
+
 public:
     OperationStore() = delete;
     OperationStore(std::shared_ptr<FilesystemAdapter> filesystem);
+    ~OperationStore();
+
+    bool storeOp(unsigned int opNr, const char *data, size_t length, std::function<void(bool)> onComplete = nullptr);
+    std::unique_ptr<ArenaJsonDocument> loadOp(unsigned int opNr); //nullptr if it doesn't exist
 
     std::unique_ptr<StoredOperationHandler> makeOpHandler();
     std::unique_ptr<StoredOperationHandler> fetchOpHandler(unsigned int opNr);
@@ -63,6 +82,8 @@ public:
 
     unsigned int getOpBegin();
     unsigned int getOpEnd() {return opEnd;}
+
+    bool hasStorage() {return log != nullptr;} //false if there is no filesystem
 };
 
 }
@@ -11,9 +11,18 @@
 #include <ArduinoOcpp/Debug.h>
 
 #include <algorithm>
+#include <string.h>
 
 #define AO_OPERATIONCACHE_MAXSIZE 10
 
+/*
+ * When the queue drains a backlog of MeterValues, adjacent MeterValues of the same connector and transaction are
+ * sent in one frame up to this payload size in bytes. Set to 0 to send every MeterValues operation on its own
+ */
+#ifndef AO_METERVALUES_COALESCE_MAXSIZE
+#define AO_METERVALUES_COALESCE_MAXSIZE 2000
+#endif
+
 using namespace ArduinoOcpp;
 
 OperationsQueue::OperationsQueue(std::shared_ptr<OcppModel> baseModel, std::shared_ptr<FilesystemAdapter> filesystem)
@@ -31,6 +40,23 @@ OcppOperation *OperationsQueue::front() {
     return head.get();
 }
 
+OperationPriority ArduinoOcpp::getOperationPriority(OcppOperation& op) {
+    if (op.getStorageHandler() && op.getStorageHandler()->getOpNr() >= 0) {
+        return OperationPriority::Transaction;
+    }
+
+    const char *action = op.getOcppOperationType();
+    if (!strcmp(action, "Authorize") || !strcmp(action, "BootNotification")) {
+        return OperationPriority::Interactive;
+    } else if (!strcmp(action, "StartTransaction") || !strcmp(action, "StopTransaction") || op.isTransactionRelated()) {
+        return OperationPriority::Transaction;
+    } else if (!strcmp(action, "MeterValues")) {
+        return OperationPriority::Metering;
+    } else {
+        return OperationPriority::Status;
+    }
+}
+
 void OperationsQueue::pop_front() {
     
     if (head && head->getStorageHandler() && head->getStorageHandler()->getOpNr() >= 0) {
@@ -38,83 +64,141 @@ void OperationsQueue::pop_front() {
         AO_DBG_DEBUG("advanced %i to %u", head->getStorageHandler()->getOpNr(), opStore.getOpBegin());
     }
 
+    if (head) {
+        unindex(head.get());
+    }
     head.reset();
 
-    unsigned int nextOpNr = opStore.getOpBegin();
-
     /*
-     * Find next operation to take as front. Two cases:
-     * A) [front, tailCache] contains all operations stored on this device
-     * B) [front, tailCache] does not contain all operations. The next operation after front is not present
-     *                       in the cache. Fetch the next operation from the flash to front
+     * Take the next operation from the first non-empty lane. Interactive and status operations are only in the
+     * cache, the transaction lane can also continue on flash
      */
+    for (OperationPriority lane : {OperationPriority::Interactive, OperationPriority::Status}) {
+        auto found = std::find_if(tailCache.begin(), tailCache.end(),
+            [lane] (std::unique_ptr<OcppOperation>& op) {
+                return getOperationPriority(*op) == lane;
+        });
+        if (found != tailCache.end()) {
+            head = std::move(*found);
+            tailCache.erase(found);
+            AO_DBG_VERBOSE("popped front");
+            return;
+        }
+    }
 
-    auto found = std::find_if(tailCache.begin(), tailCache.end(),
-        [nextOpNr] (std::unique_ptr<OcppOperation>& op) {
-            return op->getStorageHandler() &&
-                   op->getStorageHandler()->getOpNr() >= 0 &&
-                   (unsigned int) op->getStorageHandler()->getOpNr() == nextOpNr;
-    });
-
-    if (found != tailCache.end()) {
-        //cache hit -> case A) -> don't load from flash but just take the next element from tail
+    if (!popTransaction() && !tailCache.empty()) {
+        //only metering operations remain in cache
         head = std::move(tailCache.front());
         tailCache.pop_front();
-    } else {
-        //cache miss -> case B) or A) -> try to fetch operation from flash (check for case B)) or take first cached element as front
-        auto storageHandler = opStore.makeOpHandler();
-        
-        std::unique_ptr<OcppOperation> fetched;
-
-        bool exists = false;
-        unsigned int range = (opStore.getOpEnd() + AO_MAX_OPNR - nextOpNr) % AO_MAX_OPNR;
-        for (size_t i = 0; i < range; i++) {
-            exists = storageHandler->restore(nextOpNr);
-            if (exists) {
-                break;
-            }
-            nextOpNr++;
-            nextOpNr %= AO_MAX_OPNR;
+    }
+
+    coalesce();
+
+    AO_DBG_VERBOSE("popped front");
+}
+
+void OperationsQueue::coalesce() {
+#if AO_METERVALUES_COALESCE_MAXSIZE > 0
+    if (!head || strcmp(head->getOcppOperationType(), "MeterValues")) {
+        return;
+    }
+
+    /*
+     * The new head hasn't been sent yet. Merge the following operations of the same lane into it until the first
+     * one which doesn't fit, so that the order of the readings is preserved. In the transaction lane, this stops at
+     * the next StartTransaction or StopTransaction
+     */
+    auto lane = getOperationPriority(*head);
+    auto el = tailCache.begin();
+    while (el != tailCache.end()) {
+        if (getOperationPriority(**el) != lane) {
+            ++el;
+            continue;
         }
+        if (!head->merge(**el, AO_METERVALUES_COALESCE_MAXSIZE)) {
+            break;
+        }
+        AO_DBG_DEBUG("coalesced MeterValues into msgId %s", head->getMessageID());
+        unindex(el->get());
+        el = tailCache.erase(el);
+    }
+#endif
+}
 
-        if (exists) {
-            //case B) -> load operation from flash and take it as front element
-            fetched = makeOcppOperation();
+bool OperationsQueue::popTransaction() {
+
+    unsigned int nextOpNr = opStore.getOpBegin();
+
+    /*
+     * Find next operation of the transaction lane. Go through the opNrs in order and take the first operation
+     * which is either in the cache or on flash. Operations in the cache are preferred, so that operations are
+     * never restored twice. Operations without opNr (e.g. MeterValues) which have been initiated before the
+     * cached operation go first. Operations which are only on flash are older than all cached operations, because
+     * the cache only evicts stored transaction operations from its front. If no operation has an opNr, take the first
+     * cached transaction operation
+     */
+    auto storageHandler = opStore.makeOpHandler();
+
+    unsigned int range = (opStore.getOpEnd() + AO_MAX_OPNR - nextOpNr) % AO_MAX_OPNR;
+    for (size_t i = 0; i < range; i++) {
+        auto cached = std::find_if(tailCache.begin(), tailCache.end(),
+            [nextOpNr] (std::unique_ptr<OcppOperation>& op) {
+                return op->getStorageHandler() &&
+                       op->getStorageHandler()->getOpNr() >= 0 &&
+                       (unsigned int) op->getStorageHandler()->getOpNr() == nextOpNr;
+        });
+
+        if (cached != tailCache.end()) {
+            //cache hit -> don't load from flash
+            auto earlier = std::find_if(tailCache.begin(), cached,
+                [] (std::unique_ptr<OcppOperation>& op) {
+                    return getOperationPriority(*op) == OperationPriority::Transaction;
+            });
+            head = std::move(*earlier); //equals cached if no other transaction operation was initiated before
+            tailCache.erase(earlier);
+            return true;
+        }
+
+        if (storageHandler->restore(nextOpNr)) {
+            //operation only exists on flash -> restore it and take it as front element
+            auto fetched = makeOcppOperation();
             
             bool success = fetched->restore(std::move(storageHandler), baseModel);
 
-            if (!success) {
-                AO_DBG_ERR("could not restore operation");
-                fetched.reset();
+            if (success && fetched->isFullyConfigured()) {
+                head = std::move(fetched);
+                index(head.get());
+                AO_DBG_DEBUG("restored operation from flash");
+                return true;
             }
 
-            if (!fetched->isFullyConfigured()) {
-                AO_DBG_ERR("stored op initialization failure");
-                fetched.reset();
-            }
+            AO_DBG_ERR("could not restore operation");
+            storageHandler = opStore.makeOpHandler();
         }
 
-        if (fetched) {
-            //found operation in flash -> case B)
-            head = std::move(fetched);
-            AO_DBG_DEBUG("restored operation from flash");
-        } else {
-            //no operation anymore in flash -> case A) -> take next queued operation in tailCache
-            if (tailCache.empty()) {
-                //no operations anymore
-            } else {
-                head = std::move(tailCache.front());
-                tailCache.pop_front();
-            }
-        }
+        nextOpNr++;
+        nextOpNr %= AO_MAX_OPNR;
     }
 
-    AO_DBG_VERBOSE("popped front");
+    //no stored operation anymore -> take the next transaction operation without opNr
+    auto found = std::find_if(tailCache.begin(), tailCache.end(),
+        [] (std::unique_ptr<OcppOperation>& op) {
+            return getOperationPriority(*op) == OperationPriority::Transaction;
+    });
+
+    if (found != tailCache.end()) {
+        head = std::move(*found);
+        tailCache.erase(found);
+        return true;
+    }
+
+    return false;
 }
 
 void OperationsQueue::initiate(std::unique_ptr<OcppOperation> op) {
 
     op->initiate(opStore.makeOpHandler());
+    index(op.get());
 
     if (!head && !tailCache.empty()) {
         AO_DBG_ERR("invalid state");
@@ -125,9 +209,38 @@ void OperationsQueue::initiate(std::unique_ptr<OcppOperation> op) {
         head = std::move(op);
     } else {
         if (tailCache.size() >= AO_OPERATIONCACHE_MAXSIZE) {
+            /*
+             * Replace the oldest operation of the lowest priority. The transaction lane is exempt, because its
+             * operations would be lost or could be overtaken by later transaction-related messages
+             */
+            auto replaced = tailCache.end();
+            for (auto el = tailCache.begin(); el != tailCache.end(); ++el) {
+                auto priority = getOperationPriority(**el);
+                if (priority == OperationPriority::Transaction) {
+                    continue;
+                }
+                if (replaced == tailCache.end() || priority > getOperationPriority(**replaced)) {
+                    replaced = el;
+                }
+            }
+            if (replaced == tailCache.end()) {
+                /*
+                 * The cache only contains transaction operations. Evict the oldest one. If it is stored, it is
+                 * restored from flash later and still goes before the cached operations. Only stored operations in
+                 * front of the cache can be evicted without changing the order, so otherwise it is lost
+                 */
+                replaced = tailCache.begin();
+                auto storageHandler = (*replaced)->getStorageHandler();
+                if (!storageHandler || storageHandler->getOpNr() < 0 || storageHandler->isWriteFailed()) {
+                    AO_DBG_WARN("Drop transaction-related operation (cache full)");
+                    (void)0;
+                }
+            }
+
             AO_DBG_INFO("Replace cached operation (cache full): ");
-            tailCache.front()->print_debug();
-            tailCache.pop_front();
+            (*replaced)->print_debug();
+            unindex(replaced->get());
+            tailCache.erase(replaced);
         }
 
         tailCache.push_back(std::move(op));
@@ -140,7 +253,50 @@ void OperationsQueue::drop_if(std::function<bool(std::unique_ptr<OcppOperation>&
         pop_front();
     }
 
-    tailCache.erase(std::remove_if(tailCache.begin(), tailCache.end(), pred), tailCache.end());
+    auto el = tailCache.begin();
+    while (el != tailCache.end()) {
+        if (pred(*el)) {
+            unindex(el->get());
+            el = tailCache.erase(el);
+        } else {
+            ++el;
+        }
+    }
+}
+
+OcppOperation *OperationsQueue::find(const char *messageID) {
+    if (!messageID) {
+        return nullptr;
+    }
+
+    auto found = messageIDIndex.find(messageID);
+    if (found == messageIDIndex.end()) {
+        return nullptr;
+    }
+    return found->second;
+}
+
+void OperationsQueue::drop(OcppOperation *op) {
+    if (!op) {
+        return;
+    }
+
+    if (head.get() == op) {
+        pop_front();
+        return;
+    }
+
+    auto found = std::find_if(tailCache.begin(), tailCache.end(),
+        [op] (std::unique_ptr<OcppOperation>& el) {
+            return el.get() == op;
+    });
+
+    if (found != tailCache.end()) {
+        unindex(op);
+        tailCache.erase(found);
+    } else {
+        AO_DBG_ERR("op not in queue");
+    }
 }
 
 std::deque<std::unique_ptr<OcppOperation>>::iterator OperationsQueue::begin_tail() {
@@ -152,5 +308,37 @@ std::deque<std::unique_ptr<OcppOperation>>::iterator OperationsQueue::end_tail()
 }
 
 std::deque<std::unique_ptr<OcppOperation>>::iterator OperationsQueue::erase_tail(std::deque<std::unique_ptr<OcppOperation>>::iterator el) {
+    if (el != tailCache.end()) {
+        unindex(el->get());
+    }
     return tailCache.erase(el);
 }
+
+void OperationsQueue::index(OcppOperation *op) {
+    const char *messageID = op->getMessageID();
+
+    //the key must point into the messageID of the indexed op. Replace an entry of a stale op with the same messageID
+    messageIDIndex.erase(messageID);
+    messageIDIndex.emplace(messageID, op);
+}
+
+void OperationsQueue::unindex(OcppOperation *op) {
+    auto found = messageIDIndex.find(op->getMessageID());
+    if (found != messageIDIndex.end() && found->second == op) {
+        messageIDIndex.erase(found);
+    }
+}
+
+size_t OperationsQueue::MessageIDHash::operator()(const char *messageID) const {
+    //FNV-1a
+    size_t hash = 2166136261U;
+    for (const char *c = messageID; *c; c++) {
+        hash ^= (unsigned char) *c;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+bool OperationsQueue::MessageIDEqual::operator()(const char *lhs, const char *rhs) const {
+    return !strcmp(lhs, rhs);
+}
@@ -10,6 +10,7 @@
 #include <memory>
 #include <deque>
 #include <functional>
+#include <unordered_map>
 
 namespace ArduinoOcpp {
 
@@ -17,6 +18,22 @@ class FilesystemAdapter;
 class OcppOperation;
 class OcppModel;
 
+/*
+ * Priority classes of the initiated operations. The queue sends one operation at a time and always takes the next
+ * operation from the first non-empty lane, so that live traffic isn't stuck behind a backlog of stored transaction
+ * messages after an outage. Within each lane, operations keep their order. The transaction lane keeps the order in
+ * which the operations have been initiated, including the operations which are only stored on flash. Operations of
+ * the transaction lane are never replaced in the cache.
+ */
+enum class OperationPriority {
+    Interactive, //Authorize, BootNotification
+    Status,      //StatusNotification, Heartbeat and all other operations
+    Transaction, //StartTransaction, StopTransaction, MeterValues with transactionId and all operations stored on flash
+    Metering     //MeterValues without transactionId
+};
+
+OperationPriority getOperationPriority(OcppOperation& op);
+
 class OperationsQueue {
 private:
     OperationStore opStore;
@@ -24,6 +41,25 @@ private:
 
     std::unique_ptr<OcppOperation> head;
     std::deque<std::unique_ptr<OcppOperation>> tailCache;
+
+    /*
+     * Index of all cached operations (head and tailCache) by their messageID. The keys point into the messageID
+     * strings owned by the operations, so a lookup with the messageID of an incoming CALLRESULT / CALLERROR
+     * doesn't need to copy or allocate anything
+     */
+    struct MessageIDHash {
+        size_t operator()(const char *messageID) const;
+    };
+    struct MessageIDEqual {
+        bool operator()(const char *lhs, const char *rhs) const;
+    };
+    std::unordered_map<const char*, OcppOperation*, MessageIDHash, MessageIDEqual> messageIDIndex;
+
+    void index(OcppOperation *op);
+    void unindex(OcppOperation *op);
+
+    bool popTransaction(); //takes the next operation of the transaction lane as head. Returns false if lane is empty
+    void coalesce(); //merges the following MeterValues of the same lane into the head (see AO_METERVALUES_COALESCE_MAXSIZE)
 public:
 
     OperationsQueue(std::shared_ptr<OcppModel> baseModel, std::shared_ptr<FilesystemAdapter> filesystem);
@@ -39,6 +75,9 @@ public:
     std::deque<std::unique_ptr<OcppOperation>>::iterator erase_tail(std::deque<std::unique_ptr<OcppOperation>>::iterator el);
     void drop_if(std::function<bool(std::unique_ptr<OcppOperation>&)> pred); //drops operations from this queue where pred(operation) == true. Executes pred in order
 
+    OcppOperation *find(const char *messageID); //returns the cached operation with the given messageID or nullptr. Constant time
+    void drop(OcppOperation *op); //drops op from this queue. If op is the front element, this is equivalent to pop_front()
+
 };
 
 }
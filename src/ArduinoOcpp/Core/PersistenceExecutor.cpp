@@ -0,0 +1,181 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
+#include <ArduinoOcpp/Debug.h>
+
+using namespace ArduinoOcpp;
+
+static PersistenceExecutor *activePersistenceExecutor = nullptr;
+
+PersistenceExecutor *ArduinoOcpp::getActivePersistenceExecutor() {
+    return activePersistenceExecutor;
+}
+
+void ArduinoOcpp::setActivePersistenceExecutor(PersistenceExecutor *executor) {
+    activePersistenceExecutor = executor;
+}
+
+PersistenceExecutor::PersistenceExecutor(bool threaded) {
+#if AO_PERSISTENCE_THREADS
+    this->threaded = threaded;
+    if (threaded) {
+        worker = std::thread(&PersistenceExecutor::run, this);
+    }
+#else
+    if (threaded) {
+        AO_DBG_WARN("no thread support: write synchronously");
+        (void)0;
+    }
+#endif
+}
+
+PersistenceExecutor::~PersistenceExecutor() {
+    flush();
+#if AO_PERSISTENCE_THREADS
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            stopping = true;
+        }
+        cv.notify_all();
+        worker.join();
+    }
+#endif
+}
+
+#if AO_PERSISTENCE_THREADS
+void PersistenceExecutor::run() {
+    std::unique_lock<std::mutex> lock {mutex};
+    while (true) {
+        cv.wait(lock, [this] () {
+            return stopping || !queue.empty();
+        });
+
+        if (queue.empty()) {
+            return; //stopping
+        }
+
+        Task task = std::move(queue.front());
+        queue.pop_front();
+
+        lock.unlock();
+        task.success = task.job();
+        task.job = nullptr; //release the snapshot
+        lock.lock();
+
+        executed = task.ticket;
+        if (task.onComplete) {
+            completed.push_back(std::move(task));
+        }
+        cv.notify_all();
+    }
+}
+#endif
+
+uint32_t PersistenceExecutor::submit(Job job, OnComplete onComplete) {
+    if (!job) {
+        AO_DBG_ERR("invalid argument");
+        return submitted;
+    }
+
+#if AO_PERSISTENCE_THREADS
+    if (threaded) {
+        std::lock_guard<std::mutex> lock {mutex};
+        submitted++;
+        queue.push_back(Task {submitted, std::move(job), std::move(onComplete), false});
+        cv.notify_all();
+        return submitted;
+    }
+#endif
+
+    submitted++;
+    bool success = job();
+    executed = submitted;
+    if (onComplete) {
+        onComplete(success);
+    }
+    return submitted;
+}
+
+bool PersistenceExecutor::isDurable(uint32_t ticket) {
+#if AO_PERSISTENCE_THREADS
+    if (threaded) {
+        std::lock_guard<std::mutex> lock {mutex};
+        return (int32_t) (executed - ticket) >= 0;
+    }
+#endif
+    return true;
+}
+
+size_t PersistenceExecutor::getPendingCount() {
+#if AO_PERSISTENCE_THREADS
+    if (threaded) {
+        std::lock_guard<std::mutex> lock {mutex};
+        return (size_t) (submitted - executed);
+    }
+#endif
+    return 0;
+}
+
+void PersistenceExecutor::runCallbacks() {
+    std::deque<Task> done;
+#if AO_PERSISTENCE_THREADS
+    {
+        std::lock_guard<std::mutex> lock {mutex};
+        done.swap(completed);
+    }
+#else
+    done.swap(completed);
+#endif
+
+    //callbacks may submit further jobs
+    for (auto task = done.begin(); task != done.end(); task++) {
+        task->onComplete(task->success);
+    }
+}
+
+void PersistenceExecutor::loop() {
+    runCallbacks();
+}
+
+void PersistenceExecutor::flush() {
+#if AO_PERSISTENCE_THREADS
+    if (threaded) {
+        std::unique_lock<std::mutex> lock {mutex};
+        uint32_t ticket = submitted;
+        cv.wait(lock, [this, ticket] () {
+            return (int32_t) (executed - ticket) >= 0;
+        });
+    }
+#endif
+    runCallbacks();
+}
+
+bool ArduinoOcpp::persist(PersistenceExecutor::Job job, PersistenceExecutor::OnComplete onComplete) {
+    if (activePersistenceExecutor && activePersistenceExecutor->isThreaded()) {
+        activePersistenceExecutor->submit(std::move(job), std::move(onComplete));
+        return true;
+    }
+
+    bool success = job();
+    if (onComplete) {
+        onComplete(success);
+    }
+    return success;
+}
+
+void ArduinoOcpp::persistence_flush() {
+    if (activePersistenceExecutor) {
+        activePersistenceExecutor->flush();
+    }
+}
+
+uint32_t ArduinoOcpp::persistence_ticket() {
+    return activePersistenceExecutor ? activePersistenceExecutor->getLatestTicket() : 0;
+}
+
+bool ArduinoOcpp::persistence_isDurable(uint32_t ticket) {
+    return activePersistenceExecutor ? activePersistenceExecutor->isDurable(ticket) : true;
+}
@@ -0,0 +1,108 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_PERSISTENCEEXECUTOR_H
+#define AO_PERSISTENCEEXECUTOR_H
+
+#include <ArduinoOcpp/Platform.h>
+
+#include <stdint.h>
+#include <functional>
+#include <deque>
+
+#ifndef AO_PERSISTENCE_ASYNC
+#define AO_PERSISTENCE_ASYNC 0 //1: the OcppEngine writes to flash on a worker thread (POSIX only)
+#endif
+
+#ifndef AO_PERSISTENCE_THREADS
+#if AO_PLATFORM == AO_PLATFORM_UNIX
+#define AO_PERSISTENCE_THREADS 1
+#else
+#define AO_PERSISTENCE_THREADS 0
+#endif
+#endif
+
+#if AO_PERSISTENCE_THREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace ArduinoOcpp {
+
+/*
+ * Ordered queue of filesystem writes. The stores submit a job which writes a snapshot of their data and doesn't
+ * touch any other state. In threaded mode, a worker thread executes the jobs one after another, so the loop
+ * doesn't wait for flash. The completion callbacks run on the loop thread in submission order, either in loop() or
+ * in flush(). Code which reads a file that might have a pending write calls flush() before. Without the worker
+ * thread, submit() executes the job and its callback right away.
+ *
+ * Every job has a ticket number. A ticket is durable when its job and all jobs before have been executed. Operations
+ * remember the latest ticket when they are initiated and aren't sent before it is durable. Failed jobs are only
+ * reported to their completion callback, so that each writer can handle its own failures (see OcppOperation).
+ */
+class PersistenceExecutor {
+public:
+    using Job = std::function<bool()>; //returns if the write was successful
+    using OnComplete = std::function<void(bool success)>;
+private:
+    struct Task {
+        uint32_t ticket;
+        Job job;
+        OnComplete onComplete;
+        bool success;
+    };
+
+    std::deque<Task> queue; //submitted jobs which aren't executed yet
+    std::deque<Task> completed; //executed jobs whose callbacks are pending
+    uint32_t submitted = 0; //ticket of the latest submitted job
+    uint32_t executed = 0; //ticket of the latest executed job
+    bool threaded = false;
+
+#if AO_PERSISTENCE_THREADS
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread worker;
+    bool stopping = false;
+
+    void run();
+#endif
+
+    void runCallbacks();
+public:
+    PersistenceExecutor(bool threaded);
+    ~PersistenceExecutor(); //executes the pending jobs
+
+    PersistenceExecutor(const PersistenceExecutor&) = delete;
+    PersistenceExecutor& operator=(const PersistenceExecutor&) = delete;
+
+    uint32_t submit(Job job, OnComplete onComplete = nullptr); //returns the ticket of the job
+
+    bool isDurable(uint32_t ticket);
+    uint32_t getLatestTicket() {return submitted;}
+    size_t getPendingCount();
+    bool isThreaded() {return threaded;}
+
+    void loop(); //runs the completion callbacks
+    void flush(); //waits until the submitted jobs are executed and runs their completion callbacks
+};
+
+/*
+ * The executor of the OcppEngine. nullptr if there is no engine
+ */
+PersistenceExecutor *getActivePersistenceExecutor();
+void setActivePersistenceExecutor(PersistenceExecutor *executor);
+
+/*
+ * Shortcuts for the active executor. Without an active executor, persist() executes the job and the callback right
+ * away, and all tickets are durable
+ */
+bool persist(PersistenceExecutor::Job job, PersistenceExecutor::OnComplete onComplete = nullptr); //returns false if the job was executed right away and failed
+void persistence_flush();
+uint32_t persistence_ticket();
+bool persistence_isDurable(uint32_t ticket);
+
+}
+
+#endif
@@ -0,0 +1,82 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/RecordCodec.h>
+#include <ArduinoOcpp/Core/LittleEndian.h>
+#include <ArduinoOcpp/Core/Crc32.h>
+
+#include <string.h>
+
+using namespace ArduinoOcpp;
+
+void RecordCodec::encodeHeader(unsigned char *out, char type, size_t length, unsigned int opNr) const {
+    out[0] = (unsigned char) type;
+    if (opNrField) {
+        writeUintLE(out + 1, opNr, 2);
+    }
+    writeUintLE(out + getHeaderSize() - 2, length, 2);
+}
+
+void RecordCodec::writeCrc(unsigned char *record, size_t length) const {
+    writeUintLE(record + getHeaderSize() + length, crc32(record, getHeaderSize() + length), AO_RECORD_CRC_SIZE);
+}
+
+void RecordCodec::encode(unsigned char *out, char type, const char *data, size_t length, unsigned int opNr) const {
+    encodeHeader(out, type, length, opNr);
+    if (length > 0) {
+        memcpy(out + getHeaderSize(), data, length);
+    }
+    writeCrc(out, length);
+}
+
+void RecordCodec::append(std::vector<unsigned char>& out, char type, const char *data, size_t length, unsigned int opNr) const {
+    size_t begin = out.size();
+    out.resize(begin + getRecordSize(length));
+    encode(out.data() + begin, type, data, length, opNr);
+}
+
+bool RecordCodec::appendDocument(std::vector<unsigned char>& out, char type, const JsonDocument& doc, StorageFormat format, unsigned int opNr) const {
+    size_t length = FilesystemUtils::measure(doc, format);
+    if (length == 0 || length > AO_RECORD_LENGTH_MAX) {
+        return false;
+    }
+
+    size_t begin = out.size();
+    out.resize(begin + getRecordSize(length));
+    unsigned char *record = out.data() + begin;
+    encodeHeader(record, type, length, opNr);
+
+    //the serializers terminate the output with '\0' which is overwritten by the CRC afterwards
+    char *data = (char*) record + getHeaderSize();
+    size_t written = 0;
+    if (format == StorageFormat::MsgPack) {
+        written = serializeMsgPack(doc, data, length + AO_RECORD_CRC_SIZE);
+    } else {
+        written = serializeJson(doc, data, length + AO_RECORD_CRC_SIZE);
+    }
+
+    if (written != length) {
+        out.resize(begin);
+        return false;
+    }
+
+    writeCrc(record, length);
+    return true;
+}
+
+unsigned int RecordCodec::getOpNr(const unsigned char *header) const {
+    return opNrField ? readUintLE(header + 1, 2) : 0;
+}
+
+size_t RecordCodec::getLength(const unsigned char *header) const {
+    return readUintLE(header + getHeaderSize() - 2, 2);
+}
+
+uint32_t RecordCodec::crcOf(const unsigned char *header, const void *data, size_t length) const {
+    return crc32(data, length, crc32(header, getHeaderSize()));
+}
+
+uint32_t RecordCodec::getCrc(const unsigned char *crcField) const {
+    return readUintLE(crcField, AO_RECORD_CRC_SIZE);
+}
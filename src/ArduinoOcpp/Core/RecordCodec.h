@@ -0,0 +1,65 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_RECORDCODEC_H
+#define AO_RECORDCODEC_H
+
+#include <ArduinoOcpp/Core/FilesystemUtils.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#define AO_RECORD_CRC_SIZE 4
+#define AO_RECORD_LENGTH_MAX 0xFFFF
+
+namespace ArduinoOcpp {
+
+/*
+ * Framing of the records in the binary logs (OperationLog, ConfigurationContainerLog, MeterStore):
+ *
+ *     type (1 byte) | opNr (2 bytes, optional) | length (2 bytes) | data (length bytes) | CRC-32 over all previous fields (4 bytes)
+ *
+ * Only the records of the OperationLog have the opNr field. Multi-byte fields are little-endian. If the CRC doesn't
+ * match, the record is incomplete or corrupted, e.g. by a power loss during the write.
+ */
+class RecordCodec {
+private:
+    const bool opNrField;
+
+    void writeCrc(unsigned char *record, size_t length) const; //over the header and the data which are already in place
+public:
+    constexpr RecordCodec(bool opNrField) : opNrField(opNrField) { }
+
+    constexpr size_t getHeaderSize() const {return opNrField ? 5 : 3;}
+    constexpr size_t getRecordSize(size_t length) const {return getHeaderSize() + length + AO_RECORD_CRC_SIZE;}
+
+    //writes the header into out which has getHeaderSize() bytes
+    void encodeHeader(unsigned char *out, char type, size_t length, unsigned int opNr = 0) const;
+
+    //writes the record into out which has getRecordSize(length) bytes
+    void encode(unsigned char *out, char type, const char *data, size_t length, unsigned int opNr = 0) const;
+
+    //appends the record to out
+    void append(std::vector<unsigned char>& out, char type, const char *data, size_t length, unsigned int opNr = 0) const;
+
+    //appends the record with the serialized doc to out. Returns false and leaves out unchanged if doc can't be serialized
+    bool appendDocument(std::vector<unsigned char>& out, char type, const JsonDocument& doc, StorageFormat format, unsigned int opNr = 0) const;
+
+    char getType(const unsigned char *header) const {return (char) header[0];}
+    unsigned int getOpNr(const unsigned char *header) const;
+    size_t getLength(const unsigned char *header) const;
+
+    //CRC over the header and the data. Data which is read in chunks can be added with crc32()
+    uint32_t crcOf(const unsigned char *header, const void *data = nullptr, size_t length = 0) const;
+    uint32_t getCrc(const unsigned char *crcField) const;
+
+    bool isIntact(const unsigned char *header, const void *data, size_t length, const unsigned char *crcField) const {
+        return getCrc(crcField) == crcOf(header, data, length);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,23 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/StandardConfiguration.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+
+namespace ArduinoOcpp {
+namespace Ocpp16 {
+
+StandardConfigurations standardConfigurations;
+
+#define AO_STANDARD_CONFIGURATION_ENTRY(type, key, defaultValue, filename, remotePeerCanWrite, remotePeerCanRead, localClientCanWrite, rebootRequiredWhenChanged) \
+    {#key, &standardConfigurations.key, filename, remotePeerCanWrite, remotePeerCanRead, localClientCanWrite, rebootRequiredWhenChanged},
+
+constexpr StandardConfigurationEntry standardConfigurationTable [STANDARD_CONFIGURATIONS_SIZE] = {
+    AO_STANDARD_CONFIGURATIONS(AO_STANDARD_CONFIGURATION_ENTRY)
+};
+
+#undef AO_STANDARD_CONFIGURATION_ENTRY
+
+} //end namespace Ocpp16
+} //end namespace ArduinoOcpp
@@ -0,0 +1,79 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_STANDARDCONFIGURATION_H
+#define AO_STANDARDCONFIGURATION_H
+
+#include <ArduinoOcpp/Core/ConfigurationKeyValue.h>
+
+#include <stddef.h>
+
+/*
+ * Keys of the OCPP 1.6 Core profile with a fixed type. Their configurations are statically allocated instead of
+ * being created on the heap, and the modules read them directly, e.g.
+ *
+ *     int interval = standardConfigurations.HeartbeatInterval;
+ *
+ * configuration_init() registers them in the containers like declareConfiguration(), so GetConfiguration,
+ * ChangeConfiguration and the stored files treat them like any other configuration. Values stored in a previous
+ * session are taken over at registration. Calling declareConfiguration() for one of these keys returns the static
+ * configuration.
+ *
+ * Columns: type, key, default value, filename, remotePeerCanWrite, remotePeerCanRead, localClientCanWrite,
+ * rebootRequiredWhenChanged (see declareConfiguration())
+ */
+#define AO_STANDARD_CONFIGURATIONS(X) \
+    X(int,         HeartbeatInterval,                 86400, CONFIGURATION_FN,       true,  true, true,  false) \
+    X(int,         ConnectionTimeOut,                 30,    CONFIGURATION_FN,       true,  true, true,  false) \
+    X(int,         MinimumStatusDuration,             0,     CONFIGURATION_FN,       true,  true, true,  false) \
+    X(int,         ResetRetries,                      2,     CONFIGURATION_FN,       true,  true, false, false) \
+    X(int,         MeterValueSampleInterval,          60,    CONFIGURATION_FN,       true,  true, true,  false) \
+    X(int,         ClockAlignedDataInterval,          0,     CONFIGURATION_FN,       true,  true, true,  false) \
+    X(bool,        StopTransactionOnInvalidId,        true,  CONFIGURATION_FN,       true,  true, true,  false) \
+    X(bool,        StopTransactionOnEVSideDisconnect, true,  CONFIGURATION_FN,       true,  true, true,  false) \
+    X(bool,        UnlockConnectorOnEVSideDisconnect, true,  CONFIGURATION_FN,       true,  true, true,  false) \
+    X(bool,        LocalAuthorizeOffline,             false, CONFIGURATION_FN,       true,  true, true,  false) \
+    X(bool,        LocalPreAuthorize,                 false, CONFIGURATION_FN,       true,  true, true,  false) \
+    X(const char*, MeterValuesSampledData, "Energy.Active.Import.Register,Power.Active.Import", CONFIGURATION_FN, true, true, true, false) \
+    X(const char*, MeterValuesAlignedData, "Energy.Active.Import.Register,Power.Active.Import", CONFIGURATION_FN, true, true, true, false) \
+    X(const char*, StopTxnSampledData,                "",    CONFIGURATION_FN,       true,  true, true,  false) \
+    X(const char*, StopTxnAlignedData,                "",    CONFIGURATION_FN,       true,  true, true,  false) \
+    X(bool,        AuthorizeRemoteTxRequests,         false, CONFIGURATION_VOLATILE, false, true, false, false) \
+    X(int,         GetConfigurationMaxKeys,           30,    CONFIGURATION_VOLATILE, false, true, false, false) \
+    X(int,         MeterValuesSampledDataMaxLength,   8,     CONFIGURATION_VOLATILE, false, true, false, false) \
+    X(int,         MeterValuesAlignedDataMaxLength,   8,     CONFIGURATION_VOLATILE, false, true, false, false) \
+    X(int,         StopTxnSampledDataMaxLength,       8,     CONFIGURATION_VOLATILE, false, true, false, false)
+
+namespace ArduinoOcpp {
+namespace Ocpp16 {
+
+struct StandardConfigurations {
+#define AO_STANDARD_CONFIGURATION_MEMBER(type, key, defaultValue, ...) \
+    Configuration<type> key {#key, defaultValue};
+    AO_STANDARD_CONFIGURATIONS(AO_STANDARD_CONFIGURATION_MEMBER)
+#undef AO_STANDARD_CONFIGURATION_MEMBER
+};
+
+extern StandardConfigurations standardConfigurations;
+
+struct StandardConfigurationEntry {
+    const char *key;
+    AbstractConfiguration *configuration; //member of standardConfigurations
+    const char *filename;
+    bool remotePeerCanWrite;
+    bool remotePeerCanRead;
+    bool localClientCanWrite;
+    bool rebootRequiredWhenChanged;
+};
+
+#define AO_STANDARD_CONFIGURATION_COUNT(...) + 1
+constexpr size_t STANDARD_CONFIGURATIONS_SIZE = 0 AO_STANDARD_CONFIGURATIONS(AO_STANDARD_CONFIGURATION_COUNT);
+#undef AO_STANDARD_CONFIGURATION_COUNT
+
+extern const StandardConfigurationEntry standardConfigurationTable [STANDARD_CONFIGURATIONS_SIZE];
+
+} //end namespace Ocpp16
+} //end namespace ArduinoOcpp
+
+#endif
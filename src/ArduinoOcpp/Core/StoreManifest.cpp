@@ -0,0 +1,247 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/StoreManifest.h>
+#include <ArduinoOcpp/Core/FilesystemAdapter.h>
+#include <ArduinoOcpp/Core/MemoryArena.h>
+#include <ArduinoOcpp/Core/Crc32.h>
+#include <ArduinoOcpp/Core/LittleEndian.h>
+#include <ArduinoOcpp/Debug.h>
+
+#include <string.h>
+#include <algorithm>
+
+#ifndef AO_MANIFEST_DIR
+#define AO_MANIFEST_DIR AO_FILENAME_PREFIX "/"
+#endif
+
+#define AO_MANIFEST_FN_FORMAT AO_MANIFEST_DIR "%s-%u.mf"
+
+#define AO_MANIFEST_HEADER_SIZE 7 //type, revision, count
+#define AO_MANIFEST_ENTRY_SIZE 8
+#define AO_MANIFEST_CRC_SIZE 4
+#define AO_MANIFEST_MAX_ENTRIES 0xFFFF
+
+using namespace ArduinoOcpp;
+
+StoreManifest::StoreManifest(std::shared_ptr<FilesystemAdapter> filesystem, const char *name) : filesystem(filesystem), name(name) {
+
+}
+
+bool StoreManifest::makeFn(char *fn, unsigned int slot) {
+    auto ret = snprintf(fn, MAX_PATH_SIZE, AO_MANIFEST_FN_FORMAT, name, slot);
+    if (ret < 0 || ret >= MAX_PATH_SIZE) {
+        AO_DBG_ERR("fn error: %i", ret);
+        return false;
+    }
+    return true;
+}
+
+bool StoreManifest::loadSlot(unsigned int slot, std::vector<Entry>& entriesOut, uint32_t& revisionOut) {
+    char fn [MAX_PATH_SIZE];
+    if (!makeFn(fn, slot)) {
+        return false;
+    }
+
+    size_t fsize = 0;
+    if (filesystem->stat(fn, &fsize) != 0) {
+        return false;
+    }
+
+    if (fsize < AO_MANIFEST_HEADER_SIZE + AO_MANIFEST_CRC_SIZE) {
+        AO_DBG_WARN("manifest slot %s too small", fn);
+        return false;
+    }
+
+    auto file = filesystem->open(fn, "r");
+    if (!file) {
+        AO_DBG_ERR("cannot open %s", fn);
+        return false;
+    }
+
+    ArenaAllocator allocator;
+    unsigned char *buf = static_cast<unsigned char*>(allocator.allocate(fsize));
+    if (!buf) {
+        AO_DBG_ERR("OOM");
+        return false;
+    }
+
+    bool success = file->read((char*) buf, fsize) == fsize;
+
+    size_t count = 0;
+    if (success) {
+        count = readUintLE(buf + 5, 2);
+        success = buf[0] == 'M' &&
+                fsize == AO_MANIFEST_HEADER_SIZE + count * AO_MANIFEST_ENTRY_SIZE + AO_MANIFEST_CRC_SIZE &&
+                readUintLE(buf + fsize - AO_MANIFEST_CRC_SIZE, 4) == crc32(buf, fsize - AO_MANIFEST_CRC_SIZE);
+    }
+
+    if (success) {
+        revisionOut = readUintLE(buf + 1, 4);
+        entriesOut.clear();
+        entriesOut.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            const unsigned char *entry = buf + AO_MANIFEST_HEADER_SIZE + i * AO_MANIFEST_ENTRY_SIZE;
+            entriesOut.push_back(Entry {readUintLE(entry, 4), readUintLE(entry + 4, 4)});
+        }
+    } else {
+        AO_DBG_WARN("discard corrupted manifest slot %s", fn);
+    }
+
+    allocator.deallocate(buf);
+    return success;
+}
+
+bool StoreManifest::writeSlot(unsigned int slot, uint32_t slotRevision) {
+    char fn [MAX_PATH_SIZE];
+    if (!makeFn(fn, slot)) {
+        return false;
+    }
+
+    if (entries.size() > AO_MANIFEST_MAX_ENTRIES) {
+        AO_DBG_ERR("too many entries");
+        return false;
+    }
+
+    //write the slot in one call
+    size_t size = AO_MANIFEST_HEADER_SIZE + entries.size() * AO_MANIFEST_ENTRY_SIZE + AO_MANIFEST_CRC_SIZE;
+    ArenaAllocator allocator;
+    unsigned char *buf = static_cast<unsigned char*>(allocator.allocate(size));
+    if (!buf) {
+        AO_DBG_ERR("OOM");
+        return false;
+    }
+
+    buf[0] = 'M';
+    writeUintLE(buf + 1, slotRevision, 4);
+    writeUintLE(buf + 5, (uint32_t) entries.size(), 2);
+    for (size_t i = 0; i < entries.size(); i++) {
+        unsigned char *entry = buf + AO_MANIFEST_HEADER_SIZE + i * AO_MANIFEST_ENTRY_SIZE;
+        writeUintLE(entry, entries[i].key, 4);
+        writeUintLE(entry + 4, entries[i].size, 4);
+    }
+    writeUintLE(buf + size - AO_MANIFEST_CRC_SIZE, crc32(buf, size - AO_MANIFEST_CRC_SIZE), 4);
+
+    bool success = false;
+    auto file = filesystem->open(fn, "w");
+    if (file) {
+        success = file->write((const char*) buf, size) == size;
+    }
+
+    allocator.deallocate(buf);
+
+    if (!success) {
+        AO_DBG_ERR("cannot write %s", fn);
+    }
+    return success;
+}
+
+bool StoreManifest::load() {
+    entries.clear();
+    revision = 0;
+    activeSlot = 0;
+    stored = false;
+
+    if (!filesystem) {
+        return false;
+    }
+
+    std::vector<Entry> slotEntries [2];
+    uint32_t revisions [2] = {0, 0};
+    bool valid [2] = {false, false};
+
+    for (unsigned int slot = 0; slot < 2; slot++) {
+        valid[slot] = loadSlot(slot, slotEntries[slot], revisions[slot]);
+    }
+
+    if (!valid[0] && !valid[1]) {
+        AO_DBG_DEBUG("no manifest for %s", name);
+        return false;
+    }
+
+    if (valid[0] && valid[1]) {
+        activeSlot = (int32_t) (revisions[1] - revisions[0]) > 0 ? 1 : 0;
+    } else {
+        activeSlot = valid[0] ? 0 : 1;
+    }
+
+    //a corrupted slot still exists and is overwritten by the next save
+    stored = true;
+    revision = revisions[activeSlot];
+    entries = std::move(slotEntries[activeSlot]);
+    std::sort(entries.begin(), entries.end(), [] (const Entry& a, const Entry& b) {
+        return a.key < b.key;
+    });
+
+    AO_DBG_DEBUG("loaded manifest %s: %zu records", name, entries.size());
+    return true;
+}
+
+bool StoreManifest::save() {
+    if (!filesystem) {
+        return true;
+    }
+
+    unsigned int nextSlot = 1 - activeSlot;
+    if (!writeSlot(nextSlot, revision + 1)) {
+        return false;
+    }
+
+    revision++;
+    activeSlot = nextSlot;
+
+    if (!stored) {
+        //create the other slot as well, so that loading never looks for a missing file
+        stored = writeSlot(1 - activeSlot, revision - 1);
+    }
+    return true;
+}
+
+std::vector<StoreManifest::Entry>::iterator StoreManifest::find(uint32_t key) {
+    auto entry = std::lower_bound(entries.begin(), entries.end(), key, [] (const Entry& e, uint32_t key) {
+        return e.key < key;
+    });
+    if (entry != entries.end() && entry->key == key) {
+        return entry;
+    }
+    return entries.end();
+}
+
+bool StoreManifest::contains(uint32_t key) {
+    return find(key) != entries.end();
+}
+
+uint32_t StoreManifest::getSize(uint32_t key) {
+    auto entry = find(key);
+    return entry != entries.end() ? entry->size : 0;
+}
+
+bool StoreManifest::add(uint32_t key, uint32_t size) {
+    auto entry = find(key);
+    if (entry != entries.end() && entry->size == size) {
+        return true; //nothing changed
+    }
+    put(key, size);
+    return save();
+}
+
+void StoreManifest::put(uint32_t key, uint32_t size) {
+    auto entry = std::lower_bound(entries.begin(), entries.end(), key, [] (const Entry& e, uint32_t key) {
+        return e.key < key;
+    });
+    if (entry != entries.end() && entry->key == key) {
+        entry->size = size;
+    } else {
+        entries.insert(entry, Entry {key, size});
+    }
+}
+
+bool StoreManifest::remove(uint32_t key) {
+    auto entry = find(key);
+    if (entry == entries.end()) {
+        return true;
+    }
+    entries.erase(entry);
+    return save();
+}
@@ -0,0 +1,71 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef AO_STOREMANIFEST_H
+#define AO_STOREMANIFEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+namespace ArduinoOcpp {
+
+class FilesystemAdapter;
+
+/*
+ * List of the live records of a store (e.g. the stored transactions of a connector) with their sizes. With the
+ * manifest, the store knows which record files exist without checking the filesystem for every possible filename.
+ *
+ * The manifest is kept in two slot files which are written alternately:
+ *
+ *     'M' (1 byte) | revision (4 bytes) | count (2 bytes) | count * (key (4 bytes) | size (4 bytes)) | CRC-32 (4 bytes)
+ *
+ * Multi-byte fields are little-endian. When loading, the valid slot with the higher revision wins. A save which is
+ * interrupted by a power loss only corrupts the older slot, so the manifest falls back to the previous state.
+ *
+ * Stores add a record to the manifest after writing the record file and remove it before deleting the file. Then
+ * a power loss can leave an unreferenced file behind, but the manifest never lists a missing file.
+ */
+class StoreManifest {
+public:
+    struct Entry {
+        uint32_t key;
+        uint32_t size;
+    };
+private:
+    std::shared_ptr<FilesystemAdapter> filesystem;
+    const char *name;
+
+    std::vector<Entry> entries; //sorted by key
+    uint32_t revision = 0;
+    unsigned int activeSlot = 0;
+    bool stored = false; //both slots exist on the filesystem
+
+    bool makeFn(char *fn, unsigned int slot);
+    bool loadSlot(unsigned int slot, std::vector<Entry>& entriesOut, uint32_t& revisionOut);
+    bool writeSlot(unsigned int slot, uint32_t revision);
+    std::vector<Entry>::iterator find(uint32_t key);
+public:
+    StoreManifest(std::shared_ptr<FilesystemAdapter> filesystem, const char *name); //name must outlive the manifest
+
+    /*
+     * Returns false if there is no valid manifest yet. Then the store needs to rebuild it once
+     */
+    bool load();
+    bool save();
+
+    bool contains(uint32_t key);
+    uint32_t getSize(uint32_t key); //0 if the record doesn't exist
+
+    bool add(uint32_t key, uint32_t size); //saves the manifest if the entry has changed
+    void put(uint32_t key, uint32_t size); //only in memory, will be saved with the next change of the entries
+    bool remove(uint32_t key); //saves the manifest if the entry existed
+
+    const std::vector<Entry>& getEntries() const {return entries;}
+};
+
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include <ArduinoOcpp/Core/OcppModel.h>
 #include <ArduinoOcpp/Tasks/ChargePointStatus/ChargePointStatusService.h>
 #include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/StandardConfiguration.h>
 #include <ArduinoOcpp/Debug.h>
 
 #include <string.h>
@@ -81,10 +82,10 @@ void BootNotification::processConf(JsonObject payload){
 
     //only write if in valid range
     if (interval >= 1) {
-        std::shared_ptr<Configuration<int>> intervalConf = declareConfiguration<int>("HeartbeatInterval", 86400);
-        if (intervalConf && interval != *intervalConf) {
-            *intervalConf = interval;
-            configuration_save();
+        auto& intervalConf = standardConfigurations.HeartbeatInterval;
+        if (interval != intervalConf) {
+            intervalConf = interval;
+            configuration_save_deferred();
         }
     }
 
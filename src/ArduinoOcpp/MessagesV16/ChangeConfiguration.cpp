@@ -4,6 +4,7 @@
 
 #include <ArduinoOcpp/MessagesV16/ChangeConfiguration.h>
 #include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/JsonReader.h>
 #include <ArduinoOcpp/Debug.h>
 
 #include <cmath> //for isnan check
@@ -35,6 +36,36 @@ void ChangeConfiguration::processReq(JsonObject payload) {
 
     const char *value = payload["value"];
 
+    changeConfiguration(key, value);
+}
+
+bool ChangeConfiguration::readReq(JsonReader& payload) {
+    std::string key, value;
+    bool hasValue = false;
+
+    payload.readObject([&] (const char *member) {
+        if (!strcmp(member, "key")) {
+            payload.readString(key);
+        } else if (!strcmp(member, "value")) {
+            hasValue = payload.readString(value);
+        } else {
+            return false;
+        }
+        return true;
+    });
+
+    if (!payload.isValid() || key.empty() || !hasValue) {
+        errorCode = "FormationViolation";
+        AO_DBG_WARN("Could not read key and value");
+        return true;
+    }
+
+    changeConfiguration(key.c_str(), value.c_str());
+    return true;
+}
+
+void ChangeConfiguration::changeConfiguration(const char *key, const char *value) {
+
     std::shared_ptr<AbstractConfiguration> configuration = getConfiguration(key);
 
     if (!configuration) {
@@ -163,14 +194,16 @@ void ChangeConfiguration::processReq(JsonObject payload) {
 
     //success
 
-    if (!configuration_save()) {
-        AO_DBG_ERR("could not write changes to flash");
-        errorCode = "InternalError";
-        return;
-    }
-
     if (configuration->requiresRebootWhenChanged()) {
+        //the new value must be on flash before the central system reboots the charger
+        if (!configuration_save()) {
+            AO_DBG_ERR("could not write changes to flash");
+            errorCode = "InternalError";
+            return;
+        }
         rebootRequired = true;
+    } else {
+        configuration_save_deferred(); //coalesce the writes of subsequent ChangeConfiguration requests
     }
 
     //success
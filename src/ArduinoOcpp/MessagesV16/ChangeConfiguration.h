@@ -18,6 +18,8 @@ private:
     bool notSupported = false;
 
     const char *errorCode = nullptr;
+
+    void changeConfiguration(const char *key, const char *value);
 public:
     ChangeConfiguration();
 
@@ -25,6 +27,8 @@ public:
 
     void processReq(JsonObject payload);
 
+    bool readReq(JsonReader& payload);
+
     std::unique_ptr<DynamicJsonDocument> createConf();
 
     const char *getErrorCode() {return errorCode;}
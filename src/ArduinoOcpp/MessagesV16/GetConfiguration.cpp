@@ -4,9 +4,80 @@
 
 #include <ArduinoOcpp/MessagesV16/GetConfiguration.h>
 #include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/JsonReader.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
 #include <ArduinoOcpp/Debug.h>
 
 using ArduinoOcpp::Ocpp16::GetConfiguration;
+using namespace ArduinoOcpp;
+
+namespace ArduinoOcpp {
+namespace Ocpp16 {
+namespace GetConfigurationUtils {
+
+/*
+ * The configurationKey array with all readable keys, serialized. The CSMS usually requests all keys after each
+ * reconnect, but the configurations rarely change in between
+ */
+struct AllKeysSnapshot {
+    std::string json;
+    uint32_t revision = 0;
+    bool valid = false;
+
+    void release() {
+        std::string().swap(json);
+        valid = false;
+    }
+};
+
+static AllKeysSnapshot allKeysSnapshot;
+
+static void writeAllKeys(JsonWriter& out) {
+    out.beginArray();
+    for (auto container = getConfigurationContainersBegin(); container != getConfigurationContainersEnd(); container++) {
+        for (auto config = (*container)->configurationsIteratorBegin(); config != (*container)->configurationsIteratorEnd(); config++) {
+            if ((*config)->permissionRemotePeerCanRead()) {
+                (*config)->writeOcppMsgEntry(out);
+            }
+        }
+    }
+    out.endArray();
+}
+
+//returns nullptr if the array cannot be cached
+static const std::string *getAllKeysSnapshot() {
+    auto revision = configuration_revision();
+    if (allKeysSnapshot.valid && allKeysSnapshot.revision == revision) {
+        return &allKeysSnapshot.json;
+    }
+
+    allKeysSnapshot.release(); //outdated
+
+    JsonWriter measure {nullptr, 0};
+    writeAllKeys(measure);
+    if (measure.getRequiredSize() > AO_GETCONFIGURATION_SNAPSHOT_MAX) {
+        return nullptr;
+    }
+
+    allKeysSnapshot.json.resize(measure.getRequiredSize());
+    JsonWriter writer {&allKeysSnapshot.json[0], allKeysSnapshot.json.size()};
+    writeAllKeys(writer);
+    if (!writer.isValid() || writer.getLength() == 0) {
+        allKeysSnapshot.release();
+        return nullptr;
+    }
+    allKeysSnapshot.json.resize(writer.getLength());
+
+    allKeysSnapshot.valid = true;
+    allKeysSnapshot.revision = revision;
+    return &allKeysSnapshot.json;
+}
+
+} //end namespace GetConfigurationUtils
+} //end namespace Ocpp16
+} //end namespace ArduinoOcpp
+
+using namespace ArduinoOcpp::Ocpp16::GetConfigurationUtils;
 
 GetConfiguration::GetConfiguration() {
 
@@ -24,6 +95,30 @@ void GetConfiguration::processReq(JsonObject payload) {
     }
 }
 
+bool GetConfiguration::readReq(JsonReader& payload) {
+
+    payload.readObject([&] (const char *member) {
+        if (!strcmp(member, "key")) {
+            payload.readArray([&] () {
+                std::string key;
+                if (payload.readString(key)) {
+                    keys.push_back(std::move(key));
+                }
+            });
+        } else {
+            return false;
+        }
+        return true;
+    });
+
+    if (!payload.isValid()) {
+        errorCode = "FormationViolation";
+        AO_DBG_WARN("Could not read keys");
+    }
+
+    return true;
+}
+
 std::unique_ptr<DynamicJsonDocument> GetConfiguration::createConf(){
 
     std::unique_ptr<std::vector<std::shared_ptr<AbstractConfiguration>>> configurationKeys;
@@ -82,3 +177,45 @@ std::unique_ptr<DynamicJsonDocument> GetConfiguration::createConf(){
 
     return doc;
 }
+
+bool GetConfiguration::writeConf(JsonWriter& payload) {
+
+    if (keys.size() == 0) { //return all existing keys
+        payload.beginObject();
+        payload.key("configurationKey");
+        if (auto snapshot = getAllKeysSnapshot()) {
+            payload.rawValue(snapshot->c_str(), snapshot->length());
+        } else {
+            writeAllKeys(payload);
+        }
+        payload.endObject();
+        return true;
+    }
+
+    //only return keys that were searched using the "key" parameter
+    std::vector<const char*> unknownKeys;
+    payload.beginObject();
+    payload.key("configurationKey");
+    payload.beginArray();
+    for (auto key = keys.begin(); key != keys.end(); key++) {
+        std::shared_ptr<AbstractConfiguration> entry = getConfiguration(key->c_str());
+        if (entry) {
+            entry->writeOcppMsgEntry(payload);
+        } else {
+            unknownKeys.push_back(key->c_str());
+        }
+    }
+    payload.endArray();
+
+    if (!unknownKeys.empty()) {
+        payload.key("unknownKey");
+        payload.beginArray();
+        for (auto key = unknownKeys.begin(); key != unknownKeys.end(); key++) {
+            payload.value(*key);
+        }
+        payload.endArray();
+    }
+
+    payload.endObject();
+    return true;
+}
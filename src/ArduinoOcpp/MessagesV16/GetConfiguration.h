@@ -9,12 +9,18 @@
 
 #include <vector>
 
+#ifndef AO_GETCONFIGURATION_SNAPSHOT_MAX
+#define AO_GETCONFIGURATION_SNAPSHOT_MAX 4096 //max size of the cached configurationKey array. Larger arrays are serialized on each request
+#endif
+
 namespace ArduinoOcpp {
 namespace Ocpp16 {
 
 class GetConfiguration : public OcppMessage {
 private:
     std::vector<std::string> keys;
+
+    const char *errorCode {nullptr};
 public:
     GetConfiguration();
 
@@ -22,8 +28,14 @@ public:
 
     void processReq(JsonObject payload);
 
+    bool readReq(JsonReader& payload);
+
     std::unique_ptr<DynamicJsonDocument> createConf();
 
+    bool writeConf(JsonWriter& payload);
+
+    const char *getErrorCode() {return errorCode;}
+
 };
 
 } //end namespace Ocpp16
@@ -4,11 +4,23 @@
 
 #include <ArduinoOcpp/MessagesV16/Heartbeat.h>
 #include <ArduinoOcpp/Core/OcppModel.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
+#include <ArduinoOcpp/Core/ObjectPool.h>
 #include <ArduinoOcpp/Debug.h>
 #include <string.h>
 
 using ArduinoOcpp::Ocpp16::Heartbeat;
 
+static ArduinoOcpp::ObjectPool<sizeof(Heartbeat), AO_MESSAGE_POOL_SIZE> heartbeatPool;
+
+void *Heartbeat::operator new(size_t size) {
+    return heartbeatPool.allocate(size);
+}
+
+void Heartbeat::operator delete(void *ptr) {
+    heartbeatPool.deallocate(ptr);
+}
+
 Heartbeat::Heartbeat()  {
   
 }
@@ -21,6 +33,12 @@ std::unique_ptr<DynamicJsonDocument> Heartbeat::createReq() {
     return createEmptyDocument();
 }
 
+bool Heartbeat::writeReq(JsonWriter& payload) {
+    payload.beginObject();
+    payload.endObject();
+    return true;
+}
+
 void Heartbeat::processConf(JsonObject payload) {
   
     const char* currentTime = payload["currentTime"] | "Invalid";
@@ -14,10 +14,15 @@ class Heartbeat : public OcppMessage {
 public:
     Heartbeat();
 
+    static void *operator new(size_t size); //pooled, see AO_MESSAGE_POOL_SIZE
+    static void operator delete(void *ptr);
+
     const char* getOcppOperationType();
 
     std::unique_ptr<DynamicJsonDocument> createReq();
 
+    bool writeReq(JsonWriter& payload) override;
+
     void processConf(JsonObject payload);
 
     void processReq(JsonObject payload);
@@ -7,9 +7,22 @@
 #include <ArduinoOcpp/Tasks/ChargePointStatus/ChargePointStatusService.h>
 #include <ArduinoOcpp/Tasks/Metering/MeterValue.h>
 #include <ArduinoOcpp/Tasks/Transactions/Transaction.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
+#include <ArduinoOcpp/Core/ObjectPool.h>
 #include <ArduinoOcpp/Debug.h>
 
 using ArduinoOcpp::Ocpp16::MeterValues;
+using ArduinoOcpp::ArenaJsonDocument;
+
+static ArduinoOcpp::ObjectPool<sizeof(MeterValues), AO_MESSAGE_POOL_SIZE> meterValuesPool;
+
+void *MeterValues::operator new(size_t size) {
+    return meterValuesPool.allocate(size);
+}
+
+void MeterValues::operator delete(void *ptr) {
+    meterValuesPool.deallocate(ptr);
+}
 
 #define ENERGY_METER_TIMEOUT_MS 30 * 1000  //after waiting for 30s, send MeterValues without missing readings
 
@@ -39,7 +52,7 @@ std::unique_ptr<DynamicJsonDocument> MeterValues::createReq() {
 
     size_t capacity = 0;
     
-    std::vector<std::unique_ptr<DynamicJsonDocument>> entries;
+    std::vector<std::unique_ptr<ArenaJsonDocument>> entries;
     for (auto value = meterValue.begin(); value != meterValue.end(); value++) {
         auto entry = (*value)->toJson();
         if (entry) {
@@ -70,6 +83,71 @@ std::unique_ptr<DynamicJsonDocument> MeterValues::createReq() {
     return doc;
 }
 
+bool MeterValues::writeReq(JsonWriter& payload) {
+    payload.beginObject();
+
+    payload.key("connectorId");
+    payload.value(connectorId);
+
+    if (transaction && !transaction->isSilent()) { //add txId if MVs are assigned to a tx with txId
+        payload.key("transactionId");
+        payload.value(transaction->getTransactionId());
+    }
+
+    payload.key("meterValue");
+    payload.beginArray();
+    for (auto value = meterValue.begin(); value != meterValue.end(); value++) {
+        auto checkpoint = payload.getCheckpoint();
+        if (!(*value)->writeJson(payload)) {
+            AO_DBG_ERR("Energy meter reading not convertible to JSON");
+            payload.rollback(checkpoint); //skip this entry
+        }
+    }
+    payload.endArray();
+
+    payload.endObject();
+    return true;
+}
+
+bool MeterValues::merge(OcppMessage& other, size_t maxSize) {
+    if (strcmp(other.getOcppOperationType(), getOcppOperationType())) {
+        return false;
+    }
+
+    MeterValues& otherMv = static_cast<MeterValues&>(other);
+
+    if (otherMv.connectorId != connectorId || otherMv.transaction != transaction) {
+        return false;
+    }
+
+    //measure the payload after merging
+    JsonWriter measure {nullptr, 0};
+    writeReq(measure);
+    size_t size = measure.getLength();
+    for (auto value = otherMv.meterValue.begin(); value != otherMv.meterValue.end(); value++) {
+        JsonWriter entry {nullptr, 0};
+        (*value)->writeJson(entry);
+        size += entry.getLength() + 1; //separator
+    }
+
+    if (size > maxSize) {
+        return false;
+    }
+
+    //append the later readings, so the meterValue list stays in chronological order
+    for (auto value = otherMv.meterValue.begin(); value != otherMv.meterValue.end(); value++) {
+        meterValue.push_back(std::move(*value));
+    }
+    otherMv.meterValue.clear();
+
+    invalidateReq();
+    return true;
+}
+
+bool MeterValues::isTransactionRelated() {
+    return transaction && !transaction->isSilent(); //same condition as for adding the txId
+}
+
 void MeterValues::processConf(JsonObject payload) {
     AO_DBG_DEBUG("Request has been confirmed");
 }
@@ -32,12 +32,21 @@ public:
 
     ~MeterValues();
 
+    static void *operator new(size_t size); //pooled, see AO_MESSAGE_POOL_SIZE
+    static void operator delete(void *ptr);
+
     const char* getOcppOperationType();
 
     void initiate() override;
 
     std::unique_ptr<DynamicJsonDocument> createReq();
 
+    bool writeReq(JsonWriter& payload) override;
+
+    bool merge(OcppMessage& other, size_t maxSize) override;
+
+    bool isTransactionRelated() override;
+
     void processConf(JsonObject payload);
 
     void processReq(JsonObject payload);
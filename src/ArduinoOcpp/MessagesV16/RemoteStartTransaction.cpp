@@ -8,6 +8,7 @@
 #include <ArduinoOcpp/Core/Configuration.h>
 #include <ArduinoOcpp/Tasks/ChargePointStatus/ChargePointStatusService.h>
 #include <ArduinoOcpp/Tasks/SmartCharging/SmartChargingService.h>
+#include <ArduinoOcpp/Core/JsonReader.h>
 #include <ArduinoOcpp/Debug.h>
 
 using ArduinoOcpp::Ocpp16::RemoteStartTransaction;
@@ -37,15 +38,63 @@ void RemoteStartTransaction::processReq(JsonObject payload) {
     if (payload.containsKey("chargingProfile")) {
         AO_DBG_INFO("Setting Charging profile via RemoteStartTransaction");
 
-        JsonObject chargingProfile = payload["chargingProfile"];
-        if ((chargingProfile["chargingProfileId"] | -1) < 0) {
+        JsonObject chargingProfileJson = payload["chargingProfile"];
+        if ((chargingProfileJson["chargingProfileId"] | -1) < 0) {
             AO_DBG_WARN("RemoteStartTx profile requires non-negative chargingProfileId");
-            errorCode = chargingProfile.containsKey("chargingProfileId") ? 
+            errorCode = chargingProfileJson.containsKey("chargingProfileId") ? 
                         "PropertyConstraintViolation" : "FormationViolation";
         }
-        chargingProfileDoc = DynamicJsonDocument(chargingProfile.memoryUsage()); //copy TxProfile
-        chargingProfileDoc.set(chargingProfile);
+        chargingProfile = std::unique_ptr<ChargingProfile>(new ChargingProfile(chargingProfileJson));
+
+        this->chargingProfileJson.resize(measureJson(chargingProfileJson));
+        serializeJson(chargingProfileJson, &this->chargingProfileJson[0], this->chargingProfileJson.length() + 1);
+    }
+}
+
+bool RemoteStartTransaction::readReq(JsonReader& payload) {
+    connectorId = -1;
+
+    payload.readObject([&] (const char *member) {
+        if (!strcmp(member, "connectorId")) {
+            payload.readInt(connectorId);
+        } else if (!strcmp(member, "idTag")) {
+            payload.readString(idTag, sizeof(idTag));
+        } else if (!strcmp(member, "chargingProfile")) {
+            AO_DBG_INFO("Setting Charging profile via RemoteStartTransaction");
+            payload.peek();
+            size_t jsonBegin = payload.getPosition();
+            chargingProfile = std::unique_ptr<ChargingProfile>(new ChargingProfile(payload));
+            chargingProfileJson.assign(payload.getInput() + jsonBegin, payload.getPosition() - jsonBegin);
+        } else {
+            return false;
+        }
+        return true;
+    });
+
+    if (!payload.isValid() || *idTag == '\0') {
+        AO_DBG_WARN("RemoteStartTx format violation");
+        errorCode = "FormationViolation";
+        chargingProfile.reset();
+        chargingProfileJson.clear();
+        return true;
+    }
+
+    if (chargingProfile && chargingProfile->getChargingProfileId() < 0) {
+        AO_DBG_WARN("RemoteStartTx profile requires non-negative chargingProfileId");
+
+        //same error codes as processReq(): missing id is a FormationViolation, negative id a PropertyConstraintViolation
+        bool hasChargingProfileId = false;
+        JsonReader profile {chargingProfileJson.c_str(), chargingProfileJson.length()};
+        profile.readObject([&] (const char *member) {
+            if (!strcmp(member, "chargingProfileId")) {
+                hasChargingProfileId = true;
+            }
+            return false;
+        });
+        errorCode = hasChargingProfileId ? "PropertyConstraintViolation" : "FormationViolation";
     }
+
+    return true;
 }
 
 std::unique_ptr<DynamicJsonDocument> RemoteStartTransaction::createConf(){
@@ -96,7 +145,7 @@ std::unique_ptr<DynamicJsonDocument> RemoteStartTransaction::createConf(){
 
                 *sRmtProfileId = -1;
                 AO_DBG_DEBUG("Cleared Charging Profile from previous RemoteStartTx: %s", ret ? "success" : "already cleared");
-                configuration_save();
+                configuration_save_deferred();
             }
         }
 
@@ -106,15 +155,16 @@ std::unique_ptr<DynamicJsonDocument> RemoteStartTransaction::createConf(){
             connector->beginSession(idTag);
         }
 
-        if (!chargingProfileDoc.isNull()
+        if (chargingProfile
                 && (ocppModel && ocppModel->getSmartChargingService())) {
             auto scService = ocppModel->getSmartChargingService();
 
-            JsonObject chargingProfile = chargingProfileDoc.as<JsonObject>();
-            scService->setChargingProfile(chargingProfile);
-            *sRmtProfileId = chargingProfile["chargingProfileId"].as<int>();
+            int chargingProfileId = chargingProfile->getChargingProfileId();
+            scService->setChargingProfile(std::move(chargingProfile), chargingProfileJson.c_str(), chargingProfileJson.length());
+            chargingProfileJson.clear();
+            *sRmtProfileId = chargingProfileId;
             AO_DBG_DEBUG("Charging Profile from RemoteStartTx set");
-            configuration_save();
+            configuration_save_deferred();
         }
 
         payload["status"] = "Accepted";
@@ -7,6 +7,9 @@
 
 #include <ArduinoOcpp/Core/OcppMessage.h>
 #include <ArduinoOcpp/MessagesV16/CiStrings.h>
+#include <ArduinoOcpp/Tasks/SmartCharging/SmartChargingModel.h>
+
+#include <string>
 
 namespace ArduinoOcpp {
 namespace Ocpp16 {
@@ -15,7 +18,8 @@ class RemoteStartTransaction : public OcppMessage {
 private:
     int connectorId;
     char idTag [IDTAG_LEN_MAX + 1] = {'\0'};
-    DynamicJsonDocument chargingProfileDoc {0};
+    std::unique_ptr<ChargingProfile> chargingProfile;
+    std::string chargingProfileJson; //as received. SmartChargingService stores it as it is
     
     const char *errorCode {nullptr};
 public:
@@ -29,6 +33,8 @@ public:
 
     void processReq(JsonObject payload);
 
+    bool readReq(JsonReader& payload);
+
     std::unique_ptr<DynamicJsonDocument> createConf();
 
     const char *getErrorCode() {return errorCode;}
@@ -5,6 +5,7 @@
 #include <ArduinoOcpp/MessagesV16/SetChargingProfile.h>
 #include <ArduinoOcpp/Core/OcppModel.h>
 #include <ArduinoOcpp/Tasks/SmartCharging/SmartChargingService.h>
+#include <ArduinoOcpp/Core/JsonReader.h>
 #include <ArduinoOcpp/Debug.h>
 
 using ArduinoOcpp::Ocpp16::SetChargingProfile;
@@ -38,6 +39,36 @@ void SetChargingProfile::processReq(JsonObject payload) {
     }
 }
 
+bool SetChargingProfile::readReq(JsonReader& payload) {
+
+    std::unique_ptr<ChargingProfile> csChargingProfiles;
+    size_t jsonBegin = 0, jsonEnd = 0; //raw input of csChargingProfiles which is stored as it is
+
+    payload.readObject([&] (const char *member) {
+        if (!strcmp(member, "csChargingProfiles")) {
+            payload.peek();
+            jsonBegin = payload.getPosition();
+            csChargingProfiles = std::unique_ptr<ChargingProfile>(new ChargingProfile(payload));
+            jsonEnd = payload.getPosition();
+            return true;
+        }
+        return false; //connectorId: multiple connectors are not supported yet for Smart Charging
+    });
+
+    if (!payload.isValid() || !csChargingProfiles) {
+        AO_DBG_WARN("Could not read csChargingProfiles");
+        errorCode = "FormationViolation";
+        return true;
+    }
+
+    if (ocppModel && ocppModel->getSmartChargingService()) {
+        auto smartChargingService = ocppModel->getSmartChargingService();
+        smartChargingService->setChargingProfile(std::move(csChargingProfiles), payload.getInput() + jsonBegin, jsonEnd - jsonBegin);
+    }
+
+    return true;
+}
+
 std::unique_ptr<DynamicJsonDocument> SetChargingProfile::createConf(){ //TODO review
     auto doc = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(JSON_OBJECT_SIZE(1)));
     JsonObject payload = doc->to<JsonObject>();
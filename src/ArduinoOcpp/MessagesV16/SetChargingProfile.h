@@ -13,6 +13,8 @@ namespace Ocpp16 {
 class SetChargingProfile : public OcppMessage {
 private:
     std::unique_ptr<DynamicJsonDocument> payloadToClient;
+
+    const char *errorCode {nullptr};
 public:
     SetChargingProfile();
 
@@ -24,11 +26,15 @@ public:
 
     void processReq(JsonObject payload);
 
+    bool readReq(JsonReader& payload);
+
     std::unique_ptr<DynamicJsonDocument> createConf();
 
     std::unique_ptr<DynamicJsonDocument> createReq();
 
     void processConf(JsonObject payload);
+
+    const char *getErrorCode() {return errorCode;}
 };
 
 } //end namespace Ocpp16
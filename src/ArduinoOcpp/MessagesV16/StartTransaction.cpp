@@ -5,6 +5,7 @@
 #include <ArduinoOcpp/MessagesV16/StartTransaction.h>
 #include <ArduinoOcpp/Core/OcppModel.h>
 #include <ArduinoOcpp/Core/OperationStore.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
 #include <ArduinoOcpp/Tasks/ChargePointStatus/ChargePointStatusService.h>
 #include <ArduinoOcpp/Tasks/Metering/MeteringService.h>
 #include <ArduinoOcpp/Tasks/Transactions/TransactionStore.h>
@@ -138,6 +139,33 @@ std::unique_ptr<DynamicJsonDocument> StartTransaction::createReq() {
     return doc;
 }
 
+bool StartTransaction::writeReq(JsonWriter& payload) {
+    payload.beginObject();
+
+    payload.key("connectorId");
+    payload.value(transaction->getConnectorId());
+
+    if (transaction->getIdTag() && *transaction->getIdTag()) {
+        payload.key("idTag");
+        payload.value(transaction->getIdTag());
+    }
+
+    if (transaction->isMeterStartDefined()) {
+        payload.key("meterStart");
+        payload.value(transaction->getMeterStart());
+    }
+
+    if (transaction->getStartTimestamp() > MIN_TIME) {
+        char timestamp[JSONDATE_LENGTH + 1] = {'\0'};
+        transaction->getStartTimestamp().toJsonString(timestamp, JSONDATE_LENGTH + 1);
+        payload.key("timestamp");
+        payload.value(timestamp);
+    }
+
+    payload.endObject();
+    return true;
+}
+
 void StartTransaction::processConf(JsonObject payload) {
 
     const char* idTagInfoStatus = payload["idTagInfo"]["status"] | "not specified";
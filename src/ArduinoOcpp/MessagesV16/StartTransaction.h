@@ -36,6 +36,8 @@ public:
 
     std::unique_ptr<DynamicJsonDocument> createReq();
 
+    bool writeReq(JsonWriter& payload) override;
+
     void processConf(JsonObject payload);
 
     void processReq(JsonObject payload);
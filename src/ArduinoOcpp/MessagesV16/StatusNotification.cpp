@@ -5,12 +5,24 @@
 #include <ArduinoOcpp/MessagesV16/StatusNotification.h>
 #include <ArduinoOcpp/Core/OcppModel.h>
 #include <ArduinoOcpp/Tasks/ChargePointStatus/ChargePointStatusService.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
+#include <ArduinoOcpp/Core/ObjectPool.h>
 #include <ArduinoOcpp/Debug.h>
 
 #include <string.h>
 
 using ArduinoOcpp::Ocpp16::StatusNotification;
 
+static ArduinoOcpp::ObjectPool<sizeof(StatusNotification), AO_MESSAGE_POOL_SIZE> statusNotificationPool;
+
+void *StatusNotification::operator new(size_t size) {
+    return statusNotificationPool.allocate(size);
+}
+
+void StatusNotification::operator delete(void *ptr) {
+    statusNotificationPool.deallocate(ptr);
+}
+
 //helper function
 namespace ArduinoOcpp {
 namespace Ocpp16 {
@@ -112,6 +124,34 @@ std::unique_ptr<DynamicJsonDocument> StatusNotification::createReq() {
 }
 
 
+bool StatusNotification::writeReq(JsonWriter& payload) {
+    payload.beginObject();
+
+    payload.key("connectorId");
+    payload.value(connectorId);
+
+    payload.key("errorCode");
+    if (errorCode != nullptr) {
+        payload.value(errorCode);
+    } else if (currentStatus == OcppEvseState::NOT_SET) {
+        AO_DBG_ERR("Reporting undefined status");
+        payload.value("InternalError");
+    } else {
+        payload.value("NoError");
+    }
+
+    payload.key("status");
+    payload.value(cstrFromOcppEveState(currentStatus));
+
+    char timestamp[JSONDATE_LENGTH + 1] = {'\0'};
+    otimestamp.toJsonString(timestamp, JSONDATE_LENGTH + 1);
+    payload.key("timestamp");
+    payload.value(timestamp);
+
+    payload.endObject();
+    return true;
+}
+
 void StatusNotification::processConf(JsonObject payload) {
     /*
     * Empty payload
@@ -23,12 +23,17 @@ public:
 
     StatusNotification(int connectorId = -1);
 
+    static void *operator new(size_t size); //pooled, see AO_MESSAGE_POOL_SIZE
+    static void operator delete(void *ptr);
+
     const char* getOcppOperationType();
 
     void initiate();
 
     std::unique_ptr<DynamicJsonDocument> createReq();
 
+    bool writeReq(JsonWriter& payload) override;
+
     void processConf(JsonObject payload);
 
     void processReq(JsonObject payload);
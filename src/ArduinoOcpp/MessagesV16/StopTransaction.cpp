@@ -5,6 +5,7 @@
 #include <ArduinoOcpp/MessagesV16/StopTransaction.h>
 #include <ArduinoOcpp/Core/OcppModel.h>
 #include <ArduinoOcpp/Core/OperationStore.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
 #include <ArduinoOcpp/Tasks/ChargePointStatus/ChargePointStatusService.h>
 #include <ArduinoOcpp/Tasks/Metering/MeteringService.h>
 #include <ArduinoOcpp/Tasks/Metering/MeterValue.h>
@@ -14,6 +15,7 @@
 
 using ArduinoOcpp::Ocpp16::StopTransaction;
 using ArduinoOcpp::TransactionRPC;
+using ArduinoOcpp::ArenaJsonDocument;
 
 StopTransaction::StopTransaction(std::shared_ptr<Transaction> transaction)
         : transaction(transaction) {
@@ -54,6 +56,9 @@ void StopTransaction::initiate() {
 
         transaction->commit();
     }
+
+    configuration_save(); //write deferred changes before the tx ends
+
     AO_DBG_INFO("StopTransaction initiated!");
 }
 
@@ -75,6 +80,8 @@ bool StopTransaction::initiate(StoredOperationHandler *opStore) {
 
     transaction->commit();
 
+    configuration_save(); //write deferred changes before the tx ends
+
     return true; //don't execute legacy initiate
 }
 
@@ -126,7 +133,7 @@ bool StopTransaction::restore(StoredOperationHandler *opStore) {
 
 std::unique_ptr<DynamicJsonDocument> StopTransaction::createReq() {
 
-    std::vector<std::unique_ptr<DynamicJsonDocument>> txDataJson;
+    std::vector<std::unique_ptr<ArenaJsonDocument>> txDataJson;
     size_t txDataJson_size = 0;
     for (auto mv = transactionData.begin(); mv != transactionData.end(); mv++) {
         auto mvJson = (*mv)->toJson();
@@ -137,7 +144,7 @@ std::unique_ptr<DynamicJsonDocument> StopTransaction::createReq() {
         txDataJson.emplace_back(std::move(mvJson));
     }
 
-    DynamicJsonDocument txDataDoc = DynamicJsonDocument(JSON_ARRAY_SIZE(txDataJson.size()) + txDataJson_size);
+    ArenaJsonDocument txDataDoc (JSON_ARRAY_SIZE(txDataJson.size()) + txDataJson_size);
     for (auto mvJson = txDataJson.begin(); mvJson != txDataJson.end(); mvJson++) {
         txDataDoc.add(**mvJson);
     }
@@ -177,6 +184,50 @@ std::unique_ptr<DynamicJsonDocument> StopTransaction::createReq() {
     return doc;
 }
 
+bool StopTransaction::writeReq(JsonWriter& payload) {
+    payload.beginObject();
+
+    if (transaction->getStopIdTag() && *transaction->getStopIdTag()) {
+        payload.key("idTag");
+        payload.value(transaction->getStopIdTag());
+    }
+
+    if (transaction->isMeterStopDefined()) {
+        payload.key("meterStop");
+        payload.value(transaction->getMeterStop());
+    }
+
+    if (transaction->getStopTimestamp() > MIN_TIME) {
+        char timestamp [JSONDATE_LENGTH + 1] = {'\0'};
+        transaction->getStopTimestamp().toJsonString(timestamp, JSONDATE_LENGTH + 1);
+        payload.key("timestamp");
+        payload.value(timestamp);
+    }
+
+    payload.key("transactionId");
+    payload.value(transaction->getTransactionId());
+
+    if (transaction->getStopReason() && *transaction->getStopReason()) {
+        payload.key("reason");
+        payload.value(transaction->getStopReason());
+    }
+
+    if (!transactionData.empty()) {
+        payload.key("transactionData");
+        payload.beginArray();
+        for (auto mv = transactionData.begin(); mv != transactionData.end(); mv++) {
+            if (!(*mv)->writeJson(payload)) {
+                payload.setError();
+                return true;
+            }
+        }
+        payload.endArray();
+    }
+
+    payload.endObject();
+    return true;
+}
+
 void StopTransaction::processConf(JsonObject payload) {
 
     if (transaction) {
@@ -41,6 +41,8 @@ public:
 
     std::unique_ptr<DynamicJsonDocument> createReq() override;
 
+    bool writeReq(JsonWriter& payload) override;
+
     void processConf(JsonObject payload) override;
 
     bool processErr(const char *code, const char *description, JsonObject details) override;
@@ -32,6 +32,7 @@
 #include <ArduinoOcpp/Debug.h>
 
 #include <string.h>
+#include <stdint.h>
 #include <algorithm>
 #include <vector>
 
@@ -183,12 +184,147 @@ void registerCustomOcppMessage(const char *messageType, OcppMessageCreator ocppM
     customMessagesRegistry.push_back(entry);
 }
 
+/*
+ * Registry of the built-in operations. The action names are mapped to their entries by a perfect hash function
+ * which is checked at compile time, i.e. a lookup takes one hash computation, one table access and one strcmp.
+ * 
+ * When adding an entry leads to a collision, change AO_OPREGISTRY_SEED or increase AO_OPREGISTRY_SIZE
+ */
+
+#define AO_OPREGISTRY_SIZE 64 //number of hash slots. Must be a power of 2 and not larger than 64
+#define AO_OPREGISTRY_SEED 15
+
+namespace {
+
+template<class T>
+OcppMessage *createOcppMessage(int) {
+    return new T();
+}
+
+OcppMessage *createAuthorize(int) {
+    return new Ocpp16::Authorize("A0-00-00-00"); //send default idTag
+}
+
+OcppMessage *createStatusNotification(int connectorId) {
+    return new Ocpp16::StatusNotification(connectorId);
+}
+
+struct OperationEntry {
+    const char *action;
+    OcppMessage *(*create)(int connectorId);
+    OnReceiveReqListener *onReceiveReq;
+    OnSendConfListener *onSendConf;
+    bool readsStream; //message implements readReq()
+};
+
+constexpr OperationEntry operationEntries [] = {
+    {"Authorize",                     createAuthorize,                                          &onAuthorizeRequest,                     nullptr,                           false},
+    {"BootNotification",              createOcppMessage<Ocpp16::BootNotification>,              &onBootNotificationRequest,              nullptr,                           false},
+    {"GetCompositeSchedule",          createOcppMessage<Ocpp16::GetCompositeSchedule>,          nullptr,                                 nullptr,                           false},
+    {"Heartbeat",                     createOcppMessage<Ocpp16::Heartbeat>,                     nullptr,                                 nullptr,                           false},
+    {"MeterValues",                   createOcppMessage<Ocpp16::MeterValues>,                   &onMeterValuesReceiveReq,                nullptr,                           false},
+    {"SetChargingProfile",            createOcppMessage<Ocpp16::SetChargingProfile>,            &onSetChargingProfileRequest,            nullptr,                           true },
+    {"StatusNotification",            createStatusNotification,                                 nullptr,                                 nullptr,                           false},
+    {"StartTransaction",              createOcppMessage<Ocpp16::StartTransaction>,              &onStartTransactionRequest,              nullptr,                           false},
+    {"StopTransaction",               createOcppMessage<Ocpp16::StopTransaction>,               nullptr,                                 nullptr,                           false},
+    {"TriggerMessage",                createOcppMessage<Ocpp16::TriggerMessage>,                &onTriggerMessageRequest,                nullptr,                           false},
+    {"RemoteStartTransaction",        createOcppMessage<Ocpp16::RemoteStartTransaction>,        &onRemoteStartTransactionReceiveRequest, &onRemoteStartTransactionSendConf, true },
+    {"RemoteStopTransaction",         createOcppMessage<Ocpp16::RemoteStopTransaction>,         &onRemoteStopTransactionReceiveRequest,  &onRemoteStopTransactionSendConf,  false},
+    {"ChangeConfiguration",           createOcppMessage<Ocpp16::ChangeConfiguration>,           &onChangeConfigurationReceiveReq,        &onChangeConfigurationSendConf,    true },
+    {"GetConfiguration",              createOcppMessage<Ocpp16::GetConfiguration>,              &onGetConfigurationReceiveReq,           &onGetConfigurationSendConf,       true },
+    {"Reset",                         createOcppMessage<Ocpp16::Reset>,                         &onResetReceiveReq,                      &onResetSendConf,                  false},
+    {"UpdateFirmware",                createOcppMessage<Ocpp16::UpdateFirmware>,                &onUpdateFirmwareReceiveReq,             nullptr,                           false},
+    {"FirmwareStatusNotification",    createOcppMessage<Ocpp16::FirmwareStatusNotification>,    nullptr,                                 nullptr,                           false},
+    {"GetDiagnostics",                createOcppMessage<Ocpp16::GetDiagnostics>,                nullptr,                                 nullptr,                           false},
+    {"DiagnosticsStatusNotification", createOcppMessage<Ocpp16::DiagnosticsStatusNotification>, nullptr,                                 nullptr,                           false},
+    {"UnlockConnector",               createOcppMessage<Ocpp16::UnlockConnector>,               nullptr,                                 nullptr,                           false},
+    {"ClearChargingProfile",          createOcppMessage<Ocpp16::ClearChargingProfile>,          nullptr,                                 nullptr,                           false},
+    {"ChangeAvailability",            createOcppMessage<Ocpp16::ChangeAvailability>,            nullptr,                                 nullptr,                           false},
+    {"ClearCache",                    createOcppMessage<Ocpp16::ClearCache>,                    nullptr,                                 nullptr,                           false},
+};
+
+constexpr size_t operationEntriesSize = sizeof(operationEntries) / sizeof(operationEntries[0]);
+
+//FNV-1a with custom offset basis. Compile-time version
+constexpr uint32_t hashAction(const char *action, uint32_t hash = 2166136261U + AO_OPREGISTRY_SEED) {
+    return *action ? hashAction(action + 1, (hash ^ (uint8_t) *action) * 16777619U) : hash;
+}
+
+//FNV-1a with custom offset basis. Run-time version; must give the same results as hashAction
+uint32_t hashActionRuntime(const char *action) {
+    uint32_t hash = 2166136261U + AO_OPREGISTRY_SEED;
+    for (; *action; action++) {
+        hash ^= (uint8_t) *action;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+constexpr size_t slotOf(size_t entry) {
+    return hashAction(operationEntries[entry].action) & (AO_OPREGISTRY_SIZE - 1);
+}
+
+//walks through the entries once and collects the occupied slots in a bitmask
+constexpr bool hasCollision(size_t entry = 0, uint64_t occupied = 0) {
+    return entry >= operationEntriesSize ? false :
+           (occupied & ((uint64_t) 1 << slotOf(entry))) ||
+           hasCollision(entry + 1, occupied | ((uint64_t) 1 << slotOf(entry)));
+}
+
+static_assert(operationEntriesSize < AO_OPREGISTRY_SIZE && AO_OPREGISTRY_SIZE <= 64 && (AO_OPREGISTRY_SIZE & (AO_OPREGISTRY_SIZE - 1)) == 0,
+        "AO_OPREGISTRY_SIZE must be a power of 2, not larger than 64 and larger than the number of entries");
+static_assert(!hasCollision(), "action names collide in operation registry. Change AO_OPREGISTRY_SEED");
+
+//index into operationEntries for each hash slot; -1 if the slot is empty
+constexpr int entryAt(size_t slot, size_t entry = 0) {
+    return entry >= operationEntriesSize ? -1 :
+           slotOf(entry) == slot ? (int) entry :
+           entryAt(slot, entry + 1);
+}
+
+template<size_t... Slots>
+struct IndexSequence { };
+
+template<size_t N, size_t... Slots>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, Slots...> { };
+
+template<size_t... Slots>
+struct MakeIndexSequence<0, Slots...> {
+    using type = IndexSequence<Slots...>;
+};
+
+template<class Sequence>
+struct SlotTable;
+
+template<size_t... Slots>
+struct SlotTable<IndexSequence<Slots...>> {
+    static const int8_t entries [sizeof...(Slots)];
+};
+
+template<size_t... Slots>
+const int8_t SlotTable<IndexSequence<Slots...>>::entries [sizeof...(Slots)] = {entryAt(Slots)...};
+
+using OperationSlots = SlotTable<MakeIndexSequence<AO_OPREGISTRY_SIZE>::type>;
+
+const OperationEntry *findOperationEntry(const char *action) {
+    int entry = OperationSlots::entries[hashActionRuntime(action) & (AO_OPREGISTRY_SIZE - 1)];
+    if (entry < 0 || strcmp(operationEntries[entry].action, action)) {
+        return nullptr;
+    }
+    return &operationEntries[entry];
+}
+
+} //end anonymous namespace
+
 void simpleOcppFactory_deinitialize() {
     customMessagesRegistry.clear();
     toBeDeinitialized.clear();
 }
 
 CustomOcppMessageCreatorEntry *makeCustomOcppMessage(const char *messageType) {
+    if (customMessagesRegistry.empty()) {
+        return nullptr;
+    }
     for (auto it = customMessagesRegistry.begin(); it != customMessagesRegistry.end(); ++it) {
         if (!strcmp(it->messageType, messageType)) {
             return &(*it);
@@ -197,81 +333,44 @@ CustomOcppMessageCreatorEntry *makeCustomOcppMessage(const char *messageType) {
     return nullptr;
 }
 
+bool isStreamableOperation(const char *messageType) {
+    if (!messageType) {
+        return false;
+    }
+
+    if (CustomOcppMessageCreatorEntry *entry = makeCustomOcppMessage(messageType)) {
+        return !entry->onReceiveReq; //listener needs the payload as JsonObject
+    } else if (const OperationEntry *entry = findOperationEntry(messageType)) {
+        return entry->readsStream && !(entry->onReceiveReq && *entry->onReceiveReq);
+    }
+    return false;
+}
+
 std::unique_ptr<OcppOperation> makeFromJson(const JsonDocument& json) {
     const char* messageType = json[2];
     return makeOcppOperation(messageType);
 }
 
 std::unique_ptr<OcppOperation> makeOcppOperation(const char *messageType, int connectorId) {
+    if (!messageType) {
+        AO_DBG_ERR("invalid argument");
+        return nullptr;
+    }
+
     auto operation = makeOcppOperation();
     auto msg = std::unique_ptr<OcppMessage>{nullptr};
 
     if (CustomOcppMessageCreatorEntry *entry = makeCustomOcppMessage(messageType)) {
         msg = std::unique_ptr<OcppMessage>(entry->creator());
         operation->setOnReceiveReqListener(entry->onReceiveReq);
-    } else if (!strcmp(messageType, "Authorize")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::Authorize("A0-00-00-00")); //send default idTag
-        operation->setOnReceiveReqListener(onAuthorizeRequest);
-    } else if (!strcmp(messageType, "BootNotification")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::BootNotification());
-        operation->setOnReceiveReqListener(onBootNotificationRequest);
-    } else if (!strcmp(messageType, "GetCompositeSchedule")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::GetCompositeSchedule());
-    } else if (!strcmp(messageType, "Heartbeat")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::Heartbeat());
-    } else if (!strcmp(messageType, "MeterValues")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::MeterValues());
-        operation->setOnReceiveReqListener(onMeterValuesReceiveReq);
-    } else if (!strcmp(messageType, "SetChargingProfile")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::SetChargingProfile());
-        operation->setOnReceiveReqListener(onSetChargingProfileRequest);
-    } else if (!strcmp(messageType, "StatusNotification")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::StatusNotification(connectorId));
-    } else if (!strcmp(messageType, "StartTransaction")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::StartTransaction());
-        operation->setOnReceiveReqListener(onStartTransactionRequest);
-    } else if (!strcmp(messageType, "StopTransaction")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::StopTransaction());
-    } else if (!strcmp(messageType, "TriggerMessage")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::TriggerMessage());
-        operation->setOnReceiveReqListener(onTriggerMessageRequest);
-    } else if (!strcmp(messageType, "RemoteStartTransaction")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::RemoteStartTransaction());
-        operation->setOnReceiveReqListener(onRemoteStartTransactionReceiveRequest);
-        operation->setOnSendConfListener(onRemoteStartTransactionSendConf);
-    } else if (!strcmp(messageType, "RemoteStopTransaction")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::RemoteStopTransaction());
-        operation->setOnReceiveReqListener(onRemoteStopTransactionReceiveRequest);
-        operation->setOnSendConfListener(onRemoteStopTransactionSendConf);
-    } else if (!strcmp(messageType, "ChangeConfiguration")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::ChangeConfiguration());
-        operation->setOnReceiveReqListener(onChangeConfigurationReceiveReq);
-        operation->setOnSendConfListener(onChangeConfigurationSendConf);
-    } else if (!strcmp(messageType, "GetConfiguration")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::GetConfiguration());
-        operation->setOnReceiveReqListener(onGetConfigurationReceiveReq);
-        operation->setOnSendConfListener(onGetConfigurationSendConf);
-    } else if (!strcmp(messageType, "Reset")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::Reset());
-        operation->setOnReceiveReqListener(onResetReceiveReq);
-        operation->setOnSendConfListener(onResetSendConf);
-    } else if (!strcmp(messageType, "UpdateFirmware")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::UpdateFirmware());
-        operation->setOnReceiveReqListener(onUpdateFirmwareReceiveReq);
-    } else if (!strcmp(messageType, "FirmwareStatusNotification")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::FirmwareStatusNotification());
-    } else if (!strcmp(messageType, "GetDiagnostics")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::GetDiagnostics());
-    } else if (!strcmp(messageType, "DiagnosticsStatusNotification")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::DiagnosticsStatusNotification());
-    } else if (!strcmp(messageType, "UnlockConnector")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::UnlockConnector());
-    } else if (!strcmp(messageType, "ClearChargingProfile")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::ClearChargingProfile());
-    } else if (!strcmp(messageType, "ChangeAvailability")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::ChangeAvailability());
-    } else if (!strcmp(messageType, "ClearCache")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::ClearCache());
+    } else if (const OperationEntry *entry = findOperationEntry(messageType)) {
+        msg = std::unique_ptr<OcppMessage>(entry->create(connectorId));
+        if (entry->onReceiveReq) {
+            operation->setOnReceiveReqListener(*entry->onReceiveReq);
+        }
+        if (entry->onSendConf) {
+            operation->setOnSendConfListener(*entry->onSendConf);
+        }
     } else {
         AO_DBG_WARN("Operation not supported");
         msg = std::unique_ptr<OcppMessage>(new NotImplemented());
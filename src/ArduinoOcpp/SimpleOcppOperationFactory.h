@@ -22,6 +22,8 @@ std::unique_ptr<OcppOperation> makeOcppOperation(OcppMessage *msg);
 
 std::unique_ptr<OcppOperation> makeOcppOperation(const char *actionCode, int connectorId = -1);
 
+bool isStreamableOperation(const char *actionCode); //true if the request can be read without JsonDocument (see OcppMessage::readReq)
+
 void registerCustomOcppMessage(const char *messageType, OcppMessageCreator ocppMessageCreator, OnReceiveReqListener onReceiveReq = NULL);
 
 void setOnAuthorizeRequestListener(OnReceiveReqListener onReceiveReq);
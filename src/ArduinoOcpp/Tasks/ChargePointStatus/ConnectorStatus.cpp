@@ -156,7 +156,7 @@ OcppMessage *ConnectorStatus::loop() {
     if (!isTransactionRunning()) {
         if (*availability == AVAILABILITY_INOPERATIVE_SCHEDULED) {
             *availability = AVAILABILITY_INOPERATIVE;
-            configuration_save();
+            configuration_save_deferred();
         }
         if (availabilityVolatile == AVAILABILITY_INOPERATIVE_SCHEDULED) {
             availabilityVolatile = AVAILABILITY_INOPERATIVE;
@@ -571,7 +571,7 @@ void ConnectorStatus::setAvailability(bool available) {
             *availability = AVAILABILITY_INOPERATIVE;
         }
     }
-    configuration_save();
+    configuration_save_deferred();
 }
 
 void ConnectorStatus::setAvailabilityVolatile(bool available) {
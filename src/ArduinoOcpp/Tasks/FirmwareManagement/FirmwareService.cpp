@@ -254,7 +254,7 @@ std::unique_ptr<OcppOperation> FirmwareService::getFirmwareStatusNotification()
         if (strncmp(buildNumber, *previousBuildNumber, buildNoSize)) {
             //new FW
             previousBuildNumber->setValue(buildNumber, strlen(buildNumber) + 1);
-            configuration_save();
+            configuration_save_deferred();
 
             lastReportedStatus = FirmwareStatus::Installed;
             OcppMessage *fwNotificationMsg = new Ocpp16::FirmwareStatusNotification(lastReportedStatus);
@@ -5,19 +5,19 @@
 #include <ArduinoOcpp/Tasks/Heartbeat/HeartbeatService.h>
 #include <ArduinoOcpp/Core/OcppEngine.h>
 #include <ArduinoOcpp/SimpleOcppOperationFactory.h>
-#include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/StandardConfiguration.h>
 #include <ArduinoOcpp/MessagesV16/Heartbeat.h>
 #include <ArduinoOcpp/Platform.h>
 
 using namespace ArduinoOcpp;
+using namespace ArduinoOcpp::Ocpp16;
 
 HeartbeatService::HeartbeatService(OcppEngine& context) : context(context) {
-    heartbeatInterval = declareConfiguration("HeartbeatInterval", 86400);
     lastHeartbeat = ao_tick_ms();
 }
 
 void HeartbeatService::loop() {
-    unsigned long hbInterval = *heartbeatInterval;
+    unsigned long hbInterval = standardConfigurations.HeartbeatInterval;
     hbInterval *= 1000UL; //conversion s -> ms
     unsigned long now = ao_tick_ms();
 
@@ -17,7 +17,6 @@ private:
     OcppEngine& context;
 
     unsigned long lastHeartbeat;
-    std::shared_ptr<ArduinoOcpp::Configuration<int>> heartbeatInterval;
 
 public:
     HeartbeatService(OcppEngine& context);
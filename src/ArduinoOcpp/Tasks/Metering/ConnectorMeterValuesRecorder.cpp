@@ -8,6 +8,7 @@
 #include <ArduinoOcpp/Core/OcppModel.h>
 #include <ArduinoOcpp/Tasks/ChargePointStatus/ChargePointStatusService.h>
 #include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/StandardConfiguration.h>
 #include <ArduinoOcpp/MessagesV16/MeterValues.h>
 #include <ArduinoOcpp/Platform.h>
 #include <ArduinoOcpp/Debug.h>
@@ -28,7 +29,6 @@ ConnectorMeterValuesRecorder::ConnectorMeterValuesRecorder(OcppModel& context, i
     );
     declareConfiguration<int>("MeterValuesSampledDataMaxLength", 8, CONFIGURATION_VOLATILE, false, true, false, false);
     MeterValueCacheSize = declareConfiguration("AO_MeterValueCacheSize", 1, CONFIGURATION_FN, true, true, true, false);
-    MeterValueSampleInterval = declareConfiguration("MeterValueSampleInterval", 60);
     
     auto StopTxnSampledData = declareConfiguration<const char*>(
         "StopTxnSampledData",
@@ -45,7 +45,6 @@ ConnectorMeterValuesRecorder::ConnectorMeterValuesRecorder(OcppModel& context, i
         true,true,true,false
     );
     declareConfiguration<int>("MeterValuesAlignedDataMaxLength", 8, CONFIGURATION_VOLATILE, false, true, false, false);
-    ClockAlignedDataInterval  = declareConfiguration("ClockAlignedDataInterval", 0);
     
     auto StopTxnAlignedData = declareConfiguration<const char*>(
         "StopTxnAlignedData",
@@ -142,12 +141,12 @@ OcppMessage *ConnectorMeterValuesRecorder::loop() {
         }
     }
 
-    if (*ClockAlignedDataInterval >= 1) {
+    if (standardConfigurations.ClockAlignedDataInterval >= 1) {
 
         auto& timestampNow = context.getOcppTime().getOcppTimestampNow();
         auto dt = nextAlignedTime - timestampNow;
         if (dt <= 0 ||                              //normal case: interval elapsed
-                dt > *ClockAlignedDataInterval) {   //special case: clock has been adjusted or first run
+                dt > standardConfigurations.ClockAlignedDataInterval) {   //special case: clock has been adjusted or first run
 
             AO_DBG_DEBUG("Clock aligned measurement %ds: %s", dt,
                 abs(dt) <= 60 ?
@@ -171,22 +170,22 @@ OcppMessage *ConnectorMeterValuesRecorder::loop() {
             auto intervall = timestampNow - midnightBase;
             intervall %= 3600 * 24;
             OcppTimestamp midnight = timestampNow - intervall;
-            intervall += *ClockAlignedDataInterval;
+            intervall += standardConfigurations.ClockAlignedDataInterval;
             if (intervall >= 3600 * 24) {
                 //next measurement is tomorrow; set to precisely 00:00 
                 nextAlignedTime = midnight;
                 nextAlignedTime += 3600 * 24;
             } else {
-                intervall /= *ClockAlignedDataInterval;
-                nextAlignedTime = midnight + (intervall * *ClockAlignedDataInterval);
+                intervall /= standardConfigurations.ClockAlignedDataInterval;
+                nextAlignedTime = midnight + (intervall * standardConfigurations.ClockAlignedDataInterval);
             }
         }
     }
 
-    if (*MeterValueSampleInterval >= 1) {
+    if (standardConfigurations.MeterValueSampleInterval >= 1) {
         //record periodic tx data
 
-        if (ao_tick_ms() - lastSampleTime >= (unsigned long) (*MeterValueSampleInterval * 1000)) {
+        if (ao_tick_ms() - lastSampleTime >= (unsigned long) (standardConfigurations.MeterValueSampleInterval * 1000)) {
             auto sampleMeterValues = sampledDataBuilder->takeSample(context.getOcppTime().getOcppTimestampNow(), ReadingContext::SamplePeriodic);
             if (sampleMeterValues) {
                 meterData.push_back(std::move(sampleMeterValues));
@@ -202,7 +201,7 @@ OcppMessage *ConnectorMeterValuesRecorder::loop() {
         }   
     }
 
-    if (*ClockAlignedDataInterval < 1 && *MeterValueSampleInterval < 1) {
+    if (standardConfigurations.ClockAlignedDataInterval < 1 && standardConfigurations.MeterValueSampleInterval < 1) {
         meterData.clear();
     }
 
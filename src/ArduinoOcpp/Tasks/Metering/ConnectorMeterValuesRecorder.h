@@ -53,11 +53,8 @@ private:
     std::vector<std::unique_ptr<SampledValueSampler>> samplers;
     int energySamplerIndex {-1};
 
-    std::shared_ptr<Configuration<int>> MeterValueSampleInterval;
     std::shared_ptr<Configuration<int>> MeterValueCacheSize;
 
-    std::shared_ptr<Configuration<int>> ClockAlignedDataInterval;
-
     std::shared_ptr<Configuration<bool>> MeterValuesInTxOnly;
     std::shared_ptr<Configuration<bool>> StopTxnDataCapturePeriodic;
 public:
@@ -3,7 +3,11 @@
 // MIT License
 
 #include <ArduinoOcpp/Tasks/Metering/MeterStore.h>
+#include <ArduinoOcpp/Tasks/Transactions/TransactionStore.h>
 #include <ArduinoOcpp/Core/FilesystemUtils.h>
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
+#include <ArduinoOcpp/Core/MemoryArena.h>
+#include <ArduinoOcpp/Core/RecordCodec.h>
 
 #include <ArduinoOcpp/Debug.h>
 
@@ -13,10 +17,41 @@
 #define AO_METERSTORE_DIR AO_FILENAME_PREFIX "/"
 #endif
 
-#define AO_MAX_STOPTXDATA_LEN 4
+#ifndef AO_METERSTORE_FORMAT
+#define AO_METERSTORE_FORMAT AO_STORAGE_MSGPACK
+#endif
 
 using namespace ArduinoOcpp;
 
+namespace ArduinoOcpp {
+namespace MeterStoreUtils {
+
+uint32_t makeManifestKey(unsigned int connectorId, unsigned int txNr) {
+    return connectorId * MAX_TX_CNT + txNr;
+}
+
+constexpr RecordCodec meterLogRecords {false};
+
+//appends the framed sample to out
+bool encodeRecord(std::vector<unsigned char>& out, char type, MeterValue& mv) {
+    auto mvJson = mv.toJson();
+    if (!mvJson) {
+        AO_DBG_ERR("MV not ready yet");
+        return false;
+    }
+
+    if (!meterLogRecords.appendDocument(out, type, *mvJson, static_cast<StorageFormat>(AO_METERSTORE_FORMAT))) {
+        AO_DBG_ERR("cannot serialize MV");
+        return false;
+    }
+    return true;
+}
+
+} //end namespace MeterStoreUtils
+} //end namespace ArduinoOcpp
+
+using namespace ArduinoOcpp::MeterStoreUtils;
+
 TransactionMeterData::TransactionMeterData(unsigned int connectorId, unsigned int txNr, std::shared_ptr<FilesystemAdapter> filesystem)
         : connectorId(connectorId), txNr(txNr), filesystem{filesystem} {
     
@@ -24,6 +59,72 @@ TransactionMeterData::TransactionMeterData(unsigned int connectorId, unsigned in
         AO_DBG_DEBUG("volatile mode");
         (void)0;
     }
+
+    writeFailed = std::make_shared<bool>(false);
+}
+
+TransactionMeterData::~TransactionMeterData() {
+    if (filesystem) {
+        persistence_flush(); //the completion callbacks refer to this object
+    }
+}
+
+bool TransactionMeterData::makeFn(char *fn) {
+    auto ret = snprintf(fn, MAX_PATH_SIZE, AO_METERSTORE_DIR "sd" "-%u-%u.log", connectorId, txNr);
+    if (ret < 0 || ret >= MAX_PATH_SIZE) {
+        AO_DBG_ERR("fn error: %i", ret);
+        return false;
+    }
+    return true;
+}
+
+bool TransactionMeterData::writeRecords(std::shared_ptr<std::vector<unsigned char>> records, bool truncate) {
+    char fn [MAX_PATH_SIZE] = {'\0'};
+    if (!makeFn(fn)) {
+        return false;
+    }
+
+    //the write may be deferred (see PersistenceExecutor), so records is a heap copy
+    auto filesystem = this->filesystem;
+    auto failed = writeFailed;
+    return persist([filesystem, fn, records, truncate, failed] () {
+                if (*failed && !truncate) {
+                    return false; //a previous record is missing
+                }
+                auto file = filesystem->open(fn, truncate ? "w" : "a");
+                if (!file || file->write((const char*) records->data(), records->size()) != records->size()) {
+                    AO_DBG_ERR("write error %s", fn);
+                    *failed = true;
+                    return false;
+                }
+                if (truncate) {
+                    *failed = false;
+                }
+                return true;
+            }, [this] (bool success) {
+                if (!success) {
+                    //rewrite the log with the next sample
+                    rewriteRequired = true;
+                }
+            });
+}
+
+bool TransactionMeterData::rewriteLog() {
+    auto records = std::make_shared<std::vector<unsigned char>>();
+    for (auto& mv : txData) {
+        if (!encodeRecord(*records, 'A', *mv)) {
+            return false;
+        }
+    }
+
+    if (!writeRecords(records, true)) {
+        return false;
+    }
+
+    nRecords = txData.size();
+    rewriteRequired = false;
+    AO_DBG_DEBUG("rewrote sd log with %u records", nRecords);
+    return true;
 }
 
 bool TransactionMeterData::addTxData(std::unique_ptr<MeterValue> mv) {
@@ -42,45 +143,45 @@ bool TransactionMeterData::addTxData(std::unique_ptr<MeterValue> mv) {
         return true;
     }
 
-    bool replaceLast = mvCount >= AO_MAX_STOPTXDATA_LEN; //txData size exceeded? overwrite last entry instead of appending
+    bool replaceLast = txData.size() >= AO_MAX_STOPTXDATA_LEN; //txData size exceeded? overwrite last entry instead of appending
 
-    if (filesystem) {
+    std::unique_ptr<MeterValue> replaced;
+    if (replaceLast) {
+        replaced = std::move(txData.back());
+        txData.back() = std::move(mv);
+    } else {
+        txData.push_back(std::move(mv));
+    }
 
-        unsigned int mvIndex = 0;
-        if (replaceLast) {
-            mvIndex = mvCount - 1;
+    if (filesystem) {
+        bool success = false;
+        if (rewriteRequired || nRecords >= AO_METERLOG_MAX_RECORDS) {
+            //drop the outdated records
+            success = rewriteLog();
         } else {
-            mvIndex = mvCount ;
-        }
-
-        char fn [MAX_PATH_SIZE] = {'\0'};
-        auto ret = snprintf(fn, MAX_PATH_SIZE, AO_METERSTORE_DIR "sd" "-%u-%u-%u.jsn", connectorId, txNr, mvIndex);
-        if (ret < 0 || ret >= MAX_PATH_SIZE) {
-            AO_DBG_ERR("fn error: %i", ret);
-            return false;
-        }
-
-        auto mvDoc = mv->toJson();
-        if (!mvDoc) {
-            AO_DBG_ERR("MV not ready yet");
-            return false;
+            auto record = std::make_shared<std::vector<unsigned char>>();
+            success = encodeRecord(*record, replaceLast ? 'R' : 'A', *txData.back()) &&
+                      writeRecords(record, false);
+            if (success) {
+                nRecords++;
+            }
         }
 
-        if (!FilesystemUtils::storeJson(filesystem, fn, *mvDoc)) {
+        if (!success) {
             AO_DBG_ERR("FS error");
+            //undo
+            if (replaceLast) {
+                txData.back() = std::move(replaced);
+            } else {
+                txData.pop_back();
+            }
             return false;
         }
-
-        if (!replaceLast) {
-            mvCount++;
-        }
     }
 
     if (replaceLast) {
-        txData.back() = std::move(mv);
         AO_DBG_DEBUG("updated latest sd");
     } else {
-        txData.push_back(std::move(mv));
         AO_DBG_DEBUG("added sd");
     }
     return true;
@@ -102,24 +203,119 @@ bool TransactionMeterData::restore(MeterValueBuilder& mvBuilder) {
         return true;
     }
 
-    const unsigned int MISSES_LIMIT = 3;
-    unsigned int misses = 0;
+    char fn [MAX_PATH_SIZE] = {'\0'};
+    if (!makeFn(fn)) {
+        return false;
+    }
+
+    persistence_flush(); //the log may have pending records
+
+    size_t fsize = 0;
+    if (filesystem->stat(fn, &fsize) != 0) {
+        return true; //no log yet
+    }
+
+    auto file = filesystem->open(fn, "r");
+    if (!file) {
+        AO_DBG_ERR("cannot open %s", fn);
+        return false;
+    }
+
+    char buf [AO_FILE_BUFSIZE];
+    ArduinoJsonFileReader reader {file.get(), buf, sizeof(buf)};
+
+    ArenaAllocator allocator;
+
+    while (true) {
+        unsigned char header [meterLogRecords.getHeaderSize()];
+        size_t nread = reader.readBytes((char*) header, sizeof(header));
+        if (nread == 0) {
+            break; //end of log
+        }
+
+        char type = meterLogRecords.getType(header);
+        size_t length = meterLogRecords.getLength(header);
+        unsigned char *data = nullptr;
+        unsigned char crc [AO_RECORD_CRC_SIZE];
+        if (nread == sizeof(header) && (type == 'A' || type == 'R') && length > 0) {
+            data = static_cast<unsigned char*>(allocator.allocate(length));
+            if (!data) {
+                AO_DBG_ERR("OOM");
+                return false;
+            }
+        }
+
+        if (!data ||
+                reader.readBytes((char*) data, length) != length ||
+                reader.readBytes((char*) crc, sizeof(crc)) != sizeof(crc) ||
+                !meterLogRecords.isIntact(header, data, length, crc)) {
+            AO_DBG_WARN("sd log %s has a corrupted tail", fn);
+            allocator.deallocate(data);
+            rewriteRequired = true;
+            break;
+        }
+
+        auto format = FilesystemUtils::detectFormat((const char*) data, length);
+        DynamicJsonDocument doc {std::max(FilesystemUtils::measureCapacity((const char*) data, length, format), (size_t) 32)};
+        DeserializationError err = DeserializationError::InvalidInput;
+        if (format == StorageFormat::MsgPack) {
+            err = deserializeMsgPack(doc, (const char*) data, length);
+        } else {
+            err = deserializeJson(doc, (const char*) data, length);
+        }
+        allocator.deallocate(data);
+
+        if (err) {
+            AO_DBG_ERR("Deserialization error: %s", err.c_str());
+            return false;
+        }
+
+        JsonObject mvJson = doc.as<JsonObject>();
+        std::unique_ptr<MeterValue> mv = mvBuilder.deserializeSample(mvJson);
+
+        if (!mv) {
+            AO_DBG_ERR("Deserialization error");
+            return false;
+        }
+
+        if (!txData.empty() && (type == 'R' || txData.size() >= AO_MAX_STOPTXDATA_LEN)) {
+            txData.back() = std::move(mv);
+        } else {
+            txData.push_back(std::move(mv));
+        }
+        nRecords++;
+    }
+
+    AO_DBG_DEBUG("Restored %zu meter values from %u records", txData.size(), nRecords);
+    return true;
+}
+
+bool TransactionMeterData::restoreLegacy(MeterValueBuilder& mvBuilder, unsigned int mvCount) {
+    if (!filesystem) {
+        AO_DBG_DEBUG("No FS - nothing to restore");
+        return true;
+    }
+
+    if (mvCount > AO_MAX_STOPTXDATA_LEN) {
+        AO_DBG_ERR("corrupted memory");
+        return false;
+    }
+
+    for (unsigned int i = 0; i < mvCount; i++) {
 
-    while (misses < MISSES_LIMIT) { //search until region without mvs found
-        
         char fn [MAX_PATH_SIZE] = {'\0'};
-        auto ret = snprintf(fn, MAX_PATH_SIZE, AO_METERSTORE_DIR "sd" "-%u-%u-%u.jsn", connectorId, txNr, mvCount);
+        auto ret = snprintf(fn, MAX_PATH_SIZE, AO_METERSTORE_DIR "sd" "-%u-%u-%u.jsn", connectorId, txNr, i);
         if (ret < 0 || ret >= MAX_PATH_SIZE) {
             AO_DBG_ERR("fn error: %i", ret);
             return false; //all files have same length
         }
 
-        auto doc = FilesystemUtils::loadJson(filesystem, fn);
+        std::unique_ptr<MappedFile> mapping; //backs the strings of doc if the filesystem supports mapping
+        auto doc = FilesystemUtils::loadJson(filesystem, fn, &mapping);
 
         if (!doc) {
-            misses++;
-            mvCount++;
-            continue;
+            AO_DBG_ERR("missing sd %u", i);
+            return false;
         }
 
         JsonObject mvJson = doc->as<JsonObject>();
@@ -127,32 +323,111 @@ bool TransactionMeterData::restore(MeterValueBuilder& mvBuilder) {
 
         if (!mv) {
             AO_DBG_ERR("Deserialization error");
-            misses++;
-            mvCount++;
-            continue;
-        }
-
-        if (txData.size() >= AO_MAX_STOPTXDATA_LEN) {
-            AO_DBG_ERR("corrupted memory");
             return false;
         }
 
         txData.push_back(std::move(mv));
+    }
 
-        mvCount++;
-        misses = 0;
+    if (!rewriteLog()) {
+        AO_DBG_ERR("cannot migrate meter values");
+        rewriteRequired = true; //retry with the next sample
     }
 
-    AO_DBG_DEBUG("Restored %zu meter values", txData.size());
+    AO_DBG_DEBUG("Restored %zu legacy meter values", txData.size());
     return true;
 }
 
-MeterStore::MeterStore(std::shared_ptr<FilesystemAdapter> filesystem) : filesystem {filesystem} {
+bool TransactionMeterData::flush() {
+    if (!filesystem) {
+        return true;
+    }
+    persistence_flush();
+    return !rewriteRequired;
+}
+
+MeterStore::MeterStore(std::shared_ptr<FilesystemAdapter> filesystem, TransactionStore *txStore, unsigned int numConn) : filesystem {filesystem} {
 
     if (!filesystem) {
         AO_DBG_DEBUG("volatile mode");
-        (void)0;
+        return;
+    }
+
+    manifest = std::make_shared<StoreManifest>(filesystem, "sd");
+    if (!manifest->load()) {
+        /*
+         * Previous firmware versions didn't have a manifest. Look up the meter values of all stored txs on the
+         * filesystem and list them in the manifest. They are migrated into the log when the tx is accessed next time
+         * and the entry is only removed after that, so the migration continues after reboots
+         */
+        if (!txStore) {
+            AO_DBG_WARN("cannot look up legacy meter values");
+            legacyLookup = true; //don't save the manifest, try again after the next boot
+            return;
+        }
+
+        for (unsigned int cId = 0; cId < numConn; cId++) {
+            if (txStore->getTxBegin(cId) < 0 || txStore->getTxEnd(cId) < 0) {
+                continue;
+            }
+            for (unsigned int txNr = (unsigned int) txStore->getTxBegin(cId); txNr != (unsigned int) txStore->getTxEnd(cId); txNr = (txNr + 1) % MAX_TX_CNT) {
+                auto mvCount = scanLegacyMvCount(cId, txNr);
+                if (mvCount > 0) {
+                    AO_DBG_DEBUG("found %u legacy mvs for %u-%u", mvCount, cId, txNr);
+                    manifest->put(makeManifestKey(cId, txNr), mvCount);
+                }
+            }
+        }
+
+        if (!manifest->save()) {
+            AO_DBG_ERR("FS error");
+            legacyLookup = true;
+        }
+    }
+}
+
+unsigned int MeterStore::findLegacyMvCount(unsigned int connectorId, unsigned int txNr) {
+    if (!filesystem) {
+        return 0;
+    }
+
+    auto key = makeManifestKey(connectorId, txNr);
+    if (manifest->contains(key) || !legacyLookup) {
+        return manifest->getSize(key);
+    }
+
+    return scanLegacyMvCount(connectorId, txNr);
+}
+
+unsigned int MeterStore::scanLegacyMvCount(unsigned int connectorId, unsigned int txNr) {
+
+    const unsigned int MISSES_LIMIT = 3;
+    unsigned int misses = 0;
+    unsigned int i = 0;
+    unsigned int mvCount = 0;
+
+    while (misses < MISSES_LIMIT) { //search until region without mvs found
+        
+        char fn [MAX_PATH_SIZE] = {'\0'};
+        auto ret = snprintf(fn, MAX_PATH_SIZE, AO_METERSTORE_DIR "sd" "-%u-%u-%u.jsn", connectorId, txNr, i);
+        if (ret < 0 || ret >= MAX_PATH_SIZE) {
+            AO_DBG_ERR("fn error: %i", ret);
+            return 0; //all files have same length
+        }
+
+        size_t nsize = 0;
+        if (filesystem->stat(fn, &nsize) != 0) {
+            misses++;
+            i++;
+            continue;
+        }
+
+        i++;
+        mvCount = i;
+        misses = 0;
     }
+
+    return mvCount;
 }
 
 std::shared_ptr<TransactionMeterData> MeterStore::getTxMeterData(MeterValueBuilder& mvBuilder, Transaction *transaction) {
@@ -191,21 +466,24 @@ std::shared_ptr<TransactionMeterData> MeterStore::getTxMeterData(MeterValueBuild
 
     auto tx = std::make_shared<TransactionMeterData>(connectorId, txNr, filesystem);
     
-    if (filesystem) {
-        char fn [MAX_PATH_SIZE] = {'\0'};
-        auto ret = snprintf(fn, MAX_PATH_SIZE, AO_METERSTORE_DIR "sd" "-%u-%u-%u.jsn", connectorId, txNr, 0);
-        if (ret < 0 || ret >= MAX_PATH_SIZE) {
-            AO_DBG_ERR("fn error: %i", ret);
-            return nullptr; //cannot store
-        }
-
-        size_t size = 0;
-        bool exists = filesystem->stat(fn, &size) == 0;
-
-        if (exists) {
-            if (!tx->restore(mvBuilder)) {
-                remove(connectorId, txNr);
+    if (!tx->restore(mvBuilder)) {
+        remove(connectorId, txNr);
+        tx = std::make_shared<TransactionMeterData>(connectorId, txNr, filesystem);
+        AO_DBG_ERR("removed corrupted tx entries");
+    } else if (tx->size() == 0) {
+        //no log yet, but maybe meter values of previous versions
+        auto mvCount = findLegacyMvCount(connectorId, txNr);
+        if (mvCount > 0) {
+            if (!tx->restoreLegacy(mvBuilder, mvCount)) {
+                tx = std::make_shared<TransactionMeterData>(connectorId, txNr, filesystem);
                 AO_DBG_ERR("removed corrupted tx entries");
+                removeLegacy(connectorId, txNr, mvCount);
+            } else if (tx->flush()) {
+                //only delete the old files when the log is written
+                removeLegacy(connectorId, txNr, mvCount);
+            } else {
+                //the manifest keeps listing them. They're migrated again after a reboot or removed with the tx
+                AO_DBG_WARN("keep legacy mvs of %u-%u until the log is written", connectorId, txNr);
             }
         }
     }
@@ -219,8 +497,6 @@ std::shared_ptr<TransactionMeterData> MeterStore::getTxMeterData(MeterValueBuild
 
 bool MeterStore::remove(unsigned int connectorId, unsigned int txNr) {
 
-    unsigned int mvCount = 0;
-
     auto cached = std::find_if(txMeterData.begin(), txMeterData.end(),
             [connectorId, txNr] (std::weak_ptr<TransactionMeterData>& txm) {
                 if (auto txml = txm.lock()) {
@@ -232,7 +508,6 @@ bool MeterStore::remove(unsigned int connectorId, unsigned int txNr) {
     
     if (cached != txMeterData.end()) {
         if (auto cachedl = cached->lock()) {
-            mvCount = cachedl->getPathsCount();
             cachedl->finalize();
         }
     }
@@ -240,47 +515,25 @@ bool MeterStore::remove(unsigned int connectorId, unsigned int txNr) {
     bool success = true;
 
     if (filesystem) {
-        if (mvCount == 0) {
-            const unsigned int MISSES_LIMIT = 3;
-            unsigned int misses = 0;
-            unsigned int i = 0;
-
-            while (misses < MISSES_LIMIT) { //search until region without mvs found
-                
-                char fn [MAX_PATH_SIZE] = {'\0'};
-                auto ret = snprintf(fn, MAX_PATH_SIZE, AO_METERSTORE_DIR "sd" "-%u-%u-%u.jsn", connectorId, txNr, i);
-                if (ret < 0 || ret >= MAX_PATH_SIZE) {
-                    AO_DBG_ERR("fn error: %i", ret);
-                    return false; //all files have same length
-                }
+        //a pending write must not recreate the file
+        persistence_flush();
 
-                size_t nsize = 0;
-                if (filesystem->stat(fn, &nsize) != 0) {
-                    misses++;
-                    i++;
-                    continue;
-                }
-
-                i++;
-                mvCount = i;
-                misses = 0;
-            }
+        char fn [MAX_PATH_SIZE] = {'\0'};
+        auto ret = snprintf(fn, MAX_PATH_SIZE, AO_METERSTORE_DIR "sd" "-%u-%u.log", connectorId, txNr);
+        if (ret < 0 || ret >= MAX_PATH_SIZE) {
+            AO_DBG_ERR("fn error: %i", ret);
+            return false;
         }
 
-        AO_DBG_DEBUG("remove %u mvs for txNr %u", mvCount, txNr);
-
-        for (unsigned int i = 0; i < mvCount; i++) {
-            unsigned int sd = mvCount - 1U - i;
-        
-            char fn [MAX_PATH_SIZE] = {'\0'};
-            auto ret = snprintf(fn, MAX_PATH_SIZE, AO_METERSTORE_DIR "sd" "-%u-%u-%u.jsn", connectorId, txNr, sd);
-            if (ret < 0 || ret >= MAX_PATH_SIZE) {
-                AO_DBG_ERR("fn error: %i", ret);
-                return false;
-            }
-
+        size_t msize = 0;
+        if (filesystem->stat(fn, &msize) == 0) {
             success &= filesystem->remove(fn);
         }
+
+        auto mvCount = findLegacyMvCount(connectorId, txNr);
+        if (mvCount > 0) {
+            success &= removeLegacy(connectorId, txNr, mvCount);
+        }
     }
 
     //clean outdated pointers
@@ -300,3 +553,26 @@ bool MeterStore::remove(unsigned int connectorId, unsigned int txNr) {
 
     return success;
 }
+
+bool MeterStore::removeLegacy(unsigned int connectorId, unsigned int txNr, unsigned int mvCount) {
+
+    //update the manifest first, so that it never lists a deleted file
+    bool success = manifest->remove(makeManifestKey(connectorId, txNr));
+
+    AO_DBG_DEBUG("remove %u legacy mvs for txNr %u", mvCount, txNr);
+
+    for (unsigned int i = 0; i < mvCount; i++) {
+        unsigned int sd = mvCount - 1U - i;
+    
+        char fn [MAX_PATH_SIZE] = {'\0'};
+        auto ret = snprintf(fn, MAX_PATH_SIZE, AO_METERSTORE_DIR "sd" "-%u-%u-%u.jsn", connectorId, txNr, sd);
+        if (ret < 0 || ret >= MAX_PATH_SIZE) {
+            AO_DBG_ERR("fn error: %i", ret);
+            return false;
+        }
+
+        success &= filesystem->remove(fn);
+    }
+
+    return success;
+}
@@ -8,36 +8,69 @@
 #include <ArduinoOcpp/Tasks/Metering/MeterValue.h>
 #include <ArduinoOcpp/Tasks/Transactions/Transaction.h>
 #include <ArduinoOcpp/Core/FilesystemAdapter.h>
+#include <ArduinoOcpp/Core/StoreManifest.h>
 
 #include <vector>
 #include <deque>
 
+#ifndef AO_MAX_STOPTXDATA_LEN
+#define AO_MAX_STOPTXDATA_LEN 4 //max number of samples in StopTxnData. When exceeded, the last sample is overwritten
+#endif
+
+#ifndef AO_METERLOG_MAX_RECORDS
+#define AO_METERLOG_MAX_RECORDS (2 * AO_MAX_STOPTXDATA_LEN) //rewrite the log when it contains more records
+#endif
+
 namespace ArduinoOcpp {
 
+class TransactionStore;
+
+/*
+ * StopTxnData of one transaction. The samples are stored in one append-only log file per transaction. Each sample
+ * is one record (see RecordCodec):
+ *
+ *     type (1 byte) | length (2 bytes) | data (length bytes) | CRC-32 over all previous fields (4 bytes)
+ *
+ * Record types:
+ *     'A': appended sample
+ *     'R': sample which replaces the last one (when AO_MAX_STOPTXDATA_LEN is exceeded)
+ *
+ * data is the serialized MeterValue, length is little-endian. Loading stops at the first corrupted record, e.g. one
+ * which was interrupted by a power loss. Then the log is rewritten with the next sample. Removing the StopTxnData
+ * means deleting one file.
+ */
 class TransactionMeterData {
 private:
     const unsigned int connectorId; //assignment to Transaction object
     const unsigned int txNr; //assignment to Transaction object
 
-    unsigned int mvCount = 0; //nr of saved meter values
+    unsigned int nRecords = 0; //nr of records in the log file
+    bool rewriteRequired = false; //the log has a corrupted tail or a write failed
+    std::shared_ptr<bool> writeFailed; //set by the write jobs. Appends fail after a failed write until the log is rewritten
     bool finalized = false; //if true, this is read-only
 
     std::shared_ptr<FilesystemAdapter> filesystem;
 
     std::vector<std::unique_ptr<MeterValue>> txData;
 
+    bool makeFn(char *fn);
+    bool writeRecords(std::shared_ptr<std::vector<unsigned char>> records, bool truncate);
+    bool rewriteLog();
 public:
     TransactionMeterData(unsigned int connectorId, unsigned int txNr, std::shared_ptr<FilesystemAdapter> filesystem);
+    ~TransactionMeterData();
 
     bool addTxData(std::unique_ptr<MeterValue> mv);
 
     std::vector<std::unique_ptr<MeterValue>> retrieveStopTxData(); //will invalidate internal cache
 
-    bool restore(MeterValueBuilder& mvBuilder); //load record from memory; true if record found, false if nothing loaded
+    bool restore(MeterValueBuilder& mvBuilder); //load the log; false if a record is corrupted
+    bool restoreLegacy(MeterValueBuilder& mvBuilder, unsigned int mvCount); //load the one-file-per-sample layout of previous versions and move it into the log; false if the files are corrupted
+    bool flush(); //waits until the log is written; false if a write failed
 
     unsigned int getConnectorId() {return connectorId;}
     unsigned int getTxNr() {return txNr;}
-    unsigned int getPathsCount() {return mvCount;} //size of spanned path indexes
+    size_t size() {return txData.size();}
     void finalize() {finalized = true;}
     bool isFinalized() {return finalized;}
 };
@@ -45,13 +78,19 @@ public:
 class MeterStore {
 private:
     std::shared_ptr<FilesystemAdapter> filesystem;
+    std::shared_ptr<StoreManifest> manifest; //nr of meter values per tx in the one-file-per-sample layout of previous versions. Entries are removed after migrating
+    bool legacyLookup = false; //manifest couldn't be created: search the filesystem for meter values of previous firmware versions
     
     std::vector<std::weak_ptr<TransactionMeterData>> txMeterData;
 
+    unsigned int scanLegacyMvCount(unsigned int connectorId, unsigned int txNr);
+    unsigned int findLegacyMvCount(unsigned int connectorId, unsigned int txNr);
+    bool removeLegacy(unsigned int connectorId, unsigned int txNr, unsigned int mvCount);
+
 public:
     MeterStore() = delete;
     MeterStore(MeterStore&) = delete;
-    MeterStore(std::shared_ptr<FilesystemAdapter> filesystem);
+    MeterStore(std::shared_ptr<FilesystemAdapter> filesystem, TransactionStore *txStore = nullptr, unsigned int numConn = 0); //txStore: the txs whose meter values need migration
 
     std::shared_ptr<TransactionMeterData> getTxMeterData(MeterValueBuilder& mvBuilder, Transaction *transaction);
 
@@ -4,14 +4,16 @@
 
 #include <ArduinoOcpp/Tasks/Metering/MeterValue.h>
 #include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
 #include <ArduinoOcpp/Debug.h>
 
 using ArduinoOcpp::MeterValue;
 using ArduinoOcpp::MeterValueBuilder;
+using ArduinoOcpp::ArenaJsonDocument;
 
-std::unique_ptr<DynamicJsonDocument> MeterValue::toJson() {
+std::unique_ptr<ArenaJsonDocument> MeterValue::toJson() {
     size_t capacity = 0;
-    std::vector<std::unique_ptr<DynamicJsonDocument>> entries;
+    std::vector<std::unique_ptr<ArenaJsonDocument>> entries;
     for (auto sample = sampledValue.begin(); sample != sampledValue.end(); sample++) {
         auto json = (*sample)->toJson();
         if (!json) {
@@ -25,7 +27,7 @@ std::unique_ptr<DynamicJsonDocument> MeterValue::toJson() {
     capacity += JSONDATE_LENGTH + 1;
     capacity += JSON_OBJECT_SIZE(2);
     
-    auto result = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(capacity + 100)); //TODO remove safety space
+    auto result = std::unique_ptr<ArenaJsonDocument>(new ArenaJsonDocument(capacity + 100)); //TODO remove safety space
     auto jsonPayload = result->to<JsonObject>();
 
     char timestampStr [JSONDATE_LENGTH + 1] = {'\0'};
@@ -39,21 +41,50 @@ std::unique_ptr<DynamicJsonDocument> MeterValue::toJson() {
     return result;
 }
 
+bool MeterValue::writeJson(JsonWriter& out) {
+    out.beginObject();
+
+    char timestampStr [JSONDATE_LENGTH + 1] = {'\0'};
+    if (timestamp.toJsonString(timestampStr, JSONDATE_LENGTH + 1)) {
+        out.key("timestamp");
+        out.value(timestampStr);
+    }
+
+    out.key("sampledValue");
+    out.beginArray();
+    for (auto sample = sampledValue.begin(); sample != sampledValue.end(); sample++) {
+        if (!(*sample)->writeJson(out)) {
+            return false;
+        }
+    }
+    out.endArray();
+
+    out.endObject();
+    return true;
+}
+
 MeterValueBuilder::MeterValueBuilder(const std::vector<std::unique_ptr<SampledValueSampler>> &samplers,
             std::shared_ptr<Configuration<const char*>> samplers_select) :
             samplers(samplers),
             select(samplers_select) {
         
     updateObservedSamplers();
-    select_observe = select->getValueRevision();
+
+    //OCPP server has changed configuration about which measurands to take
+    select_observer = select->addObserver([this] (AbstractConfiguration&) {
+        AO_DBG_DEBUG("Updating observed samplers due to config change");
+        updateObservedSamplers();
+    });
+}
+
+MeterValueBuilder::~MeterValueBuilder() {
+    select->removeObserver(select_observer);
 }
 
 void MeterValueBuilder::updateObservedSamplers() {
 
-    if (select_mask.size() != samplers.size()) {
-        select_mask.resize(samplers.size(), false);
-        select_n = 0;
-    }
+    select_mask.assign(samplers.size(), false);
+    select_n = 0;
     
     auto selectStr = select->operator const char *();
     size_t sl = 0, sr = 0;
@@ -67,7 +98,7 @@ void MeterValueBuilder::updateObservedSamplers() {
 
         if (sr != sl + 1) {
             for (size_t i = 0; i < samplers.size(); i++) {
-                if (!strncmp(samplers[i]->getProperties().getMeasurand().c_str(), selectStr + sl, sr - sl)) {
+                if (!select_mask[i] && !strncmp(samplers[i]->getProperties().getMeasurand().c_str(), selectStr + sl, sr - sl)) {
                     select_mask[i] = true;
                     select_n++;
                 }
@@ -80,11 +111,9 @@ void MeterValueBuilder::updateObservedSamplers() {
 }
 
 std::unique_ptr<MeterValue> MeterValueBuilder::takeSample(const OcppTimestamp& timestamp, const ReadingContext& context) {
-    if (select_observe != select->getValueRevision() || //OCPP server has changed configuration about which measurands to take
-            samplers.size() != select_mask.size()) {    //Client has added another Measurand; synchronize lists
-        AO_DBG_DEBUG("Updating observed samplers due to config change or samplers added");
+    if (samplers.size() != select_mask.size()) {    //Client has added another Measurand; synchronize lists
+        AO_DBG_DEBUG("Updating observed samplers due to samplers added");
         updateObservedSamplers();
-        select_observe = select->getValueRevision();
     }
 
     if (select_n == 0) {
@@ -14,6 +14,8 @@
 
 namespace ArduinoOcpp {
 
+class JsonWriter;
+
 class MeterValue {
 private:
     OcppTimestamp timestamp;
@@ -24,7 +26,8 @@ public:
 
     void addSampledValue(std::unique_ptr<SampledValue> sample) {sampledValue.push_back(std::move(sample));}
 
-    std::unique_ptr<DynamicJsonDocument> toJson();
+    std::unique_ptr<ArenaJsonDocument> toJson();
+    bool writeJson(JsonWriter& out); //returns false if a sampled value is not serializable. Then the output is incomplete
 };
 
 class MeterValueBuilder {
@@ -33,12 +36,14 @@ private:
     std::shared_ptr<Configuration<const char*>> select;
     std::vector<bool> select_mask;
     unsigned int select_n {0};
-    decltype(select->getValueRevision()) select_observe;
+    unsigned int select_observer {0};
 
     void updateObservedSamplers();
 public:
     MeterValueBuilder(const std::vector<std::unique_ptr<SampledValueSampler>> &samplers,
             std::shared_ptr<Configuration<const char*>> samplers_select);
+    MeterValueBuilder(const MeterValueBuilder& other) = delete;
+    ~MeterValueBuilder();
     
     std::unique_ptr<MeterValue> takeSample(const OcppTimestamp& timestamp, const ReadingContext& context);
 
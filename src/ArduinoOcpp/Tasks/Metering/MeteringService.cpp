@@ -5,6 +5,7 @@
 #include <ArduinoOcpp/Tasks/Metering/MeteringService.h>
 #include <ArduinoOcpp/Tasks/Transactions/Transaction.h>
 #include <ArduinoOcpp/Core/OcppEngine.h>
+#include <ArduinoOcpp/Core/OcppModel.h>
 #include <ArduinoOcpp/Core/FilesystemAdapter.h>
 #include <ArduinoOcpp/SimpleOcppOperationFactory.h>
 #include <ArduinoOcpp/Debug.h>
@@ -12,7 +13,7 @@
 using namespace ArduinoOcpp;
 
 MeteringService::MeteringService(OcppEngine& context, int numConn, std::shared_ptr<FilesystemAdapter> filesystem)
-      : context(context), meterStore(filesystem) {
+      : context(context), meterStore(filesystem, context.getOcppModel().getTransactionStore(), (unsigned int) numConn) {
 
     for (int i = 0; i < numConn; i++) {
         connectors.push_back(std::unique_ptr<ConnectorMeterValuesRecorder>(new ConnectorMeterValuesRecorder(context.getOcppModel(), i, meterStore)));
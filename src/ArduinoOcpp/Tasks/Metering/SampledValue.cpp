@@ -3,9 +3,11 @@
 // MIT License
 
 #include <ArduinoOcpp/Tasks/Metering/SampledValue.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
 #include <ArduinoOcpp/Debug.h>
 
 using ArduinoOcpp::SampledValue;
+using ArduinoOcpp::ArenaJsonDocument;
 
 //helper function
 namespace ArduinoOcpp {
@@ -67,7 +69,7 @@ ReadingContext deserializeReadingContext(const char *context) {
 }
 }} //end namespaces
 
-std::unique_ptr<DynamicJsonDocument> SampledValue::toJson() {
+std::unique_ptr<ArenaJsonDocument> SampledValue::toJson() {
     auto value = serializeValue();
     if (value.empty()) {
         return nullptr;
@@ -80,7 +82,7 @@ std::unique_ptr<DynamicJsonDocument> SampledValue::toJson() {
                 + properties.getPhase().length() + 1
                 + properties.getLocation().length() + 1
                 + properties.getUnit().length() + 1;
-    auto result = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(capacity + 100)); //TODO remove safety space
+    auto result = std::unique_ptr<ArenaJsonDocument>(new ArenaJsonDocument(capacity + 100)); //TODO remove safety space
     auto payload = result->to<JsonObject>();
     payload["value"] = value;
     auto context_cstr = Ocpp16::serializeReadingContext(context);
@@ -98,3 +100,40 @@ std::unique_ptr<DynamicJsonDocument> SampledValue::toJson() {
         payload["unit"] = properties.getUnit();
     return result;
 }
+
+bool SampledValue::writeJson(JsonWriter& out) {
+    auto value = serializeValue();
+    if (value.empty()) {
+        return false;
+    }
+    out.beginObject();
+    out.key("value");
+    out.value(value.c_str());
+    auto context_cstr = Ocpp16::serializeReadingContext(context);
+    if (context_cstr) {
+        out.key("context");
+        out.value(context_cstr);
+    }
+    if (!properties.getFormat().empty()) {
+        out.key("format");
+        out.value(properties.getFormat().c_str());
+    }
+    if (!properties.getMeasurand().empty()) {
+        out.key("measurand");
+        out.value(properties.getMeasurand().c_str());
+    }
+    if (!properties.getPhase().empty()) {
+        out.key("phase");
+        out.value(properties.getPhase().c_str());
+    }
+    if (!properties.getLocation().empty()) {
+        out.key("location");
+        out.value(properties.getLocation().c_str());
+    }
+    if (!properties.getUnit().empty()) {
+        out.key("unit");
+        out.value(properties.getUnit().c_str());
+    }
+    out.endObject();
+    return true;
+}
@@ -6,11 +6,14 @@
 #define SAMPLEDVALUE_H
 
 #include <ArduinoJson.h>
+#include <ArduinoOcpp/Core/MemoryArena.h>
 #include <memory>
 #include <functional>
 
 namespace ArduinoOcpp {
 
+class JsonWriter;
+
 template <class T>
 class SampledValueDeSerializer {
 public:
@@ -103,7 +106,8 @@ public:
     SampledValue(const SampledValue& other) : properties(other.properties), context(other.context) { }
     virtual ~SampledValue() = default;
 
-    std::unique_ptr<DynamicJsonDocument> toJson();
+    std::unique_ptr<ArenaJsonDocument> toJson();
+    bool writeJson(JsonWriter& out); //returns false without writing anything if the value is not serializable
 
     virtual operator bool() = 0;
     virtual int32_t toInteger() = 0;
@@ -3,6 +3,7 @@
 // MIT License
 
 #include <ArduinoOcpp/Tasks/SmartCharging/SmartChargingModel.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
 #include <ArduinoOcpp/Debug.h>
 
 #include <string.h>
@@ -16,6 +17,30 @@ ChargingSchedulePeriod::ChargingSchedulePeriod(JsonObject &json){
     numberPhases = json["numberPhases"] | -1;
 }
 
+ChargingSchedulePeriod::ChargingSchedulePeriod(JsonReader &json) : startPeriod(0), limit(0.f) {
+    //same defaults as the JsonObject constructor: missing members and members of an unexpected type are ignored
+    if (json.peek() != JsonReader::Type::Object) {
+        json.skipValue();
+        return;
+    }
+
+    json.readObject([&] (const char *key) {
+        if (json.peek() != JsonReader::Type::Number) {
+            return false;
+        }
+        if (!strcmp(key, "startPeriod")) {
+            json.readInt(startPeriod);
+        } else if (!strcmp(key, "limit")) {
+            json.readFloat(limit);
+        } else if (!strcmp(key, "numberPhases")) {
+            json.readInt(numberPhases);
+        } else {
+            return false;
+        }
+        return true;
+    });
+}
+
 ChargingSchedulePeriod::ChargingSchedulePeriod(int startPeriod, float limit){
     this->startPeriod = startPeriod;
     this->limit = limit;
@@ -88,6 +113,59 @@ ChargingSchedule::ChargingSchedule(JsonObject &json, ChargingProfileKindType cha
     minChargingRate = json["minChargingRate"] | -1.0f;
 }
 
+ChargingSchedule::ChargingSchedule(JsonReader &json)
+      : chargingRateUnit(ChargingRateUnitType::Watt)
+      , chargingProfileKind(ChargingProfileKindType::Relative)
+      , recurrencyKind(RecurrencyKindType::NOT_SET) {
+
+    startSchedule = MIN_TIME;
+
+    if (json.peek() != JsonReader::Type::Object) {
+        json.skipValue();
+        return;
+    }
+
+    json.readObject([&] (const char *key) {
+        auto type = json.peek();
+        if (!strcmp(key, "duration") && type == JsonReader::Type::Number) {
+            json.readInt(duration);
+        } else if (!strcmp(key, "startSchedule") && type == JsonReader::Type::String) {
+            char startScheduleStr [JSONDATE_LENGTH + 8];
+            if (json.readTruncatedString(startScheduleStr, sizeof(startScheduleStr)) && !startSchedule.setTime(startScheduleStr)) {
+                //non-success
+                startSchedule = MIN_TIME;
+            }
+        } else if (!strcmp(key, "chargingRateUnit") && type == JsonReader::Type::String) {
+            char unit [4];
+            if (json.readTruncatedString(unit, sizeof(unit))) {
+                if (unit[0] == 'a' || unit[0] == 'A') {
+                    chargingRateUnit = ChargingRateUnitType::Amp;
+                } else {
+                    chargingRateUnit = ChargingRateUnitType::Watt;
+                }
+            }
+        } else if (!strcmp(key, "chargingSchedulePeriod") && type == JsonReader::Type::Array) {
+            json.readArray([&json, this] () {
+                auto period = std::unique_ptr<ChargingSchedulePeriod>(new ChargingSchedulePeriod(json));
+                if (json.isValid()) {
+                    chargingSchedulePeriod.push_back(std::move(period));
+                }
+            });
+        } else if (!strcmp(key, "minChargingRate") && type == JsonReader::Type::Number) {
+            json.readFloat(minChargingRate);
+        } else {
+            return false;
+        }
+        return true;
+    });
+
+    //Expecting sorted list of periods but specification doesn't garantuee it
+    std::sort(chargingSchedulePeriod.begin(), chargingSchedulePeriod.end(),
+        [] (const std::unique_ptr<ChargingSchedulePeriod> &p1, const std::unique_ptr<ChargingSchedulePeriod> &p2) {
+            return p1->getStartPeriod() < p2->getStartPeriod();
+    });
+}
+
 ChargingSchedule::ChargingSchedule(ChargingSchedule &other) {
     chargingProfileKind = other.chargingProfileKind;
     recurrencyKind = other.recurrencyKind;  
@@ -263,6 +341,42 @@ DynamicJsonDocument *ChargingSchedule::toJsonDocument() {
     return result;
 }
 
+void ChargingSchedule::writeJson(JsonWriter& out) {
+    out.beginObject();
+    if (duration >= 0) {
+        out.key("duration");
+        out.value(duration);
+    }
+    if (startSchedule > MIN_TIME) {
+        char startScheduleJson [JSONDATE_LENGTH + 1] = {'\0'};
+        startSchedule.toJsonString(startScheduleJson, JSONDATE_LENGTH + 1);
+        out.key("startSchedule");
+        out.value(startScheduleJson);
+    }
+    out.key("chargingRateUnit");
+    out.value(chargingRateUnit == (ChargingRateUnitType::Amp) ? "A" : "W");
+    out.key("chargingSchedulePeriod");
+    out.beginArray();
+    for (auto period = chargingSchedulePeriod.begin(); period != chargingSchedulePeriod.end(); period++) {
+        out.beginObject();
+        out.key("startPeriod");
+        out.value((*period)->getStartPeriod());
+        out.key("limit");
+        out.value((*period)->getLimit());
+        if ((*period)->getNumberPhases() >= 0) {
+            out.key("numberPhases");
+            out.value((*period)->getNumberPhases());
+        }
+        out.endObject();
+    }
+    out.endArray();
+    if (minChargingRate >= 0) {
+        out.key("minChargingRate");
+        out.value(minChargingRate);
+    }
+    out.endObject();
+}
+
 void ChargingSchedule::printSchedule(){
 
     char tmp[JSONDATE_LENGTH + 1] = {'\0'};
@@ -335,6 +449,92 @@ ChargingProfile::ChargingProfile(JsonObject &json){
     chargingSchedule = std::unique_ptr<ChargingSchedule>(new ChargingSchedule(schedule, chargingProfileKind, recurrencyKind));
 }
 
+ChargingProfile::ChargingProfile(JsonReader &json) {
+
+    validFrom = MIN_TIME;
+    validTo = MIN_TIME;
+
+    //same defaults as the JsonObject constructor: missing members and members of an unexpected type are ignored
+    if (json.peek() != JsonReader::Type::Object) {
+        json.skipValue();
+    } else {
+        json.readObject([&] (const char *key) {
+            auto type = json.peek();
+            if (type == JsonReader::Type::Number) {
+                if (!strcmp(key, "chargingProfileId")) {
+                    json.readInt(chargingProfileId);
+                } else if (!strcmp(key, "transactionId")) {
+                    json.readInt(transactionId);
+                } else if (!strcmp(key, "stackLevel")) {
+                    json.readInt(stackLevel);
+                } else {
+                    return false;
+                }
+            } else if (type == JsonReader::Type::String) {
+                //like the JsonObject constructor, ignore the characters which exceed the timestamp format. The enum
+                //buffers have one spare char, so that truncated strings match none of the enum values
+                if (!strcmp(key, "chargingProfilePurpose")) {
+                    char purpose [sizeof("ChargePointMaxProfile") + 1];
+                    json.readTruncatedString(purpose, sizeof(purpose));
+                    if (!strcmp(purpose, "ChargePointMaxProfile")) {
+                        chargingProfilePurpose = ChargingProfilePurposeType::ChargePointMaxProfile;
+                    } else if (!strcmp(purpose, "TxDefaultProfile")) {
+                        chargingProfilePurpose = ChargingProfilePurposeType::TxDefaultProfile;
+                    } else {
+                        chargingProfilePurpose = ChargingProfilePurposeType::TxProfile;
+                    }
+                } else if (!strcmp(key, "chargingProfileKind")) {
+                    char kind [sizeof("Recurring") + 1];
+                    json.readTruncatedString(kind, sizeof(kind));
+                    if (!strcmp(kind, "Absolute")) {
+                        chargingProfileKind = ChargingProfileKindType::Absolute;
+                    } else if (!strcmp(kind, "Recurring")) {
+                        chargingProfileKind = ChargingProfileKindType::Recurring;
+                    } else {
+                        chargingProfileKind = ChargingProfileKindType::Relative;
+                    }
+                } else if (!strcmp(key, "recurrencyKind")) {
+                    char recurrency [sizeof("Weekly") + 1];
+                    json.readTruncatedString(recurrency, sizeof(recurrency));
+                    if (!strcmp(recurrency, "Daily")) {
+                        recurrencyKind = RecurrencyKindType::Daily;
+                    } else if (!strcmp(recurrency, "Weekly")) {
+                        recurrencyKind = RecurrencyKindType::Weekly;
+                    } else {
+                        recurrencyKind = RecurrencyKindType::NOT_SET;
+                    }
+                } else if (!strcmp(key, "validFrom") || !strcmp(key, "validTo")) {
+                    OcppTimestamp &validity = key[5] == 'F' ? validFrom : validTo;
+                    char validityStr [JSONDATE_LENGTH + 8];
+                    if (json.readTruncatedString(validityStr, sizeof(validityStr)) && !validity.setTime(validityStr)) {
+                        AO_DBG_DEBUG("%s undefined. Expect format like 2022-02-01T20:53:32.486Z. Assume unlimited validity", key);
+                        validity = MIN_TIME;
+                    }
+                } else {
+                    return false;
+                }
+            } else if (!strcmp(key, "chargingSchedule")) {
+                chargingSchedule = std::unique_ptr<ChargingSchedule>(new ChargingSchedule(json));
+            } else {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    if (!chargingSchedule) {
+        //missing schedule: empty schedule like in the JsonObject constructor
+        JsonObject schedule;
+        chargingSchedule = std::unique_ptr<ChargingSchedule>(new ChargingSchedule(schedule, chargingProfileKind, recurrencyKind));
+    }
+
+    //the kinds could have been read after the schedule
+    chargingSchedule->chargingProfileKind = chargingProfileKind;
+    chargingSchedule->recurrencyKind = recurrencyKind;
+
+    AO_DBG_DEBUG("Deserialize stream: chargingProfileId=%i", chargingProfileId);
+}
+
 bool ChargingProfile::inferenceLimit(const OcppTimestamp &t, const OcppTimestamp &startOfCharging, float *limit, OcppTimestamp *nextChange){
     if (t > validTo && validTo > MIN_TIME) {
         *nextChange = MAX_TIME;
@@ -387,6 +587,42 @@ int ChargingProfile::getChargingProfileId() {
     return chargingProfileId;
 }
 
+void ChargingProfile::writeJson(JsonWriter& out) {
+    out.beginObject();
+    out.key("chargingProfileId");
+    out.value(chargingProfileId);
+    if (transactionId >= 0) {
+        out.key("transactionId");
+        out.value(transactionId);
+    }
+    out.key("stackLevel");
+    out.value(stackLevel);
+    out.key("chargingProfilePurpose");
+    out.value(chargingProfilePurpose == (ChargingProfilePurposeType::ChargePointMaxProfile) ? "ChargePointMaxProfile" :
+                chargingProfilePurpose == (ChargingProfilePurposeType::TxDefaultProfile) ? "TxDefaultProfile" : "TxProfile");
+    out.key("chargingProfileKind");
+    out.value(chargingProfileKind == (ChargingProfileKindType::Absolute) ? "Absolute" :
+                chargingProfileKind == (ChargingProfileKindType::Recurring) ? "Recurring" : "Relative");
+    if (recurrencyKind != RecurrencyKindType::NOT_SET) {
+        out.key("recurrencyKind");
+        out.value(recurrencyKind == (RecurrencyKindType::Daily) ? "Daily" : "Weekly");
+    }
+    char validityJson [JSONDATE_LENGTH + 1] = {'\0'};
+    if (validFrom > MIN_TIME) {
+        validFrom.toJsonString(validityJson, JSONDATE_LENGTH + 1);
+        out.key("validFrom");
+        out.value(validityJson);
+    }
+    if (validTo > MIN_TIME) {
+        validTo.toJsonString(validityJson, JSONDATE_LENGTH + 1);
+        out.key("validTo");
+        out.value(validityJson);
+    }
+    out.key("chargingSchedule");
+    chargingSchedule->writeJson(out);
+    out.endObject();
+}
+
 void ChargingProfile::printProfile(){
 
     char tmp[JSONDATE_LENGTH + 1] = {'\0'};
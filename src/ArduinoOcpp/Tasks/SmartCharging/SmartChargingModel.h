@@ -7,11 +7,14 @@
 
 #include <ArduinoJson.h>
 #include <ArduinoOcpp/Core/OcppTime.h>
+#include <ArduinoOcpp/Core/JsonReader.h>
 #include <memory>
 #include <vector>
 
 namespace ArduinoOcpp {
 
+class JsonWriter;
+
 enum class ChargingProfilePurposeType {
     ChargePointMaxProfile,
     TxDefaultProfile,
@@ -42,6 +45,7 @@ private:
     int numberPhases = -1;
 public:
     ChargingSchedulePeriod(JsonObject &json);
+    ChargingSchedulePeriod(JsonReader &json);
     ChargingSchedulePeriod(int startPeriod, float limit);
     int getStartPeriod();
     float getLimit();
@@ -61,8 +65,11 @@ private:
 
     ChargingProfileKindType chargingProfileKind; //copied from ChargingProfile to increase cohesion of limit inferencing methods
     RecurrencyKindType recurrencyKind; //copied from ChargingProfile to increase cohesion of limit inferencing methods
+
+    friend class ChargingProfile; //when reading a stream, the profile kinds can follow after the schedule
 public:
     ChargingSchedule(JsonObject &json, ChargingProfileKindType chargingProfileKind, RecurrencyKindType recurrencyKind);
+    ChargingSchedule(JsonReader &json);
     ChargingSchedule(ChargingSchedule &other);
     ChargingSchedule(const OcppTimestamp &startSchedule, int duration);
 
@@ -83,6 +90,8 @@ public:
 
     DynamicJsonDocument *toJsonDocument();
 
+    void writeJson(JsonWriter& out);
+
     /*
     * print on console
     */
@@ -103,6 +112,13 @@ private:
 public:
     ChargingProfile(JsonObject &json);
 
+    /*
+     * Decodes the profile directly from the input stream. Missing members and members of an unexpected type get the
+     * same defaults as with the JsonObject constructor. Check json.isValid() afterwards; on malformed input, the
+     * reader is in the error state and the profile must be discarded
+     */
+    ChargingProfile(JsonReader &json);
+
     /**
      * limit: output parameter
      * nextChange: output parameter
@@ -129,6 +145,8 @@ public:
 
     int getChargingProfileId();
 
+    void writeJson(JsonWriter& out);
+
     /*
     * print on console
     */
@@ -55,6 +55,9 @@ SmartChargingService::SmartChargingService(OcppEngine& context, float chargeLimi
     txStartTime = declareConfiguration<const char*>("AO_TXSTARTTIME_CONN_1", max_timestamp, CONFIGURATION_FN, false, false, true, false);
     chargingSessionTransactionID = -1;
     sRmtProfileId = declareConfiguration<int>("AO_SRMTPROFILEID_CONN_1", -1, CONFIGURATION_FN, false, false, true, false);
+    sRmtProfileIdObserver = sRmtProfileId->addObserver([this] (AbstractConfiguration&) {
+        sRmtProfileIdChanged = true;
+    });
     for (int i = 0; i < CHARGEPROFILEMAXSTACKLEVEL; i++) {
         ChargePointMaxProfile[i] = NULL;
         TxDefaultProfile[i] = NULL;
@@ -78,6 +81,10 @@ SmartChargingService::SmartChargingService(OcppEngine& context, float chargeLimi
     loadProfiles();
 }
 
+SmartChargingService::~SmartChargingService() {
+    sRmtProfileId->removeObserver(sRmtProfileIdObserver);
+}
+
 void SmartChargingService::loop(){
 
     refreshChargingSessionState();
@@ -248,7 +255,7 @@ void SmartChargingService::refreshChargingSessionState() {
         chargingSessionStart.setTime(*txStartTime);
         chargingSessionTransactionID = connector->getTransactionId();
         sessionIdTagRev = connector->getSessionWriteCount();
-        sRmtProfileIdRev = sRmtProfileId->getValueRevision();
+        sRmtProfileIdChanged = false;
 
         //fuzzy check if session engaged at reboot (during first loop run)
         auto chargingSessionStartCheck = MAX_TIME;
@@ -275,7 +282,7 @@ void SmartChargingService::refreshChargingSessionState() {
             char timestamp [JSONDATE_LENGTH + 1] = {'\0'};
             chargingSessionStart.toJsonString(timestamp, JSONDATE_LENGTH + 1);
             *txStartTime = timestamp;
-            configuration_save();
+            configuration_save_deferred();
         }
 
         nextChange = context.getOcppModel().getOcppTime().getOcppTimestampNow();
@@ -283,7 +290,7 @@ void SmartChargingService::refreshChargingSessionState() {
   
     if (*sRmtProfileId >= 0 && //Remote profile set? Check if to delete
             (!connector->getSessionIdTag()    //Always delete Rmt profile if there is no session
-            || (sessionIdTagRev != connector->getSessionWriteCount() && sRmtProfileIdRev == sRmtProfileId->getValueRevision()))) {
+            || (sessionIdTagRev != connector->getSessionWriteCount() && !sRmtProfileIdChanged))) {
                                                //Alternaternively delete if session state has been overwritten
         
         //after RemoteTx session expired, clean charging profile
@@ -300,17 +307,28 @@ void SmartChargingService::refreshChargingSessionState() {
 
     chargingSessionTransactionID = connector->getTransactionId();
     sessionIdTagRev = connector->getSessionWriteCount();
-    sRmtProfileIdRev = sRmtProfileId->getValueRevision();
+    sRmtProfileIdChanged = false;
 }
 
 void SmartChargingService::setChargingProfile(JsonObject json) {
-    ChargingProfile *pointer = updateProfileStack(json);
+    std::string serialized;
+    serialized.resize(measureJson(json));
+    serializeJson(json, &serialized[0], serialized.length() + 1);
+    setChargingProfile(std::unique_ptr<ChargingProfile>(new ChargingProfile(json)), serialized.c_str(), serialized.length());
+}
+
+void SmartChargingService::setChargingProfile(std::unique_ptr<ChargingProfile> chargingProfile, const char *json, size_t length) {
+    ChargingProfile *pointer = updateProfileStack(std::move(chargingProfile));
     if (pointer)
-        writeProfileToFlash(json, pointer);
+        writeProfileToFlash(json, length, pointer);
 }
 
-ChargingProfile *SmartChargingService::updateProfileStack(JsonObject json){
-    ChargingProfile *chargingProfile = new ChargingProfile(json);
+ChargingProfile *SmartChargingService::updateProfileStack(std::unique_ptr<ChargingProfile> chargingProfileOwner){
+    if (!chargingProfileOwner) {
+        AO_DBG_ERR("invalid argument");
+        return nullptr;
+    }
+    ChargingProfile *chargingProfile = chargingProfileOwner.release();
 
     if (AO_DBG_LEVEL >= AO_DL_VERBOSE) {
         AO_DBG_VERBOSE("Charging Profile internal model:");
@@ -408,7 +426,7 @@ bool SmartChargingService::clearChargingProfile(const std::function<bool(int, in
     return nMatches > 0;
 }
 
-bool SmartChargingService::writeProfileToFlash(JsonObject json, ChargingProfile *chargingProfile) {
+bool SmartChargingService::writeProfileToFlash(const char *json, size_t length, ChargingProfile *chargingProfile) {
 #ifndef AO_DEACTIVATE_FLASH
 
     if (!filesystemOpt.accessAllowed()) {
@@ -441,9 +459,9 @@ bool SmartChargingService::writeProfileToFlash(JsonObject json, ChargingProfile
         return false;
     }
 
-    // Serialize JSON to file
-    if (serializeJson(json, file) == 0) {
-        AO_DBG_ERR("Unable to save: could not serialize JSON for profile: %s", fn);
+    // Store the JSON as received
+    if (!json || file.write((const uint8_t*) json, length) != length) {
+        AO_DBG_ERR("Unable to save: could not write JSON for profile: %s", fn);
         file.close();
         return false;
     }
@@ -560,7 +578,7 @@ bool SmartChargingService::loadProfiles() {
                 }
 
                 JsonObject profileJson = profileDoc.as<JsonObject>();
-                updateProfileStack(profileJson);
+                updateProfileStack(std::unique_ptr<ChargingProfile>(new ChargingProfile(profileJson)));
 
                 profileDoc.clear();
                 break;
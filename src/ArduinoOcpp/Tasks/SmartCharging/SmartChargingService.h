@@ -40,18 +40,21 @@ private:
     OcppTimestamp chargingSessionStart;
     int chargingSessionTransactionID;
     std::shared_ptr<Configuration<int>> sRmtProfileId;
-    uint16_t sRmtProfileIdRev {0};
+    unsigned int sRmtProfileIdObserver {0};
+    bool sRmtProfileIdChanged {false}; //since the last refresh
     uint16_t sessionIdTagRev {0};
     void refreshChargingSessionState();
 
-    ChargingProfile *updateProfileStack(JsonObject json);
+    ChargingProfile *updateProfileStack(std::unique_ptr<ChargingProfile> chargingProfile);
     FilesystemOpt filesystemOpt;
-    bool writeProfileToFlash(JsonObject json, ChargingProfile *chargingProfile);
+    bool writeProfileToFlash(const char *json, size_t length, ChargingProfile *chargingProfile);
     bool loadProfiles();
   
 public:
     SmartChargingService(OcppEngine& context, float chargeLimit, float V_eff, int numConnectors, FilesystemOpt filesystemOpt = FilesystemOpt::Use_Mount_FormatOnFail);
+    ~SmartChargingService();
     void setChargingProfile(JsonObject json);
+    void setChargingProfile(std::unique_ptr<ChargingProfile> chargingProfile, const char *json, size_t length); //json: the profile as received. It's stored as it is
     bool clearChargingProfile(const std::function<bool(int, int, ChargingProfilePurposeType, int)>& filter);
     void inferenceLimit(const OcppTimestamp &t, float *limit, OcppTimestamp *validTo);
     float inferenceLimitNow();
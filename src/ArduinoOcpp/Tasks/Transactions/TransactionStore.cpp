@@ -8,9 +8,11 @@
 #include <ArduinoOcpp/MessagesV16/StopTransaction.h>
 #include <ArduinoOcpp/SimpleOcppOperationFactory.h>
 #include <ArduinoOcpp/Core/FilesystemUtils.h>
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
 #include <ArduinoOcpp/Debug.h>
 
 #include <algorithm>
+#include <string.h>
 
 using namespace ArduinoOcpp;
 
@@ -20,23 +22,117 @@ using namespace ArduinoOcpp;
 
 #define AO_TXSTORE_META_FN AO_FILENAME_PREFIX "/txstore.jsn"
 
+#define AO_TXCOUNTER_BEGIN 0
+#define AO_TXCOUNTER_END 1
+#define AO_TXCOUNTER_N 2
+
+#ifndef AO_TXSTORE_FORMAT
+#define AO_TXSTORE_FORMAT AO_STORAGE_MSGPACK
+#endif
+
+namespace ArduinoOcpp {
+namespace TransactionStoreUtils {
+
+std::shared_ptr<ConfigurationContainer> getTxStoreMetaContainer() {
+    for (auto c = getConfigurationContainersBegin(); c != getConfigurationContainersEnd(); c++) {
+        if (!strcmp((*c)->getFilename(), AO_TXSTORE_META_FN)) {
+            return *c;
+        }
+    }
+    return nullptr;
+}
+
+}
+}
+
+using namespace ArduinoOcpp::TransactionStoreUtils;
+
 ConnectorTransactionStore::ConnectorTransactionStore(TransactionStore& context, unsigned int connectorId, std::shared_ptr<FilesystemAdapter> filesystem) :
         context(context),
         connectorId(connectorId),
         filesystem(filesystem) {
 
+    auto ret = snprintf(countersFn, sizeof(countersFn), AO_TXSTORE_DIR "txctr-%u.rec", connectorId);
+    if (ret < 0 || (size_t) ret >= sizeof(countersFn)) {
+        AO_DBG_ERR("fn error: %i", ret);
+        countersFn[0] = '\0';
+    }
+
+    counters = std::unique_ptr<CounterRecord>(new CounterRecord(countersFn[0] ? filesystem : nullptr, countersFn, AO_TXCOUNTER_N));
+
+    if (!counters->load()) {
+        size_t msize;
+        if (filesystem && countersFn[0] && filesystem->stat(countersFn, &msize) == 0) {
+            //the legacy counters were removed after the first migration and must not be taken over again
+            AO_DBG_ERR("%s corrupt. Reset tx counters", countersFn);
+        } else {
+            migrateLegacyCounters();
+        }
+    }
+
+    if (!filesystem) {
+        return;
+    }
+
+    snprintf(manifestName, sizeof(manifestName), "tx-%u", connectorId);
+    manifest = std::unique_ptr<StoreManifest>(new StoreManifest(filesystem, manifestName));
+
+    if (!manifest->load()) {
+        //previous firmware versions didn't have a manifest. Take over the txs in the range of the tx counters
+        AO_DBG_DEBUG("create manifest for %s", manifestName);
+        for (unsigned int txNr = getTxBegin(); txNr != (unsigned int) getTxEnd(); txNr = (txNr + 1) % MAX_TX_CNT) {
+            char fn [MAX_PATH_SIZE] = {'\0'};
+            auto ret = snprintf(fn, MAX_PATH_SIZE, AO_TXSTORE_DIR "tx" "-%u-%u.jsn", connectorId, txNr);
+            if (ret < 0 || ret >= MAX_PATH_SIZE) {
+                AO_DBG_ERR("fn error: %i", ret);
+                break;
+            }
+
+            size_t msize;
+            if (filesystem->stat(fn, &msize) == 0) {
+                manifest->put(txNr, (uint32_t) msize);
+            }
+        }
+        manifest->save();
+    }
+}
+
+void ConnectorTransactionStore::migrateLegacyCounters() {
+    //previous firmware versions stored the tx counters in the configurations. Take them over and remove them
+    auto container = getTxStoreMetaContainer();
+
+    size_t msize;
+    if (!container && (!filesystem || filesystem->stat(AO_TXSTORE_META_FN, &msize) != 0)) {
+        return; //nothing to migrate
+    }
+
     char key [30] = {'\0'};
-    if (snprintf(key, 30, "AO_txEnd_%u", connectorId) < 0) {
-        AO_DBG_ERR("Invalid key");
-        (void)0;
+    snprintf(key, 30, "AO_txBegin_%u", connectorId);
+    auto txBegin = declareConfiguration<int>(key, 0, AO_TXSTORE_META_FN, false, false, true, false);
+    snprintf(key, 30, "AO_txEnd_%u", connectorId);
+    auto txEnd = declareConfiguration<int>(key, 0, AO_TXSTORE_META_FN, false, false, true, false);
+
+    uint32_t initial [AO_TXCOUNTER_N] = {0, 0};
+    if (txBegin && *txBegin >= 0 && txEnd && *txEnd >= 0) {
+        initial[AO_TXCOUNTER_BEGIN] = (uint32_t) *txBegin % MAX_TX_CNT;
+        initial[AO_TXCOUNTER_END] = (uint32_t) *txEnd % MAX_TX_CNT;
+    }
+    if (!counters->setAll(initial, AO_TXCOUNTER_N)) {
+        AO_DBG_ERR("cannot migrate tx counters");
+        return; //keep the legacy counters for the next attempt
     }
-    txEnd = declareConfiguration<int>(key, 0, AO_TXSTORE_META_FN, false, false, true, false);
 
-    if (snprintf(key, 30, "AO_txBegin_%u", connectorId) < 0) {
-        AO_DBG_ERR("Invalid key");
-        (void)0;
+    container = getTxStoreMetaContainer(); //declared by now
+
+    if (container) {
+        if (txBegin) {
+            container->removeConfiguration(txBegin);
+        }
+        if (txEnd) {
+            container->removeConfiguration(txEnd);
+        }
+        container->save();
     }
-    txBegin = declareConfiguration<int>(key, 0, AO_TXSTORE_META_FN, false, false, true, false);
 }
 
 std::shared_ptr<Transaction> ConnectorTransactionStore::getTransaction(unsigned int txNr) {
@@ -73,6 +169,11 @@ std::shared_ptr<Transaction> ConnectorTransactionStore::getTransaction(unsigned
         return nullptr;
     }
 
+    if (!manifest->contains(txNr)) {
+        AO_DBG_DEBUG("%u-%u does not exist", connectorId, txNr);
+        return nullptr;
+    }
+
     char fn [MAX_PATH_SIZE] = {'\0'};
     auto ret = snprintf(fn, MAX_PATH_SIZE, AO_TXSTORE_DIR "tx" "-%u-%u.jsn", connectorId, txNr);
     if (ret < 0 || ret >= MAX_PATH_SIZE) {
@@ -80,13 +181,8 @@ std::shared_ptr<Transaction> ConnectorTransactionStore::getTransaction(unsigned
         return nullptr;
     }
 
-    size_t msize;
-    if (filesystem->stat(fn, &msize) != 0) {
-        AO_DBG_DEBUG("%u-%u does not exist", connectorId, txNr);
-        return nullptr;
-    }
-
-    auto doc = FilesystemUtils::loadJson(filesystem, fn);
+    std::unique_ptr<MappedFile> mapping; //backs the strings of doc if the filesystem supports mapping
+    auto doc = FilesystemUtils::loadJson(filesystem, fn, &mapping);
 
     if (!doc) {
         AO_DBG_ERR("memory corruption");
@@ -113,13 +209,10 @@ std::shared_ptr<Transaction> ConnectorTransactionStore::getTransaction(unsigned
 
 std::shared_ptr<Transaction> ConnectorTransactionStore::createTransaction(bool silent) {
     
-    if (!txBegin || *txBegin < 0 || !txEnd || *txEnd < 0) {
-        AO_DBG_ERR("memory corruption");
-        return nullptr;
-    }
+    unsigned int txEnd = (unsigned int) getTxEnd();
 
     //check if maximum number of queued tx already reached
-    if ((*txEnd + MAX_TX_CNT - *txBegin) % MAX_TX_CNT >= AO_TXRECORD_SIZE) {
+    if (size() >= AO_TXRECORD_SIZE) {
         //limit reached
 
         if (!silent) {
@@ -129,10 +222,12 @@ std::shared_ptr<Transaction> ConnectorTransactionStore::createTransaction(bool s
         //special case: silent tx -> create tx anyway, but should be deleted immediately after charging session
     }
 
-    auto transaction = std::make_shared<Transaction>(*this, connectorId, (unsigned int) *txEnd, silent);
+    auto transaction = std::make_shared<Transaction>(*this, connectorId, txEnd, silent);
 
-    *txEnd = (*txEnd + 1) % MAX_TX_CNT;
-    configuration_save();
+    if (!counters->set(AO_TXCOUNTER_END, (txEnd + 1) % MAX_TX_CNT)) {
+        AO_DBG_ERR("FS error");
+        return nullptr;
+    }
 
     if (!commit(transaction.get())) {
         AO_DBG_ERR("FS error");
@@ -151,12 +246,7 @@ std::shared_ptr<Transaction> ConnectorTransactionStore::createTransaction(bool s
 }
 
 std::shared_ptr<Transaction> ConnectorTransactionStore::getLatestTransaction() {
-    if (!txEnd || *txEnd < 0) {
-        AO_DBG_ERR("memory corruption");
-        return nullptr;
-    }
-
-    unsigned int latest = ((unsigned int) *txEnd + MAX_TX_CNT - 1) % MAX_TX_CNT;
+    unsigned int latest = ((unsigned int) getTxEnd() + MAX_TX_CNT - 1) % MAX_TX_CNT;
 
     return getTransaction(latest);
 }
@@ -175,13 +265,35 @@ bool ConnectorTransactionStore::commit(Transaction *transaction) {
         return false;
     }
     
-    DynamicJsonDocument txDoc {0};
-    if (!transaction->serializeSessionState(txDoc)) {
+    auto txDoc = std::make_shared<DynamicJsonDocument>(0);
+    if (!transaction->serializeSessionState(*txDoc)) {
         AO_DBG_ERR("Serialization error");
         return false;
     }
 
-    if (!FilesystemUtils::storeJson(filesystem, fn, txDoc)) {
+    auto format = static_cast<StorageFormat>(AO_TXSTORE_FORMAT);
+    uint32_t size = (uint32_t) FilesystemUtils::measure(*txDoc, format);
+
+    if (manifest->contains(transaction->getTxNr())) {
+        //update of a stored tx. The write can be deferred, the size update is saved with the next tx
+        auto filesystem = this->filesystem;
+        if (!persist([filesystem, fn, txDoc, format] () {
+                    return FilesystemUtils::storeJson(filesystem, fn, *txDoc, format);
+                })) {
+            AO_DBG_ERR("FS error");
+            return false;
+        }
+        manifest->put(transaction->getTxNr(), size);
+        return true;
+    }
+
+    //new txs are added to the manifest after their file exists
+    if (!FilesystemUtils::storeJson(filesystem, fn, *txDoc, format)) {
+        AO_DBG_ERR("FS error");
+        return false;
+    }
+
+    if (!manifest->add(transaction->getTxNr(), size)) {
         AO_DBG_ERR("FS error");
         return false;
     }
@@ -204,62 +316,49 @@ bool ConnectorTransactionStore::remove(unsigned int txNr) {
         return false;
     }
 
-    size_t msize;
-    if (filesystem->stat(fn, &msize) != 0) {
+    if (!manifest->contains(txNr)) {
         AO_DBG_DEBUG("%s already removed", fn);
         return true;
     }
 
     AO_DBG_DEBUG("remove %s", fn);
+
+    //a pending write must not recreate the file
+    persistence_flush();
+
+    //update the manifest first, so that it never lists a deleted file
+    if (!manifest->remove(txNr)) {
+        AO_DBG_ERR("FS error");
+        return false;
+    }
     
     return filesystem->remove(fn);
 }
 
 int ConnectorTransactionStore::getTxBegin() {
-    if (!txBegin || *txBegin < 0) {
-        AO_DBG_ERR("memory corruption");
-        return -1;
-    }
-
-    return *txBegin;
+    return (int) counters->get(AO_TXCOUNTER_BEGIN);
 }
 
 int ConnectorTransactionStore::getTxEnd() {
-    if (!txBegin || *txBegin < 0) {
-        AO_DBG_ERR("memory corruption");
-        return -1;
-    }
-
-    return *txEnd;
+    return (int) counters->get(AO_TXCOUNTER_END);
 }
 
 void ConnectorTransactionStore::setTxBegin(unsigned int txNr) {
-    if (!txBegin || *txBegin < 0) {
-        AO_DBG_ERR("memory corruption");
-        return;
+    if (!counters->set(AO_TXCOUNTER_BEGIN, txNr)) {
+        AO_DBG_ERR("FS error");
+        (void)0;
     }
-
-    *txBegin = txNr;
-    configuration_save();
 }
 
 void ConnectorTransactionStore::setTxEnd(unsigned int txNr) {
-    if (!txBegin || *txBegin < 0 || !txEnd || *txEnd < 0) {
-        AO_DBG_ERR("memory corruption");
-        return;
+    if (!counters->set(AO_TXCOUNTER_END, txNr)) {
+        AO_DBG_ERR("FS error");
+        (void)0;
     }
-
-    *txEnd = txNr;
-    configuration_save();
 }
 
 unsigned int ConnectorTransactionStore::size() {
-    if (!txBegin || *txBegin < 0 || !txEnd || *txEnd < 0) {
-        AO_DBG_ERR("memory corruption");
-        return 0;
-    }
-
-    return (*txEnd + MAX_TX_CNT - *txBegin) % MAX_TX_CNT;
+    return (counters->get(AO_TXCOUNTER_END) + MAX_TX_CNT - counters->get(AO_TXCOUNTER_BEGIN)) % MAX_TX_CNT;
 }
 
 TransactionStore::TransactionStore(unsigned int nConnectors, std::shared_ptr<FilesystemAdapter> filesystem) {
@@ -8,6 +8,8 @@
 #include <ArduinoOcpp/Tasks/Transactions/Transaction.h>
 #include <ArduinoOcpp/Core/Configuration.h>
 #include <ArduinoOcpp/Core/FilesystemAdapter.h>
+#include <ArduinoOcpp/Core/StoreManifest.h>
+#include <ArduinoOcpp/Core/CounterRecord.h>
 #include <deque>
 
 #define MAX_TX_CNT 100000U
@@ -26,11 +28,16 @@ private:
     const unsigned int connectorId;
 
     std::shared_ptr<FilesystemAdapter> filesystem;
-    std::shared_ptr<Configuration<int>> txBegin; //if txNr < txBegin, tx has been safely deleted
-    std::shared_ptr<Configuration<int>> txEnd;
+    char countersFn [MAX_PATH_SIZE];
+    std::unique_ptr<CounterRecord> counters; //txBegin and txEnd. If txNr < txBegin, tx has been safely deleted
+
+    char manifestName [10];
+    std::unique_ptr<StoreManifest> manifest; //stored txs
     
     std::deque<std::weak_ptr<Transaction>> transactions;
 
+    void migrateLegacyCounters();
+
 public:
     ConnectorTransactionStore(TransactionStore& context, unsigned int connectorId, std::shared_ptr<FilesystemAdapter> filesystem);
     
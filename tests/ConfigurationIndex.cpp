@@ -0,0 +1,148 @@
+#include <ArduinoOcpp/Core/ConfigurationIndex.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+#include "./catch2/catch.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace ArduinoOcpp;
+
+namespace {
+
+std::shared_ptr<AbstractConfiguration> makeConfig(const char *prefix, unsigned int i) {
+    char key [40];
+    snprintf(key, sizeof(key), "%s%u", prefix, i);
+    auto config = std::make_shared<Configuration<int>>();
+    config->setKey(key);
+    *config = (int) i;
+    return config;
+}
+
+}
+
+TEST_CASE( "Configuration index" ) {
+
+    ConfigurationIndex index;
+    const unsigned int N_KEYS = 500;
+
+    std::vector<std::shared_ptr<AbstractConfiguration>> configs;
+    for (unsigned int i = 0; i < N_KEYS; i++) {
+        configs.push_back(makeConfig("Key", i));
+        REQUIRE( index.add(configs.back(), nullptr) );
+    }
+
+    REQUIRE( index.size() == N_KEYS );
+    REQUIRE( index.capacity() >= 2 * N_KEYS );
+
+    //keys are unique
+    REQUIRE( !index.add(makeConfig("Key", 7), nullptr) );
+    REQUIRE( index.find("Key7")->configuration == configs[7] );
+
+    //removing entries must not break the probe sequences of the others
+    for (unsigned int i = 0; i < N_KEYS; i += 2) {
+        REQUIRE( index.remove(configs[i].get()) );
+    }
+    REQUIRE( !index.remove(configs[0].get()) );
+    REQUIRE( index.size() == N_KEYS / 2 );
+
+    for (unsigned int i = 0; i < N_KEYS; i++) {
+        auto entry = index.find(configs[i]->getKey());
+        if (i % 2) {
+            REQUIRE( entry );
+            REQUIRE( entry->configuration == configs[i] );
+        } else {
+            REQUIRE( !entry );
+        }
+    }
+
+    REQUIRE( !index.find("Unknown") );
+}
+
+TEST_CASE( "Global configuration lookup" ) {
+
+    auto config = declareConfiguration<int>("IndexedKey", 5, CONFIGURATION_VOLATILE "/index-a.jsn");
+    REQUIRE( config );
+    REQUIRE( Ocpp16::getConfiguration("IndexedKey") == config );
+
+    //declaring again returns the same configuration
+    REQUIRE( declareConfiguration<int>("IndexedKey", 6, CONFIGURATION_VOLATILE "/index-a.jsn") == config );
+
+    //type changes replace the configuration
+    auto configString = declareConfiguration<const char*>("IndexedKey", "value", CONFIGURATION_VOLATILE "/index-a.jsn");
+    REQUIRE( configString );
+    REQUIRE( Ocpp16::getConfiguration("IndexedKey") == configString );
+
+    //containers which are registered later are indexed with their configurations
+    auto container = std::make_shared<ConfigurationContainerVolatile>(CONFIGURATION_VOLATILE "/index-b.jsn");
+    auto added = makeConfig("IndexedKeyB", 0);
+    container->addConfiguration(added);
+    REQUIRE( !Ocpp16::getConfiguration("IndexedKeyB0") );
+    addConfigurationContainer(container);
+    REQUIRE( Ocpp16::getConfiguration("IndexedKeyB0") == added );
+
+    REQUIRE( container->removeConfiguration(added) );
+    REQUIRE( !Ocpp16::getConfiguration("IndexedKeyB0") );
+
+    //if the indexed configuration is removed, its duplicate in another container is indexed
+    auto duplicateContainer = std::make_shared<ConfigurationContainerVolatile>(CONFIGURATION_VOLATILE "/index-c.jsn");
+    auto indexed = makeConfig("IndexedKeyC", 0);
+    auto duplicate = makeConfig("IndexedKeyC", 0);
+    container->addConfiguration(indexed);
+    duplicateContainer->addConfiguration(duplicate);
+    addConfigurationContainer(duplicateContainer);
+    REQUIRE( Ocpp16::getConfiguration("IndexedKeyC0") == indexed );
+    REQUIRE( duplicateContainer->getConfiguration("IndexedKeyC0") == duplicate );
+
+    REQUIRE( container->removeConfiguration(indexed) );
+    REQUIRE( Ocpp16::getConfiguration("IndexedKeyC0") == duplicate );
+    REQUIRE( duplicateContainer->getConfiguration("IndexedKeyC0") == duplicate );
+    REQUIRE( !container->getConfiguration("IndexedKeyC0") );
+}
+
+TEST_CASE( "Configuration lookup benchmark", "[.][benchmark]" ) {
+
+    //vendor extensions spread over several files
+    const unsigned int N_FILES = 8;
+    const unsigned int N_KEYS = 320;
+
+    std::vector<std::string> keys;
+    for (unsigned int i = 0; i < N_KEYS; i++) {
+        char fn [40];
+        snprintf(fn, sizeof(fn), CONFIGURATION_VOLATILE "/bm-%u.jsn", i % N_FILES);
+        char key [40];
+        snprintf(key, sizeof(key), "VendorBenchmarkKey%u", i);
+        declareConfiguration<int>(key, (int) i, strdup(fn)); //containers keep the filename pointer
+        keys.push_back(key);
+    }
+
+    BENCHMARK("Lookup 320 keys, linear scan") {
+        size_t found = 0;
+        for (auto& key : keys) {
+            for (auto container = getConfigurationContainersBegin(); container != getConfigurationContainersEnd(); container++) {
+                bool hit = false;
+                for (auto config = (*container)->configurationsIteratorBegin(); config != (*container)->configurationsIteratorEnd(); config++) {
+                    if ((*config)->keyEquals(key.c_str())) {
+                        hit = true;
+                        break;
+                    }
+                }
+                if (hit) {
+                    found++;
+                    break;
+                }
+            }
+        }
+        return found;
+    };
+
+    BENCHMARK("Lookup 320 keys, hash index") {
+        size_t found = 0;
+        for (auto& key : keys) {
+            if (Ocpp16::getConfiguration(key.c_str())) {
+                found++;
+            }
+        }
+        return found;
+    };
+}
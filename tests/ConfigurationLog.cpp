@@ -0,0 +1,316 @@
+#include <ArduinoOcpp/Core/ConfigurationContainerLog.h>
+#include <ArduinoOcpp/Core/ConfigurationContainerFlash.h>
+#include <ArduinoOcpp/Core/MemoryFilesystemAdapter.h>
+#include "./catch2/catch.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#define TEST_FN "cfg.cnf"
+
+using namespace ArduinoOcpp;
+
+namespace {
+
+std::shared_ptr<Configuration<int>> addInt(ConfigurationContainer& container, const char *prefix, unsigned int i, int value) {
+    char key [40];
+    snprintf(key, sizeof(key), "%s%u", prefix, i);
+    auto config = std::make_shared<Configuration<int>>();
+    config->setKey(key);
+    *config = value;
+    container.addConfiguration(config);
+    return config;
+}
+
+int getInt(ConfigurationContainer& container, const char *key) {
+    auto config = container.getConfiguration(key);
+    REQUIRE( config );
+    REQUIRE( !strcmp(config->getSerializedType(), "int") );
+    return *std::static_pointer_cast<Configuration<int>>(config);
+}
+
+size_t getLogSize(MemoryFilesystemAdapter& filesystem) {
+    size_t size = 0, msize = 0;
+    if (filesystem.stat(TEST_FN ".0", &msize) == 0) {
+        size += msize;
+    }
+    if (filesystem.stat(TEST_FN ".1", &msize) == 0) {
+        size += msize;
+    }
+    return size;
+}
+
+}
+
+TEST_CASE( "Configuration log" ) {
+
+    auto filesystem = std::make_shared<MemoryFilesystemAdapter>();
+
+    SECTION("Append changes") {
+        auto container = std::make_shared<ConfigurationContainerLog>(filesystem, TEST_FN);
+        REQUIRE( container->load() );
+        auto configInt = addInt(*container, "Key", 0, 1);
+        for (unsigned int i = 1; i < 20; i++) {
+            addInt(*container, "Key", i, (int) i);
+        }
+        auto configString = std::make_shared<Configuration<const char*>>();
+        configString->setKey("KeyString");
+        *configString = "value";
+        container->addConfiguration(configString);
+        REQUIRE( container->save() );
+
+        //a single change is one small record
+        size_t size = getLogSize(*filesystem);
+        *configInt = 2;
+        REQUIRE( container->save() );
+        REQUIRE( getLogSize(*filesystem) > size );
+        REQUIRE( getLogSize(*filesystem) - size < 64 );
+
+        //no change, no write
+        auto nWrites = filesystem->getStats().nWrites;
+        REQUIRE( container->save() );
+        REQUIRE( filesystem->getStats().nWrites == nWrites );
+
+        REQUIRE( container->removeConfiguration(container->getConfiguration("Key5")) );
+        REQUIRE( container->save() );
+
+        ConfigurationContainerLog rebooted {filesystem, TEST_FN};
+        REQUIRE( rebooted.load() );
+        REQUIRE( getInt(rebooted, "Key0") == 2 );
+        REQUIRE( getInt(rebooted, "Key19") == 19 );
+        REQUIRE( !rebooted.getConfiguration("Key5") );
+        auto restoredString = rebooted.getConfiguration("KeyString");
+        REQUIRE( restoredString );
+        REQUIRE( !strcmp(*std::static_pointer_cast<Configuration<const char*>>(restoredString), "value") );
+    }
+
+    SECTION("No size limit") {
+        const unsigned int N_KEYS = 2000;
+        {
+            ConfigurationContainerLog container {filesystem, TEST_FN};
+            REQUIRE( container.load() );
+            for (unsigned int i = 0; i < N_KEYS; i++) {
+                addInt(container, "VendorKey", i, (int) i);
+            }
+            REQUIRE( container.save() );
+        }
+
+        REQUIRE( getLogSize(*filesystem) > 4000 );
+
+        ConfigurationContainerLog rebooted {filesystem, TEST_FN};
+        REQUIRE( rebooted.load() );
+        for (unsigned int i = 0; i < N_KEYS; i += 100) {
+            char key [40];
+            snprintf(key, sizeof(key), "VendorKey%u", i);
+            REQUIRE( getInt(rebooted, key) == (int) i );
+        }
+    }
+
+    SECTION("Compaction") {
+        const unsigned int N_UPDATES = 500;
+        {
+            ConfigurationContainerLog container {filesystem, TEST_FN};
+            REQUIRE( container.load() );
+            auto config = addInt(container, "Key", 0, 0);
+            addInt(container, "Key", 1, 1);
+            for (unsigned int i = 1; i <= N_UPDATES; i++) {
+                *config = (int) i;
+                REQUIRE( container.save() );
+            }
+        }
+
+        //outdated records are dropped from time to time
+        REQUIRE( getLogSize(*filesystem) < (2 * 2 + AO_CONFIGLOG_COMPACT_SLACK + 4) * 64 );
+
+        ConfigurationContainerLog rebooted {filesystem, TEST_FN};
+        REQUIRE( rebooted.load() );
+        REQUIRE( getInt(rebooted, "Key0") == (int) N_UPDATES );
+        REQUIRE( getInt(rebooted, "Key1") == 1 );
+    }
+
+    SECTION("Migrate configuration file") {
+        {
+            ConfigurationContainerFlash legacy {filesystem, TEST_FN};
+            REQUIRE( legacy.load() );
+            addInt(legacy, "Key", 0, 42);
+            REQUIRE( legacy.save() );
+        }
+
+        {
+            ConfigurationContainerLog container {filesystem, TEST_FN};
+            REQUIRE( container.load() );
+            REQUIRE( getInt(container, "Key0") == 42 );
+            REQUIRE( container.save() );
+        }
+
+        size_t msize = 0;
+        REQUIRE( filesystem->stat(TEST_FN, &msize) != 0 );
+
+        ConfigurationContainerLog rebooted {filesystem, TEST_FN};
+        REQUIRE( rebooted.load() );
+        REQUIRE( getInt(rebooted, "Key0") == 42 );
+    }
+
+    SECTION("Replace loaded configuration") {
+        {
+            ConfigurationContainerLog container {filesystem, TEST_FN};
+            REQUIRE( container.load() );
+            addInt(container, "Key", 0, 0);
+            addInt(container, "Key", 1, 42);
+            addInt(container, "Key", 2, 2);
+            REQUIRE( container.save() );
+        }
+
+        size_t logSize = getLogSize(*filesystem);
+
+        ConfigurationContainerLog rebooted {filesystem, TEST_FN};
+        REQUIRE( rebooted.load() );
+        auto stored = rebooted.getConfiguration("Key1");
+        REQUIRE( stored );
+
+        //static object as declared by the standard configurations, with revoked local write permission
+        auto configuration = std::make_shared<Configuration<int>>("Key1", 3);
+        configuration->revokePermissionLocalClientCanWrite();
+        REQUIRE( configuration->adoptValue(*stored) );
+        REQUIRE( *configuration == 42 );
+        REQUIRE( rebooted.replaceConfiguration(stored, configuration) );
+
+        REQUIRE( *(rebooted.configurationsIteratorBegin() + 1) == configuration );
+        REQUIRE( rebooted.getConfiguration("Key1") == configuration );
+
+        //nothing changed, so nothing is appended
+        REQUIRE( rebooted.save() );
+        REQUIRE( getLogSize(*filesystem) == logSize );
+
+        auto mismatch = std::make_shared<Configuration<bool>>("Key0", true);
+        REQUIRE( !mismatch->adoptValue(*rebooted.getConfiguration("Key0")) );
+    }
+
+    SECTION("Retry failed writes") {
+        ConfigurationContainerLog container {filesystem, TEST_FN};
+        REQUIRE( container.load() );
+        auto config = addInt(container, "Key", 0, 0);
+        REQUIRE( container.save() );
+
+        *config = 1;
+        filesystem->failWrite(1);
+        REQUIRE( !container.save() );
+        REQUIRE( container.hasWriteFailed() );
+
+        REQUIRE( container.save() );
+        REQUIRE( !container.hasWriteFailed() );
+
+        ConfigurationContainerLog rebooted {filesystem, TEST_FN};
+        REQUIRE( rebooted.load() );
+        REQUIRE( getInt(rebooted, "Key0") == 1 );
+    }
+
+    SECTION("Retry failed writes of the configuration file") {
+        ConfigurationContainerFlash container {filesystem, TEST_FN};
+        REQUIRE( container.load() );
+        auto config = addInt(container, "Key", 0, 0);
+        REQUIRE( container.save() );
+
+        *config = 1;
+        filesystem->failWrite(1);
+        REQUIRE( !container.save() );
+        REQUIRE( container.hasWriteFailed() );
+
+        //the changes are still pending
+        REQUIRE( container.save() );
+        REQUIRE( !container.hasWriteFailed() );
+
+        ConfigurationContainerFlash rebooted {filesystem, TEST_FN};
+        REQUIRE( rebooted.load() );
+        REQUIRE( getInt(rebooted, "Key0") == 1 );
+    }
+}
+
+TEST_CASE( "Configuration log power loss" ) {
+
+    const unsigned int N_UPDATES = 100; //enough for compactions
+
+    auto run = [N_UPDATES] (std::shared_ptr<MemoryFilesystemAdapter> filesystem, unsigned long powerLossAt) {
+        int acknowledged = -1;
+        ConfigurationContainerLog container {filesystem, TEST_FN};
+        container.load();
+        auto config = addInt(container, "Key", 0, 0);
+        addInt(container, "Key", 1, 1);
+        if (powerLossAt) {
+            filesystem->powerLossAtWrite(powerLossAt, 5);
+        }
+        for (unsigned int i = 0; i < N_UPDATES; i++) {
+            *config = (int) i;
+            if (container.save() && !filesystem->isPoweredOff()) {
+                acknowledged = (int) i;
+            }
+        }
+        return acknowledged;
+    };
+
+    unsigned long nWrites = 0;
+    {
+        //dry run to count the writes
+        auto filesystem = std::make_shared<MemoryFilesystemAdapter>();
+        run(filesystem, 0);
+        nWrites = filesystem->getStats().nWrites;
+    }
+
+    for (unsigned long n = 1; n <= nWrites; n++) {
+        auto filesystem = std::make_shared<MemoryFilesystemAdapter>();
+        int acknowledged = run(filesystem, n);
+        filesystem->powerOn();
+
+        //every acknowledged value survives
+        ConfigurationContainerLog rebooted {filesystem, TEST_FN};
+        REQUIRE( rebooted.load() );
+        if (acknowledged >= 0) {
+            REQUIRE( getInt(rebooted, "Key0") >= acknowledged );
+            REQUIRE( getInt(rebooted, "Key1") == 1 );
+        }
+    }
+}
+
+TEST_CASE( "Configuration log benchmark", "[.][benchmark]" ) {
+
+    const unsigned int N_KEYS = 50; //ConfigurationContainerFlash stores up to 50 keys
+
+    auto filesystemFlash = std::make_shared<MemoryFilesystemAdapter>();
+    ConfigurationContainerFlash containerFlash {filesystemFlash, TEST_FN};
+    containerFlash.load();
+    auto configFlash = addInt(containerFlash, "Key", 0, 0);
+    for (unsigned int i = 1; i < N_KEYS; i++) {
+        addInt(containerFlash, "Key", i, (int) i);
+    }
+    containerFlash.save();
+
+    auto filesystemLog = std::make_shared<MemoryFilesystemAdapter>();
+    ConfigurationContainerLog containerLog {filesystemLog, TEST_FN};
+    containerLog.load();
+    auto configLog = addInt(containerLog, "Key", 0, 0);
+    for (unsigned int i = 1; i < N_KEYS; i++) {
+        addInt(containerLog, "Key", i, (int) i);
+    }
+    containerLog.save();
+
+    filesystemFlash->resetStats();
+    filesystemLog->resetStats();
+
+    int value = 0;
+
+    BENCHMARK("Change one key, rewrite file") {
+        *configFlash = ++value;
+        return containerFlash.save();
+    };
+
+    BENCHMARK("Change one key, append to log") {
+        *configLog = ++value;
+        return containerLog.save();
+    };
+
+    auto statsFlash = filesystemFlash->getStats();
+    auto statsLog = filesystemLog->getStats();
+    WARN( "bytes written per save: file " << statsFlash.bytesWritten / std::max(containerFlash.getWriteCount() - 1, 1U)
+            << ", log " << statsLog.bytesWritten / std::max(containerLog.getWriteCount() - 1, 1U) );
+}
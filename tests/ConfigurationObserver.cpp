@@ -0,0 +1,81 @@
+#include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Tasks/Metering/MeterValue.h>
+#include <ArduinoOcpp/Tasks/Metering/SampledValue.h>
+#include "./catch2/catch.hpp"
+
+using namespace ArduinoOcpp;
+
+TEST_CASE( "Configuration observers" ) {
+
+    auto config = declareConfiguration<int>("ObservedKey", 1, CONFIGURATION_VOLATILE "/observers.jsn");
+    REQUIRE( config );
+
+    int nCalls = 0;
+    int observed = 0;
+    auto id = config->addObserver([&nCalls, &observed, config] (AbstractConfiguration& changed) {
+        REQUIRE( &changed == config.get() );
+        nCalls++;
+        observed = *config; //the new value is already set
+    });
+
+    *config = 2;
+    REQUIRE( nCalls == 1 );
+    REQUIRE( observed == 2 );
+
+    //writing the same value is no change
+    *config = 2;
+    REQUIRE( nCalls == 1 );
+
+    int nCalls2 = 0;
+    auto id2 = config->addObserver([&nCalls2] (AbstractConfiguration&) {
+        nCalls2++;
+    });
+    REQUIRE( id2 != id );
+
+    config->removeObserver(id);
+    *config = 3;
+    REQUIRE( nCalls == 1 );
+    REQUIRE( nCalls2 == 1 );
+
+    config->removeObserver(id2);
+    *config = 4;
+    REQUIRE( nCalls2 == 1 );
+
+    SECTION("String configurations") {
+        auto configString = declareConfiguration<const char*>("ObservedString", "a", CONFIGURATION_VOLATILE "/observers.jsn");
+        std::string observedString;
+        auto idString = configString->addObserver([&observedString, configString] (AbstractConfiguration&) {
+            observedString = *configString;
+        });
+        *configString = "b";
+        REQUIRE( observedString == "b" );
+        configString->removeObserver(idString);
+    }
+
+    SECTION("MeterValueBuilder updates the selected measurands") {
+        SampledValueProperties properties;
+        properties.setMeasurand("Energy.Active.Import.Register");
+        properties.setUnit("Wh");
+
+        std::vector<std::unique_ptr<SampledValueSampler>> samplers;
+        samplers.emplace_back(new SampledValueSamplerConcrete<int32_t, SampledValueDeSerializer<int32_t>>(properties, [] (ReadingContext) {return 0;}));
+
+        auto select = declareConfiguration<const char*>("ObservedSampledData", "", CONFIGURATION_VOLATILE "/observers.jsn");
+        *select = "";
+
+        {
+            MeterValueBuilder mvBuilder {samplers, select};
+            REQUIRE( !mvBuilder.takeSample(OcppTimestamp(), ReadingContext::SamplePeriodic) );
+
+            *select = "Energy.Active.Import.Register";
+            REQUIRE( mvBuilder.takeSample(OcppTimestamp(), ReadingContext::SamplePeriodic) );
+
+            //measurands which are deselected aren't sampled anymore
+            *select = "Power.Active.Import";
+            REQUIRE( !mvBuilder.takeSample(OcppTimestamp(), ReadingContext::SamplePeriodic) );
+        }
+
+        //the builder has removed its observer
+        *select = "Energy.Active.Import.Register";
+    }
+}
@@ -0,0 +1,133 @@
+#include <ArduinoOcpp/Core/CounterRecord.h>
+#include <ArduinoOcpp/Core/FilesystemAdapter.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Tasks/Transactions/TransactionStore.h>
+#include "./catch2/catch.hpp"
+
+#include <string.h>
+
+#define TEST_FN AO_FILENAME_PREFIX "/test.rec"
+
+using namespace ArduinoOcpp;
+
+TEST_CASE( "Counter record" ) {
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use);
+    REQUIRE( filesystem );
+
+    filesystem->remove(TEST_FN);
+
+    SECTION("Restore after reboot") {
+        CounterRecord record {filesystem, TEST_FN, 2};
+        REQUIRE( !record.load() );
+        REQUIRE( record.set(0, 5) );
+        REQUIRE( record.set(1, 7) );
+        REQUIRE( record.set(1, 8) );
+
+        //the file size never changes
+        size_t msize = 0;
+        REQUIRE( filesystem->stat(TEST_FN, &msize) == 0 );
+        REQUIRE( msize == 2 * (4 + 2 * 4 + 4) );
+
+        CounterRecord rebooted {filesystem, TEST_FN, 2};
+        REQUIRE( rebooted.load() );
+        REQUIRE( rebooted.get(0) == 5 );
+        REQUIRE( rebooted.get(1) == 8 );
+    }
+
+    SECTION("Interrupted update") {
+        {
+            CounterRecord record {filesystem, TEST_FN, 2};
+            record.set(0, 1); //creates the file with slot 1 as latest
+            record.set(0, 2); //slot 0
+            record.set(0, 3); //slot 1
+        }
+
+        //power loss while writing slot 1
+        auto file = filesystem->open(TEST_FN, "r+");
+        REQUIRE( file );
+        file->seek(16);
+        file->write("\xff\xff\xff\xff", 4);
+        file.reset();
+
+        CounterRecord rebooted {filesystem, TEST_FN, 2};
+        REQUIRE( rebooted.load() );
+        REQUIRE( rebooted.get(0) == 2 );
+
+        //the corrupted slot is overwritten
+        REQUIRE( rebooted.set(0, 4) );
+        CounterRecord rebooted2 {filesystem, TEST_FN, 2};
+        REQUIRE( rebooted2.load() );
+        REQUIRE( rebooted2.get(0) == 4 );
+    }
+
+    SECTION("Migrate tx counters") {
+        configuration_init(filesystem);
+
+        char fn [MAX_PATH_SIZE];
+        for (unsigned int i = 0; i < 2; i++) {
+            snprintf(fn, sizeof(fn), AO_FILENAME_PREFIX "/txctr-%u.rec", i);
+            filesystem->remove(fn);
+        }
+
+        //counters of previous versions
+        auto txBegin = declareConfiguration<int>("AO_txBegin_1", 0, AO_FILENAME_PREFIX "/txstore.jsn", false, false, true, false);
+        auto txEnd = declareConfiguration<int>("AO_txEnd_1", 0, AO_FILENAME_PREFIX "/txstore.jsn", false, false, true, false);
+        *txBegin = 3;
+        *txEnd = 5;
+
+        {
+            TransactionStore store {2, filesystem};
+            REQUIRE( store.getTxBegin(1) == 3 );
+            REQUIRE( store.getTxEnd(1) == 5 );
+            store.setTxBegin(1, 4);
+        }
+
+        //the configurations aren't updated anymore
+        REQUIRE( (int) *txBegin == 3 );
+
+        TransactionStore rebooted {2, filesystem};
+        REQUIRE( rebooted.getTxBegin(1) == 4 );
+        REQUIRE( rebooted.getTxEnd(1) == 5 );
+        REQUIRE( rebooted.size(1) == 1 );
+
+        //the legacy counters are removed after the migration
+        std::shared_ptr<ConfigurationContainer> container;
+        for (auto c = getConfigurationContainersBegin(); c != getConfigurationContainersEnd(); c++) {
+            if (!strcmp((*c)->getFilename(), AO_FILENAME_PREFIX "/txstore.jsn")) {
+                container = *c;
+            }
+        }
+        REQUIRE( container );
+        REQUIRE( !container->getConfiguration("AO_txBegin_1") );
+        REQUIRE( !container->getConfiguration("AO_txEnd_1") );
+    }
+
+    SECTION("Corrupt tx counters") {
+        configuration_init(filesystem);
+
+        //stale counters of previous versions
+        auto txBegin = declareConfiguration<int>("AO_txBegin_1", 0, AO_FILENAME_PREFIX "/txstore.jsn", false, false, true, false);
+        auto txEnd = declareConfiguration<int>("AO_txEnd_1", 0, AO_FILENAME_PREFIX "/txstore.jsn", false, false, true, false);
+        *txBegin = 3;
+        *txEnd = 5;
+
+        //both slots of the counter file are corrupt
+        char fn [MAX_PATH_SIZE];
+        snprintf(fn, sizeof(fn), AO_FILENAME_PREFIX "/txctr-%u.rec", 1);
+        auto file = filesystem->open(fn, "w");
+        REQUIRE( file );
+        const char corrupt [32] = {'\xff'};
+        file->write(corrupt, sizeof(corrupt));
+        file.reset();
+
+        //the stale counters aren't taken over again
+        TransactionStore store {2, filesystem};
+        REQUIRE( store.getTxBegin(1) == 0 );
+        REQUIRE( store.getTxEnd(1) == 0 );
+
+        filesystem->remove(fn);
+    }
+
+    filesystem->remove(TEST_FN);
+}
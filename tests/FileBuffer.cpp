@@ -0,0 +1,158 @@
+#include <ArduinoJson.h>
+#include <ArduinoOcpp/Core/FilesystemUtils.h>
+#include <ArduinoOcpp/Core/ConfigurationContainerFlash.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Tasks/Transactions/TransactionStore.h>
+#include "./catch2/catch.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_FN AO_FILENAME_PREFIX "/buffer.jsn"
+#define TEST_CONFIG_FN AO_FILENAME_PREFIX "/bm-config.jsn"
+
+using namespace ArduinoOcpp;
+
+//counts the calls which reach the filesystem
+class CountingFileAdapter : public FileAdapter {
+    std::unique_ptr<FileAdapter> file;
+public:
+    unsigned int nReads = 0;
+    unsigned int nWrites = 0;
+
+    CountingFileAdapter(std::unique_ptr<FileAdapter> file) : file(std::move(file)) { }
+
+    size_t read(char *buf, size_t len) override {nReads++; return file->read(buf, len);}
+    size_t write(const char *buf, size_t len) override {nWrites++; return file->write(buf, len);}
+    size_t seek(size_t offset) override {return file->seek(offset);}
+    int read() override {nReads++; return file->read();}
+};
+
+TEST_CASE( "Buffered file adapters" ) {
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use);
+    REQUIRE( filesystem );
+
+    const size_t N_BYTES = 1000;
+    const size_t BUFSIZE = 64;
+
+    {
+        CountingFileAdapter file {filesystem->open(TEST_FN, "w")};
+        char buf [BUFSIZE];
+        ArduinoJsonFileWriter writer {&file, buf, sizeof(buf)};
+        for (size_t i = 0; i < N_BYTES; i++) {
+            REQUIRE( writer.write((uint8_t) i) == 1 );
+        }
+        uint8_t block [3 * BUFSIZE];
+        for (size_t i = 0; i < sizeof(block); i++) {
+            block[i] = (uint8_t) (N_BYTES + i);
+        }
+        REQUIRE( writer.write(block, sizeof(block)) == sizeof(block) );
+        REQUIRE( writer.flush() );
+        REQUIRE( file.nWrites <= N_BYTES / BUFSIZE + 2 );
+    }
+
+    size_t msize = 0;
+    REQUIRE( filesystem->stat(TEST_FN, &msize) == 0 );
+    REQUIRE( msize == N_BYTES + 3 * BUFSIZE );
+
+    {
+        CountingFileAdapter file {filesystem->open(TEST_FN, "r")};
+        char buf [BUFSIZE];
+        ArduinoJsonFileReader reader {&file, buf, sizeof(buf)};
+        for (size_t i = 0; i < N_BYTES; i++) {
+            REQUIRE( reader.read() == (int) (uint8_t) i );
+        }
+        char block [3 * BUFSIZE];
+        REQUIRE( reader.readBytes(block, sizeof(block)) == sizeof(block) );
+        for (size_t i = 0; i < sizeof(block); i++) {
+            REQUIRE( (uint8_t) block[i] == (uint8_t) (N_BYTES + i) );
+        }
+        REQUIRE( reader.read() == -1 );
+        REQUIRE( file.nReads <= N_BYTES / BUFSIZE + 4 );
+    }
+
+    filesystem->remove(TEST_FN);
+}
+
+TEST_CASE( "Buffered file I/O benchmark", "[.][benchmark]" ) {
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use);
+    configuration_init(filesystem);
+
+    filesystem->remove(TEST_CONFIG_FN);
+
+    //a config file with as many entries as a typical charger has
+    auto container = std::make_shared<ConfigurationContainerFlash>(filesystem, TEST_CONFIG_FN);
+    std::vector<std::shared_ptr<Configuration<int>>> configs;
+    for (unsigned int i = 0; i < 40; i++) {
+        char key [30];
+        snprintf(key, sizeof(key), "BenchmarkKey%u", i);
+        auto config = std::make_shared<Configuration<int>>();
+        config->setKey(key);
+        *config = (int) i;
+        container->addConfiguration(config);
+        configs.push_back(config);
+    }
+    container->save();
+
+    DynamicJsonDocument doc {4096};
+    {
+        auto loaded = FilesystemUtils::loadJson(filesystem, TEST_CONFIG_FN);
+        REQUIRE( loaded );
+        doc = *loaded;
+    }
+
+    BENCHMARK("Write config file, unbuffered") {
+        auto file = filesystem->open(TEST_FN, "w");
+        char buf [1];
+        ArduinoJsonFileWriter writer {file.get(), buf, sizeof(buf)};
+        return serializeJson(doc, writer);
+    };
+
+    BENCHMARK("Write config file, buffered") {
+        auto file = filesystem->open(TEST_FN, "w");
+        char buf [AO_FILE_BUFSIZE];
+        ArduinoJsonFileWriter writer {file.get(), buf, sizeof(buf)};
+        return serializeJson(doc, writer);
+    };
+
+    BENCHMARK("Read config file, unbuffered") {
+        auto file = filesystem->open(TEST_FN, "r");
+        char buf [1];
+        ArduinoJsonFileReader reader {file.get(), buf, sizeof(buf)};
+        DynamicJsonDocument parsed {4096};
+        return deserializeJson(parsed, reader);
+    };
+
+    BENCHMARK("Read config file, buffered") {
+        auto file = filesystem->open(TEST_FN, "r");
+        char buf [AO_FILE_BUFSIZE];
+        ArduinoJsonFileReader reader {file.get(), buf, sizeof(buf)};
+        DynamicJsonDocument parsed {4096};
+        return deserializeJson(parsed, reader);
+    };
+
+    int counter = 0;
+    BENCHMARK("Save configurations") {
+        *configs[0] = counter++;
+        return container->save();
+    };
+
+    BENCHMARK("Load configurations") {
+        ConfigurationContainerFlash loaded {filesystem, TEST_CONFIG_FN};
+        return loaded.load();
+    };
+
+    TransactionStore txStore {1, filesystem};
+    auto tx = txStore.createTransaction(0, true);
+    REQUIRE( tx );
+
+    BENCHMARK("Commit tx") {
+        return txStore.commit(tx.get());
+    };
+
+    txStore.remove(0, tx->getTxNr());
+    filesystem->remove(TEST_FN);
+    filesystem->remove(TEST_CONFIG_FN);
+}
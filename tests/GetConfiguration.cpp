@@ -0,0 +1,114 @@
+#include <ArduinoJson.h>
+#include <ArduinoOcpp/MessagesV16/GetConfiguration.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
+#include "./catch2/catch.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+using namespace ArduinoOcpp;
+
+namespace {
+
+std::string readConf(const char *req) {
+    DynamicJsonDocument reqDoc {1024};
+    deserializeJson(reqDoc, req);
+    Ocpp16::GetConfiguration getConfiguration;
+    getConfiguration.processReq(reqDoc.as<JsonObject>());
+
+    JsonWriter measure {nullptr, 0};
+    REQUIRE( getConfiguration.writeConf(measure) );
+    REQUIRE( measure.isValid() );
+
+    std::string out;
+    out.resize(measure.getRequiredSize());
+    JsonWriter writer {&out[0], out.length()};
+    getConfiguration.writeConf(writer);
+    REQUIRE( writer.isValid() );
+    out.resize(writer.getLength());
+    return out;
+}
+
+std::string createConf(const char *req) {
+    DynamicJsonDocument reqDoc {1024};
+    deserializeJson(reqDoc, req);
+    Ocpp16::GetConfiguration getConfiguration;
+    getConfiguration.processReq(reqDoc.as<JsonObject>());
+
+    std::string out;
+    serializeJson(*getConfiguration.createConf(), out);
+    return out;
+}
+
+}
+
+TEST_CASE( "Streaming GetConfiguration" ) {
+
+    auto configInt = declareConfiguration<int>("GetConfigInt", 42, CONFIGURATION_VOLATILE "/getconf.jsn");
+    declareConfiguration<const char*>("GetConfigString", "value", CONFIGURATION_VOLATILE "/getconf.jsn", false);
+    declareConfiguration<int>("GetConfigHidden", 1, CONFIGURATION_VOLATILE "/getconf.jsn", false, false);
+
+    SECTION("Requested keys") {
+        auto req = "{\"key\":[\"GetConfigString\",\"Unknown1\",\"GetConfigInt\",\"Unknown2\"]}";
+        REQUIRE( readConf(req) == createConf(req) );
+        REQUIRE( readConf(req) ==
+                "{\"configurationKey\":["
+                    "{\"key\":\"GetConfigString\",\"readonly\":true,\"value\":\"value\"},"
+                    "{\"key\":\"GetConfigInt\",\"readonly\":false,\"value\":\"42\"}],"
+                "\"unknownKey\":[\"Unknown1\",\"Unknown2\"]}" );
+    }
+
+    SECTION("All keys") {
+        auto req = "{}";
+        auto conf = readConf(req);
+        REQUIRE( conf == createConf(req) );
+        REQUIRE( conf.find("GetConfigInt") != std::string::npos );
+        REQUIRE( conf.find("GetConfigHidden") == std::string::npos );
+
+        //the snapshot is reused until a value changes
+        REQUIRE( readConf(req) == conf );
+
+        *configInt = 43;
+        auto updated = readConf(req);
+        REQUIRE( updated != conf );
+        REQUIRE( updated.find("\"value\":\"43\"") != std::string::npos );
+        REQUIRE( updated == createConf(req) );
+
+        //new keys are added to the snapshot
+        declareConfiguration<int>("GetConfigAdded", 0, CONFIGURATION_VOLATILE "/getconf.jsn");
+        REQUIRE( readConf(req).find("GetConfigAdded") != std::string::npos );
+    }
+
+    SECTION("All keys exceeding the snapshot size") {
+        auto req = "{}";
+        for (unsigned int i = 0; readConf(req).length() <= AO_GETCONFIGURATION_SNAPSHOT_MAX; i++) {
+            char key [40];
+            snprintf(key, sizeof(key), "GetConfigFiller%u", i);
+            declareConfiguration<int>(key, (int) i, CONFIGURATION_VOLATILE "/getconf.jsn");
+        }
+
+        //serialized on each request instead
+        REQUIRE( readConf(req) == createConf(req) );
+        REQUIRE( readConf(req).find("GetConfigFiller0") != std::string::npos );
+    }
+}
+
+TEST_CASE( "GetConfiguration benchmark", "[.][benchmark]" ) {
+
+    const unsigned int N_KEYS = 120;
+    for (unsigned int i = 0; i < N_KEYS; i++) {
+        char key [40];
+        snprintf(key, sizeof(key), "GetConfigBenchmarkKey%u", i);
+        declareConfiguration<int>(key, (int) i, CONFIGURATION_VOLATILE "/getconf-bm.jsn");
+    }
+
+    BENCHMARK("Poll all keys, JsonDocument per entry") {
+        return createConf("{}").length();
+    };
+
+    BENCHMARK("Poll all keys, cached snapshot") {
+        return readConf("{}").length();
+    };
+}
@@ -0,0 +1,91 @@
+#include <ArduinoJson.h>
+#include <ArduinoOcpp/Core/JsonCapacity.h>
+#include "./catch2/catch.hpp"
+
+#include <string.h>
+#include <memory>
+
+using namespace ArduinoOcpp;
+
+//captured OCPP-J frames as received from a central system
+static const char *capturedFrames [] = {
+    "[3,\"1000012\",{\"currentTime\":\"2022-12-01T09:41:27.123Z\"}]",
+    "[3,\"1000001\",{\"status\":\"Accepted\",\"currentTime\":\"2022-12-01T09:40:00.000Z\",\"interval\":3600}]",
+    "[2,\"9f1f4c2b-3d2e-4a8c-bb6e-5d4e8e1a2c70\",\"ChangeConfiguration\",{\"key\":\"MeterValueSampleInterval\",\"value\":\"60\"}]",
+    "[2,\"1d3c0a2e-7c61-4b7d-9b0f-4d3e2c1b0a99\",\"GetConfiguration\",{\"key\":[\"HeartbeatInterval\",\"MeterValueSampleInterval\","
+        "\"MeterValuesSampledData\",\"ConnectionTimeOut\",\"AuthorizeRemoteTxRequests\",\"LocalAuthorizeOffline\","
+        "\"StopTransactionOnEVSideDisconnect\",\"ClockAlignedDataInterval\",\"NumberOfConnectors\"]}]",
+    "[2,\"5b0a7e1c-6f2d-4e3a-8c9b-1a2b3c4d5e6f\",\"RemoteStartTransaction\",{\"connectorId\":1,\"idTag\":\"04A2B3C4D5E6F7\","
+        "\"chargingProfile\":{\"chargingProfileId\":12,\"stackLevel\":1,\"chargingProfilePurpose\":\"TxProfile\","
+        "\"chargingProfileKind\":\"Relative\",\"chargingSchedule\":{\"chargingRateUnit\":\"A\",\"chargingSchedulePeriod\":"
+        "[{\"startPeriod\":0,\"limit\":16.0},{\"startPeriod\":1800,\"limit\":10.0,\"numberPhases\":3}]}}}]",
+    "[2,\"c2d1e0f9-8a7b-4c6d-9e5f-0a1b2c3d4e5f\",\"SetChargingProfile\",{\"connectorId\":0,\"csChargingProfiles\":"
+        "{\"chargingProfileId\":7,\"stackLevel\":0,\"chargingProfilePurpose\":\"ChargePointMaxProfile\","
+        "\"chargingProfileKind\":\"Recurring\",\"recurrencyKind\":\"Daily\",\"validFrom\":\"2022-12-01T00:00:00.000Z\","
+        "\"validTo\":\"2023-12-01T00:00:00.000Z\",\"chargingSchedule\":{\"duration\":86400,"
+        "\"startSchedule\":\"2022-12-01T00:00:00.000Z\",\"chargingRateUnit\":\"W\",\"chargingSchedulePeriod\":["
+        "{\"startPeriod\":0,\"limit\":11000.0},{\"startPeriod\":3600,\"limit\":7400.0},{\"startPeriod\":7200,\"limit\":3700.0},"
+        "{\"startPeriod\":10800,\"limit\":11000.0},{\"startPeriod\":21600,\"limit\":22000.0},{\"startPeriod\":28800,\"limit\":11000.0},"
+        "{\"startPeriod\":43200,\"limit\":7400.0},{\"startPeriod\":54000,\"limit\":11000.0},{\"startPeriod\":64800,\"limit\":3700.0},"
+        "{\"startPeriod\":72000,\"limit\":11000.0},{\"startPeriod\":79200,\"limit\":22000.0}],\"minChargingRate\":1400.0}}}]",
+    "[4,\"1000007\",\"NotImplemented\",\"Requested Action is \\\"unknown\\\" \\u00e0 this server\",{}]"
+};
+
+TEST_CASE( "JSON capacity pre-scan" ) {
+
+    SECTION("Captured frames fit into measured capacity") {
+        for (const char *frame : capturedFrames) {
+            size_t length = strlen(frame);
+            size_t capacity = measureJsonCapacity(frame, length);
+            REQUIRE( capacity > 0 );
+
+            DynamicJsonDocument doc (capacity);
+            REQUIRE( deserializeJson(doc, frame, length) == DeserializationError::Ok );
+            REQUIRE( doc.memoryUsage() <= capacity );
+        }
+    }
+
+    SECTION("Malformed input") {
+        const char *malformed [] = {
+            "[2,\"abc\",\"Heartbeat\",{}",
+            "[2,\"abc\",\"Heartbeat\",{]}",
+            "[2,\"abc",
+            "[[[[[[[[[[[[1]]]]]]]]]]]]"
+        };
+        for (const char *frame : malformed) {
+            REQUIRE( measureJsonCapacity(frame, strlen(frame)) == 0 );
+        }
+    }
+}
+
+TEST_CASE( "JSON capacity pre-scan benchmark", "[.][benchmark]" ) {
+
+    BENCHMARK("Deserialize captured frames, grow capacity on NoMemory") {
+        size_t nParsed = 0;
+        for (const char *frame : capturedFrames) {
+            size_t length = strlen(frame);
+            size_t capacity = length + 100;
+            std::unique_ptr<DynamicJsonDocument> doc;
+            DeserializationError err = DeserializationError::NoMemory;
+            while (err == DeserializationError::NoMemory) {
+                doc.reset(new DynamicJsonDocument(capacity));
+                err = deserializeJson(*doc, frame, length);
+                capacity *= 3;
+                capacity /= 2;
+                nParsed++;
+            }
+        }
+        return nParsed;
+    };
+
+    BENCHMARK("Deserialize captured frames, pre-scan capacity") {
+        size_t nParsed = 0;
+        for (const char *frame : capturedFrames) {
+            size_t length = strlen(frame);
+            std::unique_ptr<DynamicJsonDocument> doc {new DynamicJsonDocument(measureJsonCapacity(frame, length))};
+            deserializeJson(*doc, frame, length);
+            nParsed++;
+        }
+        return nParsed;
+    };
+}
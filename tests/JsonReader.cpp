@@ -0,0 +1,194 @@
+#include <ArduinoJson.h>
+#include <ArduinoOcpp/Core/JsonReader.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
+#include <ArduinoOcpp/Tasks/SmartCharging/SmartChargingModel.h>
+#include <ArduinoOcpp/MessagesV16/RemoteStartTransaction.h>
+#include "./catch2/catch.hpp"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace ArduinoOcpp;
+
+static const char *csChargingProfiles =
+        "{\"chargingProfileId\":7,\"stackLevel\":0,\"chargingProfilePurpose\":\"ChargePointMaxProfile\","
+        "\"chargingProfileKind\":\"Recurring\",\"recurrencyKind\":\"Daily\",\"validFrom\":\"2022-12-01T00:00:00.000Z\","
+        "\"validTo\":\"2023-12-01T00:00:00.000Z\",\"chargingSchedule\":{\"duration\":86400,"
+        "\"startSchedule\":\"2022-12-01T00:00:00.000Z\",\"chargingRateUnit\":\"W\",\"chargingSchedulePeriod\":["
+        "{\"startPeriod\":3600,\"limit\":7400.0},{\"startPeriod\":0,\"limit\":11000.0,\"numberPhases\":3}],"
+        "\"minChargingRate\":1400.5}}";
+
+static std::string writeProfile(ChargingProfile& profile) {
+    JsonWriter measure {nullptr, 0};
+    profile.writeJson(measure);
+    std::string out;
+    out.resize(measure.getRequiredSize());
+    JsonWriter writer {&out[0], out.length()};
+    profile.writeJson(writer);
+    REQUIRE( writer.isValid() );
+    out.resize(writer.getLength());
+    return out;
+}
+
+TEST_CASE( "JsonReader" ) {
+
+    SECTION("Field handlers and skipping unknown members") {
+        const char *json = "{ \"unknown\": {\"a\":[1,{\"b\":null},\"]\"]}, \"id\" : 42, \"tag\":\"A\\\"\\u00e0\\ud83d\\ude00\","
+                           "\"limit\":-1.5e1, \"flag\":true, \"keys\":[\"x\",\"y\"] }";
+        JsonReader reader {json, strlen(json)};
+
+        int id = -1;
+        char tag [16] = {'\0'};
+        float limit = 0.f;
+        bool flag = false;
+        std::vector<std::string> keys;
+
+        bool success = reader.readObject([&] (const char *key) {
+            if (!strcmp(key, "id")) {
+                reader.readInt(id);
+            } else if (!strcmp(key, "tag")) {
+                reader.readString(tag, sizeof(tag));
+            } else if (!strcmp(key, "limit")) {
+                reader.readFloat(limit);
+            } else if (!strcmp(key, "flag")) {
+                reader.readBool(flag);
+            } else if (!strcmp(key, "keys")) {
+                reader.readArray([&] () {
+                    std::string k;
+                    reader.readString(k);
+                    keys.push_back(k);
+                });
+            } else {
+                return false;
+            }
+            return true;
+        });
+
+        REQUIRE( success );
+        REQUIRE( id == 42 );
+        REQUIRE( !strcmp(tag, "A\"\xc3\xa0\xf0\x9f\x98\x80") );
+        REQUIRE( limit == -15.f );
+        REQUIRE( flag );
+        REQUIRE( keys.size() == 2 );
+        REQUIRE( keys[1] == "y" );
+    }
+
+    SECTION("Type and format violations") {
+        const char *inputs [] = {
+            "{\"id\":\"42\"}", //string instead of number
+            "{\"id\":42,}",
+            "{\"id\" 42}",
+            "{\"id\":42",
+            "{\"id\":[42,]}",
+            "{\"id\":[42 42]}",
+            "{\"id\":[42}",
+            "{\"id\":[42"
+        };
+        for (const char *json : inputs) {
+            JsonReader reader {json, strlen(json)};
+            int id = -1;
+            reader.readObject([&] (const char *key) {
+                if (reader.peek() == JsonReader::Type::Array) {
+                    return reader.readArray([&] () {
+                        reader.readInt(id);
+                    });
+                }
+                return reader.readInt(id);
+            });
+            REQUIRE( !reader.isValid() );
+        }
+
+        const char *tooLong = "[\"0123456789\"]";
+        JsonReader reader {tooLong, strlen(tooLong)};
+        char buf [10];
+        reader.readArray([&] () {
+            reader.readString(buf, sizeof(buf));
+        });
+        REQUIRE( !reader.isValid() );
+    }
+
+    SECTION("Decode ChargingProfile without JsonDocument") {
+        JsonReader reader {csChargingProfiles, strlen(csChargingProfiles)};
+        ChargingProfile streamed {reader};
+        REQUIRE( reader.isValid() );
+        REQUIRE( streamed.getChargingProfileId() == 7 );
+        REQUIRE( streamed.getChargingProfilePurpose() == ChargingProfilePurposeType::ChargePointMaxProfile );
+
+        DynamicJsonDocument doc (2048);
+        REQUIRE( deserializeJson(doc, csChargingProfiles) == DeserializationError::Ok );
+        JsonObject json = doc.as<JsonObject>();
+        ChargingProfile deserialized {json};
+
+        REQUIRE( writeProfile(streamed) == writeProfile(deserialized) );
+
+        const char *malformed = "{\"chargingProfileId\":7,\"chargingSchedule\":{\"chargingSchedulePeriod\":[{},]}}";
+        JsonReader reader2 {malformed, strlen(malformed)};
+        ChargingProfile invalid {reader2};
+        REQUIRE( !reader2.isValid() );
+    }
+
+    SECTION("Accept the same ChargingProfiles as the DOM path") {
+        const char *inputs [] = {
+            csChargingProfiles,
+            //missing members
+            "{\"chargingProfileId\":7,\"stackLevel\":0}",
+            "{\"chargingSchedule\":{\"chargingSchedulePeriod\":[{\"limit\":16},{\"startPeriod\":60}]}}",
+            //strings which exceed the expected values
+            "{\"chargingProfileId\":7,\"chargingProfilePurpose\":\"ChargePointMaxProfileAndMore\","
+                "\"chargingProfileKind\":\"Recurring-Weekly\",\"recurrencyKind\":\"Weeklyyy\","
+                "\"validFrom\":\"2022-12-01T00:00:00.000000000000000Z\",\"chargingSchedule\":{"
+                "\"chargingRateUnit\":\"Amperes\",\"chargingSchedulePeriod\":[{\"startPeriod\":0,\"limit\":16}]}}",
+            "{\"chargingProfilePurpose\":\"TxDefaultProfile\",\"chargingProfileKind\":\"Absolute\","
+                "\"chargingSchedule\":{\"startSchedule\":\"2022-12-01T00:00:00.000Z and some text\","
+                "\"chargingRateUnit\":\"\",\"chargingSchedulePeriod\":[]}}",
+            //members of an unexpected type
+            "{\"chargingProfileId\":7,\"chargingProfilePurpose\":1,\"validTo\":false,\"chargingSchedule\":\"none\"}",
+            "{\"chargingProfileKind\":[\"Absolute\"],\"chargingSchedule\":{\"chargingRateUnit\":65,"
+                "\"chargingSchedulePeriod\":[1,{\"startPeriod\":60,\"limit\":16,\"numberPhases\":null}],"
+                "\"minChargingRate\":\"6\",\"unknown\":{\"a\":[{}]}}}",
+            "{\"chargingProfileId\":7,\"chargingSchedule\":{\"chargingSchedulePeriod\":{\"startPeriod\":0}}}",
+            "[]"
+        };
+
+        for (const char *json : inputs) {
+            JsonReader reader {json, strlen(json)};
+            ChargingProfile streamed {reader};
+            REQUIRE( reader.isValid() );
+
+            DynamicJsonDocument doc (2048);
+            REQUIRE( deserializeJson(doc, json) == DeserializationError::Ok );
+            JsonObject payload = doc.as<JsonObject>();
+            ChargingProfile deserialized {payload};
+
+            REQUIRE( writeProfile(streamed) == writeProfile(deserialized) );
+        }
+    }
+
+    SECTION("Same RemoteStartTransaction error codes as the DOM path") {
+        const char *inputs [] = {
+            "{\"idTag\":\"mIdTag\",\"chargingProfile\":{\"chargingProfileId\":7,\"stackLevel\":0}}",
+            "{\"idTag\":\"mIdTag\",\"chargingProfile\":{\"chargingProfileId\":-1,\"stackLevel\":0}}",
+            "{\"idTag\":\"mIdTag\",\"chargingProfile\":{\"stackLevel\":0}}",
+            "{\"chargingProfile\":{\"chargingProfileId\":7}}"
+        };
+
+        for (const char *json : inputs) {
+            Ocpp16::RemoteStartTransaction streamed;
+            JsonReader reader {json, strlen(json)};
+            REQUIRE( streamed.readReq(reader) );
+
+            DynamicJsonDocument doc (1024);
+            REQUIRE( deserializeJson(doc, json) == DeserializationError::Ok );
+            Ocpp16::RemoteStartTransaction deserialized;
+            deserialized.processReq(doc.as<JsonObject>());
+
+            if (deserialized.getErrorCode()) {
+                REQUIRE( streamed.getErrorCode() );
+                REQUIRE( !strcmp(streamed.getErrorCode(), deserialized.getErrorCode()) );
+            } else {
+                REQUIRE( !streamed.getErrorCode() );
+            }
+        }
+    }
+}
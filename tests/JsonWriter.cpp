@@ -0,0 +1,111 @@
+#include <ArduinoJson.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
+#include <ArduinoOcpp/Core/OcppTime.h>
+#include <ArduinoOcpp/Tasks/Metering/MeterValue.h>
+#include <ArduinoOcpp/Tasks/Metering/SampledValue.h>
+#include <ArduinoOcpp/MessagesV16/StatusNotification.h>
+#include "./catch2/catch.hpp"
+
+#include <string>
+#include <cmath>
+
+using namespace ArduinoOcpp;
+
+//serializes in two passes like OcppOperation: measure first, then write into the exactly sized buffer
+template<class F>
+std::string writeJson(F write) {
+    JsonWriter measure {nullptr, 0};
+    write(measure);
+    REQUIRE( measure.isValid() );
+
+    std::string out;
+    out.resize(measure.getRequiredSize());
+    JsonWriter writer {&out[0], out.length()};
+    write(writer);
+    REQUIRE( writer.isValid() );
+    REQUIRE( writer.getLength() == measure.getLength() );
+    out.resize(writer.getLength());
+    return out;
+}
+
+TEST_CASE( "JsonWriter" ) {
+
+    SECTION("Separators, escaping and rollback") {
+        auto out = writeJson([] (JsonWriter& w) {
+            w.beginArray();
+            w.value(2);
+            w.value("id \"1\"\n");
+            w.beginObject();
+            w.key("a");
+            w.value(-5L);
+            w.key("b");
+            w.beginArray();
+            w.value(true);
+            auto checkpoint = w.getCheckpoint();
+            w.beginObject();
+            w.key("discarded");
+            w.value("entry which doesn't fit into the final length");
+            w.rollback(checkpoint);
+            w.value((const char*) nullptr);
+            w.endArray();
+            w.key("c");
+            w.beginObject();
+            w.endObject();
+            w.endObject();
+            w.endArray();
+        });
+
+        REQUIRE( out == "[2,\"id \\\"1\\\"\\n\",{\"a\":-5,\"b\":[true,null],\"c\":{}}]" );
+    }
+
+    SECTION("Buffer overflow") {
+        char buf [4];
+        JsonWriter writer {buf, sizeof(buf)};
+        writer.beginArray();
+        writer.value("abc");
+        writer.endArray();
+        REQUIRE( !writer.isValid() );
+        REQUIRE( writer.getLength() == 7 );
+    }
+
+    SECTION("Floats are formatted like ArduinoJson") {
+        const float values [] = {0.f, 16.f, -7.5f, 0.1f, 1400.5f, 1e6f, 123456.7f, 9999999.f};
+        for (float val : values) {
+            StaticJsonDocument<JSON_ARRAY_SIZE(1)> doc;
+            doc.add(val);
+            std::string expected;
+            serializeJson(doc, expected);
+            REQUIRE( writeJson([val] (JsonWriter& w) {
+                w.beginArray();
+                w.value(val);
+                w.endArray();
+            }) == expected );
+        }
+
+        //no exponents for meter readings
+        REQUIRE( writeJson([] (JsonWriter& w) {w.value(1e6f);}) == "1000000" );
+        REQUIRE( writeJson([] (JsonWriter& w) {w.value(NAN);}) == "null" );
+    }
+
+    SECTION("Streaming encoders match the JsonDocument payloads") {
+        OcppTimestamp timestamp {2022, 11, 30, 9, 41, 27};
+
+        Ocpp16::StatusNotification statusNotification {1, OcppEvseState::Charging, timestamp};
+
+        std::string expected;
+        serializeJson(*statusNotification.createReq(), expected);
+        REQUIRE( writeJson([&statusNotification] (JsonWriter& w) {statusNotification.writeReq(w);}) == expected );
+
+        SampledValueProperties properties;
+        properties.setMeasurand("Energy.Active.Import.Register");
+        properties.setUnit("Wh");
+
+        MeterValue meterValue {timestamp};
+        meterValue.addSampledValue(std::unique_ptr<SampledValue>(
+                new SampledValueConcrete<int32_t, SampledValueDeSerializer<int32_t>>(properties, ReadingContext::SamplePeriodic, 12345)));
+
+        expected.clear();
+        serializeJson(*meterValue.toJson(), expected);
+        REQUIRE( writeJson([&meterValue] (JsonWriter& w) {meterValue.writeJson(w);}) == expected );
+    }
+}
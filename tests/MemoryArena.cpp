@@ -0,0 +1,68 @@
+#include <ArduinoJson.h>
+#include <ArduinoOcpp/Core/MemoryArena.h>
+#include "./catch2/catch.hpp"
+
+#include <string.h>
+
+using namespace ArduinoOcpp;
+
+TEST_CASE( "MemoryArena" ) {
+
+    MemoryArena arena {256};
+
+    SECTION("Monotonic allocation and reset") {
+        void *a = arena.allocate(10);
+        void *b = arena.allocate(20);
+        REQUIRE( a != nullptr );
+        REQUIRE( b != nullptr );
+        REQUIRE( arena.owns(a) );
+        REQUIRE( reinterpret_cast<uintptr_t>(b) % AO_ARENA_ALIGNMENT == 0 );
+        REQUIRE( arena.getBlockSize(b) == 20 );
+
+        //the most recent block can grow in place
+        REQUIRE( arena.reallocate(b, 40) == b );
+        REQUIRE( arena.reallocate(a, 40) == nullptr );
+
+        REQUIRE( arena.allocate(1000) == nullptr );
+
+        arena.deallocate(a);
+        arena.reset(); //refused, b is still in use
+        REQUIRE( arena.getUsed() > 0 );
+
+        arena.deallocate(b);
+        REQUIRE( arena.getUsed() == 0 );
+        REQUIRE( arena.getHighWater() > 0 );
+    }
+
+    SECTION("Allocator falls back to heap") {
+        ArenaAllocator allocator {&arena};
+
+        void *a = allocator.allocate(100);
+        void *b = allocator.allocate(500);
+        REQUIRE( arena.owns(a) );
+        REQUIRE( !arena.owns(b) );
+
+        //moving a block out of the arena keeps its content
+        memset(a, 'x', 100);
+        void *c = allocator.allocate(16);
+        void *moved = allocator.reallocate(a, 400);
+        REQUIRE( moved != nullptr );
+        REQUIRE( !arena.owns(moved) );
+        REQUIRE( !memcmp(moved, "xxxxxxxx", 8) );
+
+        allocator.deallocate(b);
+        allocator.deallocate(c);
+        allocator.deallocate(moved);
+        REQUIRE( arena.getUsed() == 0 );
+    }
+
+    SECTION("ArenaJsonDocument") {
+        {
+            ArenaJsonDocument doc {128, ArenaAllocator(&arena)};
+            REQUIRE( arena.getUsed() > 0 );
+            REQUIRE( deserializeJson(doc, "[2,\"1\",\"Heartbeat\",{}]") == DeserializationError::Ok );
+            REQUIRE( !strcmp(doc[2] | "", "Heartbeat") );
+        }
+        REQUIRE( arena.getUsed() == 0 );
+    }
+}
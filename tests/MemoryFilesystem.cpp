@@ -0,0 +1,198 @@
+#include <ArduinoOcpp/Core/MemoryFilesystemAdapter.h>
+#include <ArduinoOcpp/Core/CounterRecord.h>
+#include <ArduinoOcpp/Core/OperationLog.h>
+#include "./catch2/catch.hpp"
+
+#include <string.h>
+#include <vector>
+
+#define TEST_FN "test.bin"
+
+using namespace ArduinoOcpp;
+
+TEST_CASE( "Memory filesystem" ) {
+
+    MemoryFilesystemProfile profile;
+    profile.blockSize = 16;
+    profile.writeUs = 100;
+    profile.eraseUs = 1000;
+    MemoryFilesystemAdapter filesystem {profile};
+
+    SECTION("File operations") {
+        size_t msize = 0;
+        REQUIRE( filesystem.stat(TEST_FN, &msize) != 0 );
+        REQUIRE( !filesystem.open(TEST_FN, "r") );
+
+        auto file = filesystem.open(TEST_FN, "w");
+        REQUIRE( file );
+        REQUIRE( file->write("0123456789", 10) == 10 );
+        file.reset();
+
+        file = filesystem.open(TEST_FN, "a");
+        REQUIRE( file->write("abc", 3) == 3 );
+        file.reset();
+
+        file = filesystem.open(TEST_FN, "r+");
+        REQUIRE( file->seek(2) == 0 );
+        REQUIRE( file->write("XY", 2) == 2 );
+        file.reset();
+
+        REQUIRE( filesystem.stat(TEST_FN, &msize) == 0 );
+        REQUIRE( msize == 13 );
+
+        file = filesystem.open(TEST_FN, "r");
+        char buf [20];
+        REQUIRE( file->read(buf, sizeof(buf)) == 13 );
+        REQUIRE( !memcmp(buf, "01XY456789abc", 13) );
+        REQUIRE( file->read() == -1 );
+        file.reset();
+
+        auto mapping = filesystem.map(TEST_FN);
+        REQUIRE( mapping );
+        REQUIRE( mapping->size() == 13 );
+        REQUIRE( !memcmp(mapping->data(), "01XY456789abc", 13) );
+
+        REQUIRE( filesystem.remove(TEST_FN) );
+        REQUIRE( filesystem.stat(TEST_FN, &msize) != 0 );
+        REQUIRE( filesystem.getFilesCount() == 0 );
+    }
+
+    SECTION("Cost model") {
+        char data [40] = {0};
+        auto file = filesystem.open(TEST_FN, "w");
+        file->write(data, 40); //3 new blocks
+        file->write(data, 4); //still in the 3rd block
+        file->write(data, 10); //4th block
+        REQUIRE( file->seek(0) == 0 );
+        file->write(data, 20); //overwrites 2 blocks
+        file.reset();
+
+        auto stats = filesystem.getStats();
+        REQUIRE( stats.nWrites == 4 );
+        REQUIRE( stats.bytesWritten == 74 );
+        REQUIRE( stats.nErases == 6 );
+        REQUIRE( stats.elapsedUs == 4 * profile.writeUs + 6 * profile.eraseUs );
+
+        filesystem.resetStats();
+        REQUIRE( filesystem.getStats().elapsedUs == 0 );
+    }
+
+    SECTION("Write failure") {
+        auto file = filesystem.open(TEST_FN, "w");
+        filesystem.failWrite(2);
+        REQUIRE( file->write("abc", 3) == 3 );
+        REQUIRE( file->write("def", 3) == 0 );
+        REQUIRE( file->write("ghi", 3) == 3 );
+        file.reset();
+
+        size_t msize = 0;
+        filesystem.stat(TEST_FN, &msize);
+        REQUIRE( msize == 6 );
+    }
+
+    SECTION("Power loss") {
+        auto file = filesystem.open(TEST_FN, "w");
+        filesystem.powerLossAtWrite(2, 1);
+        REQUIRE( file->write("abc", 3) == 3 );
+        REQUIRE( file->write("def", 3) == 1 );
+        REQUIRE( filesystem.isPoweredOff() );
+        REQUIRE( file->write("ghi", 3) == 0 );
+        file.reset();
+
+        REQUIRE( !filesystem.open(TEST_FN, "w") );
+        REQUIRE( !filesystem.remove(TEST_FN) );
+
+        filesystem.powerOn();
+        file = filesystem.open(TEST_FN, "r");
+        char buf [10];
+        REQUIRE( file->read(buf, sizeof(buf)) == 4 );
+        REQUIRE( !memcmp(buf, "abcd", 4) );
+    }
+}
+
+TEST_CASE( "Power loss at every write" ) {
+
+    SECTION("Counter record") {
+        const uint32_t N_UPDATES = 10;
+
+        for (unsigned long n = 1; n <= N_UPDATES; n++) {
+            auto filesystem = std::make_shared<MemoryFilesystemAdapter>();
+
+            uint32_t acknowledged = 0;
+            {
+                CounterRecord record {filesystem, TEST_FN, 2};
+                record.load();
+                filesystem->powerLossAtWrite(n, 5);
+                for (uint32_t i = 1; i <= N_UPDATES; i++) {
+                    if (record.set(0, i)) {
+                        acknowledged = i;
+                    }
+                }
+            }
+
+            filesystem->powerOn();
+
+            CounterRecord rebooted {filesystem, TEST_FN, 2};
+            rebooted.load();
+            REQUIRE( rebooted.get(0) >= acknowledged );
+            REQUIRE( rebooted.get(0) <= acknowledged + 1 );
+        }
+    }
+
+    SECTION("Operation log") {
+        const unsigned int N_OPS = 80; //enough for compactions
+        char data [100];
+
+        unsigned long nWrites = 0;
+        {
+            //dry run to count the writes
+            auto filesystem = std::make_shared<MemoryFilesystemAdapter>();
+            OperationLog log {filesystem};
+            log.load(0);
+            for (unsigned int i = 0; i < N_OPS; i++) {
+                memset(data, 'a' + (i % 26), sizeof(data));
+                log.append(i, data, sizeof(data));
+                log.setHead(i > 0 ? i - 1 : 0);
+            }
+            nWrites = filesystem->getStats().nWrites;
+        }
+
+        for (unsigned long n = 1; n <= nWrites; n++) {
+            auto filesystem = std::make_shared<MemoryFilesystemAdapter>();
+
+            std::vector<unsigned int> acknowledged;
+            unsigned int acknowledgedHead = 0;
+            {
+                OperationLog log {filesystem};
+                log.load(0);
+                filesystem->powerLossAtWrite(n, 7);
+                for (unsigned int i = 0; i < N_OPS; i++) {
+                    memset(data, 'a' + (i % 26), sizeof(data));
+                    if (log.append(i, data, sizeof(data))) {
+                        acknowledged.push_back(i);
+                    }
+                    if (log.setHead(i > 0 ? i - 1 : 0)) {
+                        acknowledgedHead = i > 0 ? i - 1 : 0;
+                    }
+                }
+            }
+
+            filesystem->powerOn();
+
+            //every acknowledged operation after the acknowledged head is restored intact
+            OperationLog rebooted {filesystem};
+            rebooted.load(0);
+            REQUIRE( rebooted.getHead() >= acknowledgedHead );
+            for (auto opNr : acknowledged) {
+                if (opNr < rebooted.getHead()) {
+                    continue;
+                }
+                char buf [sizeof(data)];
+                REQUIRE( rebooted.getLength(opNr) == sizeof(data) );
+                REQUIRE( rebooted.read(opNr, buf, sizeof(buf)) );
+                memset(data, 'a' + (opNr % 26), sizeof(data));
+                REQUIRE( !memcmp(buf, data, sizeof(data)) );
+            }
+        }
+    }
+}
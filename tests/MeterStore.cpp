@@ -0,0 +1,220 @@
+#include <ArduinoJson.h>
+#include <ArduinoOcpp/Tasks/Metering/MeterStore.h>
+#include <ArduinoOcpp/Tasks/Metering/SampledValue.h>
+#include <ArduinoOcpp/Tasks/Transactions/TransactionStore.h>
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
+#include <ArduinoOcpp/Core/MemoryFilesystemAdapter.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+#include "./catch2/catch.hpp"
+
+#include <string>
+
+#define TEST_LOG_FN AO_FILENAME_PREFIX "/sd-1-7.log"
+#define TEST_MANIFEST_FN(slot) AO_FILENAME_PREFIX "/sd-" #slot ".mf"
+
+using namespace ArduinoOcpp;
+
+namespace {
+
+std::unique_ptr<MeterValue> makeSample(int32_t energy) {
+    SampledValueProperties properties;
+    properties.setMeasurand("Energy.Active.Import.Register");
+    properties.setUnit("Wh");
+
+    auto mv = std::unique_ptr<MeterValue>(new MeterValue(OcppTimestamp {2022, 11, 30, 9, 41, 27}));
+    mv->addSampledValue(std::unique_ptr<SampledValue>(
+            new SampledValueConcrete<int32_t, SampledValueDeSerializer<int32_t>>(properties, ReadingContext::SamplePeriodic, std::move(energy))));
+    return mv;
+}
+
+std::string serialize(MeterValue& mv) {
+    std::string out;
+    serializeJson(*mv.toJson(), out);
+    return out;
+}
+
+}
+
+TEST_CASE( "StopTxData log" ) {
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use);
+    configuration_init(filesystem);
+
+    filesystem->remove(TEST_LOG_FN);
+
+    SampledValueProperties properties;
+    properties.setMeasurand("Energy.Active.Import.Register");
+    properties.setUnit("Wh");
+
+    std::vector<std::unique_ptr<SampledValueSampler>> samplers;
+    samplers.emplace_back(new SampledValueSamplerConcrete<int32_t, SampledValueDeSerializer<int32_t>>(properties, [] (ReadingContext) {return 0;}));
+    auto select = declareConfiguration<const char*>("StopTxnSampledData", "Energy.Active.Import.Register", CONFIGURATION_VOLATILE);
+    MeterValueBuilder mvBuilder {samplers, select};
+
+    SECTION("Restore after reboot") {
+        {
+            TransactionMeterData txData {1, 7, filesystem};
+            REQUIRE( txData.restore(mvBuilder) );
+            for (int32_t i = 0; i < 3; i++) {
+                REQUIRE( txData.addTxData(makeSample(i)) );
+            }
+        }
+
+        TransactionMeterData rebooted {1, 7, filesystem};
+        REQUIRE( rebooted.restore(mvBuilder) );
+        REQUIRE( rebooted.size() == 3 );
+
+        auto restored = rebooted.retrieveStopTxData();
+        for (int32_t i = 0; i < 3; i++) {
+            REQUIRE( serialize(*restored[i]) == serialize(*makeSample(i)) );
+        }
+    }
+
+    SECTION("History limit") {
+        const int32_t N_SAMPLES = 3 * AO_METERLOG_MAX_RECORDS;
+        {
+            TransactionMeterData txData {1, 7, filesystem};
+            for (int32_t i = 0; i < N_SAMPLES; i++) {
+                REQUIRE( txData.addTxData(makeSample(i)) );
+            }
+            REQUIRE( txData.size() == AO_MAX_STOPTXDATA_LEN );
+        }
+
+        //outdated records are dropped from time to time
+        persistence_flush();
+        size_t msize = 0;
+        REQUIRE( filesystem->stat(TEST_LOG_FN, &msize) == 0 );
+        REQUIRE( msize < 2 * AO_METERLOG_MAX_RECORDS * serialize(*makeSample(N_SAMPLES)).size() );
+
+        TransactionMeterData rebooted {1, 7, filesystem};
+        REQUIRE( rebooted.restore(mvBuilder) );
+        REQUIRE( rebooted.size() == AO_MAX_STOPTXDATA_LEN );
+
+        auto restored = rebooted.retrieveStopTxData();
+        REQUIRE( serialize(*restored.front()) == serialize(*makeSample(0)) );
+        REQUIRE( serialize(*restored.back()) == serialize(*makeSample(N_SAMPLES - 1)) );
+    }
+
+    SECTION("Corrupted tail") {
+        {
+            TransactionMeterData txData {1, 7, filesystem};
+            REQUIRE( txData.addTxData(makeSample(1)) );
+            REQUIRE( txData.addTxData(makeSample(2)) );
+        }
+
+        //power loss while appending
+        persistence_flush();
+        auto file = filesystem->open(TEST_LOG_FN, "a");
+        REQUIRE( file );
+        file->write("A\x40\x00{\"time", 10);
+        file.reset();
+
+        {
+            TransactionMeterData rebooted {1, 7, filesystem};
+            REQUIRE( rebooted.restore(mvBuilder) );
+            REQUIRE( rebooted.size() == 2 );
+            REQUIRE( rebooted.addTxData(makeSample(3)) );
+        }
+
+        TransactionMeterData rebooted2 {1, 7, filesystem};
+        REQUIRE( rebooted2.restore(mvBuilder) );
+        REQUIRE( rebooted2.size() == 3 );
+    }
+
+    SECTION("Remove") {
+        {
+            TransactionMeterData txData {1, 7, filesystem};
+            REQUIRE( txData.addTxData(makeSample(1)) );
+        }
+
+        MeterStore meterStore {filesystem};
+        REQUIRE( meterStore.remove(1, 7) );
+
+        size_t msize = 0;
+        REQUIRE( filesystem->stat(TEST_LOG_FN, &msize) != 0 );
+    }
+
+    SECTION("Migrate legacy files on a later boot") {
+        TransactionStore txStore {2, filesystem};
+        txStore.setTxBegin(1, 7);
+        txStore.setTxEnd(1, 7);
+        auto tx = txStore.createTransaction(1);
+        REQUIRE( tx );
+        REQUIRE( tx->getTxNr() == 7 );
+
+        //one file per sample and no manifest, as written by previous firmware versions
+        const unsigned int N_LEGACY = 2;
+        for (unsigned int i = 0; i < N_LEGACY; i++) {
+            char fn [MAX_PATH_SIZE];
+            snprintf(fn, sizeof(fn), AO_FILENAME_PREFIX "/sd-1-7-%u.jsn", i);
+            auto file = filesystem->open(fn, "w");
+            REQUIRE( file );
+            auto json = serialize(*makeSample((int32_t) i));
+            file->write(json.c_str(), json.size());
+        }
+        filesystem->remove(TEST_MANIFEST_FN(0));
+        filesystem->remove(TEST_MANIFEST_FN(1));
+
+        {
+            //first boot after the upgrade doesn't touch the tx
+            MeterStore meterStore {filesystem, &txStore, 2};
+        }
+
+        MeterStore rebooted {filesystem, &txStore, 2};
+        auto txData = rebooted.getTxMeterData(mvBuilder, tx.get());
+        REQUIRE( txData );
+        REQUIRE( txData->size() == N_LEGACY );
+
+        size_t msize = 0;
+        REQUIRE( filesystem->stat(AO_FILENAME_PREFIX "/sd-1-7-0.jsn", &msize) != 0 );
+
+        txData.reset();
+        REQUIRE( rebooted.remove(1, 7) );
+        txStore.remove(1, 7);
+        txStore.setTxBegin(1, 0);
+        txStore.setTxEnd(1, 0);
+    }
+
+    SECTION("Keep legacy files until the log is written") {
+        auto memFilesystem = std::make_shared<MemoryFilesystemAdapter>();
+        TransactionStore txStore {2, memFilesystem};
+        auto tx = txStore.createTransaction(1);
+        REQUIRE( tx );
+
+        char legacyFn [MAX_PATH_SIZE];
+        snprintf(legacyFn, sizeof(legacyFn), AO_FILENAME_PREFIX "/sd-1-%u-0.jsn", tx->getTxNr());
+        auto file = memFilesystem->open(legacyFn, "w");
+        REQUIRE( file );
+        auto json = serialize(*makeSample(0));
+        file->write(json.c_str(), json.size());
+        file.reset();
+
+        MeterStore meterStore {memFilesystem, &txStore, 2};
+
+        //writing the log fails
+        memFilesystem->failWrite(1);
+        auto txData = meterStore.getTxMeterData(mvBuilder, tx.get());
+        REQUIRE( txData );
+        REQUIRE( txData->size() == 1 );
+        REQUIRE( !txData->flush() );
+
+        size_t msize = 0;
+        REQUIRE( memFilesystem->stat(legacyFn, &msize) == 0 );
+
+        //the next sample rewrites the log including the legacy sample
+        REQUIRE( txData->addTxData(makeSample(1)) );
+        REQUIRE( txData->flush() );
+        txData.reset();
+
+        MeterStore rebooted {memFilesystem, &txStore, 2};
+        auto restored = rebooted.getTxMeterData(mvBuilder, tx.get());
+        REQUIRE( restored );
+        REQUIRE( restored->size() == 2 );
+
+        restored.reset();
+        REQUIRE( rebooted.remove(1, tx->getTxNr()) );
+        REQUIRE( memFilesystem->stat(legacyFn, &msize) != 0 );
+    }
+
+    filesystem->remove(TEST_LOG_FN);
+}
@@ -0,0 +1,259 @@
+#include <ArduinoOcpp/Core/OperationStore.h>
+#include <ArduinoOcpp/Core/OcppOperation.h>
+#include <ArduinoOcpp/Core/OperationLog.h>
+#include <ArduinoOcpp/Core/FilesystemAdapter.h>
+#include <ArduinoOcpp/Core/MemoryFilesystemAdapter.h>
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+#include "./catch2/catch.hpp"
+
+#include <string.h>
+#include <string>
+
+#define SEGMENT_0 AO_FILENAME_PREFIX "/oplog-0.wal"
+#define SEGMENT_1 AO_FILENAME_PREFIX "/oplog-1.wal"
+
+using namespace ArduinoOcpp;
+
+TEST_CASE( "Operation log" ) {
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use);
+    REQUIRE( filesystem );
+
+    //start with an empty log
+    filesystem->remove(SEGMENT_0);
+    filesystem->remove(SEGMENT_1);
+
+    SECTION("Restore after reboot") {
+        OperationLog log {filesystem};
+        REQUIRE( !log.load(5) );
+        REQUIRE( log.append(5, "op-5", 4) );
+        REQUIRE( log.append(6, "op-6", 4) );
+        REQUIRE( log.setHead(6) );
+
+        OperationLog rebooted {filesystem};
+        REQUIRE( rebooted.load(0) );
+        REQUIRE( rebooted.getHead() == 6 );
+        REQUIRE( rebooted.getEnd() == 7 );
+        REQUIRE( rebooted.getLength(5) == 0 );
+
+        char buf [4];
+        REQUIRE( rebooted.read(6, buf, sizeof(buf)) );
+        REQUIRE( !memcmp(buf, "op-6", 4) );
+    }
+
+    SECTION("Interrupted append") {
+        {
+            OperationLog log {filesystem};
+            log.load(0);
+            log.append(0, "op-0", 4);
+        }
+
+        //record which was cut off by a power loss
+        auto file = filesystem->open(SEGMENT_0, "a");
+        file->write("O\x01\x00\x04\x00op", 7);
+        file.reset();
+
+        OperationLog rebooted {filesystem};
+        REQUIRE( rebooted.load(0) );
+        REQUIRE( rebooted.getEnd() == 1 );
+        REQUIRE( rebooted.append(1, "op-1", 4) );
+
+        OperationLog rebooted2 {filesystem};
+        rebooted2.load(0);
+        REQUIRE( rebooted2.getLength(0) == 4 );
+        REQUIRE( rebooted2.getLength(1) == 4 );
+    }
+
+    SECTION("Compaction") {
+        OperationLog log {filesystem};
+        log.load(0);
+
+        //the latest operation is pending, all previous ones are completed
+        char data [100];
+        for (unsigned int i = 0; i < 500; i++) {
+            memset(data, 'a' + (i % 26), sizeof(data));
+            REQUIRE( log.append(i, data, sizeof(data)) );
+            REQUIRE( log.setHead(i) );
+        }
+
+        size_t size0 = 0, size1 = 0;
+        filesystem->stat(SEGMENT_0, &size0);
+        filesystem->stat(SEGMENT_1, &size1);
+        REQUIRE( size0 + size1 <= AO_OPLOG_SEGMENT_SIZE + 2 * sizeof(data) );
+
+        OperationLog rebooted {filesystem};
+        rebooted.load(0);
+        REQUIRE( rebooted.getHead() == 499 );
+        REQUIRE( rebooted.getEnd() == 500 );
+        REQUIRE( rebooted.read(499, data, sizeof(data)) );
+        REQUIRE( data[0] == 'a' + (499 % 26) );
+    }
+
+    SECTION("OperationStore") {
+        configuration_init(filesystem);
+
+        unsigned int opNr = 0;
+        {
+            OperationStore store {filesystem};
+            auto handler = store.makeOpHandler();
+            auto rpc = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(JSON_ARRAY_SIZE(3)));
+            rpc->add(MESSAGE_TYPE_CALL);
+            rpc->add("1000");
+            rpc->add("StartTransaction");
+            auto payload = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(JSON_OBJECT_SIZE(1)));
+            (*payload)["connectorId"] = 1;
+            handler->setRpc(std::move(rpc));
+            handler->setPayload(std::move(payload));
+            REQUIRE( handler->commit() );
+            opNr = (unsigned int) handler->getOpNr();
+            REQUIRE( store.getOpEnd() == (opNr + 1) % AO_MAX_OPNR );
+        }
+
+        OperationStore rebooted {filesystem};
+        REQUIRE( rebooted.getOpBegin() == opNr );
+        auto handler = rebooted.makeOpHandler();
+        REQUIRE( handler->restore(opNr) );
+        auto rpc = handler->getRpc();
+        REQUIRE( !strcmp((*rpc)[2] | "", "StartTransaction") );
+
+        rebooted.advanceOpNr(opNr);
+        OperationStore rebooted2 {filesystem};
+        REQUIRE( rebooted2.getOpBegin() == (opNr + 1) % AO_MAX_OPNR );
+        REQUIRE( rebooted2.getOpEnd() == rebooted2.getOpBegin() );
+    }
+}
+
+TEST_CASE( "Operation log with failed deferred write" ) {
+
+    auto filesystem = std::make_shared<MemoryFilesystemAdapter>();
+    PersistenceExecutor executor {true};
+    setActivePersistenceExecutor(&executor);
+
+    {
+        OperationLog log {filesystem};
+        log.load(0);
+        REQUIRE( log.append(0, "op-0", 4) );
+        persistence_flush();
+
+        //the append is accepted, but the record never reaches the segment
+        filesystem->failWrite(1);
+        REQUIRE( log.append(1, "op-1", 4) );
+        persistence_flush();
+
+        //the compaction drops the missing record and the log continues
+        REQUIRE( log.append(2, "op-2", 4) );
+        REQUIRE( log.getLength(1) == 0 );
+
+        char buf [4];
+        REQUIRE( log.read(0, buf, sizeof(buf)) );
+        REQUIRE( !memcmp(buf, "op-0", 4) );
+        REQUIRE( log.read(2, buf, sizeof(buf)) );
+        REQUIRE( !memcmp(buf, "op-2", 4) );
+    }
+
+    OperationLog rebooted {filesystem};
+    REQUIRE( rebooted.load(0) );
+    REQUIRE( rebooted.getLength(0) == 4 );
+    REQUIRE( rebooted.getLength(1) == 0 );
+    REQUIRE( rebooted.getLength(2) == 4 );
+
+    setActivePersistenceExecutor(nullptr);
+}
+
+TEST_CASE( "Write a failed operation again" ) {
+
+    configuration_init(makeDefaultFilesystemAdapter(FilesystemOpt::Use));
+
+    auto filesystem = std::make_shared<MemoryFilesystemAdapter>();
+    PersistenceExecutor executor {true};
+    setActivePersistenceExecutor(&executor);
+
+    auto makeHandler = [] (OperationStore& store) {
+        auto handler = store.makeOpHandler();
+        auto rpc = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(JSON_ARRAY_SIZE(3)));
+        rpc->add(MESSAGE_TYPE_CALL);
+        rpc->add("1000");
+        rpc->add("StartTransaction");
+        handler->setRpc(std::move(rpc));
+        handler->setPayload(std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(JSON_OBJECT_SIZE(1))));
+        return handler;
+    };
+
+    unsigned int opNr = 0;
+    {
+        OperationStore store {filesystem};
+        auto first = makeHandler(store);
+        REQUIRE( first->commit() );
+        persistence_flush();
+        REQUIRE( !first->isWriteFailed() );
+
+        //the write is accepted, but fails in the background
+        auto handler = makeHandler(store);
+        filesystem->failWrite(1);
+        REQUIRE( handler->commit() );
+        persistence_flush();
+        REQUIRE( handler->isWriteFailed() );
+
+        REQUIRE( handler->recommit() );
+        persistence_flush();
+        REQUIRE( !handler->isWriteFailed() );
+        opNr = (unsigned int) handler->getOpNr();
+    }
+
+    OperationStore rebooted {filesystem};
+    auto handler = rebooted.makeOpHandler();
+    REQUIRE( handler->restore(opNr) );
+
+    setActivePersistenceExecutor(nullptr);
+}
+
+TEST_CASE( "Operation log with a remaining old segment" ) {
+
+    auto filesystem = std::make_shared<MemoryFilesystemAdapter>();
+
+    auto readFile = [&filesystem] (const char *fn) {
+        std::string content;
+        size_t size = 0;
+        if (filesystem->stat(fn, &size) == 0 && size > 0) {
+            content.resize(size);
+            auto file = filesystem->open(fn, "r");
+            REQUIRE( file->read(&content[0], size) == size );
+        }
+        return content;
+    };
+
+    char data [100];
+    unsigned int opNr = 0;
+    {
+        OperationLog log {filesystem};
+        log.load(0);
+
+        //append until the first compaction moves the log into segment 1
+        std::string oldSegment;
+        while (readFile(SEGMENT_1).empty()) {
+            oldSegment = readFile(SEGMENT_0);
+            memset(data, 'a' + (opNr % 26), sizeof(data));
+            REQUIRE( log.append(opNr, data, sizeof(data)) );
+            REQUIRE( log.setHead(opNr) );
+            opNr++;
+        }
+        REQUIRE( readFile(SEGMENT_0).empty() );
+
+        //the old segment couldn't be truncated
+        auto file = filesystem->open(SEGMENT_0, "w");
+        REQUIRE( file->write(oldSegment.c_str(), oldSegment.length()) == oldSegment.length() );
+        file.reset();
+
+        //operations after the compaction only exist in the new segment
+        memset(data, 'z', sizeof(data));
+        REQUIRE( log.append(opNr, data, sizeof(data)) );
+    }
+
+    OperationLog rebooted {filesystem};
+    REQUIRE( rebooted.load(0) );
+    REQUIRE( rebooted.getLength(opNr) == sizeof(data) );
+    REQUIRE( rebooted.read(opNr, data, sizeof(data)) );
+    REQUIRE( data[0] == 'z' );
+    REQUIRE( readFile(SEGMENT_0).empty() );
+}
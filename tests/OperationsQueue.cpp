@@ -0,0 +1,263 @@
+#include <ArduinoOcpp.h>
+#include <ArduinoOcpp/Core/OcppSocket.h>
+#include <ArduinoOcpp/Core/OcppMessage.h>
+#include <ArduinoOcpp/Core/OcppOperation.h>
+#include <ArduinoOcpp/Core/OperationsQueue.h>
+#include <ArduinoOcpp/Core/JsonWriter.h>
+#include <ArduinoOcpp/MessagesV16/MeterValues.h>
+#include <ArduinoOcpp/Tasks/Metering/MeterValue.h>
+#include <ArduinoOcpp/Tasks/Metering/SampledValue.h>
+#include <ArduinoOcpp/Tasks/Transactions/TransactionStore.h>
+#include <ArduinoOcpp/SimpleOcppOperationFactory.h>
+#include "./catch2/catch.hpp"
+#include "./helpers/testHelper.h"
+
+#include <string>
+#include <string.h>
+#include <vector>
+
+using namespace ArduinoOcpp;
+
+class QueuedDummy : public OcppMessage {
+private:
+    const char *action;
+public:
+    QueuedDummy(const char *action) : action(action) { }
+    const char *getOcppOperationType() override {return action;}
+};
+
+static Ocpp16::MeterValues *makeMeterValues(unsigned int connectorId, int reading, std::shared_ptr<Transaction> transaction = nullptr) {
+    static SampledValueProperties properties; //SampledValue keeps a reference to its sampler's properties
+    properties.setMeasurand("Energy.Active.Import.Register");
+    properties.setUnit("Wh");
+
+    std::vector<std::unique_ptr<MeterValue>> meterValue;
+    meterValue.emplace_back(new MeterValue(OcppTimestamp(2022, 11, 30, 9, 41, reading)));
+    meterValue.back()->addSampledValue(std::unique_ptr<SampledValue>(
+            new SampledValueConcrete<int32_t, SampledValueDeSerializer<int32_t>>(properties, ReadingContext::SamplePeriodic, (int32_t) reading)));
+    return new Ocpp16::MeterValues(std::move(meterValue), connectorId, transaction);
+}
+
+TEST_CASE( "Operation priority lanes" ) {
+
+    //initialize the configurations which the OperationStore depends on
+    OcppEchoSocket echoSocket;
+    OCPP_initialize(echoSocket);
+
+    OperationsQueue queue {nullptr, nullptr}; //no filesystem -> operations are only cached
+
+    const char *initiated [] = {"Heartbeat", "StartTransaction", "MeterValues", "StopTransaction",
+                                "StatusNotification", "MeterValues", "Authorize", "StartTransaction"};
+    for (const char *action : initiated) {
+        queue.initiate(makeOcppOperation(new QueuedDummy(action)));
+    }
+
+    std::vector<std::string> sent;
+    while (auto op = queue.front()) {
+        sent.push_back(op->getOcppOperationType());
+        queue.pop_front();
+    }
+
+    //the head (Heartbeat) was already on its way, then interactive, status, transaction in order and metering
+    std::vector<std::string> expected {"Heartbeat", "Authorize", "StatusNotification", "StartTransaction",
+                                "StopTransaction", "StartTransaction", "MeterValues", "MeterValues"};
+    REQUIRE( sent == expected );
+
+    OCPP_deinitialize();
+}
+
+TEST_CASE( "Transaction-related MeterValues" ) {
+
+    OcppEchoSocket echoSocket;
+    OCPP_initialize(echoSocket);
+
+    TransactionStore txStore {2, nullptr};
+    auto tx = txStore.createTransaction(1);
+    REQUIRE( tx );
+
+    OperationsQueue queue {nullptr, nullptr};
+
+    queue.initiate(makeOcppOperation(new QueuedDummy("Heartbeat")));
+    queue.initiate(makeOcppOperation(new QueuedDummy("StartTransaction")));
+    queue.initiate(makeOcppOperation(makeMeterValues(1, 1, tx)));
+    queue.initiate(makeOcppOperation(makeMeterValues(2, 2))); //outside of a transaction
+    queue.initiate(makeOcppOperation(makeMeterValues(1, 3, tx)));
+    queue.initiate(makeOcppOperation(new QueuedDummy("StopTransaction")));
+    queue.initiate(makeOcppOperation(makeMeterValues(1, 4, tx))); //late reading, can't overtake StopTransaction
+
+    //fill the cache with status operations. They replace each other and the metering lane, but not the transaction lane
+    for (unsigned int i = 0; i < 20; i++) {
+        queue.initiate(makeOcppOperation(new QueuedDummy("StatusNotification")));
+    }
+
+    std::vector<std::string> sent;
+    while (auto op = queue.front()) {
+        if (strcmp(op->getOcppOperationType(), "StatusNotification")) {
+            sent.push_back(op->getOcppOperationType());
+        }
+        queue.pop_front();
+    }
+
+    //MeterValues 1 and 3 are sent in one frame
+    std::vector<std::string> expected {"Heartbeat", "StartTransaction", "MeterValues", "StopTransaction", "MeterValues"};
+    REQUIRE( sent == expected );
+
+    OCPP_deinitialize();
+}
+
+TEST_CASE( "Bounded transaction lane" ) {
+
+    OcppEchoSocket echoSocket;
+    OCPP_initialize(echoSocket);
+
+    OperationsQueue queue {nullptr, nullptr};
+
+    //long offline period: without filesystem, transaction operations are only in the cache
+    for (unsigned int i = 0; i < 50; i++) {
+        queue.initiate(makeOcppOperation(new QueuedDummy("StartTransaction")));
+    }
+
+    unsigned int nSent = 0;
+    while (queue.front()) {
+        nSent++;
+        queue.pop_front();
+    }
+
+    //the head and a full cache
+    REQUIRE( nSent == 1 + 10 );
+
+    OCPP_deinitialize();
+}
+
+TEST_CASE( "Coalesce MeterValues" ) {
+
+    OcppEchoSocket echoSocket;
+    OCPP_initialize(echoSocket);
+
+    OperationsQueue queue {nullptr, nullptr};
+
+    queue.initiate(makeOcppOperation(new QueuedDummy("Heartbeat")));
+    queue.initiate(makeOcppOperation(makeMeterValues(1, 1)));
+    queue.initiate(makeOcppOperation(makeMeterValues(1, 2)));
+    queue.initiate(makeOcppOperation(new QueuedDummy("StatusNotification")));
+    queue.initiate(makeOcppOperation(makeMeterValues(1, 3)));
+    queue.initiate(makeOcppOperation(makeMeterValues(2, 4))); //other connector
+    queue.initiate(makeOcppOperation(makeMeterValues(1, 5)));
+
+    std::vector<std::string> sent;
+    while (auto op = queue.front()) {
+        sent.push_back(op->getOcppOperationType());
+        queue.pop_front();
+    }
+
+    //MeterValues 1 - 3 are sent in one frame. MeterValues 5 can't overtake MeterValues 4
+    std::vector<std::string> expected {"Heartbeat", "StatusNotification", "MeterValues", "MeterValues", "MeterValues"};
+    REQUIRE( sent == expected );
+
+    auto merged = makeMeterValues(1, 1);
+    std::unique_ptr<OcppMessage> later {makeMeterValues(1, 2)};
+    REQUIRE( merged->merge(*later, 2000) );
+    std::unique_ptr<OcppMessage> otherConnector {makeMeterValues(2, 3)};
+    REQUIRE( !merged->merge(*otherConnector, 2000) );
+    std::unique_ptr<OcppMessage> tooLarge {makeMeterValues(1, 4)};
+    REQUIRE( !merged->merge(*tooLarge, 100) );
+
+    char buf [1000];
+    JsonWriter writer {buf, sizeof(buf)};
+    merged->writeReq(writer);
+    REQUIRE( writer.isValid() );
+    REQUIRE( std::string(buf, writer.getLength()) ==
+        "{\"connectorId\":1,\"meterValue\":["
+            "{\"timestamp\":\"2022-12-31T09:41:01.000Z\",\"sampledValue\":[{\"value\":\"1\",\"context\":\"Sample.Periodic\",\"measurand\":\"Energy.Active.Import.Register\",\"unit\":\"Wh\"}]},"
+            "{\"timestamp\":\"2022-12-31T09:41:02.000Z\",\"sampledValue\":[{\"value\":\"2\",\"context\":\"Sample.Periodic\",\"measurand\":\"Energy.Active.Import.Register\",\"unit\":\"Wh\"}]}]}" );
+    delete merged;
+
+    OCPP_deinitialize();
+}
+
+TEST_CASE( "Merged operations keep their listeners" ) {
+
+    OcppEchoSocket echoSocket;
+    OCPP_initialize(echoSocket);
+
+    int confirmed1 = 0, confirmed2 = 0, confirmed3 = 0, aborted = 0;
+
+    std::unique_ptr<OcppOperation> op1 {makeOcppOperation(makeMeterValues(1, 1))};
+    op1->setOnReceiveConfListener([&confirmed1] (JsonObject) {confirmed1++;});
+    std::unique_ptr<OcppOperation> op2 {makeOcppOperation(makeMeterValues(1, 2))};
+    op2->setOnReceiveConfListener([&confirmed2] (JsonObject) {confirmed2++;});
+    op2->setOnAbortListener([&aborted] () {aborted++;});
+    std::unique_ptr<OcppOperation> op3 {makeOcppOperation(makeMeterValues(1, 3))};
+    op3->setOnReceiveConfListener([&confirmed3] (JsonObject) {confirmed3++;});
+
+    REQUIRE( op1->merge(*op2, 2000) );
+    REQUIRE( op1->merge(*op3, 2000) );
+    op2.reset();
+    op3.reset();
+
+    DynamicJsonDocument conf (256);
+    conf.add(MESSAGE_TYPE_CALLRESULT);
+    conf.add(op1->getMessageID());
+    conf.createNestedObject();
+    REQUIRE( op1->receiveConf(conf) );
+
+    REQUIRE( confirmed1 == 1 );
+    REQUIRE( confirmed2 == 1 );
+    REQUIRE( confirmed3 == 1 );
+    REQUIRE( aborted == 0 );
+
+    //an operation without listeners takes over the listeners of the merged operation
+    std::unique_ptr<OcppOperation> op4 {makeOcppOperation(makeMeterValues(1, 4))};
+    std::unique_ptr<OcppOperation> op5 {makeOcppOperation(makeMeterValues(1, 5))};
+    op5->setOnAbortListener([&aborted] () {aborted++;});
+    REQUIRE( op4->merge(*op5, 2000) );
+    op5.reset();
+
+    DynamicJsonDocument callError (256);
+    callError.add(MESSAGE_TYPE_CALLERROR);
+    callError.add(op4->getMessageID());
+    callError.add("GenericError");
+    callError.add("");
+    callError.createNestedObject();
+    REQUIRE( op4->receiveError(callError) );
+    REQUIRE( aborted == 1 );
+
+    OCPP_deinitialize();
+}
+
+TEST_CASE( "Pooled operations with shared listeners" ) {
+
+    //the slot of a destroyed operation is handed out again
+    void *slot = nullptr;
+    {
+        std::unique_ptr<OcppOperation> op {makeOcppOperation(new QueuedDummy("Heartbeat"))};
+        slot = op.get();
+    }
+    std::unique_ptr<OcppOperation> op1 {makeOcppOperation(new QueuedDummy("Heartbeat"))};
+    REQUIRE( op1.get() == slot );
+
+    int aborted = 0;
+    auto listeners = std::make_shared<OcppOperationListeners>();
+    listeners->onAbort = [&aborted] () {aborted++;};
+
+    std::unique_ptr<OcppOperation> op2 {makeOcppOperation(new QueuedDummy("Heartbeat"))};
+    op1->setListeners(listeners);
+    op2->setListeners(listeners);
+
+    //setting a single listener doesn't affect the other operation sharing the bundle
+    int op2Errors = 0;
+    op2->setOnReceiveErrorListener([&op2Errors] (const char*, const char*, JsonObject) {op2Errors++;});
+
+    for (auto op : {op1.get(), op2.get()}) {
+        DynamicJsonDocument callError (256);
+        callError.add(MESSAGE_TYPE_CALLERROR);
+        callError.add(op->getMessageID());
+        callError.add("GenericError");
+        callError.add("");
+        callError.createNestedObject();
+        REQUIRE( op->receiveError(callError) );
+    }
+
+    REQUIRE( aborted == 2 );
+    REQUIRE( op2Errors == 1 );
+}
@@ -0,0 +1,154 @@
+#include <ArduinoOcpp/Core/PersistenceExecutor.h>
+#include <ArduinoOcpp/Core/MemoryFilesystemAdapter.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Tasks/Transactions/TransactionStore.h>
+#include "./catch2/catch.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace ArduinoOcpp;
+
+TEST_CASE( "Persistence executor" ) {
+
+    bool threaded = GENERATE(false, true);
+    PersistenceExecutor executor {threaded};
+
+    SECTION("Execute in order") {
+        std::vector<int> executed;
+        std::vector<int> completed;
+        uint32_t lastTicket = 0;
+        for (int i = 0; i < 10; i++) {
+            lastTicket = executor.submit([&executed, i] () {
+                        executed.push_back(i);
+                        return i != 5;
+                    }, [&completed, i] (bool success) {
+                        REQUIRE( success == (i != 5) );
+                        completed.push_back(i);
+                    });
+        }
+
+        REQUIRE( lastTicket == executor.getLatestTicket() );
+
+        executor.flush();
+        REQUIRE( executor.isDurable(lastTicket) );
+        REQUIRE( executor.getPendingCount() == 0 );
+        REQUIRE( executed.size() == 10 );
+        REQUIRE( completed.size() == 10 );
+        for (int i = 0; i < 10; i++) {
+            REQUIRE( executed[i] == i );
+            REQUIRE( completed[i] == i );
+        }
+    }
+
+    SECTION("Callbacks run on the loop") {
+        bool completed = false;
+        auto ticket = executor.submit([] () {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    return true;
+                }, [&completed] (bool) {
+                    completed = true;
+                });
+
+        if (threaded) {
+            REQUIRE( !completed );
+            while (!executor.isDurable(ticket)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            REQUIRE( !completed );
+            executor.loop();
+        }
+
+        REQUIRE( completed );
+    }
+
+    SECTION("Flush on destruction") {
+        bool executed = false;
+        {
+            PersistenceExecutor temporary {threaded};
+            temporary.submit([&executed] () {
+                executed = true;
+                return true;
+            });
+        }
+        REQUIRE( executed );
+    }
+}
+
+TEST_CASE( "Active persistence executor" ) {
+
+    REQUIRE( getActivePersistenceExecutor() == nullptr );
+
+    //without executor, everything is written synchronously
+    REQUIRE( persist([] () {return true;}) );
+    REQUIRE( !persist([] () {return false;}) );
+    REQUIRE( persistence_isDurable(persistence_ticket()) );
+
+    PersistenceExecutor executor {true};
+    setActivePersistenceExecutor(&executor);
+
+    bool executed = false;
+    REQUIRE( persist([&executed] () {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        executed = true;
+        return true;
+    }) );
+
+    auto ticket = persistence_ticket();
+    if (executor.isThreaded()) {
+        REQUIRE( !persistence_isDurable(ticket) );
+    }
+
+    persistence_flush();
+    REQUIRE( executed );
+    REQUIRE( persistence_isDurable(ticket) );
+
+    setActivePersistenceExecutor(nullptr);
+}
+
+TEST_CASE( "Loop latency with persistence worker", "[.][benchmark]" ) {
+
+    //flash-like filesystem: every write blocks for some time
+    MemoryFilesystemProfile profile;
+    profile.writeUs = 2000;
+    profile.delayUs = [] (unsigned long us) {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    };
+    auto filesystem = std::make_shared<MemoryFilesystemAdapter>(profile);
+    configuration_init(filesystem);
+
+    const unsigned int N_COMMITS = 50;
+
+    for (bool threaded : {false, true}) {
+        PersistenceExecutor executor {threaded};
+        setActivePersistenceExecutor(&executor);
+
+        TransactionStore txStore {1, filesystem};
+        auto tx = txStore.createTransaction(0, true);
+        REQUIRE( tx );
+
+        //each commit stands for one loop iteration which updates the tx
+        std::chrono::microseconds maxLatency {0};
+        std::chrono::microseconds totalLatency {0};
+        for (unsigned int i = 0; i < N_COMMITS; i++) {
+            auto t_start = std::chrono::steady_clock::now();
+            REQUIRE( txStore.commit(tx.get()) );
+            executor.loop();
+            auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t_start);
+            maxLatency = std::max(maxLatency, latency);
+            totalLatency += latency;
+
+            //the rest of the loop
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        executor.flush();
+
+        WARN( (threaded ? "Worker thread" : "Synchronous") << ": average loop latency "
+                << totalLatency.count() / N_COMMITS << " us, max " << maxLatency.count() << " us" );
+
+        txStore.remove(0, tx->getTxNr());
+        setActivePersistenceExecutor(nullptr);
+    }
+}
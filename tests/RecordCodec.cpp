@@ -0,0 +1,75 @@
+#include <ArduinoJson.h>
+#include <ArduinoOcpp/Core/RecordCodec.h>
+#include <ArduinoOcpp/Core/Crc32.h>
+#include "./catch2/catch.hpp"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace ArduinoOcpp;
+
+TEST_CASE( "Record codec" ) {
+
+    SECTION("Record layout") {
+        RecordCodec codec {true};
+        std::vector<unsigned char> out;
+        codec.append(out, 'O', "data", 4, 513);
+
+        REQUIRE( out.size() == codec.getRecordSize(4) );
+        REQUIRE( out.size() == 5 + 4 + 4 );
+        REQUIRE( !memcmp(out.data(), "O\x01\x02\x04\x00" "data", 9) );
+        REQUIRE( codec.getType(out.data()) == 'O' );
+        REQUIRE( codec.getOpNr(out.data()) == 513 );
+        REQUIRE( codec.getLength(out.data()) == 4 );
+        REQUIRE( codec.getCrc(out.data() + 9) == crc32(out.data(), 9) );
+        REQUIRE( codec.isIntact(out.data(), out.data() + 5, 4, out.data() + 9) );
+
+        out[6] ^= 0x01;
+        REQUIRE( !codec.isIntact(out.data(), out.data() + 5, 4, out.data() + 9) );
+    }
+
+    SECTION("Serialized documents") {
+        RecordCodec codec {false};
+        DynamicJsonDocument doc {256};
+        doc["key"] = "value";
+        doc["n"] = 42;
+
+        for (auto format : {StorageFormat::Json, StorageFormat::MsgPack}) {
+            std::vector<unsigned char> out;
+            codec.append(out, 'G', nullptr, 0);
+            REQUIRE( codec.appendDocument(out, 'S', doc, format) );
+
+            //the terminating '\0' of the serializer doesn't remain in the record
+            size_t begin = codec.getRecordSize(0);
+            size_t length = codec.getLength(out.data() + begin);
+            REQUIRE( length == FilesystemUtils::measure(doc, format) );
+            REQUIRE( out.size() == begin + codec.getRecordSize(length) );
+
+            const unsigned char *header = out.data() + begin;
+            const unsigned char *data = header + codec.getHeaderSize();
+            REQUIRE( codec.getType(header) == 'S' );
+            REQUIRE( codec.isIntact(header, data, length, data + length) );
+
+            DynamicJsonDocument loaded {256};
+            if (format == StorageFormat::MsgPack) {
+                REQUIRE( deserializeMsgPack(loaded, (const char*) data, length) == DeserializationError::Ok );
+            } else {
+                REQUIRE( deserializeJson(loaded, (const char*) data, length) == DeserializationError::Ok );
+            }
+            REQUIRE( !strcmp(loaded["key"] | "", "value") );
+            REQUIRE( (loaded["n"] | 0) == 42 );
+        }
+    }
+
+    SECTION("Documents which don't fit into a record") {
+        RecordCodec codec {false};
+        DynamicJsonDocument doc {256};
+        std::string big (AO_RECORD_LENGTH_MAX, 'x');
+        doc["key"] = big.c_str();
+
+        std::vector<unsigned char> out;
+        REQUIRE( !codec.appendDocument(out, 'S', doc, StorageFormat::Json) );
+        REQUIRE( out.empty() );
+    }
+}
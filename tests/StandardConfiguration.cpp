@@ -0,0 +1,51 @@
+#include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/StandardConfiguration.h>
+#include "./catch2/catch.hpp"
+
+#include <string.h>
+
+using namespace ArduinoOcpp;
+using namespace ArduinoOcpp::Ocpp16;
+
+TEST_CASE( "Standard configurations" ) {
+
+    configuration_init(nullptr); //registers the standard configurations. Tolerates multiple calls
+
+    SECTION("Registered in the containers") {
+        for (auto& entry : standardConfigurationTable) {
+            auto configuration = getConfiguration(entry.key);
+            REQUIRE( configuration.get() == entry.configuration );
+            REQUIRE( !strcmp(configuration->getKey(), entry.key) );
+            REQUIRE( configuration->permissionRemotePeerCanWrite() == entry.remotePeerCanWrite );
+            REQUIRE( configuration->permissionRemotePeerCanRead() == entry.remotePeerCanRead );
+        }
+    }
+
+    SECTION("Declaring a standard key returns the static configuration") {
+        auto heartbeatInterval = declareConfiguration<int>("HeartbeatInterval", 1);
+        REQUIRE( heartbeatInterval.get() == &standardConfigurations.HeartbeatInterval );
+        REQUIRE( (int) *heartbeatInterval != 1 ); //the default of the declaration doesn't apply
+
+        auto sampledData = declareConfiguration<const char*>("MeterValuesSampledData", "");
+        REQUIRE( sampledData.get() == &standardConfigurations.MeterValuesSampledData );
+    }
+
+    SECTION("Changes are visible to the typed accessors") {
+        //like ChangeConfiguration
+        auto configuration = std::static_pointer_cast<Configuration<int>>(getConfiguration("MeterValueSampleInterval"));
+        REQUIRE( configuration );
+        int defaultValue = *configuration;
+
+        *configuration = 15;
+        REQUIRE( (int) standardConfigurations.MeterValueSampleInterval == 15 );
+
+        standardConfigurations.MeterValueSampleInterval = defaultValue;
+        REQUIRE( (int) *configuration == defaultValue );
+    }
+
+    SECTION("Read-only keys") {
+        int maxKeys = standardConfigurations.GetConfigurationMaxKeys;
+        standardConfigurations.GetConfigurationMaxKeys = maxKeys + 1;
+        REQUIRE( (int) standardConfigurations.GetConfigurationMaxKeys == maxKeys );
+    }
+}
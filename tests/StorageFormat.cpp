@@ -0,0 +1,193 @@
+#include <ArduinoJson.h>
+#include <ArduinoOcpp/Core/FilesystemUtils.h>
+#include <ArduinoOcpp/Core/JsonCapacity.h>
+#include "./catch2/catch.hpp"
+
+#include <string.h>
+#include <memory>
+#include <vector>
+
+#define TEST_FN AO_FILENAME_PREFIX "/format.jsn"
+
+using namespace ArduinoOcpp;
+
+//stored documents as written by previous versions
+static const char *storedDocuments [] = {
+    "{\"session\":{\"idTag\":\"04A2B3C4D5E6F7\",\"timestamp\":\"2022-12-01T09:41:27.123Z\",\"txProfileId\":-1},"
+        "\"start\":{\"rpc\":{\"requested\":true,\"confirmed\":true},\"client\":{\"timestamp\":\"2022-12-01T09:41:30.000Z\","
+        "\"meter\":123456},\"server\":{\"transactionId\":987654,\"authorized\":true}},"
+        "\"stop\":{\"rpc\":{\"requested\":false,\"confirmed\":false},\"client\":{}}}",
+    "{\"timestamp\":\"2022-12-01T10:00:00.000Z\",\"sampledValue\":[{\"value\":\"12345.6\",\"context\":\"Transaction.End\","
+        "\"measurand\":\"Energy.Active.Import.Register\",\"unit\":\"Wh\"},{\"value\":\"-3.25\",\"measurand\":\"Power.Active.Import\"}]}",
+    "{\"rpc\":[2,\"1000003\",\"StopTransaction\"],\"payload\":{\"meterStop\":1234567,\"timestamp\":\"2022-12-01T10:00:00.000Z\","
+        "\"transactionId\":987654,\"reason\":\"Local\",\"idTag\":\"04A2B3C4D5E6F7\",\"transactionData\":[]}}",
+    "[0,1,-1,127,128,-129,65536,4294967296,1.5,true,false,null,\"\",[],{}]"
+};
+
+TEST_CASE( "Storage formats" ) {
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use);
+    REQUIRE( filesystem );
+
+    SECTION("MessagePack capacity") {
+        for (const char *json : storedDocuments) {
+            DynamicJsonDocument doc {2048};
+            REQUIRE( deserializeJson(doc, json) == DeserializationError::Ok );
+
+            char msgPack [1024];
+            size_t length = serializeMsgPack(doc, msgPack, sizeof(msgPack));
+            REQUIRE( length > 0 );
+            REQUIRE( length < measureJson(doc) );
+            REQUIRE( FilesystemUtils::detectFormat(msgPack, length) == StorageFormat::MsgPack );
+
+            size_t capacity = measureMsgPackCapacity(msgPack, length);
+            REQUIRE( capacity > 0 );
+
+            DynamicJsonDocument restored {capacity};
+            REQUIRE( deserializeMsgPack(restored, (const char*) msgPack, length) == DeserializationError::Ok );
+            REQUIRE( restored == doc );
+
+            //truncated input
+            REQUIRE( measureMsgPackCapacity(msgPack, length - 1) == 0 );
+        }
+    }
+
+    SECTION("Store and load") {
+        DynamicJsonDocument doc {2048};
+        REQUIRE( deserializeJson(doc, storedDocuments[0]) == DeserializationError::Ok );
+
+        REQUIRE( FilesystemUtils::storeJson(filesystem, TEST_FN, doc, StorageFormat::MsgPack) );
+        size_t msize = 0;
+        REQUIRE( filesystem->stat(TEST_FN, &msize) == 0 );
+        REQUIRE( msize == measureMsgPack(doc) );
+
+        auto loaded = FilesystemUtils::loadJson(filesystem, TEST_FN);
+        REQUIRE( loaded );
+        REQUIRE( *loaded == doc );
+    }
+
+    SECTION("Migration from JSON files") {
+        auto file = filesystem->open(TEST_FN, "w");
+        REQUIRE( file );
+        file->write(storedDocuments[1], strlen(storedDocuments[1]));
+        file.reset();
+
+        auto loaded = FilesystemUtils::loadJson(filesystem, TEST_FN);
+        REQUIRE( loaded );
+        REQUIRE( !strcmp((*loaded)["sampledValue"][0]["unit"] | "", "Wh") );
+
+        //the next store converts the file
+        REQUIRE( FilesystemUtils::storeJson(filesystem, TEST_FN, *loaded, StorageFormat::MsgPack) );
+        auto converted = FilesystemUtils::loadJson(filesystem, TEST_FN);
+        REQUIRE( converted );
+        REQUIRE( *converted == *loaded );
+    }
+
+    SECTION("Zero-copy load") {
+        DynamicJsonDocument doc {2048};
+        REQUIRE( deserializeJson(doc, storedDocuments[0]) == DeserializationError::Ok );
+
+        for (auto format : {StorageFormat::Json, StorageFormat::MsgPack}) {
+            REQUIRE( FilesystemUtils::storeJson(filesystem, TEST_FN, doc, format) );
+            size_t msize = 0;
+            REQUIRE( filesystem->stat(TEST_FN, &msize) == 0 );
+
+            {
+                std::unique_ptr<MappedFile> mapping;
+                auto loaded = FilesystemUtils::loadJson(filesystem, TEST_FN, &mapping);
+                REQUIRE( loaded );
+                REQUIRE( *loaded == doc );
+#if AO_PLATFORM == AO_PLATFORM_UNIX
+                REQUIRE( mapping );
+#endif
+            }
+
+            //in-place parsing doesn't change the file
+            size_t msize2 = 0;
+            REQUIRE( filesystem->stat(TEST_FN, &msize2) == 0 );
+            REQUIRE( msize2 == msize );
+            auto reloaded = FilesystemUtils::loadJson(filesystem, TEST_FN);
+            REQUIRE( reloaded );
+            REQUIRE( *reloaded == doc );
+        }
+    }
+
+    filesystem->remove(TEST_FN);
+}
+
+TEST_CASE( "Storage format benchmark", "[.][benchmark]" ) {
+
+    size_t jsonSize = 0, msgPackSize = 0;
+
+    std::vector<std::vector<char>> msgPackDocuments;
+    for (const char *json : storedDocuments) {
+        DynamicJsonDocument doc {2048};
+        deserializeJson(doc, json);
+        std::vector<char> msgPack (measureMsgPack(doc));
+        serializeMsgPack(doc, msgPack.data(), msgPack.size());
+        msgPackDocuments.push_back(std::move(msgPack));
+
+        jsonSize += strlen(json);
+        msgPackSize += measureMsgPack(doc);
+    }
+
+    WARN( "Stored size: JSON " << jsonSize << " bytes, MessagePack " << msgPackSize << " bytes" );
+
+    BENCHMARK("Parse stored documents, JSON") {
+        size_t nParsed = 0;
+        for (const char *json : storedDocuments) {
+            size_t length = strlen(json);
+            DynamicJsonDocument doc {measureJsonCapacity(json, length)};
+            deserializeJson(doc, json, length);
+            nParsed++;
+        }
+        return nParsed;
+    };
+
+    BENCHMARK("Parse stored documents, MessagePack") {
+        size_t nParsed = 0;
+        for (auto& msgPack : msgPackDocuments) {
+            DynamicJsonDocument doc {measureMsgPackCapacity(msgPack.data(), msgPack.size())};
+            deserializeMsgPack(doc, (const char*) msgPack.data(), msgPack.size());
+            nParsed++;
+        }
+        return nParsed;
+    };
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use);
+    DynamicJsonDocument txDoc {2048};
+    deserializeJson(txDoc, storedDocuments[0]);
+
+    BENCHMARK("Store and load tx, JSON") {
+        FilesystemUtils::storeJson(filesystem, TEST_FN, txDoc, StorageFormat::Json);
+        return FilesystemUtils::loadJson(filesystem, TEST_FN);
+    };
+
+    BENCHMARK("Store and load tx, MessagePack") {
+        FilesystemUtils::storeJson(filesystem, TEST_FN, txDoc, StorageFormat::MsgPack);
+        return FilesystemUtils::loadJson(filesystem, TEST_FN);
+    };
+
+    FilesystemUtils::storeJson(filesystem, TEST_FN, txDoc, StorageFormat::MsgPack);
+
+    BENCHMARK("Load tx 1000 times") {
+        size_t nLoaded = 0;
+        for (unsigned int i = 0; i < 1000; i++) {
+            auto doc = FilesystemUtils::loadJson(filesystem, TEST_FN);
+            nLoaded += doc ? 1 : 0;
+        }
+        return nLoaded;
+    };
+
+    BENCHMARK("Load tx 1000 times, zero-copy") {
+        size_t nLoaded = 0;
+        for (unsigned int i = 0; i < 1000; i++) {
+            std::unique_ptr<MappedFile> mapping;
+            auto doc = FilesystemUtils::loadJson(filesystem, TEST_FN, &mapping);
+            nLoaded += doc ? 1 : 0;
+        }
+        return nLoaded;
+    };
+
+    filesystem->remove(TEST_FN);
+}
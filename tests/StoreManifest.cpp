@@ -0,0 +1,153 @@
+#include <ArduinoOcpp/Core/StoreManifest.h>
+#include <ArduinoOcpp/Core/OperationStore.h>
+#include <ArduinoOcpp/Core/OperationLog.h>
+#include <ArduinoOcpp/Core/FilesystemAdapter.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Tasks/Transactions/TransactionStore.h>
+#include "./catch2/catch.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#define MANIFEST_0 AO_FILENAME_PREFIX "/test-0.mf"
+#define MANIFEST_1 AO_FILENAME_PREFIX "/test-1.mf"
+
+using namespace ArduinoOcpp;
+
+TEST_CASE( "Store manifest" ) {
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use);
+    REQUIRE( filesystem );
+
+    filesystem->remove(MANIFEST_0);
+    filesystem->remove(MANIFEST_1);
+
+    SECTION("Restore after reboot") {
+        StoreManifest manifest {filesystem, "test"};
+        REQUIRE( !manifest.load() );
+        REQUIRE( manifest.add(7, 100) );
+        REQUIRE( manifest.add(3, 50) );
+        REQUIRE( manifest.remove(7) );
+        REQUIRE( manifest.add(9, 20) );
+
+        //both slots exist after the first save
+        size_t msize;
+        REQUIRE( filesystem->stat(MANIFEST_0, &msize) == 0 );
+        REQUIRE( filesystem->stat(MANIFEST_1, &msize) == 0 );
+
+        StoreManifest rebooted {filesystem, "test"};
+        REQUIRE( rebooted.load() );
+        REQUIRE( rebooted.getEntries().size() == 2 );
+        REQUIRE( rebooted.getSize(3) == 50 );
+        REQUIRE( rebooted.getSize(9) == 20 );
+        REQUIRE( !rebooted.contains(7) );
+    }
+
+    SECTION("Interrupted save") {
+        {
+            StoreManifest manifest {filesystem, "test"};
+            manifest.load();
+            manifest.add(1, 10);
+            manifest.add(2, 10);
+        }
+
+        //power loss while writing the latest revision (slot 0)
+        auto file = filesystem->open(MANIFEST_0, "w");
+        file->write("M\x05\x00", 3);
+        file.reset();
+
+        StoreManifest rebooted {filesystem, "test"};
+        REQUIRE( rebooted.load() );
+        REQUIRE( rebooted.getEntries().size() == 1 );
+        REQUIRE( rebooted.contains(1) );
+
+        //the corrupted slot is overwritten
+        REQUIRE( rebooted.add(3, 10) );
+        StoreManifest rebooted2 {filesystem, "test"};
+        REQUIRE( rebooted2.load() );
+        REQUIRE( rebooted2.contains(1) );
+        REQUIRE( rebooted2.contains(3) );
+    }
+
+    SECTION("TransactionStore") {
+        configuration_init(filesystem);
+
+        unsigned int txNr = 0;
+        {
+            TransactionStore store {2, filesystem};
+            auto tx = store.createTransaction(1);
+            REQUIRE( tx );
+            txNr = tx->getTxNr();
+        }
+
+        TransactionStore rebooted {2, filesystem};
+        REQUIRE( rebooted.getTransaction(1, txNr) );
+        REQUIRE( !rebooted.getTransaction(1, txNr + 1) );
+
+        REQUIRE( rebooted.remove(1, txNr) );
+        REQUIRE( !rebooted.getTransaction(1, txNr) );
+
+        TransactionStore rebooted2 {2, filesystem};
+        REQUIRE( !rebooted2.getTransaction(1, txNr) );
+    }
+}
+
+TEST_CASE( "Boot with 1k stored records benchmark", "[.][benchmark]" ) {
+
+    const unsigned int N_RECORDS = 1000;
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use);
+    configuration_init(filesystem);
+
+    filesystem->remove(MANIFEST_0);
+    filesystem->remove(MANIFEST_1);
+    filesystem->remove(AO_FILENAME_PREFIX "/oplog-0.wal");
+    filesystem->remove(AO_FILENAME_PREFIX "/oplog-1.wal");
+
+    {
+        StoreManifest manifest {filesystem, "test"};
+        manifest.load();
+        for (unsigned int i = 0; i < N_RECORDS; i++) {
+            char fn [MAX_PATH_SIZE];
+            snprintf(fn, sizeof(fn), AO_FILENAME_PREFIX "/bm-%u.jsn", i);
+            auto file = filesystem->open(fn, "w");
+            file->write("{}", 2);
+            manifest.put(i, 2);
+        }
+        manifest.save();
+
+        OperationLog log {filesystem};
+        log.load(0);
+        for (unsigned int i = 0; i < N_RECORDS; i++) {
+            log.append(i, "[2,\"1\",\"Heartbeat\",{}]", 22);
+        }
+    }
+
+    BENCHMARK("Find 1k records by probing the filesystem") {
+        //search until three consecutive misses
+        unsigned int found = 0, misses = 0;
+        for (unsigned int i = 0; misses < 3; i++) {
+            char fn [MAX_PATH_SIZE];
+            snprintf(fn, sizeof(fn), AO_FILENAME_PREFIX "/bm-%u.jsn", i);
+            size_t msize;
+            if (filesystem->stat(fn, &msize) == 0) {
+                found++;
+                misses = 0;
+            } else {
+                misses++;
+            }
+        }
+        return found;
+    };
+
+    BENCHMARK("Find 1k records in the manifest") {
+        StoreManifest manifest {filesystem, "test"};
+        manifest.load();
+        return manifest.getEntries().size();
+    };
+
+    BENCHMARK("Boot OperationStore with 1k stored operations") {
+        OperationStore store {filesystem};
+        return store.getOpEnd();
+    };
+}
@@ -108,4 +108,48 @@ TEST_CASE( "Transaction safety" ) {
         OCPP_deinitialize();
     }
 
+    SECTION("Configuration writes per charging session") {
+        AO_DBG_DEBUG("Configuration writes per charging session");
+        OCPP_loop();
+        OCPP_loop();
+        OCPP_loop();
+        configuration_save();
+        auto writesBefore = configuration_write_count();
+
+        setConnectorPluggedInput([] () {return true;});
+        beginTransaction("mIdTag");
+        loop();
+        REQUIRE(ocppPermitsCharge());
+        endTransaction();
+        loop();
+        REQUIRE(!ocppPermitsCharge());
+
+        auto writes = configuration_write_count() - writesBefore;
+        WARN("configuration writes per charging session: " << writes);
+        REQUIRE(writes <= 4);
+        OCPP_deinitialize();
+    }
+
+    SECTION("Coalesced configuration writes") {
+        AO_DBG_DEBUG("Coalesced configuration writes");
+        OCPP_loop();
+        OCPP_loop();
+        OCPP_loop();
+        configuration_save();
+        auto writesBefore = configuration_write_count();
+
+        auto heartbeatInterval = declareConfiguration<int>("HeartbeatInterval", 86400);
+        for (int i = 0; i < 10; i++) {
+            *heartbeatInterval = 100 + i;
+            configuration_save_deferred();
+            OCPP_loop();
+        }
+        REQUIRE(configuration_write_count() == writesBefore);
+
+        mtime += AO_CONFIG_FLUSH_WINDOW;
+        OCPP_loop();
+        REQUIRE(configuration_write_count() == writesBefore + 1);
+        OCPP_deinitialize();
+    }
+
 }